@@ -692,6 +692,9 @@ bool CApplication::Create()
     return false;
   }
 
+  // the scheduler can only change before the first job, so it is set up once here
+  CJobManager::GetInstance().SetScheduler(g_advancedSettings.m_jobWorkStealing, g_advancedSettings.m_jobMaxWorkers);
+
   CLog::Log(LOGINFO, "creating subdirectories");
   CLog::Log(LOGINFO, "userdata folder: %s", g_settings.GetProfileUserDataFolder().c_str());
   CLog::Log(LOGINFO, "recording folder: %s", g_guiSettings.GetString("audiocds.recordingpath",false).c_str());
@@ -1986,6 +1989,10 @@ void CApplication::LoadSkin(const SkinPtr& skin)
 
   g_localizeStrings.LoadSkinStrings(langPath, g_guiSettings.GetString("locale.language"));
 
+  // rasterize the glyphs of the language while the skin loads, rather than as they're first drawn.
+  // Each font takes the most frequent characters that fit its glyph texture
+  g_fontManager.PrefetchText(g_localizeStrings.GetCommonCharacters());
+
   g_SkinInfo->LoadIncludes();
 
   int64_t start;
@@ -3619,6 +3626,9 @@ void CApplication::Stop(int exitCode)
 
     m_network.StopServices();
 
+    CLog::Log(LOGNOTICE, "close databases");
+    CDatabaseManager::Get().Deinitialize();
+
     g_Windowing.DestroyRenderSystem();
     g_Windowing.DestroyWindow();
     g_Windowing.DestroyWindowSystem();
@@ -4605,6 +4615,7 @@ bool CApplication::WakeUpScreenSaver(bool bPowerOffKeyPressed /* = false */)
 
     // disable screensaver
     m_bScreenSave = false;
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
     m_iScreenSaveLock = 0;
     ResetScreenSaverTimer();
 
@@ -4644,6 +4655,7 @@ void CApplication::CheckScreenSaverAndDPMS()
   if (maybeScreensaver && g_windowManager.IsWindowActive(WINDOW_SCREENSAVER))
   {
     m_bScreenSave = true;
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
     maybeScreensaver = false;
   }
 
@@ -4688,6 +4700,7 @@ void CApplication::CheckScreenSaverAndDPMS()
 void CApplication::ActivateScreenSaver(bool forceType /*= false */)
 {
   m_bScreenSave = true;
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
 
   // Get Screensaver Mode
   m_screenSaver.reset();
@@ -4767,6 +4780,7 @@ void CApplication::CheckShutdown()
 void CApplication::InhibitIdleShutdown(bool inhibit)
 {
   m_bInhibitIdleShutdown = inhibit;
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
 }
 
 bool CApplication::IsIdleShutdownInhibited() const
@@ -5402,6 +5416,7 @@ void CApplication::VolumeChanged() const
   data["volume"] = GetVolume();
   data["muted"] = g_settings.m_bMute;
   CAnnouncementManager::Announce(Application, "xbmc", "OnVolumeChanged", data);
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_PLAYER);
 
   // if player has volume control, set it.
   if (m_pPlayer && m_pPlayer->ControlsVolume())
@@ -28,11 +28,27 @@
 #include "pvr/PVRDatabase.h"
 #include "epg/EpgDatabase.h"
 #include "settings/AdvancedSettings.h"
+#include "dbwrappers/dataset.h"
+#include "threads/SystemClock.h"
+
+// how long a writer waits in the queue before falling back to sqlite's busy handling
+#define WRITER_QUEUE_TIMEOUT 30000
 
 using namespace std;
 using namespace EPG;
 using namespace PVR;
 
+/* the writer queue of one database, as seen by its connections */
+class CDatabaseWriteQueue : public dbiplus::WriteQueue
+{
+public:
+  CDatabaseWriteQueue(const std::string &key) : m_key(key) {}
+  virtual bool begin_write() { return CDatabaseManager::Get().BeginWrite(m_key); }
+  virtual void end_write()   { CDatabaseManager::Get().EndWrite(m_key); }
+private:
+  std::string m_key;
+};
+
 CDatabaseManager &CDatabaseManager::Get()
 {
   static CDatabaseManager s_manager;
@@ -45,6 +61,9 @@ CDatabaseManager::CDatabaseManager()
 
 CDatabaseManager::~CDatabaseManager()
 {
+  CloseConnections();
+  for (map<string, dbiplus::WriteQueue*>::iterator i = m_writeQueues.begin(); i != m_writeQueues.end(); ++i)
+    delete i->second;
 }
 
 void CDatabaseManager::Initialize(bool addonsOnly)
@@ -68,8 +87,11 @@ void CDatabaseManager::Initialize(bool addonsOnly)
 
 void CDatabaseManager::Deinitialize()
 {
-  CSingleLock lock(m_section);
-  m_dbStatus.clear();
+  {
+    CSingleLock lock(m_section);
+    m_dbStatus.clear();
+  }
+  CloseConnections();
 }
 
 bool CDatabaseManager::CanOpen(const std::string &name)
@@ -96,3 +118,93 @@ void CDatabaseManager::UpdateStatus(const std::string &name, DB_STATUS status)
   CSingleLock lock(m_section);
   m_dbStatus[name] = status;
 }
+
+dbiplus::Database *CDatabaseManager::AcquireConnection(const std::string &key)
+{
+  CSingleLock lock(m_poolSection);
+  map<string, Connections>::iterator i = m_pool.find(key);
+  if (i == m_pool.end() || i->second.empty())
+    return NULL;
+
+  dbiplus::Database *db = i->second.back();
+  i->second.pop_back();
+  return db;
+}
+
+void CDatabaseManager::ReleaseConnection(const std::string &key, dbiplus::Database *db)
+{
+  if (!db)
+    return;
+
+  {
+    CSingleLock lock(m_poolSection);
+    Connections &idle = m_pool[key];
+    if (idle.size() < g_advancedSettings.m_databasePoolSize)
+    {
+      idle.push_back(db);
+      return;
+    }
+  }
+
+  // pool is full
+  db->disconnect();
+  delete db;
+}
+
+void CDatabaseManager::CloseConnections()
+{
+  Connections connections;
+  {
+    CSingleLock lock(m_poolSection);
+    for (map<string, Connections>::iterator i = m_pool.begin(); i != m_pool.end(); ++i)
+      connections.insert(connections.end(), i->second.begin(), i->second.end());
+    m_pool.clear();
+  }
+
+  for (Connections::iterator i = connections.begin(); i != connections.end(); ++i)
+  {
+    (*i)->disconnect();
+    delete *i;
+  }
+}
+
+dbiplus::WriteQueue *CDatabaseManager::GetWriteQueue(const std::string &key)
+{
+  CSingleLock lock(m_poolSection);
+  dbiplus::WriteQueue *&queue = m_writeQueues[key];
+  if (!queue)
+    queue = new CDatabaseWriteQueue(key);
+  return queue;
+}
+
+bool CDatabaseManager::BeginWrite(const std::string &key)
+{
+  XbmcThreads::EndTime timeout(WRITER_QUEUE_TIMEOUT);
+
+  CSingleLock lock(m_poolSection);
+  Writer &writer = m_writers[key];
+  while (writer.depth > 0 && !CThread::IsCurrentThread(writer.owner))
+  {
+    if (timeout.IsTimePast())
+    {
+      CLog::Log(LOGWARNING, "%s - timed out waiting for the writer queue of %s", __FUNCTION__, key.c_str());
+      return false;
+    }
+    m_writerDone.wait(lock, timeout.MillisLeft());
+  }
+
+  writer.owner = CThread::GetCurrentThreadId();
+  writer.depth++;
+  return true;
+}
+
+void CDatabaseManager::EndWrite(const std::string &key)
+{
+  CSingleLock lock(m_poolSection);
+  map<string, Writer>::iterator i = m_writers.find(key);
+  if (i == m_writers.end() || i->second.depth == 0)
+    return;
+
+  if (--i->second.depth == 0)
+    m_writerDone.notifyAll();
+}
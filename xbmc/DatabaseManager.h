@@ -22,12 +22,20 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "threads/CriticalSection.h"
+#include "threads/Condition.h"
 #include "threads/Event.h"
+#include "threads/Thread.h"
 
 class CDatabase;
 class DatabaseSettings;
 
+namespace dbiplus {
+  class Database;
+  class WriteQueue;
+}
+
 /*!
  \ingroup database
  \brief Database manager class for handling database updating
@@ -35,6 +43,13 @@ class DatabaseSettings;
  Ensures that databases used in XBMC are up to date, and if a database can't be
  opened, ensures we don't continuously try it.
 
+ Also owns the pool of idle sqlite connections that CDatabase instances draw from
+ on Open() and hand back on Close(), and the per-database writer queue that
+ serializes writes, in transactions or not, so that they wait their turn instead
+ of spinning in sqlite's busy handler. Combined with WAL journaling (opt-in, see
+ advancedsettings) this lets readers (GUI, JSON-RPC) run concurrently with a
+ single writer (e.g. a library scan).
+
  */
 class CDatabaseManager
 {
@@ -65,6 +80,43 @@ public:
    */ 
   bool CanOpen(const std::string &name);
 
+  /*! \brief Take an idle connection from the pool.
+   \param key the pool key of the database (host and versioned database name).
+   \return an open connection, or NULL if no idle connection is available.
+   \sa ReleaseConnection
+   */
+  dbiplus::Database *AcquireConnection(const std::string &key);
+
+  /*! \brief Hand a connection back to the pool.
+   The connection is kept open for the next AcquireConnection() call with the same key,
+   unless the pool for that key is full, in which case it is disconnected and deleted.
+   \param key the pool key of the database.
+   \param db the connection to return. Ownership is transferred to the manager.
+   */
+  void ReleaseConnection(const std::string &key, dbiplus::Database *db);
+
+  /*! \brief Get the writer queue of a database, for its connections to take turns writing.
+   Transactions and statements run outside a transaction on a connection with the queue
+   set enter it through BeginWrite() and leave it through EndWrite().
+   \param key the pool key of the database.
+   \return the queue, owned by the manager.
+   */
+  dbiplus::WriteQueue *GetWriteQueue(const std::string &key);
+
+  /*! \brief Enter the writer queue of a database.
+   Blocks until no other thread is writing to the database. Recursive for the calling thread.
+   \param key the pool key of the database.
+   \return true if the caller now owns the writer slot and must call EndWrite(), false if
+   the wait timed out (the caller may still write and rely on sqlite's own locking).
+   */
+  bool BeginWrite(const std::string &key);
+
+  /*! \brief Leave the writer queue of a database, waking the next queued writer.
+   \param key the pool key of the database.
+   \sa BeginWrite
+   */
+  void EndWrite(const std::string &key);
+
 private:
   // private construction, and no assignements; use the provided singleton methods
   CDatabaseManager();
@@ -75,7 +127,23 @@ private:
   enum DB_STATUS { DB_CLOSED, DB_UPDATING, DB_READY, DB_FAILED };
   void UpdateStatus(const std::string &name, DB_STATUS status);
   void UpdateDatabase(CDatabase &db, DatabaseSettings *settings = NULL);
+  void CloseConnections();
+
+  struct Writer
+  {
+    Writer() : depth(0) {}
+    ThreadIdentifier owner;
+    unsigned int     depth;
+  };
+
+  typedef std::vector<dbiplus::Database*> Connections;
 
   CCriticalSection            m_section;     ///< Critical section protecting m_dbStatus.
   std::map<std::string, DB_STATUS> m_dbStatus;    ///< Our database status map.
+
+  CCriticalSection            m_poolSection; ///< Critical section protecting m_pool and m_writers.
+  std::map<std::string, Connections> m_pool; ///< Idle connections per database.
+  std::map<std::string, Writer> m_writers;   ///< Current writer per database.
+  std::map<std::string, dbiplus::WriteQueue*> m_writeQueues; ///< Writer queue handed to the connections of each database.
+  XbmcThreads::ConditionVariable m_writerDone; ///< Signalled whenever a writer leaves the queue.
 };
@@ -113,6 +113,17 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowCodec = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  for (unsigned int i = 0; i < sizeof(m_sourceVersions) / sizeof(m_sourceVersions[0]); i++)
+    m_sourceVersions[i] = 0;
+  m_playerStatePlaying = false;
+  m_playerStatePaused = false;
+  m_playerStateAudio = false;
+  m_playerStateVideo = false;
+  m_playerStateSpeed = 1;
+  m_boolEvaluations = 0;
+  m_boolsCached = 0;
+  m_lastBoolEvaluations = 0;
+  m_lastBoolsCached = 0;
   ResetLibraryBools();
 }
 
@@ -1993,22 +2004,14 @@ bool CGUIInfoManager::EvaluateBool(const CStdString &expression, int contextWind
 }
 
 /*
- TODO: what to do with item-based infobools...
- these crop up:
+ Item-based infobools crop up:
  1. if condition is between LISTITEM_START and LISTITEM_END
  2. if condition is STRING_IS_EMPTY, STRING_COMPARE, STRING_STR, INTEGER_GREATER_THAN and the
     corresponding label is between LISTITEM_START and LISTITEM_END
 
- In both cases they shouldn't be in our cache as they depend on items outside of our control atm.
-
- We only pass a listitem object in for controls inside a listitemlayout, so I think it's probably OK
- to not cache these, as they're "pushed" out anyway.
-
- The problem is how do we avoid these?  The only thing we have to go on is the expression here, so I
- guess what we have to do is call through via Update.  One thing we don't handle, however, is that the
- majority of conditions (even inside lists) don't depend on the listitem at all.
-
- Advantage is that we know this at creation time I think, so could perhaps signal it in IsDirty()?
+ These are flagged as depending on INFO_SOURCE_LISTITEM and are evaluated for every item they're
+ asked for.  The majority of conditions (even inside lists) don't depend on the listitem at all, so
+ they're evaluated once, without the item, and the value reused for every item.
  */
 bool CGUIInfoManager::GetBoolValue(unsigned int expression, const CGUIListItem *item)
 {
@@ -2017,6 +2020,139 @@ bool CGUIInfoManager::GetBoolValue(unsigned int expression, const CGUIListItem *
   return false;
 }
 
+CStdString CGUIInfoManager::GetBoolExpression(unsigned int expression)
+{
+  CSingleLock lock(m_critInfo);
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetExpression();
+  return "";
+}
+
+unsigned int CGUIInfoManager::GetBoolSources(unsigned int expression)
+{
+  CSingleLock lock(m_critInfo);
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetSources();
+  return INFO_SOURCE_VOLATILE;
+}
+
+void CGUIInfoManager::SourceChanged(unsigned int sources)
+{
+  CSingleLock lock(m_critInfo);
+  for (unsigned int i = 0; i < sizeof(m_sourceVersions) / sizeof(m_sourceVersions[0]); i++)
+  {
+    if (sources & (1 << i))
+      m_sourceVersions[i]++;
+  }
+}
+
+unsigned int CGUIInfoManager::GetSourcesVersion(unsigned int sources) const
+{
+  // each version only ever increases, so neither does their sum
+  unsigned int version = 0;
+  for (unsigned int i = 0; sources; i++, sources >>= 1)
+  {
+    if (sources & 1)
+      version += m_sourceVersions[i];
+  }
+  return version;
+}
+
+void CGUIInfoManager::UpdatePlayerState()
+{
+  bool playing = g_application.IsPlaying();
+  bool paused = playing && g_application.IsPaused();
+  bool audio = playing && g_application.IsPlayingAudio();
+  bool video = playing && g_application.IsPlayingVideo();
+  int speed = playing ? g_application.GetPlaySpeed() : 1;
+  if (playing != m_playerStatePlaying || paused != m_playerStatePaused || audio != m_playerStateAudio ||
+      video != m_playerStateVideo || speed != m_playerStateSpeed)
+  {
+    m_playerStatePlaying = playing;
+    m_playerStatePaused = paused;
+    m_playerStateAudio = audio;
+    m_playerStateVideo = video;
+    m_playerStateSpeed = speed;
+    SourceChanged(INFO_SOURCE_PLAYER);
+  }
+}
+
+void CGUIInfoManager::GetBoolStatistics(unsigned int &evaluated, unsigned int &cached) const
+{
+  evaluated = m_lastBoolEvaluations;
+  cached = m_lastBoolsCached;
+}
+
+bool CGUIInfoManager::IsListItemInfo(int info) const
+{
+  info = abs(info);
+  if (info >= LISTITEM_START && info <= LISTITEM_END)
+    return true;
+  if (info >= MULTI_INFO_START && info <= MULTI_INFO_END && info - MULTI_INFO_START < (int)m_multiInfo.size())
+  {
+    int multiInfo = m_multiInfo[info - MULTI_INFO_START].m_info;
+    return multiInfo >= LISTITEM_START && multiInfo <= LISTITEM_END;
+  }
+  return false;
+}
+
+unsigned int CGUIInfoManager::GetConditionSources(int condition1) const
+{
+  int condition = abs(condition1);
+
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE || condition == SYSTEM_ETHERNET_LINK_ACTIVE ||
+     (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_ANDROID))
+    return 0; // never change
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_MUSICVIDEOS)
+    return INFO_SOURCE_LIBRARY;
+  // listitem conditions evaluated without an item depend on the focused item of a container
+  if (IsListItemInfo(condition))
+    return INFO_SOURCE_LISTITEM | INFO_SOURCE_VOLATILE;
+  if ((condition >= PLAYER_HAS_MEDIA && condition <= PLAYER_FORWARDING_32x) ||
+      condition == PLAYER_MUTED || condition == PLAYER_SHOWINFO || condition == PLAYER_SHOWCODEC)
+    return INFO_SOURCE_PLAYER;
+  if (condition == WINDOW_IS_MEDIA || condition == SYSTEM_LOGGEDON)
+    return INFO_SOURCE_WINDOW;
+  if (condition == SYSTEM_SCREENSAVER_ACTIVE || condition == SYSTEM_ISINHIBIT || condition == SYSTEM_HAS_SHUTDOWN ||
+      condition == SYSTEM_HAS_LOGINSCREEN || condition == SYSTEM_ISSTANDALONE || condition == SYSTEM_SHOW_EXIT_BUTTON)
+    return INFO_SOURCE_SYSTEM;
+
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END && condition - MULTI_INFO_START < (int)m_multiInfo.size())
+  {
+    const GUIInfo &info = m_multiInfo[condition - MULTI_INFO_START];
+    switch (info.m_info)
+    {
+      case SKIN_BOOL:
+      case SKIN_STRING:
+        return INFO_SOURCE_SKIN_SETTINGS;
+      case WINDOW_NEXT:
+      case WINDOW_PREVIOUS:
+      case WINDOW_IS_VISIBLE:
+      case WINDOW_IS_TOPMOST:
+      case WINDOW_IS_ACTIVE:
+        return INFO_SOURCE_WINDOW;
+      case SYSTEM_HAS_ALARM:
+      case SYSTEM_GET_BOOL:
+        return INFO_SOURCE_SYSTEM;
+      case STRING_IS_EMPTY:
+      case INTEGER_GREATER_THAN:
+      case STRING_STR:
+      case STRING_STR_LEFT:
+      case STRING_STR_RIGHT:
+        if (IsListItemInfo(info.GetData1()))
+          return INFO_SOURCE_LISTITEM | INFO_SOURCE_VOLATILE;
+        break;
+      case STRING_COMPARE:
+        if (IsListItemInfo(info.GetData1()) || (info.GetData2() < 0 && IsListItemInfo(-info.GetData2())))
+          return INFO_SOURCE_LISTITEM | INFO_SOURCE_VOLATILE;
+        break;
+      default:
+        break;
+    }
+  }
+  return INFO_SOURCE_VOLATILE;
+}
+
 // checks the condition and returns it as necessary.  Currently used
 // for toggle button controls and visibility of images.
 bool CGUIInfoManager::GetBool(int condition1, int contextWindow, const CGUIListItem *item)
@@ -5038,6 +5174,12 @@ void CGUIInfoManager::ResetCache()
   // reset any animation triggers as well
   m_containerMoves.clear();
   m_updateTime++;
+  UpdatePlayerState();
+
+  m_lastBoolEvaluations = m_boolEvaluations;
+  m_lastBoolsCached = m_boolsCached;
+  m_boolEvaluations = 0;
+  m_boolsCached = 0;
 }
 
 // Called from tuxbox service thread to update current status
@@ -5241,6 +5383,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  SourceChanged(INFO_SOURCE_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5250,6 +5393,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  SourceChanged(INFO_SOURCE_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
@@ -5264,6 +5408,8 @@ bool CGUIInfoManager::GetLibraryBool(int condition)
         m_libraryHasMusic = (db.GetSongsCount() > 0) ? 1 : 0;
         db.Close();
       }
+      else
+        SourceChanged(INFO_SOURCE_LIBRARY); // try again next time
     }
     return m_libraryHasMusic > 0;
   }
@@ -5277,6 +5423,8 @@ bool CGUIInfoManager::GetLibraryBool(int condition)
         m_libraryHasMovies = db.HasContent(VIDEODB_CONTENT_MOVIES) ? 1 : 0;
         db.Close();
       }
+      else
+        SourceChanged(INFO_SOURCE_LIBRARY); // try again next time
     }
     return m_libraryHasMovies > 0;
   }
@@ -5290,6 +5438,8 @@ bool CGUIInfoManager::GetLibraryBool(int condition)
         m_libraryHasMovieSets = db.HasSets() ? 1 : 0;
         db.Close();
       }
+      else
+        SourceChanged(INFO_SOURCE_LIBRARY); // try again next time
     }
     return m_libraryHasMovieSets > 0;
   }
@@ -5303,6 +5453,8 @@ bool CGUIInfoManager::GetLibraryBool(int condition)
         m_libraryHasTVShows = db.HasContent(VIDEODB_CONTENT_TVSHOWS) ? 1 : 0;
         db.Close();
       }
+      else
+        SourceChanged(INFO_SOURCE_LIBRARY); // try again next time
     }
     return m_libraryHasTVShows > 0;
   }
@@ -5316,6 +5468,8 @@ bool CGUIInfoManager::GetLibraryBool(int condition)
         m_libraryHasMusicVideos = db.HasContent(VIDEODB_CONTENT_MUSICVIDEOS) ? 1 : 0;
         db.Close();
       }
+      else
+        SourceChanged(INFO_SOURCE_LIBRARY); // try again next time
     }
     return m_libraryHasMusicVideos > 0;
   }
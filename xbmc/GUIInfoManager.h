@@ -32,6 +32,7 @@
 #include "inttypes.h"
 #include "XBDateTime.h"
 #include "utils/Observer.h"
+#include "interfaces/info/InfoBool.h"
 #include "interfaces/info/SkinVariable.h"
 
 #include <list>
@@ -45,11 +46,6 @@ class CVideoInfoTag;
 class CFileItem;
 class CGUIListItem;
 class CDateTime;
-namespace INFO
-{
-  class InfoBool;
-  class InfoSingle;
-}
 
 // conditions for window retrieval
 #define WINDOW_CONDITION_HAS_LIST_ITEMS  1
@@ -702,6 +698,34 @@ public:
    */
   bool GetBoolValue(unsigned int expression, const CGUIListItem *item = NULL);
 
+  /*! \brief Get the expression a boolean condition was registered with
+   \param expression the identifier returned by Register
+   \return the expression, or an empty string if there is no such condition
+   \sa Register
+   */
+  CStdString GetBoolExpression(unsigned int expression);
+
+  /*! \brief Get the sources of information a boolean condition depends on
+   \param expression the identifier returned by Register
+   \return a combination of INFO::InfoSource flags
+   \sa Register, SourceChanged
+   */
+  unsigned int GetBoolSources(unsigned int expression);
+
+  /*! \brief Notify that a source of information has changed
+   Boolean conditions depending on the source are evaluated again the next time they are needed.
+   Conditions depending only on sources that haven't changed keep their value.
+   \param sources the INFO::InfoSource flags of the sources that have changed
+   \sa GetBoolSources
+   */
+  void SourceChanged(unsigned int sources);
+
+  /*! \brief Get the number of boolean conditions evaluated during the last frame
+   \param evaluated [out] the number of conditions that were evaluated
+   \param cached [out] the number of conditions whose value was reused as nothing they depend on changed
+   */
+  void GetBoolStatistics(unsigned int &evaluated, unsigned int &cached) const;
+
   /*! \brief Evaluate a boolean expression
    \param expression the expression to evaluate
    \param context the context in which to evaluate the expression (currently windows)
@@ -767,10 +791,10 @@ public:
   void SetDisplayAfterSeek(unsigned int timeOut = 2500, int seekOffset = 0);
   void SetSeeking(bool seeking) { m_playerSeeking = seeking; };
   void SetShowTime(bool showtime) { m_playerShowTime = showtime; };
-  void SetShowCodec(bool showcodec) { m_playerShowCodec = showcodec; };
-  void SetShowInfo(bool showinfo) { m_playerShowInfo = showinfo; };
-  void ToggleShowCodec() { m_playerShowCodec = !m_playerShowCodec; };
-  bool ToggleShowInfo() { m_playerShowInfo = !m_playerShowInfo; return m_playerShowInfo; };
+  void SetShowCodec(bool showcodec) { m_playerShowCodec = showcodec; SourceChanged(INFO::INFO_SOURCE_PLAYER); };
+  void SetShowInfo(bool showinfo) { m_playerShowInfo = showinfo; SourceChanged(INFO::INFO_SOURCE_PLAYER); };
+  void ToggleShowCodec() { m_playerShowCodec = !m_playerShowCodec; SourceChanged(INFO::INFO_SOURCE_PLAYER); };
+  bool ToggleShowInfo() { m_playerShowInfo = !m_playerShowInfo; SourceChanged(INFO::INFO_SOURCE_PLAYER); return m_playerShowInfo; };
   bool m_performingSeek;
 
   std::string GetSystemHeatInfo(int info);
@@ -779,8 +803,8 @@ public:
   void UpdateFPS();
   inline float GetFPS() const { return m_fps; };
 
-  void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
-  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
+  void SetNextWindow(int windowID) { m_nextWindowID = windowID; SourceChanged(INFO::INFO_SOURCE_WINDOW); };
+  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; SourceChanged(INFO::INFO_SOURCE_WINDOW); };
 
   void ResetCache();
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
@@ -815,9 +839,30 @@ public:
   /// \brief iterates through boolean conditions and compares their stored values to current values. Returns true if any condition changed value.
   bool ConditionsChangedValues(const std::map<int, bool>& map);
 protected:
+  friend class INFO::InfoBool;
   friend class INFO::InfoSingle;
   bool GetBool(int condition, int contextWindow = 0, const CGUIListItem *item=NULL);
 
+  /*! \brief Get the sources of information a single condition depends on
+   \param condition the condition as returned by TranslateSingleString
+   \return a combination of INFO::InfoSource flags
+   */
+  unsigned int GetConditionSources(int condition) const;
+  bool IsListItemInfo(int info) const;
+
+  /*! \brief Get a combined version of sources of information
+   The version changes whenever any of the sources changes.
+   \param sources a combination of INFO::InfoSource flags
+   */
+  unsigned int GetSourcesVersion(unsigned int sources) const;
+
+  /*! \brief Publish a change of the player's state
+   The players change their state from their own threads without telling anyone, so the state the
+   player conditions depend on is compared once per frame with what it was the frame before.
+   \sa ResetCache
+   */
+  void UpdatePlayerState();
+
   // routines for window retrieval
   bool CheckWindowCondition(CGUIWindow *window, int condition) const;
   CGUIWindow *GetWindowWithCondition(int contextWindow, int condition) const;
@@ -915,6 +960,22 @@ protected:
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
   unsigned int m_updateTime;
 
+  // versions of the sources of information, indexed by INFO::InfoSource bit
+  unsigned int m_sourceVersions[8];
+
+  // the player state conditions were last evaluated with, see UpdatePlayerState()
+  bool m_playerStatePlaying;
+  bool m_playerStatePaused;
+  bool m_playerStateAudio;
+  bool m_playerStateVideo;
+  int m_playerStateSpeed;
+
+  // condition evaluation counters, for this frame and the last
+  unsigned int m_boolEvaluations;
+  unsigned int m_boolsCached;
+  unsigned int m_lastBoolEvaluations;
+  unsigned int m_lastBoolsCached;
+
   int m_libraryHasMusic;
   int m_libraryHasMovies;
   int m_libraryHasTVShows;
@@ -23,11 +23,11 @@
 #include "settings/GUISettings.h"
 #include "guilib/Texture.h"
 #include "threads/SingleLock.h"
-#include "utils/TimeUtils.h"
 #include "utils/JobManager.h"
 #include "guilib/GraphicContext.h"
 #include "utils/log.h"
 #include "TextureCache.h"
+#include "settings/AdvancedSettings.h"
 
 using namespace std;
 
@@ -77,7 +77,10 @@ CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path)
 {
   m_path = path;
   m_refCount = 1;
-  m_timeToDelete = 0;
+  m_state = QUEUED;
+  m_jobID = 0;
+  m_onScreen = false;
+  m_size = 0;
 }
 
 CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
@@ -91,40 +94,30 @@ void CGUILargeTextureManager::CLargeTexture::AddRef()
   m_refCount++;
 }
 
-bool CGUILargeTextureManager::CLargeTexture::DecrRef(bool deleteImmediately)
+bool CGUILargeTextureManager::CLargeTexture::DecrRef()
 {
   assert(m_refCount);
   m_refCount--;
-  if (m_refCount == 0)
-  {
-    if (deleteImmediately)
-      delete this;
-    else
-      m_timeToDelete = CTimeUtils::GetFrameTime() + TIME_TO_DELETE;
-    return true;
-  }
-  return false;
-}
-
-bool CGUILargeTextureManager::CLargeTexture::DeleteIfRequired(bool deleteImmediately)
-{
-  if (m_refCount == 0 && (deleteImmediately || m_timeToDelete < CTimeUtils::GetFrameTime()))
-  {
-    delete this;
-    return true;
-  }
-  return false;
+  return m_refCount == 0;
 }
 
 void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
 {
   assert(!m_texture.size());
+  m_state = LOADED;
   if (texture)
+  {
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
+    m_size = texture->GetPitch() * texture->GetRows();
+  }
 }
 
 CGUILargeTextureManager::CGUILargeTextureManager()
 {
+  m_loading = 0;
+  m_resident = 0;
+  m_hits = 0;
+  m_misses = 0;
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
@@ -134,37 +127,61 @@ CGUILargeTextureManager::~CGUILargeTextureManager()
 void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 {
   CSingleLock lock(m_listSection);
-  // check for items to remove from allocated list, and remove
-  listIterator it = m_allocated.begin();
-  while (it != m_allocated.end())
+  // unload the least recently used images until we're within our budget
+  uint64_t budget = (uint64_t)g_advancedSettings.m_largeTextureMemory * 1024 * 1024;
+  while (!m_unused.empty() && (immediately || m_resident > budget))
   {
-    CLargeTexture *image = *it;
-    if (image->DeleteIfRequired(immediately))
-      it = m_allocated.erase(it);
-    else
-      ++it;
+    CLargeTexture *image = m_unused.front();
+    m_unused.pop_front();
+    FreeImage(image);
   }
 }
 
+void CGUILargeTextureManager::GetStatistics(uint64_t &resident, unsigned int &hits, unsigned int &misses)
+{
+  CSingleLock lock(m_listSection);
+  resident = m_resident;
+  hits = m_hits;
+  misses = m_misses;
+}
+
+void CGUILargeTextureManager::FreeImage(CLargeTexture *image)
+{
+  m_resident -= image->GetSize();
+  m_textures.erase(image->GetPath());
+  delete image;
+}
+
 // if available, increment reference count, and return the image.
 // else, add to the queue list if appropriate.
 bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  textureIterator it = m_textures.find(path);
+  if (it != m_textures.end())
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
+    CLargeTexture *image = it->second;
+    if (firstRequest)
     {
-      if (firstRequest)
-        image->AddRef();
-      texture = image->GetTexture();
-      return texture.size() > 0;
+      if (image->IsUnused())
+        m_unused.erase(image->m_unused); // only loaded images are kept unused
+      image->AddRef();
+      if (image->m_state == CLargeTexture::LOADED)
+        m_hits++;
+      else
+        m_misses++;
     }
+    if (image->m_state != CLargeTexture::LOADED)
+      return true; // not ready as yet
+    texture = image->GetTexture();
+    return texture.size() > 0;
   }
 
   if (firstRequest)
+  {
+    m_misses++;
     QueueImage(path);
+  }
 
   return true;
 }
@@ -172,68 +189,100 @@ bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &te
 void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediately)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  textureIterator it = m_textures.find(path);
+  if (it == m_textures.end())
+    return;
+
+  CLargeTexture *image = it->second;
+  if (!image->DecrRef())
+    return; // still in use
+
+  if (image->m_state == CLargeTexture::LOADED)
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (image->DecrRef(immediately) && immediately)
-        m_allocated.erase(it);
-      return;
-    }
+    if (immediately)
+      FreeImage(image);
+    else
+      image->m_unused = m_unused.insert(m_unused.end(), image);
+    return;
   }
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+
+  // no longer wanted before it was loaded, so cancel it. Its path may be left in the queues,
+  // but is skipped once no longer queued
+  if (image->m_state == CLargeTexture::LOADING)
   {
-    unsigned int id = it->first;
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path && image->DecrRef(true))
-    {
-      // cancel this job
-      CJobManager::GetInstance().CancelJob(id);
-      m_queued.erase(it);
-      return;
-    }
+    CJobManager::GetInstance().CancelJob(image->m_jobID);
+    m_loading--;
   }
+  FreeImage(image);
+  LoadQueued();
+}
+
+void CGUILargeTextureManager::PrioritizeImage(const CStdString &path)
+{
+  CSingleLock lock(m_listSection);
+  textureIterator it = m_textures.find(path);
+  if (it == m_textures.end() || it->second->m_state != CLargeTexture::QUEUED || it->second->m_onScreen)
+    return;
+
+  it->second->m_onScreen = true;
+  m_queuedOnScreen.push_back(path);
 }
 
 // queue the image, and start the background loader if necessary
 void CGUILargeTextureManager::QueueImage(const CStdString &path)
 {
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  m_textures.insert(make_pair(path, new CLargeTexture(path)));
+  m_queued.push_back(path);
+  LoadQueued();
+}
+
+CGUILargeTextureManager::CLargeTexture *CGUILargeTextureManager::PopQueued(deque<CStdString> &queue)
+{
+  while (!queue.empty())
   {
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path)
-    {
-      image->AddRef();
-      return; // already queued
-    }
+    textureIterator it = m_textures.find(queue.front());
+    queue.pop_front();
+    if (it != m_textures.end() && it->second->m_state == CLargeTexture::QUEUED)
+      return it->second;
   }
+  return NULL;
+}
+
+void CGUILargeTextureManager::LoadQueued()
+{
+  while (m_loading < MAX_LOADING)
+  {
+    CLargeTexture *image = PopQueued(m_queuedOnScreen);
+    if (!image)
+      image = PopQueued(m_queued);
+    if (!image)
+      break;
+
+    image->m_state = CLargeTexture::LOADING;
+    image->m_jobID = StartLoading(image->GetPath());
+    m_loading++;
+  }
+}
 
-  // queue the item
-  CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
-  m_queued.push_back(make_pair(jobID, image));
+unsigned int CGUILargeTextureManager::StartLoading(const CStdString &path)
+{
+  return CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
 }
 
 void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   // see if we still have this job id
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
-  {
-    if (it->first == jobID)
-    { // found our job
-      CImageLoader *loader = (CImageLoader *)job;
-      CLargeTexture *image = it->second;
-      image->SetTexture(loader->m_texture);
-      loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
-      m_queued.erase(it);
-      m_allocated.push_back(image);
-      return;
-    }
+  CImageLoader *loader = (CImageLoader *)job;
+  textureIterator it = m_textures.find(loader->m_path);
+  if (it != m_textures.end() && it->second->m_state == CLargeTexture::LOADING && it->second->m_jobID == jobID)
+  { // found our job
+    CLargeTexture *image = it->second;
+    image->SetTexture(loader->m_texture);
+    loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
+    m_resident += image->GetSize();
+    m_loading--;
+    LoadQueued();
   }
 }
-
-
-
@@ -24,6 +24,10 @@
 #include "utils/Job.h"
 #include "guilib/TextureManager.h"
 
+#include <deque>
+#include <list>
+#include <boost/unordered_map.hpp>
+
 /*!
  \ingroup textures,jobs
  \brief Image loader job class
@@ -54,6 +58,10 @@ public:
  Used to load textures for the user interface asynchronously, allowing fluid framerates
  while background loading textures.
 
+ Images are loaded a few at a time, those on screen ahead of those only being preloaded.
+ Images no longer in use are kept loaded, up to the memory set by the largetexturememory
+ advanced setting, so that they needn't be loaded again when scrolling back to them.
+
  \sa IJobCallback, CGUITexture
  */
 class CGUILargeTextureManager : public IJobCallback
@@ -91,60 +99,103 @@ public:
    \brief Request a texture to be unloaded.
 
    When textures are finished with, this function should be called.  This decrements the texture's
-   reference count, and schedules it to be unloaded once the reference count reaches zero.  If the
+   reference count, and keeps it as unused once the reference count reaches zero.  If the
    texture is still queued for loading, or is in the process of loading, the image load is cancelled.
 
    \param path path of the image to release.
    \param immediately if set true the image is immediately unloaded once its reference count reaches zero
-                      rather than being unloaded after a delay.
+                      rather than being kept as unused.
    */
   void ReleaseImage(const CStdString &path, bool immediately = false);
 
+  /*!
+   \brief Load a queued image ahead of the others.
+
+   Called for images that are on screen but not yet loaded, so that they are loaded before images
+   that are only being preloaded, such as those of the items just off screen in a list.
+
+   \param path path of the image.
+   */
+  void PrioritizeImage(const CStdString &path);
+
   /*!
    \brief Cleanup images that are no longer in use.
 
    Loaded textures are reference counted, and upon reaching reference count 0 through ReleaseImage()
-   they are flagged as unused with the current time.  After a delay they may be unloaded, hence
-   CleanupUnusedImages() should be called periodically to ensure this occurs.
+   they are kept as unused.  The least recently used of these are unloaded while the loaded images
+   take more memory than allowed, hence CleanupUnusedImages() should be called periodically.
 
-   \param immediately set to true to cleanup images regardless of whether the delay has passed
+   \param immediately set to true to cleanup all unused images
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /*!
+   \brief Get statistics on the loaded images.
+   \param resident [out] the number of bytes taken by loaded images, in use or not.
+   \param hits [out] the number of requests for images that were already loaded.
+   \param misses [out] the number of requests for images that had to be loaded.
+   */
+  void GetStatistics(uint64_t &resident, unsigned int &hits, unsigned int &misses);
+
+protected:
+  /*!
+   \brief Start loading an image in the background.
+   \param path path of the image to load.
+   \return the id of the job loading it, which is passed back to OnJobComplete() along with a CImageLoader.
+   */
+  virtual unsigned int StartLoading(const CStdString &path);
+
 private:
   class CLargeTexture
   {
   public:
+    enum STATE { QUEUED = 0, LOADING, LOADED };
+
     CLargeTexture(const CStdString &path);
     virtual ~CLargeTexture();
 
     void AddRef();
-    bool DecrRef(bool deleteImmediately);
-    bool DeleteIfRequired(bool deleteImmediately = false);
+    bool DecrRef();
     void SetTexture(CBaseTexture* texture);
 
     const CStdString &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    unsigned int GetSize() const { return m_size; };
+    bool IsUnused() const { return m_refCount == 0; };
 
-  private:
-    static const unsigned int TIME_TO_DELETE = 2000;
+    STATE m_state;
+    unsigned int m_jobID;                         ///< id of the loading job, while LOADING
+    bool m_onScreen;                              ///< true once PrioritizeImage() has been called
+    std::list<CLargeTexture *>::iterator m_unused; ///< position in the unused list, while LOADED and unused
 
+  private:
     unsigned int m_refCount;
     CStdString m_path;
     CTextureArray m_texture;
-    unsigned int m_timeToDelete;
+    unsigned int m_size;
   };
 
-  void QueueImage(const CStdString &path);
+  static const unsigned int MAX_LOADING = 2;
 
-  std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
-  std::vector<CLargeTexture *> m_allocated;
-  typedef std::vector<CLargeTexture *>::iterator listIterator;
-  typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
+  void QueueImage(const CStdString &path);
+  void LoadQueued();
+  CLargeTexture *PopQueued(std::deque<CStdString> &queue);
+  void FreeImage(CLargeTexture *image);
+
+  typedef boost::unordered_map<std::string, CLargeTexture *> textureMap;
+  typedef textureMap::iterator textureIterator;
+
+  textureMap m_textures;                   ///< all images, queued, loading or loaded
+  std::deque<CStdString> m_queued;         ///< images to load, in the order requested
+  std::deque<CStdString> m_queuedOnScreen; ///< images to load that are on screen, loaded first
+  std::list<CLargeTexture *> m_unused;     ///< loaded images not in use, least recently used first
+  unsigned int m_loading;                  ///< number of images being loaded
+  uint64_t m_resident;                     ///< bytes taken by loaded images
+  unsigned int m_hits;
+  unsigned int m_misses;
 
   CCriticalSection m_listSection;
 };
 
 extern CGUILargeTextureManager g_largeTextureManager;
 
-
@@ -93,6 +93,11 @@ public:
 
   void ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions = NULL);
 
+  /*! \brief Get the files the skin's includes have been loaded from
+   \sa ResolveIncludes
+   */
+  const std::vector<CStdString> &GetIncludeFiles() const { return m_includes.GetFiles(); };
+
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
   const std::vector<CStartupWindow> &GetStartupWindows() const { return m_startupWindows; };
@@ -68,6 +68,7 @@ CSoftAE::CSoftAE():
   m_rawPassthrough     (false       ),
   m_soundMode          (AE_SOUND_OFF),
   m_streamsPlaying     (false       ),
+  m_underruns          (0           ),
   m_encoder            (NULL        ),
   m_converted          (NULL        ),
   m_convertedSize      (0           ),
@@ -101,11 +101,15 @@ public:
   virtual void EnumerateOutputDevices(AEDeviceList &devices, bool passthrough);
   virtual std::string GetDefaultDevice(bool passthrough);
   virtual bool SupportsRaw();
+  virtual unsigned int GetUnderrunCount() { return m_underruns; }
 
   /* internal stream methods */
   void PauseStream (CSoftAEStream *stream);
   void ResumeStream(CSoftAEStream *stream);
 
+  /* called by streams from the AE thread when they run dry, returns the new count */
+  unsigned int StreamUnderrun() { return ++m_underruns; }
+
 private:
   CThread *m_thread;
 
@@ -192,6 +196,7 @@ private:
   SoundStateList m_playing_sounds;
   int            m_soundMode;
   bool           m_streamsPlaying;
+  unsigned int   m_underruns;
 
   /* this will contain either float, or uint8_t depending on if we are in raw mode or not */
   CAEBuffer      m_buffer;
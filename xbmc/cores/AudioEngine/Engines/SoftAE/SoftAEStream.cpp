@@ -42,13 +42,14 @@ CSoftAEStream::CSoftAEStream(enum AEDataFormat dataFormat, unsigned int sampleRa
   m_delete          (false),
   m_volume          (1.0f ),
   m_rgain           (1.0f ),
-  m_refillBuffer    (0    ),
+  m_refilling       (false),
+  m_flushes         (0    ),
+  m_flushesSeen     (0    ),
   m_convertFn       (NULL ),
+  m_aeBytesPerFrame (0    ),
   m_ssrc            (NULL ),
-  m_framesBuffered  (0    ),
-  m_newPacket       (NULL ),
-  m_packet          (NULL ),
-  m_vizPacketPos    (NULL ),
+  m_remapBuffer     (NULL ),
+  m_frameBuffer     (NULL ),
   m_draining        (false),
   m_vizBufferSamples(0    ),
   m_audioCallback   (NULL ),
@@ -90,6 +91,7 @@ void CSoftAEStream::InitializeRemap()
       m_aeChannelLayout = AE.GetChannelLayout();
       m_samplesPerFrame = AE.GetChannelLayout().Count();
       m_aeBytesPerFrame = AE_IS_RAW(m_initDataFormat) ? m_bytesPerFrame : (m_samplesPerFrame * sizeof(float));
+      AllocateBuffers();
     }
   }
 }
@@ -100,7 +102,6 @@ void CSoftAEStream::Initialize()
   if (m_valid)
   {
     InternalFlush();
-    delete m_newPacket;
 
     if (m_convert)
       _aligned_free(m_convertBuffer);
@@ -138,7 +139,8 @@ void CSoftAEStream::Initialize()
   // set the waterlevel to 75 percent of the number of frames per second.
   // this lets us drain the main buffer down futher before flagging an underrun.
   m_waterLevel      = AE.GetSampleRate() - (AE.GetSampleRate() / 4);
-  m_refillBuffer    = m_waterLevel;
+  m_refilling       = true;
+  m_flushesSeen     = m_flushes;
 
   m_format.m_dataFormat    = useDataFormat;
   m_format.m_sampleRate    = m_initSampleRate;
@@ -148,10 +150,7 @@ void CSoftAEStream::Initialize()
   m_format.m_frameSamples  = m_format.m_frames * m_initChannelLayout.Count();
   m_format.m_frameSize     = m_bytesPerFrame;
 
-  m_newPacket = new PPacket();
-  if (AE_IS_RAW(m_initDataFormat))
-    m_newPacket->data.Alloc(m_format.m_frames * m_format.m_frameSize);
-  else
+  if (!AE_IS_RAW(m_initDataFormat))
   {
     if (
       !m_remap   .Initialize(m_initChannelLayout, m_aeChannelLayout               , false, false, AE.GetStdChLayout()) ||
@@ -160,12 +159,8 @@ void CSoftAEStream::Initialize()
       m_valid = false;
       return;
     }
-
-    m_newPacket->data.Alloc(m_format.m_frameSamples * sizeof(float));
   }
 
-  m_packet = NULL;
-
   m_inputBuffer.Alloc(m_format.m_frames * m_format.m_frameSize);
 
   m_resample      = (m_forceResample || m_initSampleRate != AE.GetSampleRate()) && !AE_IS_RAW(m_initDataFormat);
@@ -199,18 +194,41 @@ void CSoftAEStream::Initialize()
     // we must buffer the same amount as before but taking the source sample rate into account
     // there is no reason to decrease the buffer for upsampling
     if (m_internalRatio < 1)
-    {
       m_waterLevel *= (1.0 / m_internalRatio);
-      m_refillBuffer = m_waterLevel;
-    }
   }
 
+  AllocateBuffers();
   m_limiter.SetSamplerate(AE.GetSampleRate());
 
   m_chLayoutCount = m_format.m_channelLayout.Count();
   m_valid = true;
 }
 
+void CSoftAEStream::AllocateBuffers()
+{
+  /*
+    the mixer reads m_outBuffer without taking m_lock, so it can't be grown
+    later on. Make it hold the water level plus what one AddData call can
+    push on top of it, with some room for SetResampleRatio to speed us up.
+  */
+  double ratio = m_resample ? std::max(1.0, m_internalRatio * 1.1) : 1.0;
+  unsigned int frames = (unsigned int)std::ceil((m_waterLevel + 2 * m_format.m_frames) * ratio);
+
+  m_outBuffer.Create(frames * m_aeBytesPerFrame);
+
+  _aligned_free(m_frameBuffer);
+  m_frameBuffer = (uint8_t*)_aligned_malloc(m_aeBytesPerFrame, 16);
+
+  if (!AE_IS_RAW(m_initDataFormat))
+  {
+    m_vizOutBuffer.Create(frames * 2 * sizeof(float));
+
+    /* large enough for a block of either remap */
+    _aligned_free(m_remapBuffer);
+    m_remapBuffer = (float*)_aligned_malloc(m_format.m_frames * std::max(m_samplesPerFrame, 2U) * sizeof(float), 16);
+  }
+}
+
 void CSoftAEStream::Destroy()
 {
   CExclusiveLock lock(m_lock);
@@ -233,8 +251,8 @@ CSoftAEStream::~CSoftAEStream()
     m_ssrc = NULL;
   }
 
-  delete m_newPacket;
-  delete m_packet;
+  _aligned_free(m_remapBuffer);
+  _aligned_free(m_frameBuffer);
 
   CLog::Log(LOGDEBUG, "CSoftAEStream::~CSoftAEStream - Destructed");
 }
@@ -244,10 +262,11 @@ unsigned int CSoftAEStream::GetSpace()
   if (!m_valid || m_draining)
     return 0;
 
-  if (m_framesBuffered >= m_waterLevel)
+  unsigned int framesBuffered = GetFramesBuffered();
+  if (framesBuffered >= m_waterLevel)
     return 0;
 
-  return m_inputBuffer.Free() + (std::max(0U, (m_waterLevel - m_framesBuffered)) * m_format.m_frameSize);
+  return m_inputBuffer.Free() + ((m_waterLevel - framesBuffered) * m_format.m_frameSize);
 }
 
 unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
@@ -260,7 +279,7 @@ unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
   if (m_draining)
   {
     /* if the stream has finished draining, cork it */
-    if (m_packet && !m_packet->data.Used() && m_outBuffer.empty())
+    if (m_outBuffer.GetReadSize() == 0)
       m_draining = false;
     else
       return 0;
@@ -287,13 +306,17 @@ unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
     {
       unsigned int consumed = ProcessFrameBuffer();
       m_inputBuffer.Shift(NULL, consumed);
+
+      /* the output buffer is full, leave the rest to the caller's next call */
+      if (consumed == 0)
+        break;
     }
   }
 
   lock.Leave();
 
   /* if the stream is flagged to autoStart when the buffer is full, then do it */
-  if (m_autoStart && m_framesBuffered >= m_waterLevel)
+  if (m_autoStart && GetFramesBuffered() >= m_waterLevel)
     Resume();
 
   return taken;
@@ -302,7 +325,7 @@ unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
 unsigned int CSoftAEStream::ProcessFrameBuffer()
 {
   uint8_t     *data;
-  unsigned int frames, consumed, sampleSize;
+  unsigned int frames, consumed;
 
   /* convert the data if we need to */
   unsigned int samples;
@@ -314,22 +337,26 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
       m_inputBuffer.Used() / m_bytesPerSample,
       m_convertBuffer
     );
-    sampleSize = sizeof(float);
   }
   else
   {
     data       = (uint8_t*)m_inputBuffer.Raw(m_inputBuffer.Used());
     samples    = m_inputBuffer.Used() / m_bytesPerSample;
-    sampleSize = m_bytesPerSample;
   }
 
-  if (samples == 0)
+  /*
+    only take what fits in the output buffer, the rest stays in the input
+    buffer until the mixer has made room for it
+  */
+  unsigned int room = m_outBuffer.GetWriteSize() / m_aeBytesPerFrame;
+  if (samples == 0 || room == 0)
     return 0;
 
   /* resample it if we need to */
   if (m_resample)
   {
-    m_ssrcData.input_frames = samples / m_chLayoutCount;
+    m_ssrcData.input_frames  = samples / m_chLayoutCount;
+    m_ssrcData.output_frames = std::min((long)room, (long)m_format.m_frames * (long)std::ceil(m_ssrcData.src_ratio));
     if (src_process(m_ssrc, &m_ssrcData) != 0)
       return 0;
     data     = (uint8_t*)m_ssrcData.data_out;
@@ -337,86 +364,63 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
     consumed = m_ssrcData.input_frames_used * m_bytesPerFrame;
     if (!frames)
       return consumed;
-
-    samples = frames * m_chLayoutCount;
   }
   else
   {
     data     = (uint8_t*)m_convertBuffer;
-    frames   = samples / m_chLayoutCount;
+    frames   = std::min(samples / m_chLayoutCount, room);
     consumed = frames * m_bytesPerFrame;
   }
 
-  if (m_refillBuffer)
+  /* raw data goes to the mixer as it is */
+  if (AE_IS_RAW(m_initDataFormat))
   {
-    if (frames > m_refillBuffer)
-      m_refillBuffer = 0;
-    else
-      m_refillBuffer -= frames;
+    m_outBuffer.Write(data, frames * m_aeBytesPerFrame);
+    return consumed;
   }
 
-  /* buffer the data */
-  m_framesBuffered += frames;
-  const unsigned int inputBlockSize = m_format.m_frames * m_format.m_channelLayout.Count() * sampleSize;
-
-  size_t remaining = samples * sampleSize;
-  while (remaining)
+  /* downmix/remap the data a block at a time */
+  float *in = (float*)data;
+  while (frames)
   {
-    size_t copy = std::min(m_newPacket->data.Free(), remaining);
-    m_newPacket->data.Push(data, copy);
-    data      += copy;
-    remaining -= copy;
+    unsigned int block = std::min(frames, m_format.m_frames);
+    unsigned int size  = block * m_aeBytesPerFrame;
 
-    /* wait till we have a full packet, or no more data before processing the packet */
-    if ((!m_draining || remaining) && m_newPacket->data.Free() > 0)
-      continue;
+    m_remap.Remap(in, m_remapBuffer, block);
+    m_outBuffer.Write((uint8_t*)m_remapBuffer, size);
 
-    /* if we have a full block of data */
-    if (AE_IS_RAW(m_initDataFormat))
-    {
-      m_outBuffer.push_back(m_newPacket);
-      m_newPacket = new PPacket();
-      m_newPacket->data.Alloc(inputBlockSize);
-      continue;
-    }
-
-    /* make a new packet for downmix/remap */
-    PPacket *pkt = new PPacket();
-
-    /* downmix/remap the data */
-    size_t frames = m_newPacket->data.Used() / m_format.m_channelLayout.Count() / sizeof(float);
-    size_t used   = frames * m_aeChannelLayout.Count() * sizeof(float);
-    pkt->data.Alloc(used);
-    m_remap.Remap(
-      (float*)m_newPacket->data.Raw (m_newPacket->data.Used()),
-      (float*)pkt        ->data.Take(used),
-      frames
-    );
-
-    /* downmix for the viz if we have one */
+    /* downmix for the viz if we have one, it can miss a block if it falls behind */
     if (m_audioCallback)
     {
-      size_t vizUsed = frames * 2 * sizeof(float);
-      pkt->vizData.Alloc(vizUsed);
-      m_vizRemap.Remap(
-        (float*)m_newPacket->data   .Raw (m_newPacket->data.Used()),
-        (float*)pkt        ->vizData.Take(vizUsed),
-        frames
-      );
+      unsigned int vizSize = block * 2 * sizeof(float);
+      if (m_vizOutBuffer.GetWriteSize() >= vizSize)
+      {
+        m_vizRemap.Remap(in, m_remapBuffer, block);
+        m_vizOutBuffer.Write((uint8_t*)m_remapBuffer, vizSize);
+      }
     }
 
-    /* add the packet to the output */
-    m_outBuffer.push_back(pkt);
-    m_newPacket->data.Empty();
+    in     += block * m_chLayoutCount;
+    frames -= block;
   }
 
   return consumed;
 }
 
-uint8_t* CSoftAEStream::GetFrame()
+unsigned int CSoftAEStream::GetFramesBuffered()
 {
-  CExclusiveLock lock(m_lock);
+  if (!m_aeBytesPerFrame)
+    return 0;
+  return m_outBuffer.GetReadSize() / m_aeBytesPerFrame;
+}
 
+/*
+  this is called by the mixer for every frame. It only reads from the output
+  buffers, which AddData fills without waiting on it, so it does not take
+  m_lock and a producer busy resampling can't stall the mix.
+*/
+uint8_t* CSoftAEStream::GetFrame()
+{
   /* if we are fading, this runs even if we have underrun as it is time based */
   if (m_fadeRunning)
   {
@@ -434,54 +438,51 @@ uint8_t* CSoftAEStream::GetFrame()
     }
   }
 
-  /* if we have been deleted or are refilling but not draining */
-  if (!m_valid || m_delete || (m_refillBuffer && !m_draining))
+  /* if we have been deleted */
+  if (!m_valid || m_delete)
     return NULL;
 
-  /* if the packet is empty, advance to the next one */
-  if (!m_packet || m_packet->data.CursorEnd())
+  /* if we have been flushed we need to refill our buffers */
+  if (m_flushesSeen != m_flushes)
   {
-    delete m_packet;
-    m_packet = NULL;
-
-    /* no more packets, return null */
-    if (m_outBuffer.empty())
-    {
-      if (m_draining)
-        return NULL;
-      else
-      {
-        /* underrun, we need to refill our buffers */
-        CLog::Log(LOGDEBUG, "CSoftAEStream::GetFrame - Underrun");
-        ASSERT(m_waterLevel > m_framesBuffered);
-        m_refillBuffer = m_waterLevel - m_framesBuffered;
-        return NULL;
-      }
-    }
+    m_flushesSeen = m_flushes;
+    m_refilling   = true;
+  }
 
-    /* get the next packet */
-    m_packet = m_outBuffer.front();
-    m_outBuffer.pop_front();
+  /* if we are refilling but not draining */
+  if (m_refilling && !m_draining)
+  {
+    if (GetFramesBuffered() < m_waterLevel)
+      return NULL;
+    m_refilling = false;
   }
 
   /* fetch one frame of data */
-  uint8_t *ret = (uint8_t*)m_packet->data.CursorRead(m_aeBytesPerFrame);
+  if (m_outBuffer.Read(m_frameBuffer, m_aeBytesPerFrame) != AE_RING_BUFFER_OK)
+  {
+    /* underrun, we need to refill our buffers */
+    if (!m_draining)
+    {
+      m_refilling = true;
+      CLog::Log(LOGDEBUG, "CSoftAEStream::GetFrame - Underrun (%u so far)", AE.StreamUnderrun());
+    }
+    return NULL;
+  }
 
   /* we have a frame, if we have a viz we need to hand the data to it */
-  if (m_audioCallback && !m_packet->vizData.CursorEnd())
+  if (m_vizOutBuffer.Read((uint8_t*)(m_vizBuffer + m_vizBufferSamples), 2 * sizeof(float)) == AE_RING_BUFFER_OK)
   {
-    float *vizData = (float*)m_packet->vizData.CursorRead(2 * sizeof(float));
-    memcpy(m_vizBuffer + m_vizBufferSamples, vizData, 2 * sizeof(float));
     m_vizBufferSamples += 2;
     if (m_vizBufferSamples == 512)
     {
-      m_audioCallback->OnAudioData(m_vizBuffer, 512);
+      CSingleLock lock(m_vizLock);
+      if (m_audioCallback)
+        m_audioCallback->OnAudioData(m_vizBuffer, 512);
       m_vizBufferSamples = 0;
     }
   }
 
-  --m_framesBuffered;
-  return ret;
+  return m_frameBuffer;
 }
 
 double CSoftAEStream::GetDelay()
@@ -491,7 +492,7 @@ double CSoftAEStream::GetDelay()
 
   double delay = AE.GetDelay();
   delay += (double)(m_inputBuffer.Used() / m_format.m_frameSize) / (double)m_format.m_sampleRate;
-  delay += (double)m_framesBuffered                              / (double)AE.GetSampleRate();
+  delay += (double)GetFramesBuffered()                           / (double)AE.GetSampleRate();
   return delay;
 }
 
@@ -502,7 +503,7 @@ double CSoftAEStream::GetCacheTime()
 
   double time = AE.GetCacheTime();
   time += (double)(m_inputBuffer.Used() / m_format.m_frameSize) / (double)m_format.m_sampleRate;
-  time += (double)m_framesBuffered                              / (double)AE.GetSampleRate();
+  time += (double)GetFramesBuffered()                           / (double)AE.GetSampleRate();
   return time;
 }
 
@@ -542,8 +543,8 @@ void CSoftAEStream::Drain()
 
 bool CSoftAEStream::IsDrained()
 {
-  CSharedLock lock(m_lock);
-  return (m_draining && !m_packet && m_outBuffer.empty());
+  /* called by the mixer, so no locking */
+  return (m_draining && m_outBuffer.GetReadSize() == 0);
 }
 
 void CSoftAEStream::Flush()
@@ -565,28 +566,15 @@ void CSoftAEStream::InternalFlush()
     src_reset(m_ssrc);
   }
 
-  /* invalidate any incoming samples */
-  m_newPacket->data.Empty();
-
   /*
-    clear the current buffered packet, we cant delete the data as it may be
-    in use by the AE thread, so we just seek to the end of the buffer
+    clear the buffered frames, the AE thread may be reading them so it
+    drops them itself on its next read, and refills before playing again
   */
-  if (m_packet)
-    m_packet->data.CursorSeek(m_packet->data.Size());
+  m_outBuffer   .Flush();
+  m_vizOutBuffer.Flush();
+  ++m_flushes;
 
-  /* clear any other buffered packets */
-  while (!m_outBuffer.empty())
-  {
-    PPacket *p = m_outBuffer.front();
-    m_outBuffer.pop_front();
-    delete p;
-  }
-
-  /* reset our counts */
-  m_framesBuffered = 0;
-  m_refillBuffer   = m_waterLevel;
-  m_draining       = false;
+  m_draining = false;
 }
 
 double CSoftAEStream::GetResampleRatio()
@@ -624,8 +612,7 @@ bool CSoftAEStream::SetResampleRatio(double ratio)
 
 void CSoftAEStream::RegisterAudioCallback(IAudioCallback* pCallback)
 {
-  CExclusiveLock lock(m_lock);
-  m_vizBufferSamples = 0;
+  CSingleLock lock(m_vizLock);
   m_audioCallback = pCallback;
   if (m_audioCallback)
     m_audioCallback->OnInitialize(2, m_initSampleRate, 32);
@@ -633,9 +620,8 @@ void CSoftAEStream::RegisterAudioCallback(IAudioCallback* pCallback)
 
 void CSoftAEStream::UnRegisterAudioCallback()
 {
-  CExclusiveLock lock(m_lock);
+  CSingleLock lock(m_vizLock);
   m_audioCallback = NULL;
-  m_vizBufferSamples = 0;
 }
 
 void CSoftAEStream::FadeVolume(float from, float target, unsigned int time)
@@ -20,8 +20,8 @@
  */
 
 #include <samplerate.h>
-#include <list>
 
+#include "threads/CriticalSection.h"
 #include "threads/SharedSection.h"
 
 #include "AEAudioFormat.h"
@@ -30,6 +30,7 @@
 #include "Utils/AERemap.h"
 #include "Utils/AEBuffer.h"
 #include "Utils/AELimiter.h"
+#include "Utils/AERingBuffer.h"
 
 class IAEPostProc;
 class CSoftAEStream : public IAEStream
@@ -53,7 +54,7 @@ public:
   virtual unsigned int      GetSpace        ();
   virtual unsigned int      AddData         (void *data, unsigned int size);
   virtual double            GetDelay        ();
-  virtual bool              IsBuffering     () { return m_refillBuffer > 0; }
+  virtual bool              IsBuffering     () { return m_refilling; }
   virtual double            GetCacheTime    ();
   virtual double            GetCacheTotal   ();
 
@@ -90,6 +91,8 @@ public:
 private:
   void InternalFlush();
   void CheckResampleBuffers();
+  void AllocateBuffers();
+  unsigned int GetFramesBuffered();
 
   CSharedSection    m_lock;
   enum AEDataFormat m_initDataFormat;
@@ -97,12 +100,6 @@ private:
   unsigned int      m_initEncodedSampleRate;
   CAEChannelInfo    m_initChannelLayout;
   unsigned int      m_chLayoutCount;
-  
-  typedef struct
-  {
-    CAEBuffer data;
-    CAEBuffer vizData;
-  } PPacket;
 
   AEAudioFormat m_format;
 
@@ -118,7 +115,9 @@ private:
   float                   m_volume;        /* the volume level */
   float                   m_rgain;         /* replay gain level */
   unsigned int            m_waterLevel;    /* the fill level to fall below before calling the data callback */
-  unsigned int            m_refillBuffer;  /* how many frames that need to be buffered before we return any frames */
+  bool                    m_refilling;     /* true until m_waterLevel frames are buffered, only set by the mixer */
+  volatile unsigned int   m_flushes;       /* bumped on flush so the mixer knows to refill */
+  unsigned int            m_flushesSeen;   /* the flush count the mixer last saw */
 
   CAEConvert::AEConvertToFn m_convertFn;
 
@@ -130,13 +129,10 @@ private:
   unsigned int        m_aeBytesPerFrame;
   SRC_STATE          *m_ssrc;
   SRC_DATA            m_ssrcData;
-  unsigned int        m_framesBuffered;
-  std::list<PPacket*> m_outBuffer;
   unsigned int        ProcessFrameBuffer();
-  PPacket            *m_newPacket;
-  PPacket            *m_packet;
-  uint8_t            *m_packetPos;
-  float              *m_vizPacketPos;
+  float              *m_remapBuffer;   /* remapped frames on their way to m_outBuffer */
+  AERingBuffer        m_outBuffer;     /* frames for the mixer, written by AddData and read by GetFrame */
+  uint8_t            *m_frameBuffer;   /* the frame last returned by GetFrame */
   bool                m_paused;
   bool                m_autoStart;
   bool                m_draining;
@@ -144,8 +140,10 @@ private:
 
   /* vizualization internals */
   CAERemap           m_vizRemap;
+  AERingBuffer       m_vizOutBuffer;
   float              m_vizBuffer[512];
   unsigned int       m_vizBufferSamples;
+  CCriticalSection   m_vizLock;
   IAudioCallback    *m_audioCallback;
 
   /* fade values */
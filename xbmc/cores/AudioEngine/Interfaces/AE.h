@@ -183,5 +183,11 @@ public:
    * @returns true if the AudioEngine is capable of RAW output
    */
   virtual bool SupportsRaw() { return false; }
+
+  /**
+   * Returns how many times a playing stream has run out of data
+   * @returns the number of stream underruns since the AudioEngine was created
+   */
+  virtual unsigned int GetUnderrunCount() { return 0; }
 };
 
@@ -25,6 +25,7 @@
 #include "AEUtil.h"
 #include "utils/MathUtils.h"
 #include "utils/EndianSwap.h"
+#include "utils/CPUInfo.h"
 #include <stdint.h>
 
 #if defined(TARGET_WINDOWS)
@@ -42,7 +43,7 @@
 #include <arm_neon.h>
 #endif
 
-#define CLAMP(x) std::min(-1.0f, std::max(1.0f, (float)(x)))
+#define CLAMP(x) std::min(1.0f, std::max(-1.0f, (float)(x)))
 
 #ifndef INT24_MAX
 #define INT24_MAX (0x7FFFFF)
@@ -65,8 +66,77 @@ static inline int safeRound(double f)
   return MathUtils::round_int(f);
 }
 
+/* scales a sample to 24 bit, clamped to full scale as +1.0 would round to 0x800000 and wrap around */
+static inline int safeRoundS24(float f)
+{
+  return std::min(INT24_MAX, std::max(-INT24_MAX, safeRound(f * ((float)INT24_MAX+.5f))));
+}
+
+#ifdef __SSE2__
+/* sign extend eight 16 bit samples and scale them to float */
+static inline void S16x8_Float_SSE2(__m128i in, const __m128 mul, float *dest)
+{
+  __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+  __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+  _mm_storeu_ps(dest    , _mm_mul_ps(_mm_cvtepi32_ps(lo), mul));
+  _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), mul));
+}
+
+static inline __m128i ByteSwap16_SSE2(__m128i in)
+{
+  return _mm_or_si128(_mm_slli_epi16(in, 8), _mm_srli_epi16(in, 8));
+}
+
+static inline __m128i ByteSwap32_SSE2(__m128i in)
+{
+  in = _mm_shufflelo_epi16(_mm_shufflehi_epi16(in, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+  return ByteSwap16_SSE2(in);
+}
+
+/*
+  round to int32 saturating like safeRound does, _mm_cvtps_epi32 returns
+  INT_MIN for anything out of range which would flip full scale positive
+  samples to full scale negative
+*/
+static inline __m128i RoundS32_SSE2(__m128 in)
+{
+  const __m128 max = _mm_set_ps1(2147483648.0f);
+  __m128i over = _mm_castps_si128(_mm_cmpge_ps(in, max));
+  return _mm_xor_si128(_mm_cvtps_epi32(in), over);
+}
+#endif
+
 CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 {
+  return ToFloat(dataFormat, g_cpuInfo.GetCPUFeatures());
+}
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures)
+{
+#ifdef __SSE2__
+  /* SSE2 capable hosts are all little endian */
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_U8    : return &U8_Float_SSE2;
+      case AE_FMT_S8    : return &S8_Float_SSE2;
+      case AE_FMT_S16NE :
+      case AE_FMT_S16LE : return &S16LE_Float_SSE2;
+      case AE_FMT_S16BE : return &S16BE_Float_SSE2;
+      case AE_FMT_S24NE4:
+      case AE_FMT_S24LE4: return &S24LE4_Float_SSE2;
+      case AE_FMT_S24BE4: return &S24BE4_Float_SSE2;
+      case AE_FMT_S32NE :
+      case AE_FMT_S32LE : return &S32LE_Float_SSE2;
+      case AE_FMT_S32BE : return &S32BE_Float_SSE2;
+      case AE_FMT_DOUBLE: return &DOUBLE_Float_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &U8_Float;
@@ -103,6 +173,30 @@ CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 
 CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat)
 {
+  return FrFloat(dataFormat, g_cpuInfo.GetCPUFeatures());
+}
+
+CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures)
+{
+#ifdef __SSE2__
+  /* the 16 bit converters are already SSE2, they are left to the generic table */
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_U8    : return &Float_U8_SSE2;
+      case AE_FMT_S8    : return &Float_S8_SSE2;
+      case AE_FMT_S24NE4: return &Float_S24NE4_SSE2;
+      case AE_FMT_S32NE :
+      case AE_FMT_S32LE : return &Float_S32LE_SSE2;
+      case AE_FMT_S32BE : return &Float_S32BE_SSE2;
+      case AE_FMT_DOUBLE: return &Float_DOUBLE_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &Float_U8;
@@ -146,7 +240,7 @@ unsigned int CAEConvert::S8_Float(uint8_t *data, const unsigned int samples, flo
   const float mul = 1.0f / (INT8_MAX + 0.5f);
 
   for (unsigned int i = 0; i < samples; ++i)
-    *dest++ = *data++ * mul;
+    *dest++ = (int8_t)*data++ * mul;
 
   return samples;
 }
@@ -176,7 +270,7 @@ unsigned int CAEConvert::S16LE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapLE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapLE16(*(int16_t*)data) * mul;
 #endif
 
   return samples;
@@ -207,7 +301,7 @@ unsigned int CAEConvert::S16BE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapBE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapBE16(*(int16_t*)data) * mul;
 #endif
 
   return samples;
@@ -261,15 +355,15 @@ unsigned int CAEConvert::S32LE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
 
   return samples;
 }
@@ -320,15 +414,15 @@ unsigned int CAEConvert::S32BE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
 
   return samples;
 }
@@ -375,7 +469,7 @@ unsigned int CAEConvert::DOUBLE_Float(uint8_t *data, const unsigned int samples,
 {
   double *src = (double*)data;
   for (unsigned int i = 0; i < samples; ++i)
-    *dest++ = CLAMP(*src++ / (float)INT32_MAX);
+    *dest++ = CLAMP(*src++);
 
   return samples;
 }
@@ -785,60 +879,8 @@ unsigned int CAEConvert::Float_S16BE(float *data, const unsigned int samples, ui
 unsigned int CAEConvert::Float_S24NE4(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE__
-
-  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = safeRound(data[0] * ((float)INT24_MAX+.5f));
-    ++data;
-    ++dst;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    con         = _mm_slli_epi32(con, 8);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-      dst[0] = safeRound(data[0] * ((float)INT24_MAX+.5f));
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        con       = _mm_slli_pi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        con         = _mm_slli_epi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-      }
-    }
-  }
-  _mm_empty();
-  #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i)
-    *dst++ = (safeRound(*data++ * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << 8;
-  #endif
+    *dst++ = (safeRoundS24(*data++) & 0xFFFFFF) << 8;
 
   return samples << 2;
 }
@@ -916,7 +958,7 @@ unsigned int CAEConvert::Float_S24NE3(float *data, const unsigned int samples, u
   _mm_empty();
   #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i, ++data, dest += 3)
-    *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
+    *((uint32_t*)(dest)) = (safeRoundS24(*data) & 0xFFFFFF) << leftShift;
   #endif
 
   return samples * 3;
@@ -925,73 +967,12 @@ unsigned int CAEConvert::Float_S24NE3(float *data, const unsigned int samples, u
 unsigned int CAEConvert::Float_S32LE(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE__
-  const __m128 mul = _mm_set_ps1((float)INT32_MAX);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = safeRound(data[0] * (float)INT32_MAX);
-    ++data;
-    ++dst;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-    dst[0] = Endian_SwapLE32(dst[0]);
-    dst[1] = Endian_SwapLE32(dst[1]);
-    dst[2] = Endian_SwapLE32(dst[2]);
-    dst[3] = Endian_SwapLE32(dst[3]);
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-    {
-      dst[0] = safeRound(data[0] * (float)INT32_MAX);
-      dst[0] = Endian_SwapLE32(dst[0]);
-    }
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-        dst[0] = Endian_SwapLE32(dst[0]);
-        dst[1] = Endian_SwapLE32(dst[1]);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-        dst[0] = Endian_SwapLE32(dst[0]);
-        dst[1] = Endian_SwapLE32(dst[1]);
-        dst[2] = Endian_SwapLE32(dst[2]);
-      }
-    }
-  }
-  _mm_empty();
-  #else
-
-  /* no SIMD */
   for (uint32_t i = 0; i < samples; ++i, ++data, ++dst)
   {
     dst[0] = safeRound(data[0] * (float)INT32_MAX);
     dst[0] = Endian_SwapLE32(dst[0]);
   }
-  #endif
+
   return samples << 2;
 }
 
@@ -1034,72 +1015,11 @@ unsigned int CAEConvert::Float_S32LE_Neon(float *data, const unsigned int sample
 unsigned int CAEConvert::Float_S32BE(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE__
-  const __m128 mul = _mm_set_ps1((float)INT32_MAX);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = safeRound(data[0] * (float)INT32_MAX);
-    ++data;
-    ++dst;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-    dst[0] = Endian_SwapBE32(dst[0]);
-    dst[1] = Endian_SwapBE32(dst[1]);
-    dst[2] = Endian_SwapBE32(dst[2]);
-    dst[3] = Endian_SwapBE32(dst[3]);
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-    {
-      dst[0] = safeRound(data[0] * (float)INT32_MAX);
-      dst[0] = Endian_SwapBE32(dst[0]);
-    }
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-        dst[0] = Endian_SwapBE32(dst[0]);
-        dst[1] = Endian_SwapBE32(dst[1]);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-        dst[0] = Endian_SwapBE32(dst[0]);
-        dst[1] = Endian_SwapBE32(dst[1]);
-        dst[2] = Endian_SwapBE32(dst[2]);
-      }
-    }
-  }
-  _mm_empty();
-  #else
-  /* no SIMD */
   for (uint32_t i = 0; i < samples; ++i, ++data, ++dst)
   {
     dst[0] = safeRound(data[0] * (float)INT32_MAX);
     dst[0] = Endian_SwapBE32(dst[0]);
   }
-  #endif
 
   return samples << 2;
 }
@@ -1148,3 +1068,251 @@ unsigned int CAEConvert::Float_DOUBLE(float *data, const unsigned int samples, u
   return samples * sizeof(double);
 }
 
+#ifdef __SSE2__
+/*
+  The SSE2 converters below process whole vectors and leave the remaining
+  samples to the plain converters, the results are identical to those of
+  the plain converters except that float to int conversions round halfway
+  cases to even rather than up, and saturate rather than wrap.
+*/
+
+unsigned int CAEConvert::U8_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128  mul  = _mm_set_ps1(2.0f / UINT8_MAX);
+  const __m128  one  = _mm_set_ps1(1.0f);
+  const __m128i zero = _mm_setzero_si128();
+
+  const unsigned int even = samples & ~0xF;
+  for (unsigned int i = 0; i < even; i += 16, data += 16, dest += 16)
+  {
+    __m128i in = _mm_loadu_si128((__m128i*)data);
+    __m128i lo = _mm_unpacklo_epi8(in, zero);
+    __m128i hi = _mm_unpackhi_epi8(in, zero);
+    _mm_storeu_ps(dest     , _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), mul), one));
+    _mm_storeu_ps(dest +  4, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), mul), one));
+    _mm_storeu_ps(dest +  8, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), mul), one));
+    _mm_storeu_ps(dest + 12, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), mul), one));
+  }
+
+  U8_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S8_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(1.0f / (INT8_MAX + 0.5f));
+
+  const unsigned int even = samples & ~0xF;
+  for (unsigned int i = 0; i < even; i += 16, data += 16, dest += 16)
+  {
+    __m128i in = _mm_loadu_si128((__m128i*)data);
+    S16x8_Float_SSE2(_mm_srai_epi16(_mm_unpacklo_epi8(in, in), 8), mul, dest    );
+    S16x8_Float_SSE2(_mm_srai_epi16(_mm_unpackhi_epi8(in, in), 8), mul, dest + 8);
+  }
+
+  S8_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S16LE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(1.0f / (INT16_MAX + 0.5f));
+
+  const unsigned int even = samples & ~0x7;
+  for (unsigned int i = 0; i < even; i += 8, data += 16, dest += 8)
+    S16x8_Float_SSE2(_mm_loadu_si128((__m128i*)data), mul, dest);
+
+  S16LE_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S16BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(1.0f / (INT16_MAX + 0.5f));
+
+  const unsigned int even = samples & ~0x7;
+  for (unsigned int i = 0; i < even; i += 8, data += 16, dest += 8)
+    S16x8_Float_SSE2(ByteSwap16_SSE2(_mm_loadu_si128((__m128i*)data)), mul, dest);
+
+  S16BE_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(INT32_SCALE);
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = _mm_slli_epi32(_mm_loadu_si128((__m128i*)data), 8);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S24LE4_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S24BE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128  mul  = _mm_set_ps1(INT32_SCALE);
+  const __m128i mask = _mm_set1_epi32(0xFFFFFF00);
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = _mm_and_si128(ByteSwap32_SSE2(_mm_loadu_si128((__m128i*)data)), mask);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S24BE4_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S32LE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(1.0f / (float)INT32_MAX);
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 16, dest += 4)
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((__m128i*)data)), mul));
+
+  S32LE_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S32BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(1.0f / (float)INT32_MAX);
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = ByteSwap32_SSE2(_mm_loadu_si128((__m128i*)data));
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S32BE_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::DOUBLE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 min = _mm_set_ps1(-1.0f);
+  const __m128 max = _mm_set_ps1( 1.0f);
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 32, dest += 4)
+  {
+    __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd((double*)data    ));
+    __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd((double*)data + 2));
+    __m128 in = _mm_movelh_ps(lo, hi);
+    _mm_storeu_ps(dest, _mm_min_ps(_mm_max_ps(in, min), max));
+  }
+
+  DOUBLE_Float(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::Float_U8_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set_ps1((float)INT8_MAX+.5f);
+  const __m128 add = _mm_set_ps1(1.0f);
+
+  const unsigned int even = samples & ~0xF;
+  for (unsigned int i = 0; i < even; i += 16, data += 16, dest += 16)
+  {
+    __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data     ), add), mul));
+    __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data +  4), add), mul));
+    __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data +  8), add), mul));
+    __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data + 12), add), mul));
+    _mm_storeu_si128((__m128i*)dest, _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+  }
+
+  Float_U8(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::Float_S8_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set_ps1((float)INT8_MAX+.5f);
+
+  const unsigned int even = samples & ~0xF;
+  for (unsigned int i = 0; i < even; i += 16, data += 16, dest += 16)
+  {
+    __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data     ), mul));
+    __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data +  4), mul));
+    __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data +  8), mul));
+    __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data + 12), mul));
+    _mm_storeu_si128((__m128i*)dest, _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+  }
+
+  Float_S8(data, samples - even, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::Float_S24NE4_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
+  const __m128 max = _mm_set_ps1((float)INT24_MAX);
+  const __m128 min = _mm_set_ps1(-(float)INT24_MAX);
+  int32_t *dst = (int32_t*)dest;
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 4, dst += 4)
+  {
+    // clamp before shifting, full scale would wrap around to negative
+    __m128  in  = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(data), mul), min), max);
+    __m128i con = _mm_cvtps_epi32(in);
+    _mm_storeu_si128((__m128i*)dst, _mm_slli_epi32(con, 8));
+  }
+
+  Float_S24NE4(data, samples - even, (uint8_t*)dst);
+  return samples << 2;
+}
+
+unsigned int CAEConvert::Float_S32LE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set_ps1((float)INT32_MAX);
+  int32_t *dst = (int32_t*)dest;
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 4, dst += 4)
+    _mm_storeu_si128((__m128i*)dst, RoundS32_SSE2(_mm_mul_ps(_mm_loadu_ps(data), mul)));
+
+  Float_S32LE(data, samples - even, (uint8_t*)dst);
+  return samples << 2;
+}
+
+unsigned int CAEConvert::Float_S32BE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set_ps1((float)INT32_MAX);
+  int32_t *dst = (int32_t*)dest;
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 4, dst += 4)
+  {
+    __m128i con = RoundS32_SSE2(_mm_mul_ps(_mm_loadu_ps(data), mul));
+    _mm_storeu_si128((__m128i*)dst, ByteSwap32_SSE2(con));
+  }
+
+  Float_S32BE(data, samples - even, (uint8_t*)dst);
+  return samples << 2;
+}
+
+unsigned int CAEConvert::Float_DOUBLE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  double *dst = (double*)dest;
+
+  const unsigned int even = samples & ~0x3;
+  for (unsigned int i = 0; i < even; i += 4, data += 4, dst += 4)
+  {
+    __m128 in = _mm_loadu_ps(data);
+    _mm_storeu_pd(dst    , _mm_cvtps_pd(in));
+    _mm_storeu_pd(dst + 2, _mm_cvtps_pd(_mm_movehl_ps(in, in)));
+  }
+
+  Float_DOUBLE(data, samples - even, (uint8_t*)dst);
+  return samples * sizeof(double);
+}
+#endif
@@ -51,11 +51,38 @@ private:
   static unsigned int Float_S32LE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
   static unsigned int Float_S32BE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
 
+  static unsigned int U8_Float_SSE2    (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S8_Float_SSE2    (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S16LE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S16BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24BE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S32LE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S32BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int DOUBLE_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+
+  static unsigned int Float_U8_SSE2    (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S8_SSE2    (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S24NE4_SSE2(float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S32LE_SSE2 (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S32BE_SSE2 (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_DOUBLE_SSE2(float   *data, const unsigned int samples, uint8_t *dest);
+
 public:
   typedef unsigned int (*AEConvertToFn)(uint8_t *data, const unsigned int samples, float   *dest);
   typedef unsigned int (*AEConvertFrFn)(float   *data, const unsigned int samples, uint8_t *dest);
 
   static AEConvertToFn ToFloat(enum AEDataFormat dataFormat);
   static AEConvertFrFn FrFloat(enum AEDataFormat dataFormat);
+
+  /*!
+   \brief Get the converter for a format as selected for the given CPU features.
+   The overloads above pass the features of the running CPU; this one is
+   mostly useful to compare the vectorized converters against the plain ones.
+   \param dataFormat the sample format to convert from/to.
+   \param cpuFeatures a mask of CPU_FEATURE_* flags the converter may use.
+   */
+  static AEConvertToFn ToFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures);
+  static AEConvertFrFn FrFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures);
 };
 
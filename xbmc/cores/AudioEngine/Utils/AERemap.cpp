@@ -24,8 +24,13 @@
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "utils/log.h"
+#include "utils/CPUInfo.h"
 #include "settings/GUISettings.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 CAERemap::CAERemap() : m_inChannels(0), m_outChannels(0) 
@@ -293,8 +298,13 @@ void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
   fromInfo->in_src   = false;
 }
 
-/* This method has unrolled loop for higher performance */
 void CAERemap::Remap(float * const in, float * const out, const unsigned int frames) const
+{
+  Remap(in, out, frames, g_cpuInfo.GetCPUFeatures());
+}
+
+/* This method has unrolled loop for higher performance */
+void CAERemap::Remap(float * const in, float * const out, const unsigned int frames, unsigned int cpuFeatures) const
 {
   const unsigned int frameBlocks = frames & ~0x3;
 
@@ -347,7 +357,13 @@ void CAERemap::Remap(float * const in, float * const out, const unsigned int fra
     }
     else
     {
-      for (unsigned int f = 0; f < frames; ++f)
+      unsigned int f = 0;
+#ifdef __SSE2__
+      if (cpuFeatures & CPU_FEATURE_SSE2)
+        f = MixSSE2(info, in, out, frames, o);
+#endif
+
+      for (; f < frames; ++f)
       {
         float *outOffset = out + (f * m_outChannels) + o;
         float *inOffset  = in  + (f * m_inChannels);
@@ -380,6 +396,71 @@ void CAERemap::Remap(float * const in, float * const out, const unsigned int fra
   }
 }
 
+/*
+  Mixes the sources of output channel o four frames at a time and returns the
+  number of frames done. Each lane accumulates the sources in the same order
+  as the plain loop in Remap so that the results are identical.
+*/
+unsigned int CAERemap::MixSSE2(const AEMixInfo *info, float * const in, float * const out, const unsigned int frames, const int o) const
+{
+#ifdef __SSE2__
+  const unsigned int frameBlocks = frames & ~0x3;
+  const int          blocks      = info->srcCount & ~0x3;
+  const __m128       zero        = _mm_setzero_ps();
+
+  MEMALIGN(16, __m128 level[AE_CH_MAX]);
+  int index[AE_CH_MAX];
+  for (int i = 0; i < info->srcCount; ++i)
+  {
+    level[i] = _mm_set_ps1(info->srcIndex[i].level);
+    index[i] = info->srcIndex[i].index;
+  }
+
+  #define IN(i) _mm_setr_ps(in0[index[i]], in1[index[i]], in2[index[i]], in3[index[i]])
+
+  for (unsigned int f = 0; f < frameBlocks; f += 4)
+  {
+    const float *in0 = in  + (f * m_inChannels);
+    const float *in1 = in0 + m_inChannels;
+    const float *in2 = in1 + m_inChannels;
+    const float *in3 = in2 + m_inChannels;
+
+    int i = 0;
+    __m128 f1 = zero, f2 = zero, f3 = zero, f4 = zero;
+    for (; i < blocks; i += 4)
+    {
+      f1 = _mm_add_ps(f1, _mm_mul_ps(IN(i  ), level[i  ]));
+      f2 = _mm_add_ps(f2, _mm_mul_ps(IN(i+1), level[i+1]));
+      f3 = _mm_add_ps(f3, _mm_mul_ps(IN(i+2), level[i+2]));
+      f4 = _mm_add_ps(f4, _mm_mul_ps(IN(i+3), level[i+3]));
+    }
+
+    switch (info->srcCount & 0x3)
+    {
+      case 3: f3 = _mm_add_ps(f3, _mm_mul_ps(IN(i+2), level[i+2]));
+      case 2: f2 = _mm_add_ps(f2, _mm_mul_ps(IN(i+1), level[i+1]));
+      case 1: f1 = _mm_add_ps(f1, _mm_mul_ps(IN(i  ), level[i  ]));
+    }
+
+    /* adding to zero as the plain loop does turns -0.0 into 0.0 */
+    MEMALIGN(16, float sum[4]);
+    _mm_store_ps(sum, _mm_add_ps(zero, _mm_add_ps(_mm_add_ps(_mm_add_ps(f1, f2), f3), f4)));
+
+    float *outOffset = out + (f * m_outChannels) + o;
+    outOffset[0                ] = sum[0];
+    outOffset[m_outChannels    ] = sum[1];
+    outOffset[m_outChannels * 2] = sum[2];
+    outOffset[m_outChannels * 3] = sum[3];
+  }
+
+  #undef IN
+
+  return frameBlocks;
+#else
+  return 0;
+#endif
+}
+
 inline void CAERemap::BuildUpmixMatrix(const CAEChannelInfo& input, const CAEChannelInfo& output)
 {
   #define UM(from, to) \
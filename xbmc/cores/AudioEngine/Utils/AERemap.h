@@ -29,6 +29,12 @@ public:
   bool Initialize(CAEChannelInfo input, CAEChannelInfo output, bool finalStage, bool forceNormalize = false, enum AEStdChLayout stdChLayout = AE_CH_LAYOUT_INVALID);
   void Remap(float * const in, float * const out, const unsigned int frames) const;
 
+  /*!
+   \brief Remap using only the given CPU features, the overload above uses those of the running CPU.
+   \param cpuFeatures a mask of CPU_FEATURE_* flags the remap may use.
+   */
+  void Remap(float * const in, float * const out, const unsigned int frames, unsigned int cpuFeatures) const;
+
 private:
   typedef struct {
     int       index;
@@ -51,5 +57,6 @@ private:
 
   void ResolveMix(const AEChannel from, CAEChannelInfo to);
   void BuildUpmixMatrix(const CAEChannelInfo& input, const CAEChannelInfo& output);
+  unsigned int MixSSE2(const AEMixInfo *info, float * const in, float * const out, const unsigned int frames, const int o) const;
 };
 
@@ -19,19 +19,23 @@
  *
  */
 
-#define AE_RING_BUFFER_OK 0;
-#define AE_RING_BUFFER_EMPTY 1;
-#define AE_RING_BUFFER_FULL 2;
-#define AE_RING_BUFFER_NOTAVAILABLE 3;
+#define AE_RING_BUFFER_OK 0
+#define AE_RING_BUFFER_EMPTY 1
+#define AE_RING_BUFFER_FULL 2
+#define AE_RING_BUFFER_NOTAVAILABLE 3
 
 //#define AE_RING_BUFFER_DEBUG
 
 #include "utils/log.h"  //CLog
+#include "threads/Atomics.h"
 #include <string.h>     //memset, memcpy
 
 /**
  * This buffer can be used by one read and one write thread at any one time
  * without the risk of data corruption.
+ * The read and write counts are published with memory barriers, so the
+ * data is complete by the time the other thread sees the new count.
+ * Flushed data is dropped by the reader, until then it still holds its space.
  * If you intend to call the Reset() method, please use Locks.
  * All other operations are thread-safe.
  */
@@ -43,6 +47,7 @@ public:
     m_iWritePos(0),
     m_iRead(0),
     m_iWritten(0),
+    m_iDiscard(0),
     m_iSize(0),
     m_Buffer(NULL)
   {
@@ -53,6 +58,7 @@ public:
     m_iWritePos(0),
     m_iRead(0),
     m_iWritten(0),
+    m_iDiscard(0),
     m_iSize(0),
     m_Buffer(NULL)
   {
@@ -69,11 +75,15 @@ public:
 
   /**
    * Allocates space for buffer, and sets it's contents to 0.
+   * Any previous buffer is freed, so like Reset() this is not thread-safe.
    *
    * @return true on success, false otherwise
    */
   bool Create(int size)
   {
+    _aligned_free(m_Buffer);
+    Reset();
+    m_iSize  = 0;
     m_Buffer =  (unsigned char*)_aligned_malloc(size,16);
     if ( m_Buffer )
     {
@@ -95,6 +105,7 @@ public:
 #endif
     m_iWritten = 0;
     m_iRead = 0;
+    m_iDiscard = 0;
     m_iReadPos = 0;
     m_iWritePos = 0;
   }
@@ -140,7 +151,7 @@ public:
     }
 
     //we can increase the write count now
-    m_iWritten+=size;
+    AtomicAdd(&m_iWritten, size);
     return AE_RING_BUFFER_OK;
   }
 
@@ -153,7 +164,16 @@ public:
    */
   int Read(unsigned char *dest, unsigned int size)
   {
-    unsigned int space = GetReadSize();
+    //drop anything the writer has flushed first, which hands its space back to the writer
+    unsigned int skip = (unsigned int)AtomicAdd(&m_iDiscard, 0) - (unsigned int)m_iRead;
+    if ((int)skip > 0)
+    {
+      m_iReadPos = (m_iReadPos + skip) % m_iSize;
+      AtomicAdd(&m_iRead, skip);
+    }
+
+    //a flush from now on is only seen by the next read, this one may still copy the data
+    unsigned int space = (unsigned int)AtomicAdd(&m_iWritten, 0) - (unsigned int)m_iRead;
 
     //want to read more than we have written?
     if( space <= 0 )
@@ -195,11 +215,23 @@ public:
       m_iReadPos = second;
     }
     //we can increase the read count now
-    m_iRead+=size;
+    AtomicAdd(&m_iRead, size);
 
     return AE_RING_BUFFER_OK;
   }
 
+  /**
+   * Discards everything written so far.
+   * This may be called from the write thread, the data is dropped by
+   * the next Read() so the read thread never has to stop for it. As the
+   * reader may be copying it right now, its space is only available to
+   * the writer again once the reader has dropped it.
+   */
+  void Flush()
+  {
+    AtomicAdd(&m_iDiscard, (long)((unsigned int)m_iWritten - (unsigned int)m_iDiscard));
+  }
+
   /**
    * Dumps the buffer.
    */
@@ -223,7 +255,10 @@ public:
    */
   unsigned int GetWriteSize()
   {
-    return m_iSize - ( m_iWritten - m_iRead );
+    //flushed data counts until the reader has dropped it
+    unsigned int written = (unsigned int)AtomicAdd(&m_iWritten, 0);
+    unsigned int read    = (unsigned int)AtomicAdd(&m_iRead   , 0);
+    return m_iSize - (written - read);
   }
 
   /**
@@ -232,7 +267,14 @@ public:
    */
   unsigned int GetReadSize()
   {
-    return m_iWritten - m_iRead;
+    unsigned int written = (unsigned int)AtomicAdd(&m_iWritten, 0);
+    unsigned int read    = (unsigned int)AtomicAdd(&m_iRead   , 0);
+    unsigned int discard = (unsigned int)AtomicAdd(&m_iDiscard, 0);
+
+    //flushed data counts as read already
+    if ((int)(discard - read) > 0)
+      read = discard;
+    return written - read;
   }
 
   /**
@@ -246,8 +288,9 @@ public:
 private:
   unsigned int m_iReadPos;
   unsigned int m_iWritePos;
-  unsigned int m_iRead;
-  unsigned int m_iWritten;
+  volatile long m_iRead;
+  volatile long m_iWritten;
+  volatile long m_iDiscard;
   unsigned int m_iSize;
   unsigned char *m_Buffer;
 };
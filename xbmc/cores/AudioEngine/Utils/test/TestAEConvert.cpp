@@ -0,0 +1,225 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEConvert.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "utils/CPUInfo.h"
+#include "utils/EndianSwap.h"
+#include "utils/Stopwatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/* not a multiple of any vector size, so the remainder is converted too */
+static const unsigned int TestAEConvertSamples = 4099;
+
+static const enum AEDataFormat TestAEConvertFormats[] =
+{
+  AE_FMT_U8, AE_FMT_S8, AE_FMT_S16LE, AE_FMT_S16BE, AE_FMT_S24LE4, AE_FMT_S24BE4,
+  AE_FMT_S24NE4, AE_FMT_S32LE, AE_FMT_S32BE, AE_FMT_DOUBLE
+};
+
+static unsigned int TestAEConvertBytes(enum AEDataFormat format)
+{
+  return CAEUtil::DataFormatToBits(format) >> 3;
+}
+
+static bool TestAEConvertHasSSE2()
+{
+  return (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_SSE2) != 0;
+}
+
+/* random float samples including full scale and silence */
+static void TestAEConvertFloats(std::vector<float> &data)
+{
+  srand(1);
+  data.resize(TestAEConvertSamples);
+  for (unsigned int i = 0; i < data.size(); ++i)
+    data[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+  data[0] = 1.0f;
+  data[1] = -1.0f;
+  data[2] = 0.0f;
+}
+
+/* random integer samples, or doubles slightly out of range for AE_FMT_DOUBLE */
+static void TestAEConvertSamplesOf(enum AEDataFormat format, std::vector<uint8_t> &data)
+{
+  srand(1);
+  data.resize(TestAEConvertSamples * TestAEConvertBytes(format));
+  if (format == AE_FMT_DOUBLE)
+  {
+    double *src = (double*)&data[0];
+    for (unsigned int i = 0; i < TestAEConvertSamples; ++i)
+      src[i] = (double)rand() / RAND_MAX * 2.2 - 1.1;
+  }
+  else
+  {
+    for (unsigned int i = 0; i < data.size(); ++i)
+      data[i] = rand() & 0xFF;
+  }
+}
+
+/* the vectorized ToFloat converters must match the plain ones exactly */
+TEST(TestAEConvert, ToFloatSSE2)
+{
+  if (!TestAEConvertHasSSE2())
+    return;
+
+  for (unsigned int f = 0; f < sizeof(TestAEConvertFormats) / sizeof(TestAEConvertFormats[0]); ++f)
+  {
+    enum AEDataFormat format = TestAEConvertFormats[f];
+    std::vector<uint8_t> in;
+    TestAEConvertSamplesOf(format, in);
+
+    std::vector<float> plain(TestAEConvertSamples), sse2(TestAEConvertSamples);
+    EXPECT_EQ(TestAEConvertSamples, CAEConvert::ToFloat(format, 0)(&in[0], TestAEConvertSamples, &plain[0]));
+    EXPECT_EQ(TestAEConvertSamples, CAEConvert::ToFloat(format, CPU_FEATURE_SSE2)(&in[0], TestAEConvertSamples, &sse2[0]));
+    EXPECT_EQ(0, memcmp(&plain[0], &sse2[0], TestAEConvertSamples * sizeof(float))) << CAEUtil::DataFormatToStr(format);
+
+    // and again with the buffers off their natural alignment
+    unsigned int bytes = TestAEConvertBytes(format);
+    EXPECT_EQ(TestAEConvertSamples - 1, CAEConvert::ToFloat(format, CPU_FEATURE_SSE2)(&in[bytes], TestAEConvertSamples - 1, &sse2[1]));
+    EXPECT_EQ(0, memcmp(&plain[1], &sse2[1], (TestAEConvertSamples - 1) * sizeof(float))) << CAEUtil::DataFormatToStr(format);
+  }
+}
+
+/* the vectorized FrFloat converters round halfway cases to even, so they may differ by one step */
+TEST(TestAEConvert, FrFloatSSE2)
+{
+  if (!TestAEConvertHasSSE2())
+    return;
+
+  std::vector<float> in;
+  TestAEConvertFloats(in);
+
+  for (unsigned int f = 0; f < sizeof(TestAEConvertFormats) / sizeof(TestAEConvertFormats[0]); ++f)
+  {
+    enum AEDataFormat format = TestAEConvertFormats[f];
+    if (format == AE_FMT_S24LE4 || format == AE_FMT_S24BE4)
+      continue;
+
+    unsigned int bytes = TestAEConvertBytes(format);
+    std::vector<uint8_t> plain(TestAEConvertSamples * bytes), sse2(TestAEConvertSamples * bytes);
+    EXPECT_EQ(TestAEConvertSamples * bytes, CAEConvert::FrFloat(format, 0)(&in[0], TestAEConvertSamples, &plain[0]));
+    EXPECT_EQ(TestAEConvertSamples * bytes, CAEConvert::FrFloat(format, CPU_FEATURE_SSE2)(&in[0], TestAEConvertSamples, &sse2[0]));
+
+    for (unsigned int i = 0; i < TestAEConvertSamples; ++i)
+    {
+      int64_t a, b;
+      switch (format)
+      {
+        case AE_FMT_U8   : a = plain[i]; b = sse2[i]; break;
+        case AE_FMT_S8   : a = (int8_t)plain[i]; b = (int8_t)sse2[i]; break;
+        case AE_FMT_S16LE: a = (int16_t)Endian_SwapLE16(((uint16_t*)&plain[0])[i]); b = (int16_t)Endian_SwapLE16(((uint16_t*)&sse2[0])[i]); break;
+        case AE_FMT_S16BE: a = (int16_t)Endian_SwapBE16(((uint16_t*)&plain[0])[i]); b = (int16_t)Endian_SwapBE16(((uint16_t*)&sse2[0])[i]); break;
+        case AE_FMT_S24NE4: a = ((int32_t*)&plain[0])[i] >> 8; b = ((int32_t*)&sse2[0])[i] >> 8; break;
+        case AE_FMT_S32LE: a = (int32_t)Endian_SwapLE32(((uint32_t*)&plain[0])[i]); b = (int32_t)Endian_SwapLE32(((uint32_t*)&sse2[0])[i]); break;
+        case AE_FMT_S32BE: a = (int32_t)Endian_SwapBE32(((uint32_t*)&plain[0])[i]); b = (int32_t)Endian_SwapBE32(((uint32_t*)&sse2[0])[i]); break;
+        default          : a = b = 0; EXPECT_EQ(((double*)&plain[0])[i], ((double*)&sse2[0])[i]); break;
+      }
+
+      // the 16 bit converters are dithered
+      int64_t step = (format == AE_FMT_S16LE || format == AE_FMT_S16BE) ? 2 : 1;
+      ASSERT_GE(step, llabs(a - b)) << CAEUtil::DataFormatToStr(format) << " sample " << i;
+    }
+  }
+}
+
+TEST(TestAEConvert, Values)
+{
+  unsigned int features[] = { 0, CPU_FEATURE_SSE2 };
+  for (unsigned int f = 0; f < sizeof(features) / sizeof(features[0]); ++f)
+  {
+    float out[16];
+
+    uint8_t s8[16];
+    memset(s8, 0x80, sizeof(s8));
+    CAEConvert::ToFloat(AE_FMT_S8, features[f])(s8, 16, out);
+    EXPECT_FLOAT_EQ(-128.0f / 127.5f, out[0]);
+    EXPECT_FLOAT_EQ(-128.0f / 127.5f, out[15]);
+
+    double dbl[4] = { 0.5, -0.25, 2.0, -3.0 };
+    CAEConvert::ToFloat(AE_FMT_DOUBLE, features[f])((uint8_t*)dbl, 4, out);
+    EXPECT_FLOAT_EQ( 0.5f , out[0]);
+    EXPECT_FLOAT_EQ(-0.25f, out[1]);
+    EXPECT_FLOAT_EQ( 1.0f , out[2]);
+    EXPECT_FLOAT_EQ(-1.0f , out[3]);
+
+    // full scale must not wrap around
+    float full[8] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+    int32_t s32[8];
+    CAEConvert::FrFloat(AE_FMT_S32LE, features[f])(full, 8, (uint8_t*)s32);
+    EXPECT_EQ(INT32_MAX, (int32_t)Endian_SwapLE32(s32[0]));
+    EXPECT_GE(-INT32_MAX, (int32_t)Endian_SwapLE32(s32[1]));
+    EXPECT_EQ(INT32_MAX, (int32_t)Endian_SwapLE32(s32[4]));
+
+    // nor for 24 bit, nor past full scale, in the vectorized part and the remainder
+    float over[10] = { 1.0f, -1.0f, 1.5f, -1.5f, 1.0000001f, -1.0000001f, 100.0f, -100.0f, 1.0f, -2.0f };
+    int32_t s24[10];
+    CAEConvert::FrFloat(AE_FMT_S24NE4, features[f])(over, 10, (uint8_t*)s24);
+    for (unsigned int i = 0; i < 10; ++i)
+      EXPECT_EQ(i % 2 ? -0x7FFFFF00 : 0x7FFFFF00, s24[i]) << "sample " << i;
+  }
+}
+
+TEST(TestAEConvert, Benchmark)
+{
+  static const unsigned int iterations = 2000;
+  std::vector<float> in;
+  TestAEConvertFloats(in);
+  std::vector<uint8_t> buf(TestAEConvertSamples * sizeof(double));
+  std::vector<float>   out(TestAEConvertSamples);
+
+  for (unsigned int f = 0; f < sizeof(TestAEConvertFormats) / sizeof(TestAEConvertFormats[0]); ++f)
+  {
+    enum AEDataFormat format = TestAEConvertFormats[f];
+    float elapsed[2][2];
+    for (unsigned int sse2 = 0; sse2 < 2; ++sse2)
+    {
+      unsigned int features = sse2 ? CPU_FEATURE_SSE2 : 0;
+      CAEConvert::AEConvertFrFn fr = CAEConvert::FrFloat(format, features);
+      CAEConvert::AEConvertToFn to = CAEConvert::ToFloat(format, features);
+      CStopWatch watch;
+
+      elapsed[sse2][0] = 0;
+      if (fr)
+      {
+        watch.StartZero();
+        for (unsigned int i = 0; i < iterations; ++i)
+          fr(&in[0], TestAEConvertSamples, &buf[0]);
+        elapsed[sse2][0] = watch.GetElapsedMilliseconds();
+      }
+
+      watch.StartZero();
+      for (unsigned int i = 0; i < iterations; ++i)
+        to(&buf[0], TestAEConvertSamples, &out[0]);
+      elapsed[sse2][1] = watch.GetElapsedMilliseconds();
+    }
+
+    std::cout << CAEUtil::DataFormatToStr(format) <<
+      ": from float " << testing::PrintToString(elapsed[0][0]) << "/" << testing::PrintToString(elapsed[1][0]) <<
+      " ms, to float " << testing::PrintToString(elapsed[0][1]) << "/" << testing::PrintToString(elapsed[1][1]) <<
+      " ms (plain/SSE2)" << std::endl;
+  }
+}
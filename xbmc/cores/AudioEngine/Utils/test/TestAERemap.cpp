@@ -0,0 +1,102 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AERemap.h"
+#include "utils/CPUInfo.h"
+#include "utils/Stopwatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/* not a multiple of four, so the remainder is mixed too */
+static const unsigned int TestAERemapFrames = 1027;
+
+static const enum AEStdChLayout TestAERemapLayouts[][2] =
+{
+  { AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_2_0 },
+  { AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_2_0 },
+  { AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_5_1 },
+  { AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_5_1 },
+  { AE_CH_LAYOUT_1_0, AE_CH_LAYOUT_2_0 }
+};
+
+static void TestAERemapInput(unsigned int channels, std::vector<float> &in)
+{
+  srand(1);
+  in.resize(TestAERemapFrames * channels);
+  for (unsigned int i = 0; i < in.size(); ++i)
+    in[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+/* the vectorized down/upmix must match the plain one exactly */
+TEST(TestAERemap, RemapSSE2)
+{
+  if (!(g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_SSE2))
+    return;
+
+  for (unsigned int l = 0; l < sizeof(TestAERemapLayouts) / sizeof(TestAERemapLayouts[0]); ++l)
+  {
+    CAEChannelInfo input  = TestAERemapLayouts[l][0];
+    CAEChannelInfo output = TestAERemapLayouts[l][1];
+
+    CAERemap remap;
+    ASSERT_TRUE(remap.Initialize(input, output, false, true));
+
+    std::vector<float> in;
+    TestAERemapInput(input.Count(), in);
+
+    std::vector<float> plain(TestAERemapFrames * output.Count()), sse2(TestAERemapFrames * output.Count());
+    remap.Remap(&in[0], &plain[0], TestAERemapFrames, 0);
+    remap.Remap(&in[0], &sse2[0], TestAERemapFrames, CPU_FEATURE_SSE2);
+    EXPECT_EQ(0, memcmp(&plain[0], &sse2[0], plain.size() * sizeof(float))) <<
+      (std::string)input << " -> " << (std::string)output;
+  }
+}
+
+TEST(TestAERemap, Benchmark)
+{
+  static const unsigned int iterations = 2000;
+  CAEChannelInfo input  = AE_CH_LAYOUT_7_1;
+  CAEChannelInfo output = AE_CH_LAYOUT_2_0;
+
+  CAERemap remap;
+  ASSERT_TRUE(remap.Initialize(input, output, false, true));
+
+  std::vector<float> in;
+  TestAERemapInput(input.Count(), in);
+  std::vector<float> out(TestAERemapFrames * output.Count());
+
+  float elapsed[2];
+  for (unsigned int sse2 = 0; sse2 < 2; ++sse2)
+  {
+    CStopWatch watch;
+    watch.StartZero();
+    for (unsigned int i = 0; i < iterations; ++i)
+      remap.Remap(&in[0], &out[0], TestAERemapFrames, sse2 ? CPU_FEATURE_SSE2 : 0);
+    elapsed[sse2] = watch.GetElapsedMilliseconds();
+  }
+
+  std::cout << "7.1 -> 2.0: " << testing::PrintToString(elapsed[0]) << "/" <<
+    testing::PrintToString(elapsed[1]) << " ms (plain/SSE2)" << std::endl;
+}
@@ -0,0 +1,174 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "cores/AudioEngine/Utils/AERingBuffer.h"
+#include "threads/Thread.h"
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+/* an odd frame size, so frames wrap around the end of the buffer */
+static const unsigned int TestAERingBufferFrame  = 12;
+static const unsigned int TestAERingBufferFrames = 200000;
+
+/* writes numbered frames in bursts of up to 64, as AddData would */
+class TestAERingBufferWriter : public CThread
+{
+public:
+  TestAERingBufferWriter(AERingBuffer &buffer)
+    : CThread("TestAERingBufferWriter"), m_buffer(buffer) {}
+
+protected:
+  virtual void Process()
+  {
+    uint32_t frame[TestAERingBufferFrame / sizeof(uint32_t) * 64];
+    uint32_t next = 0;
+    while (next < TestAERingBufferFrames && !m_bStop)
+    {
+      unsigned int count = std::min(1 + next % 64, TestAERingBufferFrames - next);
+      if (m_buffer.GetWriteSize() < count * TestAERingBufferFrame)
+      {
+        Sleep(1);
+        continue;
+      }
+
+      for (unsigned int i = 0; i < count * TestAERingBufferFrame / sizeof(uint32_t); ++i)
+        frame[i] = next + i / (TestAERingBufferFrame / sizeof(uint32_t));
+      m_buffer.Write((unsigned char*)frame, count * TestAERingBufferFrame);
+      next += count;
+    }
+  }
+
+  AERingBuffer &m_buffer;
+};
+
+/* the reader must see every frame complete and in order */
+TEST(TestAERingBuffer, SingleReaderWriter)
+{
+  AERingBuffer buffer(TestAERingBufferFrame * 1000);
+  TestAERingBufferWriter writer(buffer);
+  writer.Create();
+
+  uint32_t frame[TestAERingBufferFrame / sizeof(uint32_t)];
+  for (uint32_t next = 0; next < TestAERingBufferFrames; )
+  {
+    if (buffer.Read((unsigned char*)frame, TestAERingBufferFrame) != AE_RING_BUFFER_OK)
+      continue;
+
+    for (unsigned int i = 0; i < TestAERingBufferFrame / sizeof(uint32_t); ++i)
+      ASSERT_EQ(next, frame[i]);
+    ++next;
+  }
+
+  writer.StopThread();
+  EXPECT_EQ(0U, buffer.GetReadSize());
+}
+
+TEST(TestAERingBuffer, Flush)
+{
+  AERingBuffer buffer(100);
+  unsigned char data[100], out[100];
+  for (unsigned int i = 0; i < sizeof(data); ++i)
+    data[i] = i;
+
+  EXPECT_EQ(AE_RING_BUFFER_OK, buffer.Write(data, 60));
+  EXPECT_EQ(AE_RING_BUFFER_OK, buffer.Read(out, 10));
+  EXPECT_EQ(50U, buffer.GetReadSize());
+
+  // the writer flushes, the space is free for it once the reader has dropped the data
+  buffer.Flush();
+  EXPECT_EQ(0U, buffer.GetReadSize());
+  EXPECT_EQ(50U, buffer.GetWriteSize());
+  EXPECT_EQ(AE_RING_BUFFER_EMPTY, buffer.Read(out, 1));
+  EXPECT_EQ(100U, buffer.GetWriteSize());
+
+  // and the reader only sees what is written after the flush
+  EXPECT_EQ(AE_RING_BUFFER_OK, buffer.Write(data + 20, 80));
+  EXPECT_EQ(AE_RING_BUFFER_OK, buffer.Read(out, 80));
+  EXPECT_EQ(0, memcmp(data + 20, out, 80));
+  EXPECT_EQ(AE_RING_BUFFER_EMPTY, buffer.Read(out, 1));
+}
+
+static const unsigned int TestAERingBufferFlushFrames = 50000;
+
+/* writes numbered frames as fast as the buffer takes them and flushes every now and then */
+class TestAERingBufferFlusher : public CThread
+{
+public:
+  TestAERingBufferFlusher(AERingBuffer &buffer)
+    : CThread("TestAERingBufferFlusher"), m_buffer(buffer), m_flushes(0) {}
+
+  volatile long m_flushes;
+
+protected:
+  virtual void Process()
+  {
+    uint32_t frame[TestAERingBufferFrame / sizeof(uint32_t)];
+    for (uint32_t next = 0; next < TestAERingBufferFlushFrames && !m_bStop; )
+    {
+      if (next % 97 == 0 && m_buffer.GetReadSize() > 0)
+      {
+        m_buffer.Flush();
+        AtomicIncrement(&m_flushes);
+      }
+
+      for (unsigned int i = 0; i < TestAERingBufferFrame / sizeof(uint32_t); ++i)
+        frame[i] = next;
+      if (m_buffer.Write((unsigned char*)frame, TestAERingBufferFrame) == AE_RING_BUFFER_OK)
+        ++next;
+      else
+        Sleep(0);
+    }
+  }
+
+  AERingBuffer &m_buffer;
+};
+
+/* with a flushing writer the reader may miss frames, but must never see one torn or out of order */
+TEST(TestAERingBuffer, FlushWhileReading)
+{
+  AERingBuffer buffer(TestAERingBufferFrame * 8);
+  TestAERingBufferFlusher writer(buffer);
+  writer.Create();
+
+  uint32_t frame[TestAERingBufferFrame / sizeof(uint32_t)];
+  uint32_t last = 0;
+  unsigned int frames = 0;
+  while (last + 1 < TestAERingBufferFlushFrames)
+  {
+    if (buffer.Read((unsigned char*)frame, TestAERingBufferFrame) != AE_RING_BUFFER_OK)
+    {
+      XbmcThreads::ThreadSleep(0);
+      continue;
+    }
+
+    for (unsigned int i = 1; i < TestAERingBufferFrame / sizeof(uint32_t); ++i)
+      ASSERT_EQ(frame[0], frame[i]) << "frame " << frame[0] << " is torn";
+    if (frames++)
+      ASSERT_LT(last, frame[0]);
+    last = frame[0];
+  }
+
+  writer.StopThread();
+  EXPECT_LT(0, writer.m_flushes);
+}
@@ -37,6 +37,7 @@
 
 #if defined(HAS_GL)
   #include "LinuxRendererGL.h"
+  #include "guilib/GUITextureBatchGL.h"
 #elif HAS_GLES == 2
   #include "LinuxRendererGLES.h"
 #elif defined(HAS_DX)
@@ -296,6 +297,10 @@ void CXBMCRenderManager::Update(bool bPauseDrawing)
 
 void CXBMCRenderManager::RenderUpdate(bool clear, DWORD flags, DWORD alpha)
 {
+#if defined(HAS_GL)
+  CGUITextureBatchGL::Get().Flush();
+#endif
+
   { CRetakeLock<CExclusiveLock> lock(m_sharedSection);
     if (!m_pRenderer)
       return;
@@ -669,6 +674,11 @@ void CXBMCRenderManager::RegisterRenderFeaturesCallBack(const void *ctx, RenderF
 
 void CXBMCRenderManager::Render(bool clear, DWORD flags, DWORD alpha)
 {
+#if defined(HAS_GL)
+  // the video is drawn straight away, so draw the GUI queued so far first
+  CGUITextureBatchGL::Get().Flush();
+#endif
+
   CSharedLock lock(m_sharedSection);
 
   if( m_presentmethod == PRESENT_METHOD_BOB )
@@ -243,4 +243,15 @@ public:
   {
     return 0;
   }
+
+  /*
+   *
+   * How many packets the codec takes in before the picture
+   * of the first one comes out, on top of the reordering
+   * the stream itself needs (frame threading)
+   */
+  virtual unsigned GetDelay()
+  {
+    return 0;
+  }
 };
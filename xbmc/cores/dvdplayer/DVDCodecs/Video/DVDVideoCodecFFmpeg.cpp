@@ -67,6 +67,14 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   if(!ctx->IsHardwareAllowed())
     return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
 
+  // frame threads decode in software only, they crash with hardware acceleration.
+  // Open() doesn't use them while a hardware decoder may be, so this is a safeguard
+  if(avctx->active_thread_type & FF_THREAD_FRAME)
+  {
+    CLog::Log(LOGWARNING,"CDVDVideoCodecFFmpeg::GetFormat - frame threading, not using hardware decoding");
+    return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
+  }
+
   const PixelFormat * cur = fmt;
   while(*cur != PIX_FMT_NONE)
   {
@@ -287,16 +295,47 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   {
     if (it->m_name == "surfaces")
       m_uSurfacesCount = std::atoi(it->m_value.c_str());
+    else if (it->m_name == "lowres")
+    {
+      // avcodec_open2 refuses a lowres the decoder can't do, so ask for as much as it can
+      m_pCodecContext->lowres = std::max(0, std::min(std::atoi(it->m_value.c_str()), (int)pCodec->max_lowres));
+    }
     else
       m_dllAvUtil.av_opt_set(m_pCodecContext, it->m_name.c_str(), it->m_value.c_str(), 0);
   }
 
-  int num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
+  int num_threads = g_advancedSettings.m_videoDecodeThreads;
+  if (num_threads <= 0)
+    num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
   if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
   && ( pCodec->id == CODEC_ID_H264
     || pCodec->id == CODEC_ID_MPEG4 ))
+  {
     m_pCodecContext->thread_count = num_threads;
 
+    /* frame threading also spreads streams that aren't sliced over the cores, but
+     * holds back a picture per extra thread, so only use it when asked to. As it
+     * can't be used with hardware decoding, not while GetFormat may pick a decoder */
+    if (g_advancedSettings.m_videoFrameThreading
+    && (pCodec->capabilities & CODEC_CAP_FRAME_THREADS))
+    {
+      bool hardware = false;
+#ifdef HAVE_LIBVDPAU
+      hardware |= g_guiSettings.GetBool("videoplayer.usevdpau");
+#endif
+#ifdef HAS_DX
+      hardware |= g_guiSettings.GetBool("videoplayer.usedxva2");
+#endif
+#ifdef HAVE_LIBVA
+      hardware |= g_guiSettings.GetBool("videoplayer.usevaapi");
+#endif
+      if (hardware && IsHardwareAllowed())
+        CLog::Log(LOGNOTICE,"CDVDVideoCodecFFmpeg::Open() Not using frame threading, hardware decoding is enabled");
+      else
+        m_pCodecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+  }
+
   if (m_dllAvCodec.avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
     CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Unable to open codec");
@@ -306,6 +345,9 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pFrame = m_dllAvCodec.avcodec_alloc_frame();
   if (!m_pFrame) return false;
 
+  if (m_pCodecContext->active_thread_type & FF_THREAD_FRAME)
+    CLog::Log(LOGNOTICE,"CDVDVideoCodecFFmpeg::Open() Using frame threading with %d threads", m_pCodecContext->thread_count);
+
   UpdateName();
   return true;
 }
@@ -453,7 +495,8 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
     int result = 0;
     if(pData == NULL)
       result = FilterProcess(NULL);
-    if(result)
+    // once the filters are empty, pictures frame threads hold on to are drained
+    if(result && !(result == VC_BUFFER && GetDelay() > 0))
       return result;
   }
 
@@ -464,6 +507,9 @@ int CDVDVideoCodecFFmpeg::Decode(BYTE* pData, int iSize, double dts, double pts)
   m_dllAvCodec.av_init_packet(&avpkt);
   avpkt.data = pData;
   avpkt.size = iSize;
+  /* frame threads hand back the dts of the packet a picture was decoded from */
+  if (m_pCodecContext->active_thread_type & FF_THREAD_FRAME)
+    avpkt.dts = pts_dtoi(dts);
   /* We lie, but this flag is only used by pngdec.c.
    * Setting it correctly would allow CorePNG decoding. */
   avpkt.flags = AV_PKT_FLAG_KEY;
@@ -632,7 +678,11 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(DVDVideoPicture* pDvdVideoPicture)
     pDvdVideoPicture->qscale_type = DVP_QSCALE_UNKNOWN;
   }
 
-  pDvdVideoPicture->dts = m_dts;
+  // with frame threading the picture is from a packet given some calls earlier
+  if (m_pCodecContext->active_thread_type & FF_THREAD_FRAME)
+    pDvdVideoPicture->dts = pts_itod(m_pFrame->pkt_dts);
+  else
+    pDvdVideoPicture->dts = m_dts;
   m_dts = DVD_NOPTS_VALUE;
   if (m_pFrame->reordered_opaque)
     pDvdVideoPicture->pts = pts_itod(m_pFrame->reordered_opaque);
@@ -861,3 +911,11 @@ unsigned CDVDVideoCodecFFmpeg::GetConvergeCount()
   else
     return 0;
 }
+
+unsigned CDVDVideoCodecFFmpeg::GetDelay()
+{
+  if(m_pCodecContext && (m_pCodecContext->active_thread_type & FF_THREAD_FRAME))
+    return m_pCodecContext->thread_count - 1;
+  else
+    return 0;
+}
@@ -37,6 +37,7 @@
 #include "DVDInputStreams/DVDInputStreamPVRManager.h"
 #include "DVDInputStreams/DVDInputStreamFFmpeg.h"
 #include "DVDDemuxUtils.h"
+#include "DVDDemuxProbeCache.h"
 #include "DVDClock.h" // for DVD_TIME_BASE
 #include "commons/Exception.h"
 #include "settings/AdvancedSettings.h"
@@ -44,6 +45,8 @@
 #include "filesystem/File.h"
 #include "filesystem/Directory.h"
 #include "utils/log.h"
+#include "utils/URIUtils.h"
+#include "URL.h"
 #include "threads/Thread.h"
 #include "threads/SystemClock.h"
 #include "utils/TimeUtils.h"
@@ -211,6 +214,7 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_iCurrentPts = DVD_NOPTS_VALUE;
   m_bMatroska = false;
   m_bAVI = false;
+  m_probeCached = false;
   m_speed = DVD_PLAYSPEED_NORMAL;
   m_program = UINT_MAX;
 }
@@ -257,6 +261,13 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
 
+  // files probed before, while scanning or playing them, can skip probing
+  unsigned int openTime = XbmcThreads::SystemClockMillis();
+  bool probeCache = g_advancedSettings.m_videoProbeCache && m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) &&
+                    !URIUtils::IsInternetStream(CURL(strFile));
+  CDVDDemuxProbeInfo probeInfo;
+  bool probed = probeCache && CDVDDemuxProbeCache::Load(strFile, probeInfo);
+
   if( m_pInput->GetContent().length() > 0 )
   {
     std::string content = m_pInput->GetContent();
@@ -272,6 +283,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       iformat = m_dllAvFormat.av_find_input_format("mjpeg");
   }
 
+  if (probed && !iformat)
+    iformat = m_dllAvFormat.av_find_input_format(probeInfo.format.c_str());
+
   // open the demuxer
   m_pFormatContext  = m_dllAvFormat.avformat_alloc_context();
   m_pFormatContext->interrupt_callback = int_cb;
@@ -438,13 +452,27 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   m_bMatroska = strncmp(m_pFormatContext->iformat->name, "matroska", 8) == 0;	// for "matroska.webm"
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
 
-  if (streaminfo)
+  if (probed)
+  {
+    probed = SetProbeInfo(probeInfo);
+    if (!probed)
+    {
+      CLog::Log(LOGDEBUG, "%s - streams of %s have changed since they were probed", __FUNCTION__, strFile.c_str());
+      CDVDDemuxProbeCache::Remove(strFile);
+    }
+  }
+
+  if (streaminfo && !probed)
   {
     /* too speed up dvd switches, only analyse very short */
     if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
       m_pFormatContext->max_analyze_duration = 500000;
 
 
+    // formats without a header, like MPEG-TS, only list the streams found so far
+    unsigned int headerStreams = m_pFormatContext->nb_streams;
+    bool noHeader = (m_pFormatContext->ctx_flags & AVFMTCTX_NOHEADER) != 0;
+
     CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
     int iErr = m_dllAvFormat.avformat_find_stream_info(m_pFormatContext, NULL);
     if (iErr < 0)
@@ -461,7 +489,17 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       }
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+    if (iErr >= 0 && probeCache)
+    {
+      GetProbeInfo(probeInfo);
+      probeInfo.headerIncomplete = noHeader || m_pFormatContext->nb_streams != headerStreams;
+      CDVDDemuxProbeCache::Save(strFile, probeInfo);
+    }
   }
+  m_probeCached = probed;
+  CLog::Log(LOGDEBUG, "%s - opened %s in %u ms%s", __FUNCTION__, strFile.c_str(),
+            XbmcThreads::SystemClockMillis() - openTime, probed ? ", with the probe result of an earlier open" : "");
   // reset any timeout
   m_timeout.SetInfinite();
 
@@ -526,6 +564,11 @@ void CDVDDemuxFFmpeg::Dispose()
 
   for (int i = 0; i < MAX_STREAMS; i++)
   {
+    if (m_packetStats[i].allocations)
+      CLog::Log(LOGDEBUG, "CDVDDemuxFFmpeg::Dispose - stream %d: %u packets, %u allocations avoided, %"PRIu64" bytes copied",
+                i, m_packetStats[i].allocations, m_packetStats[i].allocationsAvoided, m_packetStats[i].bytesCopied);
+    m_packetStats[i] = DemuxPacketStats();
+
     if (m_streams[i])
     {
       if (m_streams[i]->ExtraData)
@@ -672,26 +715,26 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
     else
     {
       AVStream *stream = m_pFormatContext->streams[pkt.stream_index];
+      bool wanted = true;
 
       if (m_program != UINT_MAX)
       {
+        wanted = false;
         /* check so packet belongs to selected program */
         for (unsigned int i = 0; i < m_pFormatContext->programs[m_program]->nb_stream_indexes; i++)
         {
           if(pkt.stream_index == (int)m_pFormatContext->programs[m_program]->stream_index[i])
           {
-            pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt.size);
+            wanted = true;
             break;
           }
         }
 
-        if (!pPacket)
+        if (!wanted)
           bReturnEmpty = true;
       }
-      else
-        pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt.size);
 
-      if (pPacket)
+      if (wanted)
       {
         // lavf sometimes bugs out and gives 0 dts/pts instead of no dts/pts
         // since this could only happens on initial frame under normal
@@ -725,13 +768,13 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
           pkt.pts = AV_NOPTS_VALUE;
         }
 
-        // copy contents into our own packet
-        pPacket->iSize = pkt.size;
-
-        // maybe we can avoid a memcpy here by detecting where pkt.destruct is pointing too?
-        if (pkt.data)
-          memcpy(pPacket->pData, pkt.data, pPacket->iSize);
+        // take over the payload, or copy it when it still belongs to the demuxer
+        DemuxPacketStats *stats = pkt.stream_index < MAX_STREAMS ? &m_packetStats[pkt.stream_index] : NULL;
+        pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt, stats);
+      }
 
+      if (pPacket)
+      {
         pPacket->pts = ConvertTimestamp(pkt.pts, stream->time_base.den, stream->time_base.num);
         pPacket->dts = ConvertTimestamp(pkt.dts, stream->time_base.den, stream->time_base.num);
         pPacket->duration =  DVD_SEC_TO_TIME((double)pkt.duration * stream->time_base.num / stream->time_base.den);
@@ -887,6 +930,129 @@ void CDVDDemuxFFmpeg::UpdateCurrentPTS()
   }
 }
 
+void CDVDDemuxFFmpeg::GetProbeInfo(CDVDDemuxProbeInfo &info)
+{
+  info.Reset();
+  info.format    = m_pFormatContext->iformat->name;
+  info.startTime = m_pFormatContext->start_time;
+  info.duration  = m_pFormatContext->duration;
+  info.bitRate   = m_pFormatContext->bit_rate;
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVStream *stream = m_pFormatContext->streams[i];
+    AVCodecContext *codec = stream->codec;
+    CDVDDemuxProbeStream probed;
+    probed.type               = codec->codec_type;
+    probed.codec              = codec->codec_id;
+    probed.tag                = codec->codec_tag;
+    probed.subId              = codec->sub_id;
+    probed.profile            = codec->profile;
+    probed.level              = codec->level;
+    probed.bitRate            = codec->bit_rate;
+    probed.bitsPerCodedSample = codec->bits_per_coded_sample;
+    probed.bitsPerRawSample   = codec->bits_per_raw_sample;
+    probed.timeBaseNum        = codec->time_base.num;
+    probed.timeBaseDen        = codec->time_base.den;
+    probed.ticksPerFrame      = codec->ticks_per_frame;
+
+    probed.width              = codec->width;
+    probed.height             = codec->height;
+    probed.pixFmt             = codec->pix_fmt;
+    probed.hasBFrames         = codec->has_b_frames;
+    probed.sarNum             = codec->sample_aspect_ratio.num;
+    probed.sarDen             = codec->sample_aspect_ratio.den;
+    probed.streamSarNum       = stream->sample_aspect_ratio.num;
+    probed.streamSarDen       = stream->sample_aspect_ratio.den;
+    probed.rFrameRateNum      = stream->r_frame_rate.num;
+    probed.rFrameRateDen      = stream->r_frame_rate.den;
+    probed.avgFrameRateNum    = stream->avg_frame_rate.num;
+    probed.avgFrameRateDen    = stream->avg_frame_rate.den;
+
+    probed.sampleRate         = codec->sample_rate;
+    probed.channels           = codec->channels;
+    probed.channelLayout      = codec->channel_layout;
+    probed.sampleFmt          = codec->sample_fmt;
+    probed.blockAlign         = codec->block_align;
+    probed.frameSize          = codec->frame_size;
+
+    probed.startTime          = stream->start_time;
+    probed.duration           = stream->duration;
+    probed.frames             = stream->nb_frames;
+    probed.infoFrames         = stream->codec_info_nb_frames;
+    if (codec->extradata && codec->extradata_size > 0)
+      probed.extraData.assign((const char*)codec->extradata, codec->extradata_size);
+    info.streams.push_back(probed);
+  }
+}
+
+bool CDVDDemuxFFmpeg::SetProbeInfo(const CDVDDemuxProbeInfo &info)
+{
+  // the header must have announced the streams that were probed, so containers
+  // whose streams only turn up while reading packets are still probed each time
+  if (m_pFormatContext->nb_streams != info.streams.size())
+    return false;
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    if (codec->codec_type != info.streams[i].type || codec->codec_id != info.streams[i].codec)
+      return false;
+  }
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const CDVDDemuxProbeStream &probed = info.streams[i];
+    AVStream *stream = m_pFormatContext->streams[i];
+    AVCodecContext *codec = stream->codec;
+    codec->codec_tag                 = probed.tag;
+    codec->sub_id                    = probed.subId;
+    codec->profile                   = probed.profile;
+    codec->level                     = probed.level;
+    codec->bit_rate                  = probed.bitRate;
+    codec->bits_per_coded_sample     = probed.bitsPerCodedSample;
+    codec->bits_per_raw_sample       = probed.bitsPerRawSample;
+    codec->time_base.num             = probed.timeBaseNum;
+    codec->time_base.den             = probed.timeBaseDen;
+    codec->ticks_per_frame           = probed.ticksPerFrame;
+
+    codec->width                     = probed.width;
+    codec->height                    = probed.height;
+    codec->pix_fmt                   = (PixelFormat)probed.pixFmt;
+    codec->has_b_frames              = probed.hasBFrames;
+    codec->sample_aspect_ratio.num   = probed.sarNum;
+    codec->sample_aspect_ratio.den   = probed.sarDen;
+    stream->sample_aspect_ratio.num  = probed.streamSarNum;
+    stream->sample_aspect_ratio.den  = probed.streamSarDen;
+    stream->r_frame_rate.num         = probed.rFrameRateNum;
+    stream->r_frame_rate.den         = probed.rFrameRateDen;
+    stream->avg_frame_rate.num       = probed.avgFrameRateNum;
+    stream->avg_frame_rate.den       = probed.avgFrameRateDen;
+
+    codec->sample_rate               = probed.sampleRate;
+    codec->channels                  = probed.channels;
+    codec->channel_layout            = probed.channelLayout;
+    codec->sample_fmt                = (AVSampleFormat)probed.sampleFmt;
+    codec->block_align               = probed.blockAlign;
+    codec->frame_size                = probed.frameSize;
+
+    stream->start_time               = probed.startTime;
+    stream->duration                 = probed.duration;
+    stream->nb_frames                = probed.frames;
+    stream->codec_info_nb_frames     = probed.infoFrames;
+    if (!codec->extradata_size && !probed.extraData.empty())
+    {
+      codec->extradata = (uint8_t*)m_dllAvUtil.av_mallocz(probed.extraData.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      memcpy(codec->extradata, probed.extraData.c_str(), probed.extraData.size());
+      codec->extradata_size = probed.extraData.size();
+    }
+  }
+
+  m_pFormatContext->start_time = info.startTime;
+  m_pFormatContext->duration   = info.duration;
+  m_pFormatContext->bit_rate   = info.bitRate;
+  return true;
+}
+
 int CDVDDemuxFFmpeg::GetStreamLength()
 {
   if (!m_pFormatContext)
@@ -21,6 +21,7 @@
  */
 
 #include "DVDDemux.h"
+#include "DVDDemuxUtils.h"
 #include "DllAvFormat.h"
 #include "DllAvCodec.h"
 #include "DllAvUtil.h"
@@ -29,6 +30,7 @@
 #include "threads/SystemClock.h"
 
 class CDVDDemuxFFmpeg;
+class CDVDDemuxProbeInfo;
 
 class CDemuxStreamVideoFFmpeg
   : public CDemuxStreamVideo
@@ -110,6 +112,11 @@ public:
 
   bool Aborted();
 
+  /*!
+   \brief Whether the last Open used the probe result of an earlier open instead of probing
+   */
+  bool UsedProbeResult() const { return m_probeCached; }
+
   AVFormatContext* m_pFormatContext;
   CDVDInputStream* m_pInput;
 
@@ -124,9 +131,13 @@ protected:
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
 
+  void GetProbeInfo(CDVDDemuxProbeInfo &info);
+  bool SetProbeInfo(const CDVDDemuxProbeInfo &info);
+
   CCriticalSection m_critSection;
   #define MAX_STREAMS 100
   CDemuxStream* m_streams[MAX_STREAMS]; // maximum number of streams that ffmpeg can handle
+  DemuxPacketStats m_packetStats[MAX_STREAMS];
 
   AVIOContext* m_ioContext;
 
@@ -137,6 +148,7 @@ protected:
   double   m_iCurrentPts; // used for stream length estimation
   bool     m_bMatroska;
   bool     m_bAVI;
+  bool     m_probeCached;
   int      m_speed;
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
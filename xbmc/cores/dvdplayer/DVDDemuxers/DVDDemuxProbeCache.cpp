@@ -0,0 +1,252 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxProbeCache.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <time.h>
+
+#define PROBECACHE_VERSION 1
+#define PROBECACHE_END     0x50524f42 // "PROB"
+#define PROBECACHE_MAX_STREAMS 100
+#define PROBECACHE_FOLDER      "special://temp/probecache/"
+#define PROBECACHE_MAX_ENTRIES 1000
+#define PROBECACHE_REFRESH_AGE (24 * 60 * 60) // seconds a used entry goes before it is rewritten
+
+using namespace XFILE;
+
+/* reads a string CArchive stored, checking its length against what is left of the file
+   so a damaged entry can't make us allocate an arbitrary amount */
+static bool LoadString(CArchive &ar, CFile &file, std::string &str)
+{
+  int length = -1;
+  ar >> length;
+  if (length < 0 || length > file.GetLength() - file.GetPosition())
+    return false;
+  str.resize(length);
+  return length == 0 || file.Read(&str[0], length) == (unsigned int)length;
+}
+
+CDVDDemuxProbeStream::CDVDDemuxProbeStream()
+{
+  type = codec = subId = profile = level = bitRate = 0;
+  tag = 0;
+  bitsPerCodedSample = bitsPerRawSample = 0;
+  timeBaseNum = ticksPerFrame = 0;
+  timeBaseDen = 1;
+  width = height = pixFmt = hasBFrames = 0;
+  sarNum = streamSarNum = 0;
+  sarDen = streamSarDen = 1;
+  rFrameRateNum = avgFrameRateNum = 0;
+  rFrameRateDen = avgFrameRateDen = 1;
+  sampleRate = channels = sampleFmt = blockAlign = frameSize = 0;
+  channelLayout = 0;
+  startTime = duration = frames = 0;
+  infoFrames = 0;
+}
+
+CDVDDemuxProbeInfo::CDVDDemuxProbeInfo()
+{
+  Reset();
+}
+
+void CDVDDemuxProbeInfo::Reset()
+{
+  format.clear();
+  startTime = duration = 0;
+  bitRate = 0;
+  headerIncomplete = false;
+  streams.clear();
+}
+
+bool CDVDDemuxProbeCache::Load(const CStdString &path, CDVDDemuxProbeInfo &info)
+{
+  struct __stat64 st;
+  if (CFile::Stat(path, &st) != 0)
+    return false;
+
+  CStdString cacheFile(GetCacheFile(path));
+  struct __stat64 cacheSt;
+  CFile file;
+  if (CFile::Stat(cacheFile, &cacheSt) != 0 || !file.Open(cacheFile))
+    return false;
+
+  CArchive ar(&file, CArchive::load);
+  int version = 0;
+  std::string cachedPath;
+  int64_t size = 0, mtime = 0;
+  ar >> version;
+  bool valid = version == PROBECACHE_VERSION && LoadString(ar, file, cachedPath);
+  if (valid)
+  {
+    ar >> size >> mtime;
+    valid = cachedPath == path && size == (int64_t)st.st_size && mtime == (int64_t)st.st_mtime;
+  }
+  int count = 0, end = 0;
+  if (valid)
+  {
+    info.Reset();
+    valid = LoadString(ar, file, info.format);
+  }
+  if (valid)
+  {
+    ar >> info.startTime >> info.duration >> info.bitRate;
+    ar >> count;
+    valid = count > 0 && count <= PROBECACHE_MAX_STREAMS;
+  }
+  for (int i = 0; valid && i < count; i++)
+  {
+    CDVDDemuxProbeStream stream;
+    ar >> stream.type >> stream.codec >> stream.tag >> stream.subId >> stream.profile >> stream.level;
+    ar >> stream.bitRate >> stream.bitsPerCodedSample >> stream.bitsPerRawSample;
+    ar >> stream.timeBaseNum >> stream.timeBaseDen >> stream.ticksPerFrame;
+    ar >> stream.width >> stream.height >> stream.pixFmt >> stream.hasBFrames;
+    ar >> stream.sarNum >> stream.sarDen >> stream.streamSarNum >> stream.streamSarDen;
+    ar >> stream.rFrameRateNum >> stream.rFrameRateDen >> stream.avgFrameRateNum >> stream.avgFrameRateDen;
+    ar >> stream.sampleRate >> stream.channels >> stream.channelLayout >> stream.sampleFmt;
+    ar >> stream.blockAlign >> stream.frameSize;
+    ar >> stream.startTime >> stream.duration >> stream.frames >> stream.infoFrames;
+    valid = LoadString(ar, file, stream.extraData);
+    info.streams.push_back(stream);
+  }
+  if (valid)
+  {
+    ar >> end;
+    valid = end == PROBECACHE_END;
+  }
+  ar.Close();
+  file.Close();
+
+  if (!valid)
+  {
+    info.Reset();
+    return false;
+  }
+
+  // entries are pruned oldest first, so one still in use is rewritten now and then to keep it
+  if (time(NULL) - (time_t)cacheSt.st_mtime > PROBECACHE_REFRESH_AGE)
+    Save(path, info);
+  return true;
+}
+
+bool CDVDDemuxProbeCache::Save(const CStdString &path, const CDVDDemuxProbeInfo &info)
+{
+  struct __stat64 st;
+  if (info.headerIncomplete || info.streams.empty() || info.streams.size() > PROBECACHE_MAX_STREAMS ||
+      CFile::Stat(path, &st) != 0)
+    return false;
+
+  // written aside and renamed into place, so a reader never sees a partial entry
+  CStdString cacheFile(GetCacheFile(path));
+  CStdString tempFile(cacheFile + ".tmp");
+  CFile file;
+  if (!CDirectory::Exists(PROBECACHE_FOLDER))
+    CDirectory::Create(PROBECACHE_FOLDER);
+  if (!file.OpenForWrite(tempFile, true))
+    return false;
+
+  CArchive ar(&file, CArchive::store);
+  ar << (int)PROBECACHE_VERSION << path << (int64_t)st.st_size << (int64_t)st.st_mtime;
+  ar << info.format << info.startTime << info.duration << info.bitRate;
+  ar << (int)info.streams.size();
+  for (std::vector<CDVDDemuxProbeStream>::const_iterator i = info.streams.begin(); i != info.streams.end(); ++i)
+  {
+    ar << i->type << i->codec << i->tag << i->subId << i->profile << i->level;
+    ar << i->bitRate << i->bitsPerCodedSample << i->bitsPerRawSample;
+    ar << i->timeBaseNum << i->timeBaseDen << i->ticksPerFrame;
+    ar << i->width << i->height << i->pixFmt << i->hasBFrames;
+    ar << i->sarNum << i->sarDen << i->streamSarNum << i->streamSarDen;
+    ar << i->rFrameRateNum << i->rFrameRateDen << i->avgFrameRateNum << i->avgFrameRateDen;
+    ar << i->sampleRate << i->channels << i->channelLayout << i->sampleFmt;
+    ar << i->blockAlign << i->frameSize;
+    ar << i->startTime << i->duration << i->frames << i->infoFrames;
+    ar << i->extraData;
+  }
+  ar << (int)PROBECACHE_END;
+  ar.Close();
+  file.Close();
+
+  if (!CFile::Rename(tempFile, cacheFile))
+  {
+    // not every filesystem renames over an existing file
+    CFile::Delete(cacheFile);
+    if (!CFile::Rename(tempFile, cacheFile))
+    {
+      CFile::Delete(tempFile);
+      return false;
+    }
+  }
+
+  Prune(PROBECACHE_MAX_ENTRIES);
+  return true;
+}
+
+void CDVDDemuxProbeCache::Remove(const CStdString &path)
+{
+  CStdString cacheFile(GetCacheFile(path));
+  if (CFile::Exists(cacheFile))
+  {
+    CLog::Log(LOGDEBUG, "%s - removing probe result of %s", __FUNCTION__, path.c_str());
+    CFile::Delete(cacheFile);
+  }
+}
+
+static bool ProbeEntryOlder(const CFileItemPtr &left, const CFileItemPtr &right)
+{
+  return left->m_dateTime < right->m_dateTime;
+}
+
+void CDVDDemuxProbeCache::Prune(unsigned int maxEntries)
+{
+  CFileItemList items;
+  if (!CDirectory::GetDirectory(PROBECACHE_FOLDER, items, ".dp", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  std::vector<CFileItemPtr> entries;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (!items[i]->m_bIsFolder)
+      entries.push_back(items[i]);
+  }
+  if (entries.size() <= maxEntries)
+    return;
+
+  std::sort(entries.begin(), entries.end(), ProbeEntryOlder);
+  CLog::Log(LOGDEBUG, "%s - removing %u of %u probe results", __FUNCTION__,
+            (unsigned int)(entries.size() - maxEntries), (unsigned int)entries.size());
+  for (std::vector<CFileItemPtr>::iterator i = entries.begin(); i != entries.end() - maxEntries; ++i)
+    CFile::Delete((*i)->GetPath());
+}
+
+CStdString CDVDDemuxProbeCache::GetCacheFile(const CStdString &path)
+{
+  Crc32 crc;
+  crc.Compute(path);
+
+  CStdString cacheFile;
+  cacheFile.Format(PROBECACHE_FOLDER "probe-%08x.dp", (unsigned __int32)crc);
+  return cacheFile;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "utils/StdString.h"
+
+/*!
+ \brief Parameters of a probed stream
+ The AVStream and AVCodecContext fields avformat_find_stream_info fills in, kept apart
+ from ffmpeg's structures so they can be stored.
+ */
+class CDVDDemuxProbeStream
+{
+public:
+  CDVDDemuxProbeStream();
+
+  int          type;            ///< AVMediaType
+  int          codec;           ///< CodecID
+  unsigned int tag;
+  int          subId;
+  int          profile;
+  int          level;
+  int          bitRate;
+  int          bitsPerCodedSample;
+  int          bitsPerRawSample;
+  int          timeBaseNum;
+  int          timeBaseDen;
+  int          ticksPerFrame;
+
+  int          width;
+  int          height;
+  int          pixFmt;
+  int          hasBFrames;
+  int          sarNum;          ///< sample aspect ratio of the codec
+  int          sarDen;
+  int          streamSarNum;    ///< sample aspect ratio of the container
+  int          streamSarDen;
+  int          rFrameRateNum;
+  int          rFrameRateDen;
+  int          avgFrameRateNum;
+  int          avgFrameRateDen;
+
+  int          sampleRate;
+  int          channels;
+  uint64_t     channelLayout;
+  int          sampleFmt;
+  int          blockAlign;
+  int          frameSize;
+
+  int64_t      startTime;
+  int64_t      duration;
+  int64_t      frames;
+  int          infoFrames;      ///< frames decoded while probing
+  std::string  extraData;
+};
+
+/*!
+ \brief Result of probing a file: its input format and the parameters of its streams
+ */
+class CDVDDemuxProbeInfo
+{
+public:
+  CDVDDemuxProbeInfo();
+  void Reset();
+
+  std::string format;           ///< name of the input format
+  int64_t     startTime;
+  int64_t     duration;
+  int         bitRate;
+  bool        headerIncomplete; ///< probing found streams the header does not list, as in MPEG-TS
+  std::vector<CDVDDemuxProbeStream> streams;
+};
+
+/*!
+ \brief Persisted probe results of media files
+
+ The result of probing a file is kept in special://temp/probecache, keyed on its
+ path and checked against the size and modification time the file had when it was
+ probed, so that files scanned or played before open without being probed again.
+ The folder is kept to a fixed number of entries, dropping the least recently used.
+ */
+class CDVDDemuxProbeCache
+{
+public:
+  /*!
+   \brief Load the probe result of a file
+   \param path path of the media file.
+   \param info the probe result.
+   \return true if a result was found for the file as it is now, false otherwise.
+   */
+  static bool Load(const CStdString &path, CDVDDemuxProbeInfo &info);
+
+  /*!
+   \brief Store the probe result of a file, replacing any earlier one
+   A result with an incomplete header is not stored, as the streams it lacks would
+   be missing when the file is opened with it.
+   \param path path of the media file.
+   \param info the probe result.
+   \return true if the result was stored, false otherwise.
+   */
+  static bool Save(const CStdString &path, const CDVDDemuxProbeInfo &info);
+
+  /*!
+   \brief Forget the probe result of a file, e.g. when using it failed
+   \param path path of the media file.
+   */
+  static void Remove(const CStdString &path);
+
+  /*!
+   \brief Drop the least recently used probe results beyond a number of entries
+   Called after each save; results that are loaded are rewritten once a day so
+   their modification time tells when they were last used.
+   \param maxEntries number of results to keep.
+   */
+  static void Prune(unsigned int maxEntries);
+
+private:
+  static CStdString GetCacheFile(const CStdString &path);
+};
@@ -24,6 +24,8 @@
 #include "DVDDemuxUtils.h"
 #include "DVDClock.h"
 #include "utils/log.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 extern "C" {
 #if (defined USE_EXTERNAL_FFMPEG)
   #if (defined HAVE_LIBAVCODEC_AVCODEC_H)
@@ -36,13 +38,133 @@ extern "C" {
 #endif
 }
 
+#include <vector>
+
+/* Packets are recycled together with their payload, in size classes of powers of two so that a
+   payload can be reused for any packet of its class. Payloads above the largest class aren't
+   pooled. About what the player's queues hold while playing high bitrate video is kept. */
+#define DEMUXPACKET_CLASS_MIN   10 // 1 KiB
+#define DEMUXPACKET_CLASS_MAX   22 // 4 MiB
+#define DEMUXPACKET_CLASSES     (DEMUXPACKET_CLASS_MAX - DEMUXPACKET_CLASS_MIN + 1)
+#define DEMUXPACKET_POOL_BYTES  (32 * 1024 * 1024)
+#define DEMUXPACKET_POOL_EMPTY  256 // packets without a payload
+
+typedef struct DemuxPacketNode
+{
+  DemuxPacket packet;     // must be first, it's all the rest of the player sees
+  unsigned char *buffer;  // payload allocation, NULL when the packet has none of its own
+  int sizeClass;          // size class of buffer, -1 when it isn't pooled
+  bool adopted;           // payload belongs to avpacket
+  AVPacket avpacket;
+} DemuxPacketNode;
+
+class CDemuxPacketPool
+{
+public:
+  CDemuxPacketPool() : m_bytes(0) {}
+
+  ~CDemuxPacketPool()
+  {
+    Clear();
+  }
+
+  /*! \brief Release all packets in the pool. */
+  void Clear()
+  {
+    CSingleLock lock(m_section);
+    for (unsigned int i = 0; i <= DEMUXPACKET_CLASSES; i++)
+    {
+      for (std::vector<DemuxPacketNode*>::iterator it = m_free[i].begin(); it != m_free[i].end(); ++it)
+      {
+        if ((*it)->buffer)
+          _aligned_free((*it)->buffer);
+        delete *it;
+      }
+      m_free[i].clear();
+    }
+    m_bytes = 0;
+  }
+
+  /*! \brief Get a packet from the pool.
+   \param sizeClass size class of the payload wanted, -1 for a packet without a pooled payload.
+   \return the packet, NULL if the pool has none.
+   */
+  DemuxPacketNode *Get(int sizeClass)
+  {
+    std::vector<DemuxPacketNode*> &nodes = m_free[sizeClass < 0 ? DEMUXPACKET_CLASSES : sizeClass - DEMUXPACKET_CLASS_MIN];
+    CSingleLock lock(m_section);
+    if (nodes.empty())
+      return NULL;
+    DemuxPacketNode *node = nodes.back();
+    nodes.pop_back();
+    if (node->buffer)
+      m_bytes -= (size_t)1 << node->sizeClass;
+    return node;
+  }
+
+  /*! \brief Return a packet to the pool.
+   \return true if the pool kept it, false if it should be released.
+   */
+  bool Put(DemuxPacketNode *node)
+  {
+    CSingleLock lock(m_section);
+    if (node->sizeClass < 0)
+    {
+      if (node->buffer || m_free[DEMUXPACKET_CLASSES].size() >= DEMUXPACKET_POOL_EMPTY)
+        return false;
+      m_free[DEMUXPACKET_CLASSES].push_back(node);
+      return true;
+    }
+    size_t size = (size_t)1 << node->sizeClass;
+    if (m_bytes + size > DEMUXPACKET_POOL_BYTES)
+      return false;
+    m_free[node->sizeClass - DEMUXPACKET_CLASS_MIN].push_back(node);
+    m_bytes += size;
+    return true;
+  }
+
+private:
+  CCriticalSection m_section;
+  std::vector<DemuxPacketNode*> m_free[DEMUXPACKET_CLASSES + 1]; // the last for packets without a payload
+  size_t m_bytes;
+};
+
+static CDemuxPacketPool g_demuxPacketPool;
+
+static int GetSizeClass(int iDataSize)
+{
+  int sizeClass = DEMUXPACKET_CLASS_MIN;
+  while (sizeClass <= DEMUXPACKET_CLASS_MAX && ((size_t)1 << sizeClass) < (size_t)iDataSize + FF_INPUT_BUFFER_PADDING_SIZE)
+    sizeClass++;
+  return sizeClass <= DEMUXPACKET_CLASS_MAX ? sizeClass : -1;
+}
+
+static void ReleaseNode(DemuxPacketNode *node)
+{
+  if (node->buffer)
+    _aligned_free(node->buffer);
+  delete node;
+}
+
+void CDVDDemuxUtils::ReleasePacketPool()
+{
+  g_demuxPacketPool.Clear();
+}
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      DemuxPacketNode *node = (DemuxPacketNode*)pPacket;
+      if (node->adopted)
+      {
+        if (node->avpacket.destruct)
+          node->avpacket.destruct(&node->avpacket);
+        node->adopted = false;
+      }
+      if (!g_demuxPacketPool.Put(node))
+        ReleaseNode(node);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -50,47 +172,110 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
   }
 }
 
-DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize, DemuxPacketStats *stats)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
+  DemuxPacketNode* node = NULL;
 
   try
   {
-    memset(pPacket, 0, sizeof(DemuxPacket));
+    int sizeClass = iDataSize > 0 ? GetSizeClass(iDataSize) : -1;
+    node = g_demuxPacketPool.Get(sizeClass);
+    if (node)
+    {
+      if (stats && node->buffer)
+        stats->allocationsAvoided++;
+    }
+    else
+    {
+      node = new DemuxPacketNode;
+      node->buffer = NULL;
+      node->sizeClass = sizeClass;
+      node->adopted = false;
+    }
+    memset(&node->packet, 0, sizeof(DemuxPacket));
 
     if (iDataSize > 0)
     {
-      // need to allocate a few bytes more.
-      // From avcodec.h (ffmpeg)
-      /**
-        * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
-        * this is mainly needed because some optimized bitstream readers read
-        * 32 or 64 bit at once and could read over the end<br>
-        * Note, if the first 23 bits of the additional bytes are not 0 then damaged
-        * MPEG bitstreams could cause overread and segfault
-        */
-      pPacket->pData =(BYTE*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
+      if (!node->buffer)
       {
-        FreeDemuxPacket(pPacket);
-        return NULL;
+        // need to allocate a few bytes more.
+        // From avcodec.h (ffmpeg)
+        /**
+          * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
+          * this is mainly needed because some optimized bitstream readers read
+          * 32 or 64 bit at once and could read over the end<br>
+          * Note, if the first 23 bits of the additional bytes are not 0 then damaged
+          * MPEG bitstreams could cause overread and segfault
+          */
+        size_t size = sizeClass < 0 ? (size_t)iDataSize + FF_INPUT_BUFFER_PADDING_SIZE : (size_t)1 << sizeClass;
+        node->buffer = (BYTE*)_aligned_malloc(size, 16);
+        if (!node->buffer)
+        {
+          node->sizeClass = -1;
+          FreeDemuxPacket(&node->packet);
+          return NULL;
+        }
       }
+      node->packet.pData = node->buffer;
 
       // reset the last 8 bytes to 0;
-      memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+      memset(node->packet.pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
     }
 
     // setup defaults
-    pPacket->dts       = DVD_NOPTS_VALUE;
-    pPacket->pts       = DVD_NOPTS_VALUE;
-    pPacket->iStreamId = -1;
+    node->packet.dts       = DVD_NOPTS_VALUE;
+    node->packet.pts       = DVD_NOPTS_VALUE;
+    node->packet.iStreamId = -1;
+    if (stats)
+      stats->allocations++;
   }
   catch(...)
   {
     CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
-    FreeDemuxPacket(pPacket);
-    pPacket = NULL;
+    if (node)
+      FreeDemuxPacket(&node->packet);
+    node = NULL;
+  }
+  return node ? &node->packet : NULL;
+}
+
+DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(AVPacket &pkt, DemuxPacketStats *stats)
+{
+  // without a destructor the payload still belongs to the demuxer, so needs copying
+  if (!pkt.destruct || !pkt.data)
+  {
+    DemuxPacket *pPacket = AllocateDemuxPacket(pkt.data ? pkt.size : 0, stats);
+    if (pPacket && pkt.data)
+    {
+      memcpy(pPacket->pData, pkt.data, pkt.size);
+      pPacket->iSize = pkt.size;
+      if (stats)
+        stats->bytesCopied += pkt.size;
+    }
+    return pPacket;
+  }
+
+  DemuxPacket *pPacket = AllocateDemuxPacket(0);
+  if (!pPacket)
+    return NULL;
+
+  // the payload is padded like any other the codecs get, see av_new_packet
+  DemuxPacketNode *node = (DemuxPacketNode*)pPacket;
+  node->avpacket = pkt;
+  node->adopted = true;
+  pPacket->pData = pkt.data;
+  pPacket->iSize = pkt.size;
+
+  pkt.data = NULL;
+  pkt.size = 0;
+  pkt.destruct = NULL;
+  pkt.side_data = NULL;
+  pkt.side_data_elems = 0;
+
+  if (stats)
+  {
+    stats->allocations++;
+    stats->allocationsAvoided++;
   }
   return pPacket;
 }
@@ -21,11 +21,42 @@
  */
 
 #include "DVDDemuxPacket.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct AVPacket;
+
+/// packet allocation counters, kept per stream by demuxers that want them
+struct DemuxPacketStats
+{
+  DemuxPacketStats() : allocations(0), allocationsAvoided(0), bytesCopied(0) {}
+  unsigned int allocations;        // packets handed out
+  unsigned int allocationsAvoided; // of those, packets whose payload was reused from the pool or taken over from ffmpeg
+  uint64_t bytesCopied;            // payload bytes copied into packets
+};
 
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
-  static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+  static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0, DemuxPacketStats *stats = NULL);
+
+  /*! \brief Allocate a packet for the payload of an ffmpeg packet.
+   Payloads owned by the ffmpeg packet are taken over without a copy and released through the
+   packet's destructor once the DemuxPacket is freed. Payloads that still belong to the demuxer
+   (eg the parser's buffer) are copied. Either way \p pkt is left without a payload, ready for
+   av_free_packet.
+   \param pkt ffmpeg packet to take the payload of.
+   \param stats counters to update, may be NULL.
+   \return the packet, NULL on failure.
+   */
+  static DemuxPacket* AllocateDemuxPacket(AVPacket &pkt, DemuxPacketStats *stats = NULL);
+
+  /*! \brief Release the packets kept for reuse.
+   The pool holds up to DEMUXPACKET_POOL_BYTES of payloads, which aren't needed once a file is closed.
+   Packets still in use are returned to the pool as usual once freed.  The pool is shared by every
+   demuxer in the process, so this is only called by the player once it has finished playing.
+   */
+  static void ReleasePacketPool();
 };
 
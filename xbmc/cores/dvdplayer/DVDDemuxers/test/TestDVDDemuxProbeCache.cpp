@@ -0,0 +1,208 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxProbeCache.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStreamFile.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+#include "utils/TimeUtils.h"
+
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+static const int TestDVDDemuxProbeCacheWidth = 640;
+static const int TestDVDDemuxProbeCacheHeight = 360;
+static const unsigned int TestDVDDemuxProbeCacheFrames = 50;
+static const unsigned int TestDVDDemuxProbeCacheOpens = 20;
+
+/* writes a clip of moving gradients */
+class TestDVDDemuxProbeCache : public testing::Test
+{
+protected:
+  TestDVDDemuxProbeCache()
+  {
+    m_file = XBMC_CREATEYUV4MPEGFILE(TestDVDDemuxProbeCacheWidth, TestDVDDemuxProbeCacheHeight,
+                                     TestDVDDemuxProbeCacheFrames, 0);
+    m_path = XBMC_TEMPFILEPATH(m_file);
+    CDVDDemuxProbeCache::Remove(m_path);
+  }
+
+  ~TestDVDDemuxProbeCache()
+  {
+    CDVDDemuxProbeCache::Remove(m_path);
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  /* time from opening the clip until its first packet is read, in host counter ticks */
+  int64_t Open(CDVDDemuxFFmpeg &demuxer, CDVDInputStreamFile &input)
+  {
+    int64_t start = CurrentHostCounter();
+    if (!input.Open(m_path.c_str(), "") || !demuxer.Open(&input))
+      return -1;
+    DemuxPacket *packet = demuxer.Read();
+    int64_t elapsed = CurrentHostCounter() - start;
+    if (!packet)
+      return -1;
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+    return elapsed;
+  }
+
+  XFILE::CFile *m_file;
+  CStdString m_path;
+};
+
+TEST_F(TestDVDDemuxProbeCache, SaveLoad)
+{
+  CDVDDemuxProbeInfo info, loaded;
+  EXPECT_FALSE(CDVDDemuxProbeCache::Load(m_path, loaded));
+
+  info.format = "matroska,webm";
+  info.duration = 5400000000LL;
+  CDVDDemuxProbeStream video, audio;
+  video.type = 0;
+  video.codec = 28;
+  video.width = 1920;
+  video.height = 1080;
+  video.hasBFrames = 2;
+  video.extraData = std::string("\x01\x64\x00\x29\xff\xe1\x00", 7);
+  audio.type = 1;
+  audio.channels = 6;
+  audio.channelLayout = 0x60f;
+  info.streams.push_back(video);
+  info.streams.push_back(audio);
+
+  // streams missing from the header would be missing when opening with the result
+  info.headerIncomplete = true;
+  EXPECT_FALSE(CDVDDemuxProbeCache::Save(m_path, info));
+  EXPECT_FALSE(CDVDDemuxProbeCache::Load(m_path, loaded));
+  info.headerIncomplete = false;
+  ASSERT_TRUE(CDVDDemuxProbeCache::Save(m_path, info));
+
+  ASSERT_TRUE(CDVDDemuxProbeCache::Load(m_path, loaded));
+  EXPECT_EQ(info.format, loaded.format);
+  EXPECT_EQ(info.duration, loaded.duration);
+  ASSERT_EQ(2U, loaded.streams.size());
+  EXPECT_EQ(1920, loaded.streams[0].width);
+  EXPECT_EQ(2, loaded.streams[0].hasBFrames);
+  EXPECT_EQ(video.extraData, loaded.streams[0].extraData);
+  EXPECT_EQ(6, loaded.streams[1].channels);
+  EXPECT_EQ(0x60fU, loaded.streams[1].channelLayout);
+
+  // once the file has changed, what was probed no longer applies
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(m_path, true));
+  file.Write("YUV4MPEG2", 9);
+  file.Close();
+  EXPECT_FALSE(CDVDDemuxProbeCache::Load(m_path, loaded));
+}
+
+TEST_F(TestDVDDemuxProbeCache, Prune)
+{
+  CDVDDemuxProbeInfo info, loaded;
+  info.format = "yuv4mpegpipe";
+  info.streams.push_back(CDVDDemuxProbeStream());
+
+  XFILE::CFile *files[] = { m_file, XBMC_CREATETEMPFILE(".y4m"), XBMC_CREATETEMPFILE(".y4m") };
+  CStdString paths[3];
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    ASSERT_TRUE(files[i] != NULL);
+    paths[i] = XBMC_TEMPFILEPATH(files[i]);
+    ASSERT_TRUE(CDVDDemuxProbeCache::Save(paths[i], info));
+  }
+
+  // the cache keeps to the number of entries it is pruned to
+  CDVDDemuxProbeCache::Prune(2);
+  int kept = 0;
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    if (CDVDDemuxProbeCache::Load(paths[i], loaded))
+      kept++;
+  }
+  EXPECT_EQ(2, kept);
+
+  CDVDDemuxProbeCache::Prune(0);
+  for (unsigned int i = 0; i < 3; i++)
+    EXPECT_FALSE(CDVDDemuxProbeCache::Load(paths[i], loaded));
+
+  for (unsigned int i = 1; i < 3; i++)
+    XBMC_DELETETEMPFILE(files[i]);
+}
+
+TEST_F(TestDVDDemuxProbeCache, Open)
+{
+  CDVDDemuxProbeInfo info;
+  {
+    CDVDInputStreamFile input;
+    CDVDDemuxFFmpeg demuxer;
+    ASSERT_LT(0, Open(demuxer, input));
+    ASSERT_EQ(1, demuxer.GetNrOfStreams());
+    EXPECT_FALSE(demuxer.UsedProbeResult());
+  }
+  ASSERT_TRUE(CDVDDemuxProbeCache::Load(m_path, info));
+  ASSERT_EQ(1U, info.streams.size());
+  EXPECT_EQ(TestDVDDemuxProbeCacheWidth, info.streams[0].width);
+
+  // opened with the probe result, the demuxer has the same streams
+  CDVDInputStreamFile input;
+  CDVDDemuxFFmpeg demuxer;
+  ASSERT_LT(0, Open(demuxer, input));
+  EXPECT_TRUE(demuxer.UsedProbeResult());
+  ASSERT_EQ(1, demuxer.GetNrOfStreams());
+  CDemuxStreamVideo *stream = (CDemuxStreamVideo*)demuxer.GetStream(0);
+  ASSERT_TRUE(stream != NULL);
+  EXPECT_EQ(STREAM_VIDEO, stream->type);
+  EXPECT_EQ(TestDVDDemuxProbeCacheWidth, stream->iWidth);
+  EXPECT_EQ(TestDVDDemuxProbeCacheHeight, stream->iHeight);
+  EXPECT_EQ(25, stream->iFpsRate / stream->iFpsScale);
+}
+
+/* time to the first packet of a clip, probing it each time and with the probe result of
+   the first open */
+TEST_F(TestDVDDemuxProbeCache, OpenBenchmark)
+{
+  int64_t probing = 0, cached = 0;
+  for (unsigned int i = 0; i < TestDVDDemuxProbeCacheOpens; i++)
+  {
+    CDVDDemuxProbeCache::Remove(m_path);
+    CDVDInputStreamFile input;
+    CDVDDemuxFFmpeg demuxer;
+    int64_t elapsed = Open(demuxer, input);
+    ASSERT_LT(0, elapsed);
+    probing += elapsed;
+  }
+  for (unsigned int i = 0; i < TestDVDDemuxProbeCacheOpens; i++)
+  {
+    CDVDInputStreamFile input;
+    CDVDDemuxFFmpeg demuxer;
+    int64_t elapsed = Open(demuxer, input);
+    ASSERT_LT(0, elapsed);
+    EXPECT_TRUE(demuxer.UsedProbeResult());
+    cached += elapsed;
+  }
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << "first packet after " << probing / frequency / TestDVDDemuxProbeCacheOpens << " ms probing, " <<
+    cached / frequency / TestDVDDemuxProbeCacheOpens << " ms with the probe result" << std::endl;
+}
@@ -0,0 +1,211 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDClock.h"
+#include "DllAvCodec.h"
+#include "utils/TimeUtils.h"
+
+#include <iostream>
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestDVDDemuxUtilsPackets = 2000;
+static const int TestDVDDemuxUtilsPacketSize = 192 * 1024;
+
+static unsigned int TestDVDDemuxUtilsDestructed = 0;
+
+static void TestDVDDemuxUtilsDestruct(AVPacket *pkt)
+{
+  delete[] pkt->data;
+  pkt->data = NULL;
+  TestDVDDemuxUtilsDestructed++;
+}
+
+/* an ffmpeg packet with a padded payload, owned by the packet unless told otherwise */
+static AVPacket TestDVDDemuxUtilsPacket(int size, bool owned = true)
+{
+  AVPacket pkt;
+  memset(&pkt, 0, sizeof(pkt));
+  pkt.data = new uint8_t[size + FF_INPUT_BUFFER_PADDING_SIZE];
+  memset(pkt.data + size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+  pkt.size = size;
+  if (owned)
+    pkt.destruct = TestDVDDemuxUtilsDestruct;
+  return pkt;
+}
+
+static bool TestDVDDemuxUtilsPadded(const DemuxPacket *pPacket)
+{
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+  {
+    if (pPacket->pData[pPacket->iSize + i])
+      return false;
+  }
+  return true;
+}
+
+TEST(TestDVDDemuxUtils, PooledPayloads)
+{
+  DemuxPacketStats stats;
+  DemuxPacket *pPacket = CDVDDemuxUtils::AllocateDemuxPacket(3000, &stats);
+  ASSERT_TRUE(pPacket != NULL);
+  memset(pPacket->pData, 0xFF, 3000 + FF_INPUT_BUFFER_PADDING_SIZE);
+  unsigned char *payload = pPacket->pData;
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+  // a packet of the same size class gets the payload back, padded for its own size
+  pPacket = CDVDDemuxUtils::AllocateDemuxPacket(2500, &stats);
+  ASSERT_TRUE(pPacket != NULL);
+  EXPECT_EQ(payload, pPacket->pData);
+  pPacket->iSize = 2500;
+  EXPECT_TRUE(TestDVDDemuxUtilsPadded(pPacket));
+  EXPECT_EQ(DVD_NOPTS_VALUE, pPacket->pts);
+  EXPECT_EQ(DVD_NOPTS_VALUE, pPacket->dts);
+  EXPECT_EQ(-1, pPacket->iStreamId);
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+  EXPECT_EQ(2U, stats.allocations);
+  EXPECT_EQ(1U, stats.allocationsAvoided);
+  EXPECT_EQ(0U, stats.bytesCopied);
+
+  // payloads too large for the pool still work
+  pPacket = CDVDDemuxUtils::AllocateDemuxPacket(8 * 1024 * 1024);
+  ASSERT_TRUE(pPacket != NULL);
+  pPacket->iSize = 8 * 1024 * 1024;
+  EXPECT_TRUE(TestDVDDemuxUtilsPadded(pPacket));
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+  pPacket = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  ASSERT_TRUE(pPacket != NULL);
+  EXPECT_TRUE(pPacket->pData == NULL);
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+}
+
+TEST(TestDVDDemuxUtils, ReleasePacketPool)
+{
+  DemuxPacket *pPacket = CDVDDemuxUtils::AllocateDemuxPacket(3000);
+  ASSERT_TRUE(pPacket != NULL);
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+  // once released, nothing is left to reuse
+  DemuxPacketStats stats;
+  CDVDDemuxUtils::ReleasePacketPool();
+  pPacket = CDVDDemuxUtils::AllocateDemuxPacket(3000, &stats);
+  ASSERT_TRUE(pPacket != NULL);
+  pPacket->iSize = 3000;
+  EXPECT_TRUE(TestDVDDemuxUtilsPadded(pPacket));
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+  EXPECT_EQ(1U, stats.allocations);
+  EXPECT_EQ(0U, stats.allocationsAvoided);
+}
+
+TEST(TestDVDDemuxUtils, AdoptedPayloads)
+{
+  DemuxPacketStats stats;
+  AVPacket pkt = TestDVDDemuxUtilsPacket(1000);
+  uint8_t *data = pkt.data;
+  DemuxPacket *pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt, &stats);
+  ASSERT_TRUE(pPacket != NULL);
+  EXPECT_EQ(data, pPacket->pData);
+  EXPECT_EQ(1000, pPacket->iSize);
+  EXPECT_TRUE(pkt.data == NULL);
+  EXPECT_TRUE(pkt.destruct == NULL);
+
+  // the payload is released through the ffmpeg packet once the packet is freed
+  unsigned int destructed = TestDVDDemuxUtilsDestructed;
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+  EXPECT_EQ(destructed + 1, TestDVDDemuxUtilsDestructed);
+  EXPECT_EQ(1U, stats.allocations);
+  EXPECT_EQ(1U, stats.allocationsAvoided);
+  EXPECT_EQ(0U, stats.bytesCopied);
+
+  // the packet is reused without a payload of its own, so nothing is released twice
+  pPacket = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  ASSERT_TRUE(pPacket != NULL);
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+  EXPECT_EQ(destructed + 1, TestDVDDemuxUtilsDestructed);
+}
+
+TEST(TestDVDDemuxUtils, CopiedPayloads)
+{
+  DemuxPacketStats stats;
+  AVPacket pkt = TestDVDDemuxUtilsPacket(1000, false);
+  memset(pkt.data, 0xAB, 1000);
+  DemuxPacket *pPacket = CDVDDemuxUtils::AllocateDemuxPacket(pkt, &stats);
+  ASSERT_TRUE(pPacket != NULL);
+  EXPECT_NE(pkt.data, pPacket->pData);
+  ASSERT_EQ(1000, pPacket->iSize);
+  EXPECT_EQ(0, memcmp(pkt.data, pPacket->pData, 1000));
+  EXPECT_TRUE(TestDVDDemuxUtilsPadded(pPacket));
+  EXPECT_EQ(1000U, stats.bytesCopied);
+  CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+  delete[] pkt.data;
+}
+
+/* time for the demuxer to hand packets the size of high bitrate video frames to a queue of a few
+   seconds, copying every payload as it used to and taking them over from ffmpeg */
+TEST(TestDVDDemuxUtils, PacketBenchmark)
+{
+  std::vector<DemuxPacket*> queue;
+  DemuxPacketStats copied, adopted;
+  int64_t start = CurrentHostCounter();
+  for (unsigned int i = 0; i < TestDVDDemuxUtilsPackets; i++)
+  {
+    AVPacket pkt = TestDVDDemuxUtilsPacket(TestDVDDemuxUtilsPacketSize, false);
+    queue.push_back(CDVDDemuxUtils::AllocateDemuxPacket(pkt, &copied));
+    delete[] pkt.data;
+    if (queue.size() > 100)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(queue.front());
+      queue.erase(queue.begin());
+    }
+  }
+  for (unsigned int i = 0; i < queue.size(); i++)
+    CDVDDemuxUtils::FreeDemuxPacket(queue[i]);
+  queue.clear();
+  int64_t copy = CurrentHostCounter() - start;
+
+  start = CurrentHostCounter();
+  for (unsigned int i = 0; i < TestDVDDemuxUtilsPackets; i++)
+  {
+    AVPacket pkt = TestDVDDemuxUtilsPacket(TestDVDDemuxUtilsPacketSize);
+    queue.push_back(CDVDDemuxUtils::AllocateDemuxPacket(pkt, &adopted));
+    if (queue.size() > 100)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(queue.front());
+      queue.erase(queue.begin());
+    }
+  }
+  for (unsigned int i = 0; i < queue.size(); i++)
+    CDVDDemuxUtils::FreeDemuxPacket(queue[i]);
+  int64_t adopt = CurrentHostCounter() - start;
+
+  EXPECT_EQ((uint64_t)TestDVDDemuxUtilsPackets * TestDVDDemuxUtilsPacketSize, copied.bytesCopied);
+  EXPECT_EQ(0U, adopted.bytesCopied);
+  EXPECT_EQ(TestDVDDemuxUtilsPackets, adopted.allocationsAvoided);
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << TestDVDDemuxUtilsPackets << " packets of " << TestDVDDemuxUtilsPacketSize / 1024 << " KiB: " <<
+    copy / frequency << " ms copied (" << copied.allocationsAvoided << " payloads from the pool), " <<
+    adopt / frequency << " ms taken over" << std::endl;
+}
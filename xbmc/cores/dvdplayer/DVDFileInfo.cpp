@@ -28,6 +28,9 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/URIUtils.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 
 #include "DVDClock.h"
 #include "DVDStreamInfo.h"
@@ -89,6 +92,113 @@ int DegreeToOrientation(int degrees)
   }
 }
 
+/* video bytes read looking for a key frame to decode at reduced resolution */
+#define THUMB_KEYFRAME_BYTES (8 * 1024 * 1024)
+/* video bytes read decoding every frame before giving up */
+#define THUMB_DECODE_BYTES (32 * 1024 * 1024)
+
+/* video bytes all running extractions may read at once, so that the few that decode every frame
+   don't compete with each other for the disk or the network */
+#define THUMB_BYTES_IN_FLIGHT (2 * THUMB_DECODE_BYTES)
+
+/* the bytes of THUMB_BYTES_IN_FLIGHT taken by the extractions decoding at the moment */
+class CThumbByteBudget
+{
+public:
+  CThumbByteBudget() : m_inFlight(0) {}
+
+  /* waits until the bytes fit. An extraction on its own may take more than the budget */
+  void Acquire(int bytes)
+  {
+    CSingleLock lock(m_section);
+    while (m_inFlight > 0 && m_inFlight + bytes > THUMB_BYTES_IN_FLIGHT)
+      m_released.wait(lock);
+    m_inFlight += bytes;
+  }
+
+  void Release(int bytes)
+  {
+    CSingleLock lock(m_section);
+    m_inFlight -= bytes;
+    m_released.notifyAll();
+  }
+
+private:
+  CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_released;
+  int m_inFlight;
+};
+
+static CThumbByteBudget g_thumbByteBudget;
+
+/* opens a software decoder for thumb extraction. A fast decoder only decodes key frames,
+   without the loop filter and at the smallest resolution still wider than a thumb. */
+static CDVDVideoCodec* OpenThumbCodec(CDVDStreamInfo &hint, bool fast)
+{
+  if (fast)
+  {
+    int lowres = 0;
+    while (lowres < 3 && (hint.width >> (lowres + 1)) >= (int)g_advancedSettings.GetThumbSize())
+      lowres++;
+
+    CStdString value;
+    value.Format("%d", lowres);
+    CDVDCodecOptions dvdOptions;
+    dvdOptions.m_keys.push_back(CDVDCodecOption("skip_frame", "nokey"));
+    dvdOptions.m_keys.push_back(CDVDCodecOption("skip_loop_filter", "all"));
+    dvdOptions.m_keys.push_back(CDVDCodecOption("flags", "+low_delay"));
+    dvdOptions.m_keys.push_back(CDVDCodecOption("lowres", value));
+    return CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+  }
+
+  if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
+  {
+    // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
+    CDVDCodecOptions dvdOptions;
+    return CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+  }
+  return CDVDFactoryCodec::CreateVideoCodec(hint);
+}
+
+/* decodes packets of the video stream until a picture comes out, reading at most
+   maxPackets packets or maxBytes bytes of video */
+static bool DecodeThumbPicture(CDVDDemux *pDemuxer, int nVideoStream, CDVDVideoCodec *pVideoCodec,
+                               int maxPackets, int maxBytes, DVDVideoPicture &picture, int &packetsTried)
+{
+  g_thumbByteBudget.Acquire(maxBytes);
+  bool decoded = false;
+  int bytes = 0;
+  for (int packets = 0; packets < maxPackets && bytes < maxBytes && !decoded; packets++)
+  {
+    DemuxPacket* pPacket = pDemuxer->Read();
+    packetsTried++;
+
+    if (!pPacket)
+      break;
+
+    if (pPacket->iStreamId != nVideoStream)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      continue;
+    }
+
+    bytes += pPacket->iSize;
+    int iDecoderState = pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+    if (iDecoderState & VC_ERROR)
+      break;
+
+    if (iDecoderState & VC_PICTURE)
+    {
+      memset(&picture, 0, sizeof(DVDVideoPicture));
+      decoded = pVideoCodec->GetPicture(&picture) && !(picture.iFlags & DVP_FLAG_DROPPED);
+    }
+  }
+  g_thumbByteBudget.Release(maxBytes);
+  return decoded;
+}
+
 bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails)
 {
   unsigned int nTime = XbmcThreads::SystemClockMillis();
@@ -157,111 +267,78 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
   if (nVideoStream != -1)
   {
-    CDVDVideoCodec *pVideoCodec;
-
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
-    {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
-    }
-    else
-    {
-      pVideoCodec = CDVDFactoryCodec::CreateVideoCodec( hint );
-    }
+    int nTotalLen = pDemuxer->GetStreamLength();
+    int nSeekTo = nTotalLen / 3;
+
+    DVDVideoPicture picture;
+    memset(&picture, 0, sizeof(picture));
 
+    // try the first key frame after the seek point at reduced resolution, which is all
+    // a thumb needs, and only decode every frame if none turned up within the budget
+    CDVDVideoCodec *pVideoCodec = OpenThumbCodec(hint, true);
     if (pVideoCodec)
     {
-      int nTotalLen = pDemuxer->GetStreamLength();
-      int nSeekTo = nTotalLen / 3;
-
       CLog::Log(LOGDEBUG,"%s - seeking to pos %dms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, strPath.c_str());
-      if (pDemuxer->SeekTime(nSeekTo, true))
+      if (!pDemuxer->SeekTime(nSeekTo, true) ||
+          !DecodeThumbPicture(pDemuxer, nVideoStream, pVideoCodec, pDemuxer->GetNrOfStreams() * 80, THUMB_KEYFRAME_BYTES, picture, packetsTried))
       {
-        DemuxPacket* pPacket = NULL;
-        int iDecoderState = VC_ERROR;
-        DVDVideoPicture picture;
-
-        memset(&picture, 0, sizeof(picture));
-
-        // num streams * 80 frames, should get a valid frame, if not abort.
-        int abort_index = pDemuxer->GetNrOfStreams() * 80;
-        do
-        {
-          pPacket = pDemuxer->Read();
-          packetsTried++;
-
-          if (!pPacket)
-            break;
-
-          if (pPacket->iStreamId != nVideoStream)
-          {
-            CDVDDemuxUtils::FreeDemuxPacket(pPacket);
-            continue;
-          }
-
-          iDecoderState = pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
-          CDVDDemuxUtils::FreeDemuxPacket(pPacket);
-
-          if (iDecoderState & VC_ERROR)
-            break;
-
-          if (iDecoderState & VC_PICTURE)
-          {
-            memset(&picture, 0, sizeof(DVDVideoPicture));
-            if (pVideoCodec->GetPicture(&picture))
-            {
-              if(!(picture.iFlags & DVP_FLAG_DROPPED))
-                break;
-            }
-          }
-
-        } while (abort_index--);
+        CLog::Log(LOGDEBUG,"%s - no key frame in %s after %d packets, decoding every frame", __FUNCTION__, strPath.c_str(), packetsTried);
+        delete pVideoCodec;
+        pVideoCodec = NULL;
+      }
+    }
 
-        if (iDecoderState & VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
-        {
-          {
-            unsigned int nWidth = g_advancedSettings.GetThumbSize();
-            double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
-            if(hint.forced_aspect && hint.aspect != 0)
-              aspect = hint.aspect;
-            unsigned int nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / aspect);
-
-            DllSwScale dllSwScale;
-            dllSwScale.Load();
-
-            BYTE *pOutBuf = new BYTE[nWidth * nHeight * 4];
-            struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight,
-                  PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-            uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
-            int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
-            uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
-            int     dstStride[] = { nWidth*4, 0, 0, 0 };
-
-            if (context)
-            {
-              int orientation = DegreeToOrientation(hint.orientation);
-              dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
-              dllSwScale.sws_freeContext(context);
-
-              details.width = nWidth;
-              details.height = nHeight;
-              CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
-              bOk = true;
-            }
-
-            dllSwScale.Unload();
-            delete [] pOutBuf;
-          }
-        }
-        else
+    if (!pVideoCodec)
+    {
+      pVideoCodec = OpenThumbCodec(hint, false);
+      if (pVideoCodec)
+      {
+        if (!pDemuxer->SeekTime(nSeekTo, true) ||
+            !DecodeThumbPicture(pDemuxer, nVideoStream, pVideoCodec, pDemuxer->GetNrOfStreams() * 80, THUMB_DECODE_BYTES, picture, packetsTried))
         {
           CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, strPath.c_str(), packetsTried);
+          delete pVideoCodec;
+          pVideoCodec = NULL;
         }
       }
+    }
+
+    if (pVideoCodec)
+    {
+      unsigned int nWidth = g_advancedSettings.GetThumbSize();
+      double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
+      if(hint.forced_aspect && hint.aspect != 0)
+        aspect = hint.aspect;
+      unsigned int nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / aspect);
+
+      DllSwScale dllSwScale;
+      dllSwScale.Load();
+
+      BYTE *pOutBuf = new BYTE[nWidth * nHeight * 4];
+      struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight,
+            PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+      uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
+      int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
+      uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
+      int     dstStride[] = { nWidth*4, 0, 0, 0 };
+
+      if (context)
+      {
+        int orientation = DegreeToOrientation(hint.orientation);
+        dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+        dllSwScale.sws_freeContext(context);
+
+        details.width = nWidth;
+        details.height = nHeight;
+        CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
+        bOk = true;
+      }
+
+      dllSwScale.Unload();
+      delete [] pOutBuf;
       delete pVideoCodec;
     }
   }
@@ -269,6 +346,7 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
   if (pDemuxer)
     delete pDemuxer;
 
+  // the packet pool is shared with playback, which may be going on, so it's left to the player to release
   delete pInputStream;
 
   if(!bOk)
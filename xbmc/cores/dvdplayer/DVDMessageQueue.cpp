@@ -27,6 +27,54 @@
 
 using namespace std;
 
+/* rings start with room for about a second of packets, so they rarely need to grow while playing */
+#define DVDMESSAGERING_CAPACITY 64
+
+CDVDMessageRing::CDVDMessageRing(int priority, unsigned int capacity)
+  : m_priority(priority), m_items(capacity, (CDVDMsg*)NULL), m_front(0), m_size(0)
+{
+}
+
+void CDVDMessageRing::Push(CDVDMsg* msg)
+{
+  if (m_size == m_items.size())
+  {
+    // grow, unwrapping the messages to the start of the new ring
+    vector<CDVDMsg*> items(m_items.size() * 2, (CDVDMsg*)NULL);
+    for (unsigned int i = 0; i < m_size; i++)
+      items[i] = At(i);
+    m_items.swap(items);
+    m_front = 0;
+  }
+  m_items[(m_front + m_size) & (m_items.size() - 1)] = msg;
+  m_size++;
+}
+
+CDVDMsg* CDVDMessageRing::Pop()
+{
+  CDVDMsg* msg = m_items[m_front];
+  m_items[m_front] = NULL;
+  m_front = (m_front + 1) & (m_items.size() - 1);
+  m_size--;
+  return msg;
+}
+
+void CDVDMessageRing::Flush(CDVDMsg::Message type)
+{
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < m_size; i++)
+  {
+    CDVDMsg* msg = At(i);
+    if (type == CDVDMsg::NONE || msg->IsType(type))
+      msg->Release();
+    else
+      m_items[(m_front + kept++) & (m_items.size() - 1)] = msg;
+  }
+  for (unsigned int i = kept; i < m_size; i++)
+    m_items[(m_front + i) & (m_items.size() - 1)] = NULL;
+  m_size = kept;
+}
+
 CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
 {
   m_owner = owner;
@@ -35,17 +83,23 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
   m_bInitialized  = false;
   m_bCaching      = false;
   m_bEmptied      = true;
+  m_bWaiting      = false;
+  m_iPackets      = 0;
 
   m_TimeBack      = DVD_NOPTS_VALUE;
   m_TimeFront     = DVD_NOPTS_VALUE;
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+
+  // packets, and the control messages the players send each other
+  m_rings.push_back(CDVDMessageRing(1, DVDMESSAGERING_CAPACITY));
+  m_rings.push_back(CDVDMessageRing(0, DVDMESSAGERING_CAPACITY * 4));
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
 {
   // remove all remaining messages
-  Flush();
+  Flush(CDVDMsg::NONE);
 }
 
 void CDVDMessageQueue::Init()
@@ -62,17 +116,13 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
   CSingleLock lock(m_section);
 
-  for(SList::iterator it = m_list.begin(); it != m_list.end();)
-  {
-    if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
-      it = m_list.erase(it);
-    else
-      it++;
-  }
+  for (SRings::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+    it->Flush(type);
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
     m_iDataSize = 0;
+    m_iPackets  = 0;
     m_TimeBack  = DVD_NOPTS_VALUE;
     m_TimeFront = DVD_NOPTS_VALUE;
     m_bEmptied = true;
@@ -116,19 +166,18 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
-  {
-    if(priority <= it->priority)
-      break;
+  SRings::iterator it = m_rings.begin();
+  while (it != m_rings.end() && it->GetPriority() > priority)
     it++;
-  }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  if (it == m_rings.end() || it->GetPriority() != priority)
+    it = m_rings.insert(it, CDVDMessageRing(priority, DVDMESSAGERING_CAPACITY));
+  it->Push(pMsg);
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
+  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
   {
+    m_iPackets++;
     DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if(packet)
+    if(packet && priority == 0)
     {
       m_iDataSize += packet->iSize;
       if     (packet->dts != DVD_NOPTS_VALUE)
@@ -140,28 +189,52 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     }
   }
 
-  pMsg->Release();
-
-  m_hEvent.Set(); // inform waiter for new packet
+  if (m_bWaiting)
+    m_hEvent.Set(); // inform waiter for new packet
 
   return MSGQ_OK;
 }
 
-MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+CDVDMsg* CDVDMessageQueue::Pop(CDVDMessageRing &ring)
 {
-  CSingleLock lock(m_section);
-
-  *pMsg = NULL;
+  CDVDMsg* msg = ring.Pop();
+  if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
+  {
+    m_iPackets--;
+    if (ring.GetPriority() == 0)
+    {
+      DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
+      if(packet)
+      {
+        m_iDataSize -= packet->iSize;
+        if     (packet->dts != DVD_NOPTS_VALUE)
+          m_TimeBack = packet->dts;
+        else if(packet->pts != DVD_NOPTS_VALUE)
+          m_TimeBack = packet->pts;
+      }
 
-  int ret = 0;
+      if(m_bEmptied && m_iDataSize > 0)
+        m_bEmptied = false;
+    }
+  }
+  return msg;
+}
 
+/* waits until a message of at least the given priority is at the front of a ring, leaving the
+   lock while waiting */
+MsgQueueReturnCode CDVDMessageQueue::Wait(CSingleLock &lock, unsigned int iTimeoutInMilliSeconds, int priority)
+{
   if (!m_bInitialized)
   {
     CLog::Log(LOGFATAL, "CDVDMessageQueue(%s)::Get MSGQ_NOT_INITIALIZED", m_owner.c_str());
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  bool empty = true;
+  for (SRings::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+    empty &= it->IsEmpty();
+
+  if(empty && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -171,54 +244,72 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    for (SRings::iterator it = m_rings.begin(); it != m_rings.end() && it->GetPriority() >= priority; ++it)
     {
-      DVDMessageListItem& item(m_list.back());
-      priority = item.priority;
+      if (!it->IsEmpty() && !m_bCaching)
+        return MSGQ_OK;
+    }
 
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-
-        if(m_bEmptied && m_iDataSize > 0)
-          m_bEmptied = false;
-      }
+    if (!iTimeoutInMilliSeconds)
+      return MSGQ_TIMEOUT;
 
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
+    m_hEvent.Reset();
+    m_bWaiting = true;
+    lock.Leave();
 
-      ret = MSGQ_OK;
-      break;
-    }
-    else if (!iTimeoutInMilliSeconds)
+    // wait for a new message
+    bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+
+    lock.Enter();
+    m_bWaiting = false;
+    if (!signaled)
+      return MSGQ_TIMEOUT;
+  }
+
+  return MSGQ_ABORT;
+}
+
+MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+{
+  CSingleLock lock(m_section);
+
+  *pMsg = NULL;
+
+  MsgQueueReturnCode ret = Wait(lock, iTimeoutInMilliSeconds, priority);
+  if (ret != MSGQ_OK)
+    return ret;
+
+  for (SRings::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+  {
+    if (!it->IsEmpty())
     {
-      ret = MSGQ_TIMEOUT;
+      priority = it->GetPriority();
+      *pMsg = Pop(*it);
       break;
     }
-    else
-    {
-      m_hEvent.Reset();
-      lock.Leave();
+  }
+  return MSGQ_OK;
+}
+
+MsgQueueReturnCode CDVDMessageQueue::Get(std::vector<CDVDMsg*> &msgs, unsigned int count, unsigned int iTimeoutInMilliSeconds, int &priority)
+{
+  CSingleLock lock(m_section);
 
-      // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+  MsgQueueReturnCode ret = Wait(lock, iTimeoutInMilliSeconds, priority);
+  if (ret != MSGQ_OK)
+    return ret;
 
-      lock.Enter();
+  for (SRings::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+  {
+    if (!it->IsEmpty())
+    {
+      priority = it->GetPriority();
+      for (unsigned int i = 0; i < count && !it->IsEmpty(); i++)
+        msgs.push_back(Pop(*it));
+      break;
     }
   }
-
-  if (m_bAbortRequest) return MSGQ_ABORT;
-
-  return (MsgQueueReturnCode)ret;
+  return MSGQ_OK;
 }
 
 
@@ -229,11 +320,17 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
   if (!m_bInitialized)
     return 0;
 
+  if (type == CDVDMsg::DEMUXER_PACKET)
+    return m_iPackets;
+
   unsigned count = 0;
-  for(SList::iterator it = m_list.begin(); it != m_list.end();it++)
+  for (SRings::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
   {
-    if(it->message->IsType(type))
-      count++;
+    for (unsigned int i = 0; i < it->GetSize(); i++)
+    {
+      if (it->At(i)->IsType(type))
+        count++;
+    }
   }
 
   return count;
@@ -23,6 +23,7 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include <vector>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
@@ -68,6 +69,34 @@ struct DVDMessageListItem
   int      priority;
 };
 
+class CSingleLock;
+
+/// messages of one priority, oldest first, in a ring that grows as needed and never shrinks
+class CDVDMessageRing
+{
+public:
+  CDVDMessageRing(int priority, unsigned int capacity);
+
+  int          GetPriority() const { return m_priority; }
+  bool         IsEmpty() const     { return m_size == 0; }
+  unsigned int GetSize() const     { return m_size; }
+
+  /// appends msg, taking over the reference the caller holds
+  void     Push(CDVDMsg* msg);
+  /// removes the oldest message, handing its reference to the caller
+  CDVDMsg* Pop();
+  CDVDMsg* Peek() const            { return m_items[m_front]; }
+  CDVDMsg* At(unsigned int index) const { return m_items[(m_front + index) & (m_items.size() - 1)]; }
+  /// releases the messages of the given type, or all of them for CDVDMsg::NONE, keeping the order of the others
+  void     Flush(CDVDMsg::Message type);
+
+private:
+  int m_priority;
+  std::vector<CDVDMsg*> m_items; // size is a power of two
+  unsigned int m_front;
+  unsigned int m_size;
+};
+
 enum MsgQueueReturnCode
 {
   MSGQ_OK               = 1,
@@ -105,6 +134,15 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
+  /**
+   * gets several messages of the same priority with a single wakeup, oldest first
+   * msgs,      messages got are appended, the caller releases them
+   * count,     maximum number of messages to get
+   * timeout,   timeout in msec to wait for the first message
+   * priority,  minimum priority to get, outputs returned packets priority
+   */
+  MsgQueueReturnCode Get(std::vector<CDVDMsg*> &msgs, unsigned int count, unsigned int iTimeoutInMilliSeconds, int &priority);
+
   int GetDataSize() const               { return m_iDataSize; }
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
@@ -123,6 +161,8 @@ public:
   bool IsDataBased() const;
 
 private:
+  MsgQueueReturnCode Wait(CSingleLock &lock, unsigned int iTimeoutInMilliSeconds, int priority);
+  CDVDMsg* Pop(CDVDMessageRing &ring);
 
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
@@ -138,9 +178,11 @@ private:
 
   int m_iMaxDataSize;
   bool m_bEmptied;
+  bool m_bWaiting;        // the reader waits for m_hEvent, so writers need to set it
+  unsigned int m_iPackets; // DEMUXER_PACKET messages of any priority
   std::string m_owner;
 
-  typedef std::list<DVDMessageListItem> SList;
-  SList m_list;
+  typedef std::vector<CDVDMessageRing> SRings;
+  SRings m_rings; // highest priority first
 };
 
@@ -421,6 +421,7 @@ CDVDPlayer::CDVDPlayer(IPlayerCallback& callback)
   m_offset_pts = 0.0;
   m_playSpeed = DVD_PLAYSPEED_NORMAL;
   m_caching = CACHESTATE_DONE;
+  m_iOpenTime = 0;
   m_HasVideo = false;
   m_HasAudio = false;
 
@@ -457,6 +458,7 @@ bool CDVDPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
     m_State.Clear();
     m_UpdateApplication = 0;
     m_offset_pts = 0;
+    m_iOpenTime = XbmcThreads::SystemClockMillis();
 
     m_PlayerOptions = options;
     m_item     = file;
@@ -1427,6 +1429,13 @@ bool CDVDPlayer::GetCachingTimes(double& level, double& delay, double& offset)
     return false;
 
   double play_sbp  = DVD_MSEC_TO_TIME(m_pDemuxer->GetStreamLength()) / length;
+
+  // without a known duration, go by the rate the cache is being consumed at
+  if (play_sbp <= 0.0 && status.readrate > 0)
+    play_sbp = (double)DVD_TIME_BASE / status.readrate;
+  if (play_sbp <= 0.0)
+    return false;
+
   double queued = 1000.0 * GetQueueTime() / play_sbp;
 
   delay  = 0.0;
@@ -1973,6 +1982,8 @@ void CDVDPlayer::OnExit()
 
     m_messenger.End();
 
+    // the packets pooled while playing are only of use to the next file
+    CDVDDemuxUtils::ReleasePacketPool();
   }
   catch (...)
   {
@@ -2287,6 +2298,11 @@ void CDVDPlayer::HandleMessages()
         if(player == DVDPLAYER_VIDEO)
           m_CurrentVideo.started = true;
         CLog::Log(LOGDEBUG, "CDVDPlayer::HandleMessages - player started %d", player);
+        if(player == DVDPLAYER_VIDEO && m_iOpenTime)
+        {
+          CLog::Log(LOGDEBUG, "CDVDPlayer::HandleMessages - first frame %u ms after opening %s", XbmcThreads::SystemClockMillis() - m_iOpenTime, m_filename.c_str());
+          m_iOpenTime = 0;
+        }
       }
     }
     catch (...)
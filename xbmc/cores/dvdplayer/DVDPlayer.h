@@ -347,6 +347,7 @@ protected:
   ECacheState  m_caching;
   CFileItem    m_item;
   unsigned int m_iChannelEntryTimeOut;
+  unsigned int m_iOpenTime; // when the file was opened, until its first video frame is shown
 
 
   CCurrentStream m_CurrentAudio;
@@ -136,6 +136,7 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
   m_bRenderSubs = false;
   m_stalled = false;
   m_started = false;
+  m_decoderFill.Reset();
   m_iVideoDelay = 0;
   m_iSubtitleDelay = 0;
   m_FlipTimeStamp = 0.0;
@@ -276,6 +277,7 @@ void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
   StopThread(); // will set this->m_bStop to true
 
   m_messageQueue.End();
+  m_decoderFill.Reset();
 
   CLog::Log(LOGNOTICE, "deleting video codec");
   if (m_pVideoCodec)
@@ -298,6 +300,7 @@ void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
 void CDVDPlayerVideo::OnStartup()
 {
   m_iDroppedFrames = 0;
+  m_decoderFill.Reset();
 
   m_crop.x1 = m_crop.x2 = 0.0f;
   m_crop.y1 = m_crop.y2 = 0.0f;
@@ -435,6 +438,7 @@ void CDVDPlayerVideo::Process()
         m_pVideoCodec->Reset();
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
       m_packets.clear();
+      m_decoderFill.Reset();
       m_started = false;
     }
     else if (pMsg->IsType(CDVDMsg::GENERAL_FLUSH)) // private message sent by (CDVDPlayerVideo::Flush())
@@ -443,6 +447,7 @@ void CDVDPlayerVideo::Process()
         m_pVideoCodec->Reset();
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
       m_packets.clear();
+      m_decoderFill.Reset();
 
       m_pullupCorrection.Flush();
       //we need to recalculate the framerate
@@ -479,6 +484,15 @@ void CDVDPlayerVideo::Process()
       OpenStream(msg->m_hints, msg->m_codec);
       msg->m_codec = NULL;
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
+      m_decoderFill.Reset();
+    }
+    else if (pMsg->IsType(CDVDMsg::GENERAL_EOF))
+    {
+      // a frame threaded decoder still holds the last pictures of the stream,
+      // empty packets get them out the same way as any other picture. HasData()
+      // counts them until they are decoded, so the player doesn't end first
+      CLog::Log(LOGDEBUG, "CDVDPlayerVideo - CDVDMsg::GENERAL_EOF, draining %u pictures", m_decoderFill.GetFill());
+      m_decoderFill.Drain(m_messageQueue);
     }
 
     if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
@@ -545,6 +559,9 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
+      // the first packets after a reset give no picture from a decoder with a delay
+      bool bDecoderFull = m_decoderFill.Add(pPacket, m_pVideoCodec->GetDelay());
+
       int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
 
       // buffer packets so we can recover should decoder flush for some reason
@@ -561,10 +578,15 @@ void CDVDPlayerVideo::Process()
       // picture from a demux packet, this should be reasonable
       // for libavformat as a demuxer as it normally packetizes
       // pictures when they come from demuxer
-      if(bRequestDrop && !bPacketDrop && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE))
+      if(bRequestDrop && !bPacketDrop && bDecoderFull && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE))
       {
         m_iDroppedFrames++;
         iDropped++;
+
+        // with a delay, the gap a dropped picture leaves in the timestamps comes
+        // after the pullup correction was flushed for the drop request
+        if(m_pVideoCodec->GetDelay() > 0)
+          m_pullupCorrection.Flush();
       }
 
       // loop while no error
@@ -588,6 +610,7 @@ void CDVDPlayerVideo::Process()
 
           m_pVideoCodec->Reset();
           m_packets.clear();
+          m_decoderFill.Reset();
           break;
         }
 
@@ -732,6 +755,7 @@ void CDVDPlayerVideo::Process()
           {
             CLog::Log(LOGWARNING, "Decoder Error getting videoPicture.");
             m_pVideoCodec->Reset();
+            m_decoderFill.Reset();
           }
         }
 
@@ -1266,7 +1290,8 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
 
       //if we requested 5 drops in a row and we're still late, drop on output
       //this keeps a/v sync if the decoder can't drop, or we're still calculating the framerate
-      if (m_iDroppedRequest > 5)
+      //a decoder with a delay only drops pictures that many requests later
+      if (m_iDroppedRequest > 5 + (int)m_pVideoCodec->GetDelay())
       {
         m_iDroppedRequest--; //decrease so we only drop half the frames
         return result | EOS_DROPPED;
@@ -26,6 +26,7 @@
 #include "DVDCodecs/Video/DVDVideoCodec.h"
 #include "DVDClock.h"
 #include "DVDOverlayContainer.h"
+#include "DVDStreamInfo.h"
 #include "DVDTSCorrection.h"
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
@@ -37,6 +38,55 @@ class CDVDOverlayCodecCC;
 
 #define VIDEO_PICTURE_QUEUE_SIZE 1
 
+/*!
+ \brief Counts the packets a decoder with a delay holds back
+ A frame threaded decoder gives the picture of a packet only after as many more
+ packets as its delay, so at the end of the stream that many empty packets get
+ the last pictures out of it.
+ */
+class CDVDDecoderFill
+{
+public:
+  CDVDDecoderFill() : m_fill(0) {}
+
+  void Reset() { m_fill = 0; }
+
+  /*!
+   \brief Count a packet about to be given to the decoder
+   \param packet the packet, empty when draining the decoder.
+   \param delay the delay of the decoder.
+   \return true if the decoder already holds as many packets as its delay, so gives a picture for this one.
+   */
+  bool Add(const DemuxPacket *packet, unsigned int delay)
+  {
+    bool full = m_fill >= delay;
+    if(!full && packet->pData)
+      m_fill++;
+    else if(!packet->pData && m_fill > 0)
+      m_fill--;
+    return full;
+  }
+
+  /*!
+   \brief Queue an empty packet for each picture the decoder still holds
+   \param queue the queue the decoder is fed from.
+   */
+  void Drain(CDVDMessageQueue &queue) const
+  {
+    for(unsigned int i = 0; i < m_fill; i++)
+    {
+      DemuxPacket* pPacket = CDVDDemuxUtils::AllocateDemuxPacket(0);
+      if(pPacket)
+        queue.Put(new CDVDMsgDemuxerPacket(pPacket));
+    }
+  }
+
+  unsigned int GetFill() const { return m_fill; }
+
+private:
+  unsigned int m_fill; // packets given to the decoder since its reset, up to its delay
+};
+
 class CDVDPlayerVideo : public CThread
 {
 public:
@@ -56,7 +106,7 @@ public:
   // just waiting for packetqueue should be enough for video
   void WaitForBuffers()                             { m_messageQueue.WaitUntilEmpty(); }
   bool AcceptsData() const                          { return !m_messageQueue.IsFull(); }
-  bool HasData() const                              { return m_messageQueue.GetDataSize() > 0; }
+  bool HasData() const                              { return m_messageQueue.GetDataSize() > 0 || m_decoderFill.GetFill() > 0; }
   int  GetLevel();
   bool IsInited() const                             { return m_messageQueue.IsInited(); }
   void SendMessage(CDVDMsg* pMsg, int priority = 0) { m_messageQueue.Put(pMsg, priority); }
@@ -176,6 +226,7 @@ protected:
 
   bool m_stalled;
   bool m_started;
+  CDVDDecoderFill m_decoderFill;
   std::string m_codecname;
 
   /* autosync decides on how much of clock we should use when deciding sleep time */
@@ -0,0 +1,153 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDFileInfo.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Profile.h"
+#include "settings/Settings.h"
+#include "test/TestUtils.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobGroup.h"
+#include "utils/JobManager.h"
+#include "utils/StdString.h"
+#include "utils/StreamDetails.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestDVDFileInfoClips = 12;
+static const unsigned int TestDVDFileInfoFrames = 25;
+
+/* extracts the thumb and stream details of a clip, as CThumbExtractor does */
+class TestDVDFileInfoJob : public CJob
+{
+public:
+  TestDVDFileInfoJob(const CStdString &path, const CStdString &thumb) : m_path(path), m_thumb(thumb) {}
+  virtual bool DoWork()
+  {
+    CTextureDetails details;
+    details.file = m_thumb;
+    CStreamDetails streamDetails;
+    return CDVDFileInfo::ExtractThumb(m_path, details, &streamDetails) &&
+           streamDetails.GetStreamCount(CStreamDetail::VIDEO) == 1;
+  }
+private:
+  CStdString m_path;
+  CStdString m_thumb;
+};
+
+/* writes clips of moving gradients in a few sizes */
+class TestDVDFileInfo : public testing::Test
+{
+protected:
+  TestDVDFileInfo()
+  {
+    // thumbs are cached below the profile's folder
+    m_addedProfile = !g_settings.GetNumProfiles();
+    if (m_addedProfile)
+      g_settings.AddProfile(CProfile("special://temp/"));
+    XFILE::CDirectory::Create(g_settings.GetThumbnailsFolder());
+
+    const int sizes[][2] = { { 320, 240 }, { 480, 272 }, { 640, 360 } };
+    for (unsigned int i = 0; i < TestDVDFileInfoClips; i++)
+    {
+      XFILE::CFile *file = XBMC_CREATEYUV4MPEGFILE(sizes[i % 3][0], sizes[i % 3][1],
+                                                   TestDVDFileInfoFrames, i);
+      if (!file)
+        continue;
+      m_paths.push_back(XBMC_TEMPFILEPATH(file));
+      m_files.push_back(file);
+    }
+  }
+
+  ~TestDVDFileInfo()
+  {
+    for (unsigned int i = 0; i < m_files.size(); i++)
+      XBMC_DELETETEMPFILE(m_files[i]);
+    for (unsigned int i = 0; i < m_paths.size(); i++)
+      XFILE::CFile::Delete(CTextureCache::GetCachedPath(Thumb(i)));
+    if (m_addedProfile)
+      g_settings.RemoveProfile(0);
+  }
+
+  CStdString Thumb(unsigned int clip) const
+  {
+    return StringUtils::Format("testdvdfileinfo%u.jpg", clip);
+  }
+
+  std::vector<XFILE::CFile*> m_files;
+  std::vector<CStdString> m_paths;
+  bool m_addedProfile;
+};
+
+TEST_F(TestDVDFileInfo, ExtractThumb)
+{
+  ASSERT_EQ(TestDVDFileInfoClips, m_paths.size());
+
+  CTextureDetails details;
+  details.file = Thumb(1);
+  CStreamDetails streamDetails;
+  ASSERT_TRUE(CDVDFileInfo::ExtractThumb(m_paths[1], details, &streamDetails));
+  EXPECT_EQ(g_advancedSettings.GetThumbSize(), details.width);
+  EXPECT_NEAR(g_advancedSettings.GetThumbSize() * 272.0 / 480.0, details.height, 1.0);
+  EXPECT_TRUE(XFILE::CFile::Exists(CTextureCache::GetCachedPath(details.file)));
+
+  // stream details come from the same probe
+  EXPECT_EQ(1, streamDetails.GetStreamCount(CStreamDetail::VIDEO));
+  EXPECT_EQ(480, streamDetails.GetVideoWidth());
+  EXPECT_EQ(272, streamDetails.GetVideoHeight());
+}
+
+/* time taken extracting thumbs and stream details of every clip one by one, as the thumb
+   loader used to, and a few files at once */
+TEST_F(TestDVDFileInfo, ExtractBenchmark)
+{
+  ASSERT_EQ(TestDVDFileInfoClips, m_paths.size());
+
+  int64_t start = CurrentHostCounter();
+  for (unsigned int i = 0; i < m_paths.size(); i++)
+  {
+    TestDVDFileInfoJob job(m_paths[i], Thumb(i));
+    EXPECT_TRUE(job.DoWork()) << m_paths[i];
+  }
+  int64_t serial = CurrentHostCounter() - start;
+
+  unsigned int jobs = std::max(2, std::min(4, g_cpuInfo.getCPUCount()));
+  start = CurrentHostCounter();
+  CJobGroup group(NULL, jobs);
+  for (unsigned int i = 0; i < m_paths.size(); i++)
+    group.AddJob(new TestDVDFileInfoJob(m_paths[i], Thumb(i)));
+  group.Close();
+  ASSERT_TRUE(group.Wait(60000));
+  int64_t concurrent = CurrentHostCounter() - start;
+  EXPECT_EQ(m_paths.size(), group.GetSucceeded());
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << m_paths.size() << " clips: " << serial / frequency << " ms one by one, " <<
+    concurrent / frequency << " ms " << jobs << " at once" << std::endl;
+}
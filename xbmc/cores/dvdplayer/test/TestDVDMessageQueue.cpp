@@ -0,0 +1,320 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "DVDClock.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestDVDMessageQueueMessages = 200000;
+static const unsigned int TestDVDMessageQueueWakeups = 200;
+
+static CDVDMsg *TestDVDMessageQueuePacket(int size, double dts)
+{
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->dts = dts;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+static double TestDVDMessageQueueDts(CDVDMsg *msg)
+{
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->dts;
+}
+
+/* the queue as it was before messages were kept in rings: a sorted list with a node per message,
+   waking the reader on every message */
+class TestDVDMessageQueueList
+{
+public:
+  TestDVDMessageQueueList() : m_event(true) {}
+  ~TestDVDMessageQueueList()
+  {
+    for (std::list<DVDMessageListItem>::iterator it = m_list.begin(); it != m_list.end(); ++it)
+      it->message->Release();
+  }
+
+  void Put(CDVDMsg *msg, int priority = 0)
+  {
+    CSingleLock lock(m_section);
+    std::list<DVDMessageListItem>::iterator it = m_list.begin();
+    while (it != m_list.end() && priority > it->priority)
+      it++;
+    m_list.insert(it, DVDMessageListItem(msg, priority));
+    msg->Release();
+    m_event.Set();
+  }
+
+  MsgQueueReturnCode Get(CDVDMsg **msg, unsigned int timeout, int &priority)
+  {
+    CSingleLock lock(m_section);
+    while (true)
+    {
+      if (!m_list.empty() && m_list.back().priority >= priority)
+      {
+        priority = m_list.back().priority;
+        *msg = m_list.back().message->Acquire();
+        m_list.pop_back();
+        return MSGQ_OK;
+      }
+      m_event.Reset();
+      lock.Leave();
+      if (!m_event.WaitMSec(timeout))
+        return MSGQ_TIMEOUT;
+      lock.Enter();
+    }
+  }
+
+private:
+  CEvent m_event;
+  CCriticalSection m_section;
+  std::list<DVDMessageListItem> m_list;
+};
+
+/* a demuxer putting packets, and for the wakeup latency one packet at a time with a pause before
+   each, noting when it was put */
+template<class Queue> class TestDVDMessageQueueWriter : public CThread
+{
+public:
+  TestDVDMessageQueueWriter(Queue &queue, unsigned int count, bool paused)
+    : CThread("TestDVDMessageQueueWriter"), m_queue(queue), m_count(count), m_paused(paused), m_put(0) {}
+
+  volatile int64_t m_put;
+
+protected:
+  virtual void Process()
+  {
+    for (unsigned int i = 0; i < m_count && !m_bStop; i++)
+    {
+      CDVDMsg *msg = TestDVDMessageQueuePacket(64, i);
+      if (m_paused)
+      {
+        XbmcThreads::ThreadSleep(1);
+        m_put = CurrentHostCounter();
+      }
+      m_queue.Put(msg, 0);
+    }
+  }
+
+  Queue &m_queue;
+  unsigned int m_count;
+  bool m_paused;
+};
+
+template<class Queue> static bool TestDVDMessageQueueRead(Queue &queue, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    CDVDMsg *msg;
+    int priority = 0;
+    if (queue.Get(&msg, 5000, priority) != MSGQ_OK || TestDVDMessageQueueDts(msg) != i)
+      return false;
+    msg->Release();
+  }
+  return true;
+}
+
+template<class Queue> static bool TestDVDMessageQueueRead(Queue &queue, unsigned int count, unsigned int batch)
+{
+  return TestDVDMessageQueueRead(queue, count);
+}
+
+static bool TestDVDMessageQueueRead(CDVDMessageQueue &queue, unsigned int count, unsigned int batch)
+{
+  if (batch <= 1)
+    return TestDVDMessageQueueRead(queue, count);
+
+  std::vector<CDVDMsg*> msgs;
+  for (unsigned int i = 0; i < count; )
+  {
+    int priority = 0;
+    msgs.clear();
+    if (queue.Get(msgs, batch, 5000, priority) != MSGQ_OK)
+      return false;
+    for (unsigned int j = 0; j < msgs.size(); j++, i++)
+    {
+      if (TestDVDMessageQueueDts(msgs[j]) != i)
+        return false;
+      msgs[j]->Release();
+    }
+  }
+  return true;
+}
+
+/* time to pass packets from one thread to another, and from putting a packet to the waiting reader
+   getting it, in microseconds */
+template<class Queue> static void TestDVDMessageQueueMeasure(Queue &queue, unsigned int batch, double &throughput, double &latency)
+{
+  double frequency = CurrentHostFrequency() / 1000000.0;
+  TestDVDMessageQueueWriter<Queue> writer(queue, TestDVDMessageQueueMessages, false);
+  int64_t start = CurrentHostCounter();
+  writer.Create();
+  EXPECT_TRUE(TestDVDMessageQueueRead(queue, TestDVDMessageQueueMessages, batch));
+  throughput = TestDVDMessageQueueMessages / ((CurrentHostCounter() - start) / frequency);
+  writer.StopThread();
+
+  TestDVDMessageQueueWriter<Queue> paused(queue, TestDVDMessageQueueWakeups, true);
+  paused.Create();
+  int64_t total = 0;
+  for (unsigned int i = 0; i < TestDVDMessageQueueWakeups; i++)
+  {
+    CDVDMsg *msg;
+    int priority = 0;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 5000, priority));
+    total += CurrentHostCounter() - paused.m_put;
+    msg->Release();
+  }
+  latency = total / frequency / TestDVDMessageQueueWakeups;
+  paused.StopThread();
+}
+
+TEST(TestDVDMessageQueue, Priorities)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  queue.Put(TestDVDMessageQueuePacket(100, 1));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+  queue.Put(TestDVDMessageQueuePacket(100, 2));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC), 10);
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESET), 1);
+  EXPECT_EQ(2U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(200, queue.GetDataSize());
+
+  // highest priority first, in the order they were put within a priority
+  CDVDMsg::Message expected[] = { CDVDMsg::GENERAL_RESYNC, CDVDMsg::GENERAL_FLUSH, CDVDMsg::GENERAL_RESET };
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    CDVDMsg *msg;
+    int priority = 1;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+    EXPECT_TRUE(msg->IsType(expected[i]));
+    EXPECT_EQ(i == 0 ? 10 : 1, priority);
+    msg->Release();
+  }
+
+  // packets aren't got when asking for control messages only
+  CDVDMsg *msg;
+  int priority = 1;
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_EQ(1, TestDVDMessageQueueDts(msg));
+  msg->Release();
+  EXPECT_EQ(1U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(100, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Batches)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  for (unsigned int i = 0; i < 10; i++)
+    queue.Put(TestDVDMessageQueuePacket(100, i));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+
+  // a batch doesn't mix priorities
+  std::vector<CDVDMsg*> msgs;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(msgs, 4, 0, priority));
+  ASSERT_EQ(1U, msgs.size());
+  EXPECT_EQ(1, priority);
+  msgs[0]->Release();
+
+  msgs.clear();
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(msgs, 4, 0, priority));
+  ASSERT_EQ(4U, msgs.size());
+  for (unsigned int i = 0; i < msgs.size(); i++)
+  {
+    EXPECT_EQ(i, TestDVDMessageQueueDts(msgs[i]));
+    msgs[i]->Release();
+  }
+  EXPECT_EQ(6U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(600, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  // more than fit the preallocated ring, so it has to grow with messages wrapped around its end
+  for (unsigned int i = 0; i < 100; i++)
+  {
+    CDVDMsg *msg;
+    queue.Put(TestDVDMessageQueuePacket(10, i));
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    msg->Release();
+  }
+  for (unsigned int i = 0; i < 1000; i++)
+  {
+    queue.Put(TestDVDMessageQueuePacket(10, i));
+    if (i % 100 == 0)
+      queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  }
+  EXPECT_EQ(10U, queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+
+  queue.Flush(CDVDMsg::GENERAL_RESYNC);
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(1000U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  for (unsigned int i = 0; i < 1000; i++)
+  {
+    CDVDMsg *msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    ASSERT_EQ(i, TestDVDMessageQueueDts(msg));
+    msg->Release();
+  }
+
+  queue.Put(TestDVDMessageQueuePacket(10, 0));
+  queue.Flush();
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+/* packets per millisecond from a demuxer thread to a player thread, and how long the player waits
+   to get a packet put while it was waiting, with the list the queue used to be and the rings */
+TEST(TestDVDMessageQueue, Benchmark)
+{
+  double listThroughput, listLatency, ringThroughput, ringLatency, batchThroughput, batchLatency;
+  TestDVDMessageQueueList list;
+  TestDVDMessageQueueMeasure(list, 1, listThroughput, listLatency);
+
+  CDVDMessageQueue rings("test");
+  rings.Init();
+  TestDVDMessageQueueMeasure(rings, 1, ringThroughput, ringLatency);
+  TestDVDMessageQueueMeasure(rings, 16, batchThroughput, batchLatency);
+  rings.End();
+
+  std::cout << "list: " << listThroughput * 1000 << " packets/ms, " << listLatency << " us wakeup" << std::endl;
+  std::cout << "rings: " << ringThroughput * 1000 << " packets/ms, " << ringLatency << " us wakeup" << std::endl;
+  std::cout << "rings, batches of 16: " << batchThroughput * 1000 << " packets/ms, " << batchLatency << " us wakeup" << std::endl;
+}
@@ -0,0 +1,350 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDCodecs/DVDCodecs.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStreamFile.h"
+#include "cores/dvdplayer/DVDPlayerVideo.h"
+#include "cores/dvdplayer/DVDStreamInfo.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/GUISettings.h"
+#include "test/TestUtils.h"
+#include "utils/CPUInfo.h"
+#include "utils/TimeUtils.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const int TestDVDVideoCodecFFmpegWidth = 640;
+static const int TestDVDVideoCodecFFmpegHeight = 360;
+static const unsigned int TestDVDVideoCodecFFmpegFrames = 100;
+
+/* decodes the sample files given with --add-testvideocodec-file(s), or when there are none a
+   clip of moving gradients. That clip decodes as rawvideo, which has no frame threads */
+class TestDVDVideoCodecFFmpeg : public testing::Test
+{
+protected:
+  TestDVDVideoCodecFFmpeg()
+  {
+    m_decodeThreads = g_advancedSettings.m_videoDecodeThreads;
+    m_frameThreading = g_advancedSettings.m_videoFrameThreading;
+
+    // frame threading is only used when no hardware decoder may be opened
+#ifdef HAVE_LIBVDPAU
+    m_useVdpau = g_guiSettings.GetBool("videoplayer.usevdpau");
+    g_guiSettings.SetBool("videoplayer.usevdpau", false);
+#endif
+#ifdef HAS_DX
+    m_useDxva2 = g_guiSettings.GetBool("videoplayer.usedxva2");
+    g_guiSettings.SetBool("videoplayer.usedxva2", false);
+#endif
+#ifdef HAVE_LIBVA
+    m_useVaapi = g_guiSettings.GetBool("videoplayer.usevaapi");
+    g_guiSettings.SetBool("videoplayer.usevaapi", false);
+#endif
+
+    m_file = NULL;
+    m_paths = CXBMCTestUtils::Instance().getTestVideoCodecFiles();
+    m_samples = !m_paths.empty();
+    if (m_samples)
+      return;
+
+    m_file = XBMC_CREATEYUV4MPEGFILE(TestDVDVideoCodecFFmpegWidth, TestDVDVideoCodecFFmpegHeight,
+                                     TestDVDVideoCodecFFmpegFrames, 0);
+    if (m_file)
+      m_paths.push_back(XBMC_TEMPFILEPATH(m_file));
+  }
+
+  ~TestDVDVideoCodecFFmpeg()
+  {
+    g_advancedSettings.m_videoDecodeThreads = m_decodeThreads;
+    g_advancedSettings.m_videoFrameThreading = m_frameThreading;
+#ifdef HAVE_LIBVDPAU
+    g_guiSettings.SetBool("videoplayer.usevdpau", m_useVdpau);
+#endif
+#ifdef HAS_DX
+    g_guiSettings.SetBool("videoplayer.usedxva2", m_useDxva2);
+#endif
+#ifdef HAVE_LIBVA
+    g_guiSettings.SetBool("videoplayer.usevaapi", m_useVaapi);
+#endif
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  /* decodes the first video stream of a file, as CDVDPlayerVideo does but without output, and
+     returns the number of pictures and the timestamps they came out with */
+  int Decode(const CStdString &path, int threads, bool frameThreading,
+             std::vector<double> &dts, std::vector<double> &pts, unsigned int &delay)
+  {
+    g_advancedSettings.m_videoDecodeThreads = threads;
+    g_advancedSettings.m_videoFrameThreading = frameThreading;
+    dts.clear();
+    pts.clear();
+    delay = 0;
+
+    CDVDInputStreamFile input;
+    CDVDDemuxFFmpeg demuxer;
+    if (!input.Open(path.c_str(), "") || !demuxer.Open(&input))
+      return -1;
+
+    int stream = -1;
+    for (int i = 0; i < demuxer.GetNrOfStreams() && stream < 0; i++)
+    {
+      if (demuxer.GetStream(i)->type == STREAM_VIDEO)
+        stream = i;
+    }
+    if (stream < 0)
+      return -1;
+
+    CDVDStreamInfo hints(*demuxer.GetStream(stream), true);
+    CDVDCodecOptions options;
+    options.m_formats.push_back(RENDER_FMT_YUV420P);
+    CDVDVideoCodecFFmpeg codec;
+    if (!codec.Open(hints, options))
+      return -1;
+    delay = codec.GetDelay();
+
+    DVDVideoPicture picture;
+    DemuxPacket *packet;
+    while ((packet = demuxer.Read()))
+    {
+      if (packet->iStreamId == stream)
+      {
+        int state = codec.Decode(packet->pData, packet->iSize, packet->dts, packet->pts);
+        if ((state & VC_PICTURE) && codec.GetPicture(&picture))
+        {
+          dts.push_back(picture.dts);
+          pts.push_back(picture.pts);
+        }
+      }
+      CDVDDemuxUtils::FreeDemuxPacket(packet);
+    }
+
+    // get the pictures frame threads still hold, as CDVDPlayerVideo does at the end of the stream
+    for (unsigned int i = 0; i < delay; i++)
+    {
+      int state = codec.Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+      if ((state & VC_PICTURE) && codec.GetPicture(&picture))
+      {
+        dts.push_back(picture.dts);
+        pts.push_back(picture.pts);
+      }
+    }
+    codec.Dispose();
+    return (int)pts.size();
+  }
+
+  XFILE::CFile *m_file;
+  std::vector<CStdString> m_paths;
+  bool m_samples;
+  int m_decodeThreads;
+  bool m_frameThreading;
+#ifdef HAVE_LIBVDPAU
+  bool m_useVdpau;
+#endif
+#ifdef HAS_DX
+  bool m_useDxva2;
+#endif
+#ifdef HAVE_LIBVA
+  bool m_useVaapi;
+#endif
+};
+
+TEST_F(TestDVDVideoCodecFFmpeg, FrameThreading)
+{
+  // the generated clip never takes the frame threaded path, so there is nothing to compare
+  if (!m_samples)
+  {
+    RecordProperty("skipped", "no sample files given");
+    std::cout << "[  SKIPPED ] no sample files given with --add-testvideocodec-file(s)" << std::endl;
+    return;
+  }
+
+  int threads = std::max(2, std::min(8, g_cpuInfo.getCPUCount()));
+  for (unsigned int i = 0; i < m_paths.size(); i++)
+  {
+    std::vector<double> dts, pts, threadedDts, threadedPts;
+    unsigned int delay = 0;
+    int pictures = Decode(m_paths[i], 1, false, dts, pts, delay);
+    ASSERT_LT(0, pictures) << m_paths[i];
+    EXPECT_EQ(0U, delay);
+
+    // the delay is made up for at the end, and pictures come with the timestamps of their packets
+    EXPECT_EQ(pictures, Decode(m_paths[i], threads, true, threadedDts, threadedPts, delay)) << m_paths[i];
+    EXPECT_TRUE(delay == 0 || delay == (unsigned int)threads - 1);
+    EXPECT_TRUE(dts == threadedDts) << m_paths[i];
+    EXPECT_TRUE(pts == threadedPts) << m_paths[i];
+  }
+}
+
+/* pictures decoded per second with slice and with frame threading, for a few thread counts */
+TEST_F(TestDVDVideoCodecFFmpeg, DecodeBenchmark)
+{
+  ASSERT_FALSE(m_paths.empty());
+
+  double frequency = (double)CurrentHostFrequency();
+  for (unsigned int i = 0; i < m_paths.size(); i++)
+  {
+    std::cout << m_paths[i] << std::endl;
+    for (int threads = 1; threads <= std::max(2, std::min(8, g_cpuInfo.getCPUCount())); threads *= 2)
+    {
+      std::vector<double> dts, pts;
+      unsigned int delay = 0;
+      std::cout << "  " << threads << " threads:";
+      for (int frameThreading = 0; frameThreading < 2; frameThreading++)
+      {
+        int64_t start = CurrentHostCounter();
+        int pictures = Decode(m_paths[i], threads, frameThreading != 0, dts, pts, delay);
+        int64_t elapsed = CurrentHostCounter() - start;
+        ASSERT_LT(0, pictures) << m_paths[i];
+        std::cout << (frameThreading ? ", frame " : " slice ") << pictures * frequency / elapsed << " fps";
+        if (frameThreading)
+          std::cout << " (delay " << delay << ")";
+      }
+      std::cout << std::endl;
+    }
+  }
+}
+
+/* a decoder that gives the picture of a packet only after as many more packets as its
+   delay, as frame threads do */
+class TestDVDVideoCodecDelayed : public CDVDVideoCodec
+{
+public:
+  TestDVDVideoCodecDelayed(unsigned int delay) : m_delay(delay), m_pts(DVD_NOPTS_VALUE) {}
+
+  virtual bool Open(CDVDStreamInfo &hints, CDVDCodecOptions &options) { return true; }
+  virtual void Dispose() { Reset(); }
+  virtual int Decode(BYTE* pData, int iSize, double dts, double pts)
+  {
+    if (pData)
+      m_held.push_back(pts);
+    if (m_held.empty() || (pData && m_held.size() <= m_delay))
+      return VC_BUFFER;
+    m_pts = m_held.front();
+    m_held.pop_front();
+    return VC_PICTURE | VC_BUFFER;
+  }
+  virtual void Reset() { m_held.clear(); }
+  virtual bool GetPicture(DVDVideoPicture* pDvdVideoPicture)
+  {
+    memset(pDvdVideoPicture, 0, sizeof(DVDVideoPicture));
+    pDvdVideoPicture->pts = m_pts;
+    return true;
+  }
+  virtual void SetDropState(bool bDrop) {}
+  virtual const char* GetName() { return "delayed"; }
+  virtual unsigned GetDelay() { return m_delay; }
+
+private:
+  unsigned int m_delay;
+  double m_pts;
+  std::deque<double> m_held;
+};
+
+/* feeds the decoder the packets of a queue as CDVDPlayerVideo does, returning the
+   number of packets that came while the decoder was full */
+static unsigned int TestDVDDecoderFillDecode(CDVDMessageQueue &queue, CDVDDecoderFill &fill,
+                                             CDVDVideoCodec &codec, std::vector<double> &pts)
+{
+  unsigned int full = 0;
+  CDVDMsg *msg;
+  int priority = 0;
+  while (queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET) > 0 && queue.Get(&msg, 0, priority) == MSGQ_OK)
+  {
+    DemuxPacket *packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
+    if (fill.Add(packet, codec.GetDelay()))
+      full++;
+
+    DVDVideoPicture picture;
+    int state = codec.Decode(packet->pData, packet->iSize, packet->dts, packet->pts);
+    if ((state & VC_PICTURE) && codec.GetPicture(&picture))
+      pts.push_back(picture.pts);
+    msg->Release();
+  }
+  return full;
+}
+
+static void TestDVDDecoderFillPut(CDVDMessageQueue &queue, int first, int count)
+{
+  for (int i = first; i < first + count; i++)
+  {
+    DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(1);
+    packet->iSize = 1;
+    packet->dts = packet->pts = i;
+    queue.Put(new CDVDMsgDemuxerPacket(packet));
+  }
+}
+
+TEST(TestDVDDecoderFill, DrainsDelayedPictures)
+{
+  const unsigned int delay = 3;
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  TestDVDVideoCodecDelayed codec(delay);
+  CDVDDecoderFill fill;
+  std::vector<double> pts;
+
+  // the decoder holds back the pictures of the last packets of the stream
+  TestDVDDecoderFillPut(queue, 0, 10);
+  EXPECT_EQ(10U - delay, TestDVDDecoderFillDecode(queue, fill, codec, pts));
+  EXPECT_EQ(10U - delay, pts.size());
+  EXPECT_EQ(delay, fill.GetFill());
+
+  // at the end of the stream, as many empty packets as it holds get them out in order
+  fill.Drain(queue);
+  EXPECT_EQ(delay, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  TestDVDDecoderFillDecode(queue, fill, codec, pts);
+  EXPECT_EQ(0U, fill.GetFill());
+  ASSERT_EQ(10U, pts.size());
+  for (unsigned int i = 0; i < pts.size(); i++)
+    EXPECT_EQ((double)i, pts[i]);
+
+  // nothing is left to drain, and a stream shorter than the delay drains all of it
+  fill.Drain(queue);
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  pts.clear();
+  TestDVDDecoderFillPut(queue, 0, delay - 1);
+  EXPECT_EQ(0U, TestDVDDecoderFillDecode(queue, fill, codec, pts));
+  EXPECT_TRUE(pts.empty());
+  EXPECT_EQ(delay - 1, fill.GetFill());
+  fill.Drain(queue);
+  TestDVDDecoderFillDecode(queue, fill, codec, pts);
+  EXPECT_EQ(delay - 1, pts.size());
+  EXPECT_EQ(0U, fill.GetFill());
+
+  // a reset drops what the decoder holds
+  TestDVDDecoderFillPut(queue, 0, delay);
+  TestDVDDecoderFillDecode(queue, fill, codec, pts);
+  codec.Reset();
+  fill.Reset();
+  fill.Drain(queue);
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  queue.End();
+}
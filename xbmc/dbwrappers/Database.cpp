@@ -36,11 +36,42 @@
 #include "mysqldataset.h"
 #endif
 
+#ifdef TARGET_LINUX
+#include <sys/vfs.h>
+#endif
+
 using namespace AUTOPTR;
 using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
 
+/* whether folder is on a local file system */
+static bool IsLocalFolder(const CStdString &folder)
+{
+  // UNC paths of network shares
+  if (folder.Left(2) == "\\\\" || folder.Left(2) == "//")
+    return false;
+  if (URIUtils::IsRemote(folder))
+    return false;
+
+#ifdef TARGET_LINUX
+  // mounted network shares
+  struct statfs fsInfo;
+  if (statfs(folder.c_str(), &fsInfo) == 0)
+  {
+    switch ((unsigned long)fsInfo.f_type)
+    {
+    case 0x6969:     // NFS_SUPER_MAGIC
+    case 0x517B:     // SMB_SUPER_MAGIC
+    case 0xFF534D42: // CIFS_MAGIC_NUMBER
+      return false;
+    }
+  }
+#endif
+
+  return true;
+}
+
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
   if (strField.empty())
@@ -331,7 +362,28 @@ bool CDatabase::Open(const DatabaseSettings &settings)
 
   CStdString dbName = dbSettings.name;
   dbName.AppendFormat("%d", GetMinVersion());
-  return Connect(dbName, dbSettings, false);
+
+  if (!m_sqlite)
+    return Connect(dbName, dbSettings, false);
+
+  // sqlite connections are pooled by the database manager, so try to reuse an idle one first
+  CStdString poolKey;
+  URIUtils::AddFileToFolder(dbSettings.host, dbName, poolKey);
+  dbiplus::Database *db = CDatabaseManager::Get().AcquireConnection(poolKey);
+  if (db)
+  {
+    m_pDB.reset(db);
+    m_pDS.reset(m_pDB->CreateDataset());
+    m_pDS2.reset(m_pDB->CreateDataset());
+    m_openCount = 1;
+  }
+  else if (!Connect(dbName, dbSettings, false))
+    return false;
+
+  // writes from every connection to this database take turns
+  m_pDB->setWriteQueue(CDatabaseManager::Get().GetWriteQueue(poolKey));
+  m_poolKey = poolKey;
+  return true;
 }
 
 void CDatabase::InitSettings(DatabaseSettings &dbSettings)
@@ -498,6 +550,22 @@ bool CDatabase::Connect(const CStdString &dbName, const DatabaseSettings &dbSett
       m_pDS->exec("PRAGMA cache_size=4096\n");
       m_pDS->exec("PRAGMA synchronous='NORMAL'\n");
       m_pDS->exec("PRAGMA count_changes='OFF'\n");
+
+      //  Write-ahead logging lets readers carry on while a writer
+      //  is active. It needs shared memory between the connections,
+      //  which network file systems don't provide, so it is only used
+      //  for local databases. The journal mode is persistent, so switch
+      //  it back when disabled; this fails harmlessly while other
+      //  connections to the database are open.
+      bool wal = g_advancedSettings.m_databaseWAL && IsLocalFolder(dbSettings.host);
+      try
+      {
+        m_pDS->exec(wal ? "PRAGMA journal_mode=WAL\n" : "PRAGMA journal_mode=DELETE\n");
+      }
+      catch (...)
+      {
+        CLog::Log(LOGWARNING, "%s unable to change the journal mode of %s", __FUNCTION__, dbName.c_str());
+      }
     }
   }
   catch (DbErrors &error)
@@ -578,10 +646,21 @@ void CDatabase::Close()
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
-  m_pDB->disconnect();
-  m_pDB.reset();
+  if (m_pDB->in_transaction())
+    RollbackTransaction();
   m_pDS.reset();
   m_pDS2.reset();
+
+  if (!m_poolKey.empty())
+  {
+    // hand the connection back to the pool for the next Open()
+    CDatabaseManager::Get().ReleaseConnection(m_poolKey, m_pDB.release());
+    m_poolKey.clear();
+    return;
+  }
+
+  m_pDB->disconnect();
+  m_pDB.reset();
 }
 
 bool CDatabase::Compress(bool bForce /* =true */)
@@ -640,6 +719,7 @@ void CDatabase::BeginTransaction()
 
 bool CDatabase::CommitTransaction()
 {
+  bool success = true;
   try
   {
     if (NULL != m_pDB.get())
@@ -648,9 +728,9 @@ bool CDatabase::CommitTransaction()
   catch (...)
   {
     CLog::Log(LOGERROR, "database:committransaction failed");
-    return false;
+    success = false;
   }
-  return true;
+  return success;
 }
 
 void CDatabase::RollbackTransaction()
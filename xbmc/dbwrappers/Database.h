@@ -173,4 +173,5 @@ private:
 
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
   unsigned int m_openCount;
+  std::string m_poolKey; ///< key of our connection in the database manager's pool, empty if not pooled
 };
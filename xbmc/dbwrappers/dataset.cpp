@@ -48,6 +48,7 @@ Database::Database() {
   login = "";
   passwd = "";
   sequence_table = "db_sequence";
+  write_queue = NULL;
 }
 
 Database::~Database() {
@@ -75,6 +76,28 @@ string Database::prepare(const char *format, ...)
   return result;
 }
 
+//************* ResultSetCursor implementation ***************
+
+/* cursor over the result set of a dataset, for drivers without native cursors */
+class ResultSetCursor : public Cursor {
+public:
+  ResultSetCursor(const result_set &result) : res(result), row(-1) {};
+  virtual bool next() { return ++row < (int)res.records.size(); }
+  virtual int field_count() { return res.record_header.size(); }
+  virtual const char *field_name(int n) { return res.record_header[n].name.c_str(); }
+  virtual bool is_null(int n) { return value(n).get_isNull(); }
+  virtual int get_int(int n) { return value(n).get_asInt(); }
+  virtual int64_t get_int64(int n) { return value(n).get_asInt64(); }
+  virtual double get_double(int n) { return value(n).get_asDouble(); }
+  virtual const char *get_text(int n) { text = value(n).get_asString(); return text.c_str(); }
+  virtual field_value get_value(int n) { return value(n); }
+private:
+  const field_value &value(int n) { return res.records[row]->at(n); }
+  const result_set &res;
+  int row;
+  std::string text;
+};
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset() {
@@ -152,6 +175,62 @@ void Dataset::setSqlParams(const char *sqlFrmt, sqlType t, ...) {
 
 
 
+string Dataset::bind_sql(const string &sql, const BindList &params) {
+  string result;
+  result.reserve(sql.size());
+  char quote = 0; // quote character of the literal we are in, if any
+  unsigned int param = 0;
+  char buf[64];
+  for (size_t i = 0; i < sql.size(); i++) {
+    char c = sql[i];
+    if (quote) {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '\'' || c == '"' || c == '`')
+      quote = c;
+    if (c != '?' || quote) {
+      result += c;
+      continue;
+    }
+    if (param >= params.size())
+      throw DbErrors("Not enough values bound to query: %s", sql.c_str());
+    const field_value &v = params[param++];
+    if (v.get_isNull()) {
+      result += "NULL";
+      continue;
+    }
+    switch (v.get_fType()) {
+    case ft_Boolean: case ft_Short: case ft_UShort: case ft_Int: case ft_Int64:
+      sprintf(buf, "%lld", (long long)v.get_asInt64());
+      result += buf;
+      break;
+    case ft_UInt:
+      sprintf(buf, "%u", v.get_asUInt());
+      result += buf;
+      break;
+    case ft_Float: case ft_Double: case ft_LongDouble:
+      sprintf(buf, "%.17g", v.get_asDouble());
+      result += buf;
+      break;
+    default:
+      result += db->prepare("'%s'", v.get_asString().c_str());
+      break;
+    }
+  }
+  return result;
+}
+
+bool Dataset::query(const string &sql, const BindList &params) {
+  return query(bind_sql(sql, params).c_str());
+}
+
+Cursor *Dataset::open_cursor(const string &sql, const BindList &params) {
+  if (!query(sql, params))
+    return NULL;
+  return new ResultSetCursor(result);
+}
+
 void Dataset::set_select_sql(const char *sel_sql) {
  select_sql = sel_sql;
 }
@@ -34,6 +34,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #include "qry_dat.h"
 #include <stdarg.h>
 
@@ -60,6 +61,22 @@ class Dataset;		// forward declaration of class Dataset
 #define DB_UNEXPECTED		7	// This shouldn't ever happen
 #define DB_UNEXPECTED_RESULT   -1       //For integer functions
 
+/******************* Class WriteQueue definition ******************
+
+   lets the connections to one database take turns writing
+
+******************************************************************/
+class WriteQueue {
+public:
+  virtual ~WriteQueue() {};
+/* wait for our turn to write, returns false when writing without it */
+  virtual bool begin_write() = 0;
+/* end a turn taken with begin_write */
+  virtual void end_write() = 0;
+};
+
+
+
 /******************* Class Database definition ********************
 
    represents  connection with database server;
@@ -72,6 +89,7 @@ protected:
     host, port, db, login, passwd, //Login info
     sequence_table, //Sequence table for nextid
     default_charset; //Default character set
+  WriteQueue *write_queue; // queue shared by all connections to this database, if any
 
 public:
 /* constructor */
@@ -107,6 +125,11 @@ public:
   const char *getSequenceTable(void) { return sequence_table.c_str(); }
 /* Get the default character set */
   const char *getDefaultCharset(void) { return default_charset.c_str(); }
+/* sets the queue writes wait in; it must outlive the connection */
+  void setWriteQueue(WriteQueue *queue) { write_queue = queue; }
+/* take a turn in the write queue, returns true if end_write must be called */
+  bool begin_write() { return write_queue && write_queue->begin_write(); }
+  void end_write() { if (write_queue) write_queue->end_write(); }
 
 /* virtual methods that must be overloaded in derived classes */
 
@@ -158,6 +181,59 @@ public:
 
 
 
+/******************* Class Cursor definition **********************
+
+  forward-only, typed access to the rows of a query
+
+******************************************************************/
+class Cursor {
+public:
+  virtual ~Cursor() {};
+/* advance to the next row, returns false once there are no more rows */
+  virtual bool next() = 0;
+/* number of fields in a row */
+  virtual int field_count() = 0;
+/* name of the field with index n */
+  virtual const char *field_name(int n) = 0;
+/* typed values of the field with index n in the current row */
+  virtual bool is_null(int n) = 0;
+  virtual int get_int(int n) = 0;
+  virtual int64_t get_int64(int n) = 0;
+  virtual double get_double(int n) = 0;
+/* text of the field with index n, valid until the next call on the cursor */
+  virtual const char *get_text(int n) = 0;
+/* field with index n as a field_value, typed like the rows of a query */
+  virtual field_value get_value(int n) = 0;
+};
+
+
+
+/******************* Class RecordCursor definition ****************
+
+  cursor positioned on a single, already fetched record; lets code
+  written against Cursor also read the rows of a result_set
+
+******************************************************************/
+class RecordCursor : public Cursor {
+public:
+  RecordCursor(const sql_record *record) : rec(record) {};
+/* the cursor starts on its record, there is no next one */
+  virtual bool next() { return false; }
+  virtual int field_count() { return rec->size(); }
+  virtual const char *field_name(int n) { return ""; }
+  virtual bool is_null(int n) { return rec->at(n).get_isNull(); }
+  virtual int get_int(int n) { return rec->at(n).get_asInt(); }
+  virtual int64_t get_int64(int n) { return rec->at(n).get_asInt64(); }
+  virtual double get_double(int n) { return rec->at(n).get_asDouble(); }
+  virtual const char *get_text(int n) { text = rec->at(n).get_asString(); return text.c_str(); }
+  virtual field_value get_value(int n) { return rec->at(n); }
+private:
+  const sql_record *rec;
+  std::string text;
+};
+
+
+
 /******************* Class Dataset definition *********************
 
   global abstraction for using Databases
@@ -171,6 +247,7 @@ enum sqlType {sqlSelect,sqlUpdate,sqlInsert,sqlDelete,sqlExec};
 
 typedef std::list<std::string> StringList;
 typedef std::map<std::string,field_value> ParamList;
+typedef std::vector<field_value> BindList;  // values for '?' placeholders
 
 
 class Dataset  {
@@ -248,6 +325,9 @@ protected:
 /* Parse Sql - replacing fields with prefixes :OLD_ and :NEW_ with current values of OLD or NEW field. */
   void parse_sql(std::string &sql);
 
+/* Replace '?' placeholders outside of string literals with the escaped values in params */
+  std::string bind_sql(const std::string &sql, const BindList &params);
+
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
@@ -296,6 +376,12 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* as query, with '?' placeholders in sql bound to the values in params */
+  virtual bool query(const std::string &sql, const BindList &params);
+/* Opens a forward-only cursor over a select query with '?' placeholders bound to
+   the values in params.  The caller owns the cursor, and must delete it before
+   the next query on this dataset.  Returns NULL on failure. */
+  virtual Cursor *open_cursor(const std::string &sql, const BindList &params = BindList());
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -79,6 +79,75 @@ int callback(void* res_ptr,int ncol, char** reslt,char** cols)
   return 0;  
 }
 
+#define MAX_CACHED_STATEMENTS 64
+
+/* copies column i of the current row of a statement into v, typed by the column's storage class */
+static void read_value(sqlite3_stmt *stmt, int i, field_value &v)
+{
+  switch (sqlite3_column_type(stmt, i))
+  {
+  case SQLITE_INTEGER:
+    v.set_asInt64(sqlite3_column_int64(stmt, i));
+    break;
+  case SQLITE_FLOAT:
+    v.set_asDouble(sqlite3_column_double(stmt, i));
+    break;
+  case SQLITE_TEXT:
+    v.set_asString((const char *)sqlite3_column_text(stmt, i));
+    break;
+  case SQLITE_BLOB:
+    v.set_asString((const char *)sqlite3_column_text(stmt, i));
+    break;
+  case SQLITE_NULL:
+  default:
+    v.set_asString("");
+    v.set_isNull();
+    break;
+  }
+}
+
+//************* SqliteCursor implementation ***************
+
+class SqliteCursor : public Cursor {
+public:
+  SqliteCursor(SqliteDatabase *database, const string &query, sqlite3_stmt *statement)
+    : db(database), sql(query), stmt(statement) {};
+  virtual ~SqliteCursor() { db->release_statement(sql, stmt); }
+  virtual bool next()
+  {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW)
+      return true;
+    if (rc != SQLITE_DONE)
+    {
+      db->setErr(rc, sql.c_str());
+      throw DbErrors(db->getErrorMsg());
+    }
+    return false;
+  }
+  virtual int field_count() { return sqlite3_column_count(stmt); }
+  virtual const char *field_name(int n) { return sqlite3_column_name(stmt, n); }
+  virtual bool is_null(int n) { return sqlite3_column_type(stmt, n) == SQLITE_NULL; }
+  virtual int get_int(int n) { return sqlite3_column_int(stmt, n); }
+  virtual int64_t get_int64(int n) { return sqlite3_column_int64(stmt, n); }
+  virtual double get_double(int n) { return sqlite3_column_double(stmt, n); }
+  virtual const char *get_text(int n)
+  {
+    const char *text = (const char *)sqlite3_column_text(stmt, n);
+    return text ? text : "";
+  }
+  virtual field_value get_value(int n)
+  {
+    field_value v;
+    read_value(stmt, n, v);
+    return v;
+  }
+private:
+  SqliteDatabase *db;
+  string sql;
+  sqlite3_stmt *stmt;
+};
+
 static int busy_callback(void*, int busyCount)
 {
 	Sleep(100);
@@ -92,6 +161,7 @@ SqliteDatabase::SqliteDatabase() {
 
   active = false;	
   _in_transaction = false;		// for transaction
+  _write_turn = false;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -260,8 +330,11 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clear_statements();
   sqlite3_close(conn);
   active = false;
+  _in_transaction = false;
+  end_transaction_turn();
 }
 
 int SqliteDatabase::create() {
@@ -349,10 +422,65 @@ long SqliteDatabase::nextid(const char* sname) {
 }
 
 
+// methods for the statement cache
+// ---------------------------------------------
+sqlite3_stmt *SqliteDatabase::get_statement(const string &sql) {
+  if (!active) throw DbErrors("No Database Connection");
+
+  // statements are removed from the cache while in use, so a nested
+  // query with the same sql gets a statement of its own
+  StatementCache::iterator i = statements.find(sql);
+  if (i != statements.end())
+  {
+    sqlite3_stmt *stmt = i->second.first;
+    statements_lru.erase(i->second.second);
+    statements.erase(i);
+    return stmt;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+  return stmt;
+}
+
+void SqliteDatabase::release_statement(const string &sql, sqlite3_stmt *stmt) {
+  if (!stmt) return;
+  if (!active || statements.find(sql) != statements.end())
+  {
+    sqlite3_finalize(stmt);
+    return;
+  }
+
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  statements_lru.push_front(sql);
+  statements.insert(make_pair(sql, make_pair(stmt, statements_lru.begin())));
+
+  // evict the least recently used statement
+  if (statements.size() > MAX_CACHED_STATEMENTS)
+  {
+    StatementCache::iterator oldest = statements.find(statements_lru.back());
+    sqlite3_finalize(oldest->second.first);
+    statements.erase(oldest);
+    statements_lru.pop_back();
+  }
+}
+
+void SqliteDatabase::clear_statements() {
+  for (StatementCache::iterator i = statements.begin(); i != statements.end(); ++i)
+    sqlite3_finalize(i->second.first);
+  statements.clear();
+  statements_lru.clear();
+}
+
 // methods for transactions
 // ---------------------------------------------
 void SqliteDatabase::start_transaction() {
   if (active) {
+    // queue behind other writers to this database rather than spinning in the busy handler
+    if (!_in_transaction && !_write_turn)
+      _write_turn = begin_write();
     sqlite3_exec(conn,"begin IMMEDIATE",NULL,NULL,NULL);
     _in_transaction = true;
   }
@@ -363,6 +491,7 @@ void SqliteDatabase::commit_transaction() {
     sqlite3_exec(conn,"commit",NULL,NULL,NULL);
     _in_transaction = false;
   }
+  end_transaction_turn();
 }
 
 void SqliteDatabase::rollback_transaction() {
@@ -370,6 +499,14 @@ void SqliteDatabase::rollback_transaction() {
     sqlite3_exec(conn,"rollback",NULL,NULL,NULL);
     _in_transaction = false;
   }  
+  end_transaction_turn();
+}
+
+void SqliteDatabase::end_transaction_turn() {
+  if (_write_turn) {
+    end_write();
+    _write_turn = false;
+  }
 }
 
 
@@ -580,7 +717,13 @@ int SqliteDataset::exec(const string &sql) {
       qry = qry.substr(0, pos);
   }
 
-  if((res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str())) == SQLITE_OK)
+  // statements outside a transaction wait for their turn like transactions do
+  bool turn = !db->in_transaction() && db->begin_write();
+  int rc = sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg);
+  if (turn)
+    db->end_write();
+
+  if((res = db->setErr(rc,qry.c_str())) == SQLITE_OK)
     return res;
   else
     {
@@ -611,43 +754,7 @@ bool SqliteDataset::query(const char *query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
-  // column headers
-  const unsigned int numColumns = sqlite3_column_count(stmt);
-  result.record_header.resize(numColumns);
-  for (unsigned int i = 0; i < numColumns; i++)
-    result.record_header[i].name = sqlite3_column_name(stmt, i);
-
-  // returned rows
-  while (sqlite3_step(stmt) == SQLITE_ROW)
-  { // have a row of data
-    sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
-    }
-    result.records.push_back(res);
-  }
+  fetch_rows(stmt);
   if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
   {
     active = true;
@@ -665,6 +772,99 @@ bool SqliteDataset::query(const string &q){
   return query(q.c_str());
 }
 
+bool SqliteDataset::query(const string &q, const BindList &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->get_statement(q);
+  try
+  {
+    bind_params(stmt, params, q.c_str());
+    fetch_rows(stmt);
+  }
+  catch (...)
+  {
+    database->release_statement(q, stmt);
+    throw;
+  }
+  database->release_statement(q, stmt);
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+Cursor *SqliteDataset::open_cursor(const string &q, const BindList &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->get_statement(q);
+  try
+  {
+    bind_params(stmt, params, q.c_str());
+  }
+  catch (...)
+  {
+    database->release_statement(q, stmt);
+    throw;
+  }
+  return new SqliteCursor(database, q, stmt);
+}
+
+void SqliteDataset::bind_params(sqlite3_stmt *stmt, const BindList &params, const char *sql) {
+  if ((int)params.size() != sqlite3_bind_parameter_count(stmt))
+    throw DbErrors("Wrong number of values bound to query: %s", sql);
+
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    int rc;
+    if (v.get_isNull())
+      rc = sqlite3_bind_null(stmt, i + 1);
+    else
+    {
+      switch (v.get_fType())
+      {
+      case ft_Boolean: case ft_Short: case ft_UShort: case ft_Int: case ft_UInt: case ft_Int64:
+        rc = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
+        break;
+      case ft_Float: case ft_Double: case ft_LongDouble:
+        rc = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
+        break;
+      default:
+        {
+          std::string text = v.get_asString();
+          rc = sqlite3_bind_text(stmt, i + 1, text.c_str(), text.size(), SQLITE_TRANSIENT);
+        }
+        break;
+      }
+    }
+    if (db->setErr(rc, sql) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
+  }
+}
+
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
+  // column headers
+  const unsigned int numColumns = sqlite3_column_count(stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = sqlite3_column_name(stmt, i);
+
+  // returned rows
+  while (sqlite3_step(stmt) == SQLITE_ROW)
+  { // have a row of data
+    sql_record *res = new sql_record;
+    res->resize(numColumns);
+    for (unsigned int i = 0; i < numColumns; i++)
+      read_value(stmt, i, res->at(i));
+    result.records.push_back(res);
+  }
+}
+
 void SqliteDataset::open(const string &sql) {
 	set_select_sql(sql);
 	open();
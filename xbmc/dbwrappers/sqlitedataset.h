@@ -30,6 +30,7 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <list>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -44,6 +45,7 @@ protected:
 /* connect descriptor */
   sqlite3 *conn;
   bool _in_transaction;
+  bool _write_turn; // whether the open transaction holds a turn in the write queue
   int last_err;
 
 public:
@@ -94,6 +96,19 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* prepared statement cache.  get_statement() hands out a cached statement for sql,
+   or prepares a new one; release_statement() resets it and returns it to the cache */
+  sqlite3_stmt *get_statement(const std::string &sql);
+  void release_statement(const std::string &sql, sqlite3_stmt *stmt);
+
+private:
+  void clear_statements();
+  void end_transaction_turn();
+
+  typedef std::list<std::string> StatementLRU;
+  typedef std::map<std::string, std::pair<sqlite3_stmt*, StatementLRU::iterator> > StatementCache;
+  StatementCache statements;
+  StatementLRU statements_lru;  // most recently released first
 };
 
 
@@ -125,6 +140,11 @@ protected:
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
 
+/* reads the rows of a prepared statement into the result set */
+  void fetch_rows(sqlite3_stmt *stmt);
+/* binds params to the placeholders of a prepared statement */
+  void bind_params(sqlite3_stmt *stmt, const BindList &params, const char *sql);
+
 public:
 /* constructor */
   SqliteDataset();
@@ -147,6 +167,10 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+/* as query, using a cached prepared statement with '?' placeholders bound to params */
+  virtual bool query(const std::string &query, const BindList &params);
+/* steps a cached prepared statement directly, without copying the rows */
+  virtual Cursor *open_cursor(const std::string &query, const BindList &params = BindList());
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -0,0 +1,316 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DatabaseManager.h"
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/Thread.h"
+#include "utils/Stopwatch.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace dbiplus;
+
+/* A song table shaped like the music library, with enough rows to show
+ * the cost of materializing and copying every row of a listing.
+ */
+class TestSqliteDataset : public testing::Test
+{
+protected:
+  TestSqliteDataset()
+  {
+    db.setHostName(CSpecialProtocol::TranslatePath("special://temp/").c_str());
+    db.setDatabase("TestSqliteDataset");
+    db.connect(true);
+    ds.reset(db.CreateDataset());
+  }
+
+  ~TestSqliteDataset()
+  {
+    ds.reset();
+    db.disconnect();
+    XFILE::CFile::Delete("special://temp/TestSqliteDataset.db");
+    XFILE::CFile::Delete("special://temp/TestSqliteDataset.db-wal");
+    XFILE::CFile::Delete("special://temp/TestSqliteDataset.db-shm");
+  }
+
+  void CreateSongs(int rows)
+  {
+    ds->exec("CREATE TABLE song (idSong integer primary key, strTitle text, iTrack integer, iDuration integer, fRating real, idPath integer)");
+    db.start_transaction();
+    for (int i = 0; i < rows; i++)
+      ds->exec(db.prepare("INSERT INTO song VALUES (NULL, 'Song %i', %i, %i, %f, %i)", i, i % 20, 180 + i % 120, (i % 10) / 2.0, i % 5));
+    db.commit_transaction();
+  }
+
+  SqliteDatabase db;
+  std::auto_ptr<Dataset> ds;
+};
+
+TEST_F(TestSqliteDataset, BindQuery)
+{
+  CreateSongs(100);
+
+  BindList params;
+  params.push_back(2);
+  params.push_back("Song 12");
+  EXPECT_TRUE(ds->query("SELECT idSong, strTitle FROM song WHERE idPath=? AND strTitle=?", params));
+  EXPECT_EQ(1, ds->num_rows());
+  EXPECT_EQ(13, ds->fv(0).get_asInt());
+  EXPECT_STREQ("Song 12", ds->fv(1).get_asString().c_str());
+  ds->close();
+
+  // the cached statement is reused with new values
+  params[1] = "Song 17";
+  EXPECT_TRUE(ds->query("SELECT idSong, strTitle FROM song WHERE idPath=? AND strTitle=?", params));
+  EXPECT_EQ(1, ds->num_rows());
+  EXPECT_EQ(18, ds->fv(0).get_asInt());
+  ds->close();
+}
+
+TEST_F(TestSqliteDataset, BindSQL)
+{
+  CreateSongs(10);
+
+  BindList params;
+  params.push_back("it's");
+  params.push_back(3);
+  params.push_back(field_value());
+  params.back().set_isNull();
+  // the generic implementation substitutes escaped values into the query text,
+  // leaving quoted literals and identifiers alone
+  EXPECT_TRUE(ds->Dataset::query("SELECT ? AS \"it's ?\", '?', ?, ?", params));
+  EXPECT_STREQ("it's", ds->fv(0).get_asString().c_str());
+  EXPECT_STREQ("?", ds->fv(1).get_asString().c_str());
+  EXPECT_EQ(3, ds->fv(2).get_asInt());
+  EXPECT_TRUE(ds->fv(3).get_isNull());
+  ds->close();
+}
+
+TEST_F(TestSqliteDataset, Cursor)
+{
+  CreateSongs(100);
+
+  BindList params;
+  params.push_back(10);
+  std::auto_ptr<Cursor> cursor(ds->open_cursor("SELECT idSong, strTitle, fRating FROM song WHERE idSong <= ? ORDER BY idSong", params));
+  ASSERT_TRUE(cursor.get() != NULL);
+  EXPECT_EQ(3, cursor->field_count());
+  EXPECT_STREQ("strTitle", cursor->field_name(1));
+  int rows = 0;
+  while (cursor->next())
+  {
+    rows++;
+    EXPECT_EQ(rows, cursor->get_int(0));
+    char title[32];
+    sprintf(title, "Song %i", rows - 1);
+    EXPECT_STREQ(title, cursor->get_text(1));
+    EXPECT_DOUBLE_EQ(((rows - 1) % 10) / 2.0, cursor->get_double(2));
+  }
+  EXPECT_EQ(10, rows);
+}
+
+TEST_F(TestSqliteDataset, ListingBenchmark)
+{
+  static const int rows = 100000;
+  CreateSongs(rows);
+
+  CStopWatch watch;
+  int64_t sumDataset = 0, sumCursor = 0;
+  size_t titlesDataset = 0, titlesCursor = 0;
+
+  // GetSongsByWhere style: formatted SQL, materialized rows, string backed fields
+  watch.StartZero();
+  ASSERT_TRUE(ds->query(db.prepare("SELECT * FROM song WHERE idPath < %i", 5).c_str()));
+  while (!ds->eof())
+  {
+    sumDataset += ds->fv(0).get_asInt() + ds->fv(2).get_asInt() + ds->fv(3).get_asInt();
+    titlesDataset += ds->fv(1).get_asString().size();
+    ds->next();
+  }
+  ds->close();
+  float datasetTime = watch.GetElapsedMilliseconds();
+
+  // the same listing through a cached statement and typed cursor
+  BindList params;
+  params.push_back(5);
+  watch.StartZero();
+  std::auto_ptr<Cursor> cursor(ds->open_cursor("SELECT * FROM song WHERE idPath < ?", params));
+  ASSERT_TRUE(cursor.get() != NULL);
+  while (cursor->next())
+  {
+    sumCursor += cursor->get_int(0) + cursor->get_int(2) + cursor->get_int(3);
+    titlesCursor += strlen(cursor->get_text(1));
+  }
+  cursor.reset();
+  float cursorTime = watch.GetElapsedMilliseconds();
+
+  EXPECT_EQ(sumDataset, sumCursor);
+  EXPECT_EQ(titlesDataset, titlesCursor);
+
+  std::cout << "Dataset: " << testing::PrintToString(datasetTime) << " ms" << std::endl;
+  std::cout << "Cursor: " << testing::PrintToString(cursorTime) << " ms" << std::endl;
+}
+
+/* counts the turns taken by a connection */
+class TestSqliteDatasetWriteQueue : public WriteQueue
+{
+public:
+  TestSqliteDatasetWriteQueue() : begins(0), ends(0) {}
+  virtual bool begin_write() { begins++; return true; }
+  virtual void end_write() { ends++; }
+  int begins;
+  int ends;
+};
+
+TEST_F(TestSqliteDataset, WriteQueue)
+{
+  TestSqliteDatasetWriteQueue queue;
+  db.setWriteQueue(&queue);
+
+  // a statement outside a transaction takes a turn of its own
+  ds->exec("CREATE TABLE song (idSong integer primary key, strTitle text)");
+  EXPECT_EQ(1, queue.begins);
+  EXPECT_EQ(1, queue.ends);
+
+  // a transaction holds one turn until it ends
+  db.start_transaction();
+  EXPECT_EQ(2, queue.begins);
+  ds->exec("INSERT INTO song VALUES (NULL, 'Song 1')");
+  ds->exec("INSERT INTO song VALUES (NULL, 'Song 2')");
+  EXPECT_EQ(2, queue.begins);
+  EXPECT_EQ(1, queue.ends);
+  db.commit_transaction();
+  EXPECT_EQ(2, queue.ends);
+
+  db.start_transaction();
+  ds->exec("INSERT INTO song VALUES (NULL, 'Song 3')");
+  db.rollback_transaction();
+  EXPECT_EQ(3, queue.begins);
+  EXPECT_EQ(3, queue.ends);
+
+  // reading takes no turn
+  EXPECT_TRUE(ds->query("SELECT COUNT(*) FROM song"));
+  EXPECT_EQ(2, ds->fv(0).get_asInt());
+  ds->close();
+  EXPECT_EQ(3, queue.begins);
+
+  db.setWriteQueue(NULL);
+}
+
+/* takes a turn in a writer queue of the database manager */
+class TestSqliteDatasetWriter : public CThread
+{
+public:
+  TestSqliteDatasetWriter(WriteQueue *queue)
+    : CThread("TestSqliteDatasetWriter"), m_queue(queue), m_writing(false) {}
+  virtual void Process()
+  {
+    if (m_queue->begin_write())
+    {
+      m_writing = true;
+      m_queue->end_write();
+    }
+  }
+  WriteQueue *m_queue;
+  volatile bool m_writing;
+};
+
+TEST_F(TestSqliteDataset, WriteQueueTurns)
+{
+  WriteQueue *queue = CDatabaseManager::Get().GetWriteQueue("TestSqliteDataset");
+  ASSERT_TRUE(queue != NULL);
+  EXPECT_EQ(queue, CDatabaseManager::Get().GetWriteQueue("TestSqliteDataset"));
+
+  // turns are recursive for the thread holding one
+  ASSERT_TRUE(queue->begin_write());
+  ASSERT_TRUE(queue->begin_write());
+  queue->end_write();
+
+  // other threads wait until the turn has ended
+  TestSqliteDatasetWriter writer(queue);
+  writer.Create();
+  EXPECT_FALSE(writer.WaitForThreadExit(200));
+  EXPECT_FALSE(writer.m_writing);
+  queue->end_write();
+  EXPECT_TRUE(writer.WaitForThreadExit(10000));
+  EXPECT_TRUE(writer.m_writing);
+}
+
+/* counts the songs through a connection of its own */
+class TestSqliteDatasetReader : public CThread
+{
+public:
+  TestSqliteDatasetReader()
+    : CThread("TestSqliteDatasetReader"), m_songs(-1) {}
+  virtual void Process()
+  {
+    SqliteDatabase db;
+    db.setHostName(CSpecialProtocol::TranslatePath("special://temp/").c_str());
+    db.setDatabase("TestSqliteDataset");
+    if (db.connect(false) != DB_CONNECTION_OK)
+      return;
+    std::auto_ptr<Dataset> ds(db.CreateDataset());
+    if (ds->query("SELECT COUNT(*) FROM song"))
+      m_songs = ds->fv(0).get_asInt();
+    ds.reset();
+    db.disconnect();
+  }
+  volatile int m_songs;
+};
+
+/* counts the songs from several threads at once, each of which must finish */
+static void CountSongsConcurrently(unsigned int readers, int expected)
+{
+  std::vector<TestSqliteDatasetReader*> threads;
+  for (unsigned int i = 0; i < readers; i++)
+  {
+    threads.push_back(new TestSqliteDatasetReader);
+    threads.back()->Create();
+  }
+  for (unsigned int i = 0; i < readers; i++)
+  {
+    EXPECT_TRUE(threads[i]->WaitForThreadExit(10000));
+    EXPECT_EQ(expected, threads[i]->m_songs);
+    threads[i]->StopThread();
+    delete threads[i];
+  }
+}
+
+TEST_F(TestSqliteDataset, ReadersDuringWriteTransaction)
+{
+  ds->exec("PRAGMA journal_mode=WAL");
+  CreateSongs(100);
+
+  // with write-ahead logging readers see the last commit while a write transaction is open
+  db.start_transaction();
+  for (int i = 0; i < 10; i++)
+    ds->exec(db.prepare("INSERT INTO song VALUES (NULL, 'New %i', 1, 180, 0, 0)", i));
+  CountSongsConcurrently(4, 100);
+  db.commit_transaction();
+
+  // and the new rows once it is committed
+  CountSongsConcurrently(4, 110);
+}
@@ -57,6 +57,16 @@ void CCacheStrategy::ClearEndOfInput()
   m_bEndOfInput = false;
 }
 
+int64_t CCacheStrategy::CachedDataEndPos()
+{
+  return -1;
+}
+
+bool CCacheStrategy::SetWritePosition(int64_t iSourcePosition)
+{
+  return false;
+}
+
 CSimpleFileCache::CSimpleFileCache()
   : m_hCacheFileRead(NULL)
   , m_hCacheFileWrite(NULL)
@@ -57,6 +57,19 @@ public:
   virtual bool IsEndOfInput();
   virtual void ClearEndOfInput();
 
+  /*! \brief End of the cached data that is contiguous with the read position.
+   Strategies that keep data away from the write position return where the source has to
+   continue from once the reader runs out of cached data.
+   \return the file position, or -1 if the strategy only caches around the write position.
+   */
+  virtual int64_t CachedDataEndPos();
+
+  /*! \brief Move the write position after the source has been repositioned,
+   without moving the read position or dropping cached data.
+   \return false if the strategy doesn't support it, in which case Reset() has to be used.
+   */
+  virtual bool SetWritePosition(int64_t iSourcePosition);
+
   CEvent m_space;
 protected:
   bool  m_bEndOfInput;
@@ -26,15 +26,21 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "SegmentedCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "settings/AdvancedSettings.h"
 
+#include <limits>
+
 using namespace AUTOPTR;
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+#define READ_CACHE_CHUNK_MIN   (16*1024)
+#define READ_CACHE_CHUNK_MAX   (1024*1024)
+#define READ_RATE_INTERVAL     1000 /* ms over which the consumption rate is sampled */
 
 class CWriteRate
 {
@@ -83,10 +89,15 @@ CFileCache::CFileCache() : CThread("CFileCache")
    m_bDeleteCache = true;
    m_nSeekResult = 0;
    m_seekPos = 0;
+   m_seekRefill = false;
    m_readPos = 0;
    m_writePos = 0;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
+   else if (g_advancedSettings.m_cacheSegmented)
+     m_pCache = new CSegmentedCache(g_advancedSettings.m_cacheMemBufferSize
+                                  + std::max<unsigned int>( g_advancedSettings.m_cacheMemBufferSize / 4, 1024 * 1024)
+                                  , g_advancedSettings.m_cacheMemBufferSize);
    else
      m_pCache = new CCircularCache(g_advancedSettings.m_cacheMemBufferSize
                                  , std::max<unsigned int>( g_advancedSettings.m_cacheMemBufferSize / 4, 1024 * 1024));
@@ -99,6 +110,7 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("CFi
   m_pCache = pCache;
   m_bDeleteCache = bDeleteCache;
   m_seekPos = 0;
+  m_seekRefill = false;
   m_readPos = 0;
   m_writePos = 0;
   m_nSeekResult = 0;
@@ -168,10 +180,14 @@ bool CFileCache::Open(const CURL& url)
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
 
   m_readPos = 0;
+  m_readRate = 0;
+  m_readRatePos = 0;
+  m_readRateStamp = XbmcThreads::SystemClockMillis();
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
   m_writeRateActual = 0;
   m_cacheFull = false;
+  m_seekRefill = false;
   m_seekEvent.Reset();
   m_seekEnded.Reset();
 
@@ -188,8 +204,11 @@ void CFileCache::Process()
     return;
   }
 
-  // create our read buffer
-  auto_aptr<char> buffer(new char[m_chunkSize]);
+  // create our read buffer, large enough for the largest chunk we adapt to
+  const unsigned maxChunk = std::max<unsigned>(m_chunkSize, CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_MAX));
+  const unsigned minChunk = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_MIN);
+  unsigned chunk = m_chunkSize;
+  auto_aptr<char> buffer(new char[maxChunk]);
   if (buffer.get() == NULL)
   {
     CLog::Log(LOGERROR, "%s - failed to allocate read buffer", __FUNCTION__);
@@ -205,13 +224,27 @@ void CFileCache::Process()
     if (m_seekEvent.WaitMSec(0))
     {
       m_seekEvent.Reset();
-      CLog::Log(LOGDEBUG,"%s, request seek on source to %"PRId64, __FUNCTION__, m_seekPos);
-      m_nSeekResult = m_source.Seek(m_seekPos, SEEK_SET);
-      if (m_nSeekResult != m_seekPos)
+      bool refill = m_seekRefill;
+      m_seekRefill = false;
+
+      CLog::Log(LOGDEBUG,"%s, request %s on source to %"PRId64, __FUNCTION__, refill ? "refill" : "seek", m_seekPos);
+      int64_t result = m_source.Seek(m_seekPos, SEEK_SET);
+      if (!refill)
+        m_nSeekResult = result;
+
+      if (result != m_seekPos)
       {
-        CLog::Log(LOGERROR,"%s, error %d seeking. seek returned %"PRId64, __FUNCTION__, (int)GetLastError(), m_nSeekResult);
+        CLog::Log(LOGERROR,"%s, error %d seeking. seek returned %"PRId64, __FUNCTION__, (int)GetLastError(), result);
         m_seekPossible = m_source.IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
       }
+      else if (refill && m_pCache->SetWritePosition(m_seekPos))
+      {
+        // the reader stays where it is, we just continue caching where its data ends
+        average.Reset(m_seekPos);
+        limiter.Reset(m_seekPos);
+        m_writePos = m_seekPos;
+        m_cacheFull = false;
+      }
       else
       {
         m_pCache->Reset(m_seekPos);
@@ -222,7 +255,8 @@ void CFileCache::Process()
         m_cacheFull = false;
       }
 
-      m_seekEnded.Set();
+      if (!refill)
+        m_seekEnded.Set();
     }
 
     while (m_writeRate)
@@ -233,7 +267,8 @@ void CFileCache::Process()
         break;
       }
 
-      if (limiter.Rate(m_writePos) < m_writeRate)
+      // once the read ahead target is buffered, wait for the reader to catch up
+      if (limiter.Rate(m_writePos) < m_writeRate && m_writePos - m_readPos < GetReadAhead())
         break;
 
       if (m_seekEvent.WaitMSec(100))
@@ -243,7 +278,7 @@ void CFileCache::Process()
       }
     }
 
-    int iRead = m_source.Read(buffer.get(), m_chunkSize);
+    int iRead = m_source.Read(buffer.get(), chunk);
     if (iRead == 0)
     {
       CLog::Log(LOGINFO, "CFileCache::Process - Hit eof.");
@@ -300,6 +335,11 @@ void CFileCache::Process()
     // under estimate write rate by a second, to
     // avoid uncertainty at start of caching
     m_writeRateActual = average.Rate(m_writePos, 1000);
+
+    // aim for reads of about 100ms worth of data. small reads get data to the
+    // reader early on slow links, large reads keep the overhead down on fast ones.
+    if (m_writeRateActual)
+      chunk = CFile::GetChunkSize(m_source.GetChunkSize(), std::min(std::max(m_writeRateActual / 10, minChunk), maxChunk));
   }
 }
 
@@ -341,11 +381,17 @@ retry:
   if (iRc > 0)
   {
     m_readPos += iRc;
+    UpdateReadRate();
     return (int)iRc;
   }
 
   if (iRc == CACHE_RC_WOULD_BLOCK)
   {
+    // we may have run out of data cached earlier, in which case the source has to catch up
+    Refill();
+    if (GetLength() > 0 && m_readPos >= GetLength())
+      return 0;
+
     // just wait for some data to show up
     iRc = m_pCache->WaitForData(1, 10000);
     if (iRc > 0)
@@ -395,6 +441,7 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
 
     /* never request closer to end than 2k, speeds up tag reading */
     m_seekPos = std::min(iTarget, std::max((int64_t)0, m_source.GetLength() - m_chunkSize));
+    m_seekRefill = false;
 
     m_seekEvent.Set();
     if (!m_seekEnded.Wait())
@@ -418,11 +465,57 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
     m_seekEvent.Reset();
   }
   else
+  {
     m_readPos = iTarget;
+    Refill();
+  }
+
+  // don't count the jump as consumed data
+  m_readRatePos = m_readPos;
+  m_readRateStamp = XbmcThreads::SystemClockMillis();
 
   return m_nSeekResult;
 }
 
+void CFileCache::Refill()
+{
+  if (m_seekPossible == 0)
+    return;
+
+  // only strategies that keep data away from the write position need this
+  int64_t cacheEnd = m_pCache->CachedDataEndPos();
+  if (cacheEnd < 0 || (GetLength() > 0 && cacheEnd >= GetLength()))
+    return;
+
+  m_seekPos = cacheEnd;
+  m_seekRefill = true;
+  m_seekEvent.Set();
+}
+
+void CFileCache::UpdateReadRate()
+{
+  unsigned now = XbmcThreads::SystemClockMillis();
+  unsigned elapsed = now - m_readRateStamp;
+  if (elapsed < READ_RATE_INTERVAL)
+    return;
+
+  // smooth over the bursts in which the demuxer reads
+  unsigned rate = (unsigned)(1000 * (m_readPos - m_readRatePos) / elapsed);
+  m_readRate = m_readRate ? (3 * m_readRate + rate) / 4 : rate;
+  m_readRatePos = m_readPos;
+  m_readRateStamp = now;
+}
+
+int64_t CFileCache::GetReadAhead()
+{
+  if (g_advancedSettings.m_cacheReadAheadTime == 0)
+    return std::numeric_limits<int64_t>::max();
+
+  // the throttle rate is set from the stream's average bitrate, the read rate is what the player actually consumes
+  unsigned rate = std::max(m_writeRate, m_readRate);
+  return std::max((int64_t)rate * g_advancedSettings.m_cacheReadAheadTime, (int64_t)2 * m_chunkSize);
+}
+
 void CFileCache::Close()
 {
   StopThread();
@@ -468,6 +561,7 @@ int CFileCache::IoControl(EIoControl request, void* param)
     status->forward = m_pCache->WaitForData(0, 0);
     status->maxrate = m_writeRate;
     status->currate = m_writeRateActual;
+    status->readrate = m_readRate;
     status->full    = m_cacheFull;
     return 0;
   }
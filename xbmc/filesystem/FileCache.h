@@ -61,6 +61,10 @@ namespace XFILE
     virtual CStdString GetContent();
 
   private:
+    void Refill();
+    void UpdateReadRate();
+    int64_t GetReadAhead();
+
     CCacheStrategy *m_pCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
@@ -70,11 +74,15 @@ namespace XFILE
     CEvent      m_seekEnded;
     int64_t      m_nSeekResult;
     int64_t      m_seekPos;
+    bool         m_seekRefill;
     int64_t      m_readPos;
     int64_t      m_writePos;
     unsigned     m_chunkSize;
     unsigned     m_writeRate;
     unsigned     m_writeRateActual;
+    unsigned     m_readRate;      ///< smoothed rate the reader consumes the cache at
+    int64_t      m_readRatePos;   ///< read position at the start of the current rate sample
+    unsigned     m_readRateStamp; ///< time at the start of the current rate sample
     bool         m_cacheFull;
     CCriticalSection m_sync;
   };
@@ -34,6 +34,7 @@ struct SCacheStatus
   uint64_t forward;  /**< number of bytes cached forward of current position */
   unsigned maxrate;  /**< maximum number of bytes per second cache is allowed to fill */
   unsigned currate;  /**< average read rate from source file since last position change */
+  unsigned readrate; /**< average rate the cache is consumed at */
   bool     full;     /**< is the cache full */
 };
 
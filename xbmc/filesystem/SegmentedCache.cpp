@@ -0,0 +1,359 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/SystemClock.h"
+#include "system.h"
+#include "utils/log.h"
+#include "threads/SingleLock.h"
+#include "SegmentedCache.h"
+
+using namespace XFILE;
+
+#define SEGMENT_BLOCK_SIZE (64 * 1024)
+#define PIN_HEAD_SIZE      (1024 * 1024) /* file header, always pinned */
+#define PIN_RUN_SIZE       (1024 * 1024) /* runs between seeks up to this size are pinned */
+#define MAX_PIN_RANGES     64
+
+CSegmentedCache::CSegmentedCache(size_t size, size_t front)
+ : CCacheStrategy()
+ , m_maxBlocks(std::max<size_t>(size / SEGMENT_BLOCK_SIZE, 2))
+ , m_maxPinned(m_maxBlocks / 4)
+ , m_pinned(0)
+ , m_front(std::min(front, (m_maxBlocks - m_maxPinned - 1) * SEGMENT_BLOCK_SIZE))
+ , m_used(0)
+ , m_cur(0)
+ , m_end(0)
+ , m_run(0)
+{
+}
+
+CSegmentedCache::~CSegmentedCache()
+{
+  Close();
+}
+
+int CSegmentedCache::Open()
+{
+  Close();
+
+  CSingleLock lock(m_sync);
+  m_cur = 0;
+  m_end = 0;
+  m_run = 0;
+  m_used = 0;
+  PinRange(0, PIN_HEAD_SIZE);
+  return CACHE_RC_OK;
+}
+
+void CSegmentedCache::Close()
+{
+  CSingleLock lock(m_sync);
+  for (Blocks::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+    delete[] it->second.data;
+  m_blocks.clear();
+  m_pins.clear();
+  m_pinned = 0;
+}
+
+/**
+ * Writes data at the write position, at most up to the end of the
+ * block it falls in. Multiple calls may be needed to write everything.
+ *
+ * Data that is already cached is skipped over, which happens when the
+ * writer runs into a range that was cached earlier. Data written just in
+ * front of the cached range of a block extends it, anything else that
+ * isn't contiguous with it starts the block over. Returns 0 if the
+ * read ahead is full or no block can be evicted to make room.
+ */
+int CSegmentedCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  // limit by max forward size
+  if (m_end >= m_cur && (size_t)(m_end - m_cur) >= m_front)
+    return 0;
+
+  int64_t      index  = m_end / SEGMENT_BLOCK_SIZE;
+  unsigned int offset = (unsigned int)(m_end % SEGMENT_BLOCK_SIZE);
+
+  Block *block = FindBlock(m_end);
+  if (block && offset >= block->lo && offset < block->hi)
+  {
+    len = std::min(len, (size_t)(block->hi - offset));
+    m_end += len;
+    m_written.Set();
+    return len;
+  }
+
+  if (!block && (block = AllocBlock(index)) == NULL)
+    return 0;
+
+  len = std::min(len, (size_t)(SEGMENT_BLOCK_SIZE - offset));
+  if (len == 0)
+    return 0;
+
+  if (offset < block->lo && offset + len >= block->lo)
+  { // new data runs into what we have, fill in up to it and skip over it on the next call
+    len = block->lo - offset;
+    block->lo = offset;
+  }
+  else
+  {
+    // data we have isn't contiguous with the new data, start the block over
+    if (offset != block->hi)
+    {
+      block->lo = offset;
+      block->hi = offset;
+    }
+    block->hi += len;
+  }
+
+  memcpy(block->data + offset, buf, len);
+  block->used = ++m_used;
+  m_end      += len;
+
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Reads cached data at the read position, at most up to the end
+ * of the block it falls in. So multiple calls may be needed.
+ */
+int CSegmentedCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  unsigned int offset = (unsigned int)(m_cur % SEGMENT_BLOCK_SIZE);
+  Block *block = FindBlock(m_cur);
+  if (!block || offset < block->lo || offset >= block->hi)
+  {
+    if (IsEndOfInput() && m_cur >= m_end)
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  len = std::min(len, (size_t)(block->hi - offset));
+  if (len == 0)
+    return 0;
+
+  memcpy(buf, block->data + offset, len);
+  block->used = ++m_used;
+  m_cur += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+int64_t CSegmentedCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = ContiguousEnd(m_cur) - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_front)
+    minimum = m_front;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = ContiguousEnd(m_cur) - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CSegmentedCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we are writing, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000 && ContiguousEnd(m_cur) == m_end)
+  {
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  if (pos == m_end || ContiguousEnd(pos) > pos)
+  {
+    m_cur = pos;
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+void CSegmentedCache::Reset(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  EndRun();
+  m_end = pos;
+  m_cur = pos;
+  m_run = pos;
+}
+
+int64_t CSegmentedCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+  int64_t end = ContiguousEnd(m_cur);
+
+  // the writer is filling the data following the read position already
+  if (m_end >= m_cur && m_end <= end)
+    return -1;
+
+  return end;
+}
+
+bool CSegmentedCache::SetWritePosition(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  EndRun();
+  m_end = pos;
+  m_run = pos;
+  m_written.Set();
+  return true;
+}
+
+void CSegmentedCache::Pin(int64_t start, int64_t end)
+{
+  CSingleLock lock(m_sync);
+  PinRange(start, end);
+}
+
+CSegmentedCache::Block *CSegmentedCache::FindBlock(int64_t pos)
+{
+  Blocks::iterator it = m_blocks.find(pos / SEGMENT_BLOCK_SIZE);
+  if (it == m_blocks.end())
+    return NULL;
+  return &it->second;
+}
+
+CSegmentedCache::Block *CSegmentedCache::AllocBlock(int64_t index)
+{
+  if (m_blocks.size() >= m_maxBlocks && !EvictBlock())
+    return NULL;
+
+  Block block;
+  block.data   = new uint8_t[SEGMENT_BLOCK_SIZE];
+  block.lo     = 0;
+  block.hi     = 0;
+  block.used   = ++m_used;
+  block.pinned = m_pinned < m_maxPinned && IsPinned(index);
+  if (block.pinned)
+    m_pinned++;
+
+  return &(m_blocks[index] = block);
+}
+
+/**
+ * Drops the least recently used block that is neither pinned
+ * nor part of the data ahead of the read position.
+ */
+bool CSegmentedCache::EvictBlock()
+{
+  int64_t first = m_cur / SEGMENT_BLOCK_SIZE;
+  int64_t last  = std::max(m_end, ContiguousEnd(m_cur)) / SEGMENT_BLOCK_SIZE;
+  int64_t write = m_end / SEGMENT_BLOCK_SIZE;
+
+  Blocks::iterator victim = m_blocks.end();
+  for (Blocks::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    if (it->second.pinned || it->first == write || (it->first >= first && it->first <= last))
+      continue;
+    if (victim == m_blocks.end() || it->second.used < victim->second.used)
+      victim = it;
+  }
+
+  if (victim == m_blocks.end())
+    return false;
+
+  delete[] victim->second.data;
+  m_blocks.erase(victim);
+  return true;
+}
+
+/**
+ * Returns the end of the cached data that is contiguous with pos,
+ * or pos itself if pos isn't cached.
+ */
+int64_t CSegmentedCache::ContiguousEnd(int64_t pos)
+{
+  for (;;)
+  {
+    int64_t      index  = pos / SEGMENT_BLOCK_SIZE;
+    unsigned int offset = (unsigned int)(pos % SEGMENT_BLOCK_SIZE);
+    Blocks::const_iterator it = m_blocks.find(index);
+    if (it == m_blocks.end() || offset < it->second.lo || offset >= it->second.hi)
+      return pos;
+    pos = index * SEGMENT_BLOCK_SIZE + it->second.hi;
+  }
+}
+
+void CSegmentedCache::PinRange(int64_t start, int64_t end)
+{
+  if (end <= start || m_pinned >= m_maxPinned || m_pins.size() >= MAX_PIN_RANGES)
+    return;
+
+  m_pins.push_back(std::make_pair(start, end));
+
+  // pin what we have of it already
+  Blocks::iterator it = m_blocks.lower_bound(start / SEGMENT_BLOCK_SIZE);
+  for (; it != m_blocks.end() && it->first * SEGMENT_BLOCK_SIZE < end && m_pinned < m_maxPinned; ++it)
+  {
+    if (!it->second.pinned)
+    {
+      it->second.pinned = true;
+      m_pinned++;
+    }
+  }
+}
+
+bool CSegmentedCache::IsPinned(int64_t index) const
+{
+  int64_t start = index * SEGMENT_BLOCK_SIZE;
+  int64_t end   = start + SEGMENT_BLOCK_SIZE;
+  for (Ranges::const_iterator it = m_pins.begin(); it != m_pins.end(); ++it)
+  {
+    if (it->first < end && it->second > start)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Called when the writer is repositioned. A short run of data
+ * read between two seeks is most likely an index lookup, which
+ * tends to be repeated, so pin it.
+ */
+void CSegmentedCache::EndRun()
+{
+  if (m_run > 0 && m_end > m_run && m_end - m_run <= PIN_RUN_SIZE)
+    PinRange(m_run, m_end);
+}
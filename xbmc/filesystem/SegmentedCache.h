@@ -0,0 +1,111 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHESEGMENTED_H
+#define CACHESEGMENTED_H
+
+#include <map>
+#include <vector>
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+namespace XFILE {
+
+/*!
+ \brief Cache strategy holding a sparse set of cached byte ranges.
+
+ Unlike CCircularCache, which only keeps a single window around the read position,
+ data is kept in fixed size blocks indexed by file position, so that seeking back
+ to a range that has been read before (MKV cues, AVI indexes, the file header) is
+ served from memory instead of refetching it from the source.
+
+ Blocks are evicted in least recently used order, except for the read ahead window
+ and pinned blocks. The head of the file is pinned, as are short runs of data read
+ between two seeks, which is the typical access pattern of index lookups.
+ */
+class CSegmentedCache : public CCacheStrategy
+{
+public:
+    /*!
+     \brief Create a segmented cache.
+     \param size total amount of memory used for cached data.
+     \param front maximum amount of data read ahead of the read position.
+     */
+    CSegmentedCache(size_t size, size_t front);
+    virtual ~CSegmentedCache();
+
+    virtual int Open() ;
+    virtual void Close();
+
+    virtual int WriteToCache(const char *buf, size_t len) ;
+    virtual int ReadFromCache(char *buf, size_t len) ;
+    virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis) ;
+
+    virtual int64_t Seek(int64_t pos) ;
+    virtual void Reset(int64_t pos) ;
+
+    virtual int64_t CachedDataEndPos();
+    virtual bool SetWritePosition(int64_t pos);
+
+    /*!
+     \brief Keep a byte range cached once it has been read, e.g. a known index region.
+     The amount of pinned data is limited to a quarter of the cache size.
+     \param start first byte of the range.
+     \param end end of the range (exclusive).
+     */
+    void Pin(int64_t start, int64_t end);
+
+protected:
+    struct Block
+    {
+      uint8_t     *data;
+      unsigned int lo;      /**< offset in block of beginning of valid data */
+      unsigned int hi;      /**< offset in block of end of valid data */
+      bool         pinned;
+      uint64_t     used;    /**< value of m_used when the block was last accessed */
+    };
+    typedef std::map<int64_t, Block> Blocks;
+    typedef std::vector< std::pair<int64_t, int64_t> > Ranges;
+
+    Block  *FindBlock(int64_t pos);
+    Block  *AllocBlock(int64_t index);
+    bool    EvictBlock();
+    int64_t ContiguousEnd(int64_t pos);
+    void    PinRange(int64_t start, int64_t end);
+    bool    IsPinned(int64_t index) const;
+    void    EndRun();
+
+    Blocks            m_blocks;    /**< cached blocks by index in file */
+    Ranges            m_pins;      /**< pinned ranges in file */
+    size_t            m_maxBlocks; /**< number of blocks that fit in the cache size */
+    size_t            m_maxPinned; /**< number of blocks that may be pinned */
+    size_t            m_pinned;    /**< number of pinned blocks */
+    size_t            m_front;     /**< maximum size of read ahead */
+    uint64_t          m_used;      /**< access counter for lru eviction */
+    int64_t           m_cur;       /**< current reading index in file */
+    int64_t           m_end;       /**< current writing index in file */
+    int64_t           m_run;       /**< index in file where writing started after the last seek */
+    CCriticalSection  m_sync;
+    CEvent            m_written;
+};
+
+} // namespace XFILE
+#endif
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CircularCache.h"
+#include "filesystem/FileCache.h"
+#include "filesystem/test/TestHTTPStandIn.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/Stopwatch.h"
+#include "URL.h"
+
+#include <iostream>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+class TestFileCache : public testing::Test
+{
+protected:
+  TestFileCache()
+  {
+    readAheadTime = g_advancedSettings.m_cacheReadAheadTime;
+  }
+
+  ~TestFileCache()
+  {
+    g_advancedSettings.m_cacheReadAheadTime = readAheadTime;
+  }
+
+  /* play a stream of the given rate for a number of seconds, consuming it in 100ms steps */
+  void Play(CFileCache &file, TestHTTPStandIn &server, unsigned int rate, unsigned int seconds)
+  {
+    char buf[65536];
+    maxForward = 0;
+    maxStall = 0;
+    underruns = 0;
+    delivered = 0;
+    for (unsigned int step = 0; step < seconds * 10; step++)
+    {
+      CStopWatch watch;
+      watch.StartZero();
+      int64_t pos = file.GetPosition();
+      unsigned int want = rate / 10;
+      ASSERT_EQ(0, file.IoControl(IOCTRL_CACHE_STATUS, &status));
+      if (status.forward < want)
+        underruns++;
+      while (want > 0)
+      {
+        unsigned int rc = file.Read(buf, std::min<unsigned int>(sizeof(buf), want));
+        ASSERT_LT(0U, rc);
+        for (unsigned int i = 0; i < rc; i++)
+          ASSERT_EQ(TestHTTPStandIn::ByteAt(pos + i), buf[i]);
+        pos += rc;
+        want -= rc;
+        delivered += rc;
+      }
+      float elapsed = watch.GetElapsedMilliseconds();
+      maxStall = std::max(maxStall, elapsed);
+      if (elapsed < 100)
+        server.Sleep(100 - (unsigned int)elapsed);
+
+      ASSERT_EQ(0, file.IoControl(IOCTRL_CACHE_STATUS, &status));
+      maxForward = std::max(maxForward, status.forward);
+    }
+
+    std::cout << "forward " << testing::PrintToString(status.forward) <<
+      " (max " << testing::PrintToString(maxForward) << ") bytes, fill rate " <<
+      testing::PrintToString(status.currate) << " B/s, read rate " <<
+      testing::PrintToString(status.readrate) << " B/s, longest read " <<
+      testing::PrintToString(maxStall) << " ms, " << underruns << " underruns" << std::endl;
+  }
+
+  unsigned int readAheadTime;
+  SCacheStatus status;
+  uint64_t maxForward;
+  float maxStall;
+  unsigned int underruns; ///< steps that found less than they wanted in the cache
+  uint64_t delivered;     ///< bytes read, each checked against the source
+};
+
+/* A source that is much faster than the stream: caching should stop at the
+ * read ahead target instead of filling the whole cache.
+ */
+TEST_F(TestFileCache, ReadAhead)
+{
+  TestHTTPStandIn server(64 * 1024 * 1024, 4 * 1024 * 1024);
+  ASSERT_TRUE(server.Start());
+  g_advancedSettings.m_cacheReadAheadTime = 2;
+
+  CFileCache file(new CCircularCache(32 * 1024 * 1024, 1024 * 1024));
+  ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+
+  // as CDVDInputStreamFile::SetReadRate does for a 256 KB/s stream
+  unsigned int rate = 256 * 1024 + 1024 * 1024 / 8;
+  file.IoControl(IOCTRL_CACHE_SETRATE, &rate);
+
+  Play(file, server, 256 * 1024, 6);
+  EXPECT_EQ(6U * 10 * (256 * 1024 / 10), delivered);
+
+  // two seconds at the throttle rate, plus a read in flight
+  EXPECT_GT(2 * rate + 1024 * 1024, maxForward);
+
+  file.Close();
+}
+
+/* A source only just faster than the stream: reads should be small enough
+ * that the player never waits for a large chunk to arrive.
+ */
+TEST_F(TestFileCache, SlowSource)
+{
+  TestHTTPStandIn server(16 * 1024 * 1024, 384 * 1024);
+  ASSERT_TRUE(server.Start());
+
+  CFileCache file(new CCircularCache(32 * 1024 * 1024, 1024 * 1024));
+  ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+
+  // let the cache get a second ahead, as the player does before it starts
+  server.Sleep(1000);
+
+  // underruns and rates depend on the machine's timing, so they are only printed
+  Play(file, server, 256 * 1024, 5);
+  EXPECT_EQ(5U * 10 * (256 * 1024 / 10), delivered);
+
+  file.Close();
+}
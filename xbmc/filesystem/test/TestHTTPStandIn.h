@@ -0,0 +1,223 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+
+// winsock on windows, through xbmc/win32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#ifndef TARGET_WINDOWS
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* Minimal HTTP server standing in for a remote source. It serves a generated
+ * file, honours Range requests, optionally throttles each transfer to a given
+ * rate and records where each request started. Every connection gets its own
+ * thread, as CCurlFile keeps the previous connection open when it seeks.
+ */
+class TestHTTPStandIn : public CThread
+{
+public:
+  TestHTTPStandIn(int64_t size, unsigned int rate = 0)
+    : CThread("TestHTTPStandIn"), m_size(size), m_rate(rate), m_socket(INVALID_SOCKET), m_port(0) {}
+
+  ~TestHTTPStandIn()
+  {
+    Stop();
+  }
+
+  bool Start()
+  {
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket == INVALID_SOCKET)
+      return false;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(m_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(m_socket, 8) < 0 ||
+        getsockname(m_socket, (struct sockaddr*)&addr, &len) < 0)
+      return false;
+
+    m_port = ntohs(addr.sin_port);
+    Create();
+    return true;
+  }
+
+  void Stop()
+  {
+    StopThread();
+    for (std::vector<Connection*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+      delete *it;
+    m_connections.clear();
+    if (m_socket != INVALID_SOCKET)
+      closesocket(m_socket);
+    m_socket = INVALID_SOCKET;
+  }
+
+  std::string GetURL() const
+  {
+    char url[64];
+    sprintf(url, "http://127.0.0.1:%d/standin.mkv", m_port);
+    return url;
+  }
+
+  std::vector<int64_t> GetRequests()
+  {
+    CSingleLock lock(m_section);
+    return m_requests;
+  }
+
+  void ClearRequests()
+  {
+    CSingleLock lock(m_section);
+    m_requests.clear();
+  }
+
+  /* content of the served file at pos */
+  static char ByteAt(int64_t pos)
+  {
+    return (char)(pos * 7 + (pos >> 16));
+  }
+
+protected:
+  class Connection : public CThread
+  {
+  public:
+    Connection(TestHTTPStandIn *server, SOCKET socket) : CThread("TestHTTPStandIn"), m_server(server), m_socket(socket) {}
+
+    ~Connection()
+    {
+      m_bStop = true;
+      shutdown(m_socket, SHUT_RDWR);
+      StopThread();
+      closesocket(m_socket);
+    }
+
+  protected:
+    virtual void Process()
+    {
+      std::string request;
+      char buf[16384];
+      while (request.find("\r\n\r\n") == std::string::npos)
+      {
+        int rc = recv(m_socket, buf, sizeof(buf), 0);
+        if (rc <= 0)
+          return;
+        request.append(buf, rc);
+      }
+
+      int64_t start = 0;
+      size_t range = request.find("Range: bytes=");
+      if (range != std::string::npos)
+        start = strtoll(request.c_str() + range + 13, NULL, 10);
+      bool head = request.compare(0, 4, "HEAD") == 0;
+
+      int64_t size = m_server->m_size;
+      if (range != std::string::npos)
+        sprintf(buf, "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lld-%lld/%lld\r\n",
+                (long long)start, (long long)size - 1, (long long)size);
+      else
+        sprintf(buf, "HTTP/1.1 200 OK\r\n");
+      sprintf(buf + strlen(buf), "Content-Length: %lld\r\nAccept-Ranges: bytes\r\nConnection: close\r\n\r\n",
+              (long long)(size - start));
+      if (send(m_socket, buf, strlen(buf), MSG_NOSIGNAL) <= 0 || head)
+        return;
+
+      {
+        CSingleLock lock(m_server->m_section);
+        m_server->m_requests.push_back(start);
+      }
+
+      unsigned int begin = XbmcThreads::SystemClockMillis();
+      for (int64_t pos = start; pos < size && !m_bStop; )
+      {
+        int len = (int)std::min<int64_t>(sizeof(buf), size - pos);
+        for (int i = 0; i < len; i++)
+          buf[i] = ByteAt(pos + i);
+        int rc = send(m_socket, buf, len, MSG_NOSIGNAL);
+        if (rc <= 0)
+          return;
+        pos += rc;
+
+        // throttle to the configured rate
+        if (m_server->m_rate)
+        {
+          int64_t due = (pos - start) * 1000 / m_server->m_rate;
+          int64_t elapsed = XbmcThreads::SystemClockMillis() - begin;
+          if (due > elapsed)
+            Sleep((unsigned int)(due - elapsed));
+        }
+      }
+    }
+
+  private:
+    TestHTTPStandIn *m_server;
+    SOCKET           m_socket;
+  };
+
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET(m_socket, &set);
+      struct timeval tv = { 0, 100000 };
+      if (select((int)m_socket + 1, &set, NULL, NULL, &tv) <= 0)
+        continue;
+
+      SOCKET client = accept(m_socket, NULL, NULL);
+      if (client == INVALID_SOCKET)
+        continue;
+
+      Connection *connection = new Connection(this, client);
+      m_connections.push_back(connection);
+      connection->Create();
+    }
+  }
+
+private:
+  int64_t                  m_size;
+  unsigned int             m_rate;
+  SOCKET                   m_socket;
+  int                      m_port;
+  std::vector<Connection*> m_connections;
+  std::vector<int64_t>     m_requests;
+  CCriticalSection         m_section;
+};
+
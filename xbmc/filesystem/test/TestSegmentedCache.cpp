@@ -0,0 +1,250 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/SegmentedCache.h"
+#include "filesystem/CircularCache.h"
+#include "filesystem/FileCache.h"
+#include "filesystem/test/TestHTTPStandIn.h"
+#include "utils/Stopwatch.h"
+#include "URL.h"
+
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static const int64_t TestSegmentedCacheSize = 32 * 1024 * 1024;
+
+/* write len bytes of the generated file at pos, as CFileCache does */
+static int64_t TestSegmentedCacheWrite(CCacheStrategy &cache, int64_t pos, int64_t len)
+{
+  char buf[16384];
+  int64_t done = 0;
+  while (done < len)
+  {
+    int chunk = (int)std::min<int64_t>(sizeof(buf), len - done);
+    for (int i = 0; i < chunk; i++)
+      buf[i] = TestHTTPStandIn::ByteAt(pos + done + i);
+    for (int written = 0; written < chunk; )
+    {
+      int rc = cache.WriteToCache(buf + written, chunk - written);
+      if (rc <= 0)
+        return done + written;
+      written += rc;
+    }
+    done += chunk;
+  }
+  return done;
+}
+
+/* read len bytes at the read position and check they match the generated file at pos */
+static bool TestSegmentedCacheRead(CCacheStrategy &cache, int64_t pos, int64_t len)
+{
+  char buf[16384];
+  int64_t done = 0;
+  while (done < len)
+  {
+    int rc = cache.ReadFromCache(buf, (size_t)std::min<int64_t>(sizeof(buf), len - done));
+    if (rc <= 0)
+      return false;
+    for (int i = 0; i < rc; i++)
+    {
+      if (buf[i] != TestHTTPStandIn::ByteAt(pos + done + i))
+        return false;
+    }
+    done += rc;
+  }
+  return true;
+}
+
+TEST(TestSegmentedCache, SeekBack)
+{
+  CSegmentedCache cache(8 * 1024 * 1024, 4 * 1024 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // header
+  EXPECT_EQ(300000, TestSegmentedCacheWrite(cache, 0, 300000));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, 0, 200000));
+
+  // index at the end of the file, not cached yet
+  const int64_t index = 100 * 1024 * 1024;
+  EXPECT_GT(0, cache.Seek(index));
+  cache.Reset(index);
+  EXPECT_EQ(200000, TestSegmentedCacheWrite(cache, index, 200000));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, index, 150000));
+
+  // back to the header, which is still cached
+  EXPECT_EQ(1000, cache.Seek(1000));
+  EXPECT_EQ(300000, cache.CachedDataEndPos());
+  EXPECT_TRUE(cache.SetWritePosition(300000));
+  EXPECT_EQ(-1, cache.CachedDataEndPos());
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, 1000, 299000));
+
+  // and the index too
+  EXPECT_EQ(index + 10, cache.Seek(index + 10));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, index + 10, 100000));
+
+  cache.Close();
+}
+
+TEST(TestSegmentedCache, Eviction)
+{
+  CSegmentedCache cache(8 * 1024 * 1024, 4 * 1024 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // a short run between two seeks gets pinned
+  const int64_t index = 100 * 1024 * 1024;
+  cache.Reset(index);
+  EXPECT_EQ(200000, TestSegmentedCacheWrite(cache, index, 200000));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, index, 200000));
+
+  // stream far more than the cache holds
+  cache.Reset(0);
+  int64_t pos = 0;
+  while (pos < 40 * 1024 * 1024)
+  {
+    int64_t written = TestSegmentedCacheWrite(cache, pos, 100000);
+    ASSERT_TRUE(TestSegmentedCacheRead(cache, pos, written));
+    pos += written;
+  }
+
+  // the head of the file and the short run are pinned
+  EXPECT_EQ(5, cache.Seek(5));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, 5, 500000));
+  EXPECT_EQ(index, cache.Seek(index));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, index, 200000));
+
+  // the least recently used data is gone
+  EXPECT_GT(0, cache.Seek(10 * 1024 * 1024));
+
+  // writing over cached data skips it
+  cache.Reset(index - 1000);
+  EXPECT_EQ(5000, TestSegmentedCacheWrite(cache, index - 1000, 5000));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, index - 1000, 5000));
+
+  cache.Close();
+}
+
+TEST(TestSegmentedCache, SeekBackInBlock)
+{
+  CSegmentedCache cache(8 * 1024 * 1024, 4 * 1024 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // the second half of a block is cached first
+  const int64_t block = 10 * 64 * 1024;
+  cache.Reset(block + 32768);
+  EXPECT_EQ(16384, TestSegmentedCacheWrite(cache, block + 32768, 16384));
+
+  // then the writer seeks back into the same block and runs into it
+  cache.Reset(block + 20000);
+  EXPECT_EQ(60000, TestSegmentedCacheWrite(cache, block + 20000, 60000));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, block + 20000, 60000));
+
+  // the range cached first is still there
+  EXPECT_EQ(block + 40000, cache.Seek(block + 40000));
+  EXPECT_TRUE(TestSegmentedCacheRead(cache, block + 40000, 8000));
+
+  // writing past a gap in the block starts it over
+  cache.Reset(block + 63000);
+  EXPECT_EQ(500, TestSegmentedCacheWrite(cache, block + 63000, 500));
+  EXPECT_GT(0, cache.Seek(block + 20000));
+
+  cache.Close();
+}
+
+/* read len bytes at the current position of the file and check them */
+static bool TestSegmentedCacheRead(CFileCache &file, int64_t len)
+{
+  char buf[32768];
+  int64_t pos = file.GetPosition();
+  for (int64_t done = 0; done < len; )
+  {
+    unsigned int rc = file.Read(buf, std::min<int64_t>(sizeof(buf), len - done));
+    if (rc == 0)
+      return false;
+    for (unsigned int i = 0; i < rc; i++)
+    {
+      if (buf[i] != TestHTTPStandIn::ByteAt(pos + done + i))
+        return false;
+    }
+    done += rc;
+  }
+  return true;
+}
+
+class TestSegmentedCacheHTTP : public testing::Test
+{
+protected:
+  TestSegmentedCacheHTTP() : server(TestSegmentedCacheSize), refetches(0)
+  {
+    server.Start();
+  }
+
+  /* the access pattern of opening an MKV: header, cues at the end, back to the first cluster */
+  void IndexSeeks(CCacheStrategy *strategy, const char *name)
+  {
+    CFileCache file(strategy);
+    ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+    ASSERT_EQ(TestSegmentedCacheSize, file.GetLength());
+
+    EXPECT_TRUE(TestSegmentedCacheRead(file, 512 * 1024));
+    EXPECT_EQ(TestSegmentedCacheSize - 1024 * 1024, file.Seek(TestSegmentedCacheSize - 1024 * 1024, SEEK_SET));
+    EXPECT_TRUE(TestSegmentedCacheRead(file, 256 * 1024));
+
+    server.ClearRequests();
+    CStopWatch watch;
+    watch.StartZero();
+    EXPECT_EQ(4096, file.Seek(4096, SEEK_SET));
+    EXPECT_TRUE(TestSegmentedCacheRead(file, 256 * 1024));
+    float elapsed = watch.GetElapsedMilliseconds();
+
+    // count the requests for data that has been fetched before
+    std::vector<int64_t> requests = server.GetRequests();
+    refetches = 0;
+    for (std::vector<int64_t>::iterator it = requests.begin(); it != requests.end(); ++it)
+    {
+      if (*it < 512 * 1024)
+        refetches++;
+    }
+
+    // and stream the rest of the file
+    watch.StartZero();
+    EXPECT_TRUE(TestSegmentedCacheRead(file, TestSegmentedCacheSize - file.GetPosition()));
+    float streamed = watch.GetElapsedMilliseconds();
+
+    std::cout << name << ": seek back " << testing::PrintToString(elapsed) << " ms, " <<
+      testing::PrintToString(refetches) << " refetches, " <<
+      testing::PrintToString(streamed > 0 ? TestSegmentedCacheSize / 1024 / streamed : 0) << " MB/s" << std::endl;
+
+    file.Close();
+  }
+
+  TestHTTPStandIn server;
+  int refetches;
+};
+
+TEST_F(TestSegmentedCacheHTTP, IndexSeeks)
+{
+  IndexSeeks(new CCircularCache(4 * 1024 * 1024, 1024 * 1024), "Circular cache");
+  IndexSeeks(new CSegmentedCache(5 * 1024 * 1024, 4 * 1024 * 1024), "Segmented cache");
+  EXPECT_EQ(0, refetches);
+}
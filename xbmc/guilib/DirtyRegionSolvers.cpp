@@ -21,6 +21,13 @@
 #include "DirtyRegionSolvers.h"
 #include "GraphicContext.h"
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// beyond these the tile solver falls back to a union: coordinates far off screen, or
+// damage so scattered that picking the regions to merge costs more than it saves
+#define TILES_MAX_TILES   65536
+#define TILES_MAX_MERGE   64
 
 void CUnionDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
 {
@@ -81,3 +88,135 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+CTileDirtyRegionSolver::CTileDirtyRegionSolver(float tileSize, unsigned int maxRegions)
+{
+  m_tileSize = tileSize;
+  m_maxRegions = maxRegions;
+}
+
+void CTileDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  CRect bounds;
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    if (input[i].Width() > 0 && input[i].Height() > 0)
+      bounds.Union(input[i]);
+  }
+  if (bounds.IsEmpty())
+    return;
+
+  int left = (int)floorf(bounds.x1 / m_tileSize);
+  int top = (int)floorf(bounds.y1 / m_tileSize);
+  int columns = (int)ceilf(bounds.x2 / m_tileSize) - left;
+  int rows = (int)ceilf(bounds.y2 / m_tileSize) - top;
+  if (columns <= 0 || rows <= 0 || columns > TILES_MAX_TILES / rows)
+  {
+    output.push_back(bounds);
+    return;
+  }
+
+  // mark the tiles touched by each region
+  m_tiles.assign(columns * rows, 0);
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    const CDirtyRegion &region = input[i];
+    if (region.Width() <= 0 || region.Height() <= 0)
+      continue;
+    int x1 = (int)floorf(region.x1 / m_tileSize) - left;
+    int x2 = (int)ceilf(region.x2 / m_tileSize) - left;
+    int y1 = (int)floorf(region.y1 / m_tileSize) - top;
+    int y2 = (int)ceilf(region.y2 / m_tileSize) - top;
+    for (int y = y1; y < y2; y++)
+      memset(&m_tiles[y * columns + x1], 1, x2 - x1);
+  }
+
+  // join each row's runs of damaged tiles, extending the rectangle above when it has the same run
+  CDirtyRegionList regions;
+  std::vector<int> above(columns, -1), current(columns, -1); // region of the run starting at each column
+  for (int y = 0; y < rows; y++)
+  {
+    const unsigned char *row = &m_tiles[y * columns];
+    for (int x = 0; x < columns; )
+    {
+      if (!row[x])
+      {
+        x++;
+        continue;
+      }
+      int start = x;
+      while (x < columns && row[x])
+        x++;
+
+      int region = above[start];
+      if (region >= 0 && regions[region].x2 == (left + x) * m_tileSize)
+        regions[region].y2 = (top + y + 1) * m_tileSize;
+      else
+      {
+        region = regions.size();
+        regions.push_back(CDirtyRegion((left + start) * m_tileSize, (top + y) * m_tileSize,
+                                       (left + x) * m_tileSize, (top + y + 1) * m_tileSize));
+      }
+      current[start] = region;
+    }
+    above.swap(current);
+    current.assign(columns, -1);
+  }
+
+  // tiles overhang the damage, so shrink each rectangle to what was marked within it
+  for (unsigned int i = 0; i < regions.size(); i++)
+  {
+    CDirtyRegion damage;
+    for (unsigned int j = 0; j < input.size(); j++)
+    {
+      CRect overlap(input[j]);
+      overlap.Intersect(regions[i]);
+      if (!overlap.IsEmpty())
+        damage.Union(overlap);
+    }
+    regions[i] = damage;
+  }
+
+  MergeRegions(regions);
+  output.insert(output.end(), regions.begin(), regions.end());
+}
+
+void CTileDirtyRegionSolver::MergeRegions(CDirtyRegionList &regions) const
+{
+  if (regions.size() > TILES_MAX_MERGE)
+  {
+    CDirtyRegion unifiedRegion;
+    for (unsigned int i = 0; i < regions.size(); i++)
+      unifiedRegion.Union(regions[i]);
+    regions.assign(1, unifiedRegion);
+    return;
+  }
+
+  while (regions.size() > 1)
+  {
+    // find the pair that grows the redrawn area the least when merged
+    unsigned int first = 0, second = 1;
+    float cheapest = 0;
+    for (unsigned int i = 0; i < regions.size(); i++)
+    {
+      for (unsigned int j = i + 1; j < regions.size(); j++)
+      {
+        CRect merged(regions[i]);
+        merged.Union(regions[j]);
+        float cost = merged.Area() - regions[i].Area() - regions[j].Area();
+        if ((i == 0 && j == 1) || cost < cheapest)
+        {
+          first = i;
+          second = j;
+          cheapest = cost;
+        }
+      }
+    }
+
+    if (regions.size() <= m_maxRegions && cheapest > m_tileSize * m_tileSize)
+      break;
+
+    regions[first].Union(regions[second]);
+    regions.erase(regions.begin() + second);
+  }
+}
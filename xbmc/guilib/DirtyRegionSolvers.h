@@ -20,6 +20,7 @@
  */
 
 #include "IDirtyRegionSolver.h"
+#include <vector>
 
 class CUnionDirtyRegionSolver : public IDirtyRegionSolver
 {
@@ -48,3 +49,26 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*!
+ \brief Redraws only the tiles of a grid that have been damaged in any of the buffered frames.
+
+ The marked regions of the last few frames are rasterized onto a grid of tiles. Runs of damaged
+ tiles are joined into rectangles, which are shrunk to the damage they contain.  This keeps the
+ redrawn area small when a few small elements such as a clock, a spinner and a scrolling label
+ animate in different corners of the screen, which union-based solvers would merge into most of
+ it.  As each region costs a render pass, regions are merged while there are more than maxRegions
+ of them, or while merging adds less than a tile of area.
+ */
+class CTileDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  CTileDirtyRegionSolver(float tileSize = 32.0f, unsigned int maxRegions = 6);
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+private:
+  void MergeRegions(CDirtyRegionList &regions) const;
+
+  float m_tileSize;
+  unsigned int m_maxRegions;
+  std::vector<unsigned char> m_tiles; ///< the damaged tiles of the last Solve(), kept to save reallocating
+};
@@ -35,10 +35,15 @@ CDirtyRegionTracker::~CDirtyRegionTracker()
 }
 
 void CDirtyRegionTracker::SelectAlgorithm()
+{
+  SelectAlgorithm(g_advancedSettings.m_guiAlgorithmDirtyRegions);
+}
+
+void CDirtyRegionTracker::SelectAlgorithm(int algorithm)
 {
   delete m_solver;
 
-  switch (g_advancedSettings.m_guiAlgorithmDirtyRegions)
+  switch (algorithm)
   {
     case DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE:
       CLog::Log(LOGDEBUG, "guilib: Fill viewport on change for solving rendering passes");
@@ -52,6 +57,10 @@ void CDirtyRegionTracker::SelectAlgorithm()
       m_solver = new CUnionDirtyRegionSolver();
       CLog::Log(LOGDEBUG, "guilib: Union as algorithm for solving rendering passes");
       break;
+    case DIRTYREGION_SOLVER_TILES:
+      CLog::Log(LOGDEBUG, "guilib: Damaged tiles as algorithm for solving rendering passes");
+      m_solver = new CTileDirtyRegionSolver();
+      break;
     case DIRTYREGION_SOLVER_FILL_VIEWPORT_ALWAYS:
     default:
       CLog::Log(LOGDEBUG, "guilib: Fill viewport always for solving rendering passes");
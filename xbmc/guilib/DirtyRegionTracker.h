@@ -34,6 +34,7 @@ public:
   CDirtyRegionTracker(int buffering = DEFAULT_BUFFERING);
   ~CDirtyRegionTracker();
   void SelectAlgorithm();
+  void SelectAlgorithm(int algorithm); ///< one of DIRTYREGION_SOLVER_*
   void MarkDirtyRegion(const CDirtyRegion &region);
 
   const CDirtyRegionList &GetMarkedRegions() const;
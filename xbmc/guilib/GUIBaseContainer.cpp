@@ -160,7 +160,8 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
   {
     if (!item->GetFocusedLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_focusedLayout);
+      CGUIListItemLayout *layout = m_focusedLayoutPool.Acquire(*m_focusedLayout);
+      layout->RestoreState(item->DetachLayoutState(true));
       item->SetFocusedLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -187,7 +188,8 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
       item->GetFocusedLayout()->SetFocusedItem(0);  // focus is not set
     if (!item->GetLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_layout);
+      CGUIListItemLayout *layout = m_layoutPool.Acquire(*m_layout);
+      layout->RestoreState(item->DetachLayoutState(false));
       item->SetLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -812,6 +814,8 @@ void CGUIBaseContainer::FreeResources(bool immediately)
   { // free any static content
     Reset();
   }
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
   m_scroller.Stop();
 }
 
@@ -1086,17 +1090,30 @@ void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      ReleaseLayouts(m_items[i].get());
     for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      ReleaseLayouts(m_items[i].get());
   }
   else
   { // wrapping
     for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      ReleaseLayouts(m_items[i].get());
   }
 }
 
+void CGUIBaseContainer::ReleaseLayouts(CGUIListItem *item)
+{
+  // keep enough layouts around to fill all the items kept in memory, see Process()
+  unsigned int maxPooled = m_itemsPerPage + m_cacheItems + 2;
+  // the item keeps what its layouts were in the middle of, for the next layouts it gets
+  if (item->GetLayout())
+    item->SetLayoutState(item->GetLayout()->SaveState(), false);
+  if (item->GetFocusedLayout())
+    item->SetLayoutState(item->GetFocusedLayout()->SaveState(), true);
+  m_layoutPool.Release(item->DetachLayout(), maxPooled);
+  m_focusedLayoutPool.Release(item->DetachFocusedLayout(), maxPooled);
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -141,6 +141,7 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void ReleaseLayouts(CGUIListItem *item);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -164,6 +165,9 @@ protected:
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
 
+  CGUIListItemLayoutPool m_layoutPool;        ///< unused copies of m_layout
+  CGUIListItemLayoutPool m_focusedLayoutPool; ///< unused copies of m_focusedLayout
+
   void ScrollToOffset(int offset);
   void SetContainerMoving(int direction);
   void UpdateScrollOffset(unsigned int currentTime);
@@ -0,0 +1,380 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUICompiledXML.h"
+#include "GUIInfoManager.h"
+#include "filesystem/File.h"
+#include "utils/log.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <string.h>
+
+using namespace std;
+
+// bump whenever the layout below changes
+#define COMPILED_XML_MAGIC    "XBCX"
+#define COMPILED_XML_FORMAT   1
+
+// deeper than any sane skin, guards against recursing through a corrupt file
+#define COMPILED_XML_MAX_DEPTH 256
+
+enum CompiledNodeType
+{
+  COMPILED_NODE_ELEMENT = 0,
+  COMPILED_NODE_TEXT
+};
+
+/*
+ File layout, all numbers in host byte order as the file never leaves the machine it was made on:
+   magic, format
+   version string
+   dependency count, then for each: path, modification time, size
+   condition count, then for each: expression, value
+   string count, then each string
+   the root element
+
+ Strings are a uint32 length followed by the characters. Nodes are a type byte and the string index
+ of their value, followed for elements by the attribute count, the name and value index of each
+ attribute, the child count and each child.
+ */
+
+static void WriteUInt32(string &data, uint32_t value)
+{
+  data.append((const char *)&value, sizeof(value));
+}
+
+static void WriteInt64(string &data, int64_t value)
+{
+  data.append((const char *)&value, sizeof(value));
+}
+
+static void WriteString(string &data, const string &value)
+{
+  WriteUInt32(data, value.size());
+  data.append(value);
+}
+
+class CGUICompiledXML::CReader
+{
+public:
+  CReader(const string &data) : m_data(data), m_pos(0), m_ok(true) {}
+
+  bool Ok() const { return m_ok; }
+  bool AtEnd() const { return m_pos == m_data.size(); }
+
+  bool Read(void *buffer, size_t size)
+  {
+    if (!m_ok || m_data.size() - m_pos < size)
+      return m_ok = false;
+    memcpy(buffer, m_data.c_str() + m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  uint32_t ReadUInt32()
+  {
+    uint32_t value = 0;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  int64_t ReadInt64()
+  {
+    int64_t value = 0;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  uint8_t ReadByte()
+  {
+    uint8_t value = 0;
+    Read(&value, sizeof(value));
+    return value;
+  }
+
+  string ReadString()
+  {
+    uint32_t size = ReadUInt32();
+    if (!m_ok || m_data.size() - m_pos < size)
+    {
+      m_ok = false;
+      return "";
+    }
+    m_pos += size;
+    return m_data.substr(m_pos - size, size);
+  }
+
+private:
+  const string &m_data;
+  size_t m_pos;
+  bool m_ok;
+};
+
+bool CGUICompiledXML::StatFile(const CStdString &file, int64_t &time, int64_t &size)
+{
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(file, &st) != 0)
+    return false;
+  time = st.st_mtime;
+  size = st.st_size;
+  return true;
+}
+
+void CGUICompiledXML::CollectStrings(const TiXmlNode *node, map<string, unsigned int> &strings)
+{
+  strings.insert(make_pair(string(node->Value()), (unsigned int)strings.size()));
+  if (node->Type() != TiXmlNode::TINYXML_ELEMENT)
+    return;
+
+  for (const TiXmlAttribute *attribute = node->ToElement()->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    strings.insert(make_pair(string(attribute->Name()), (unsigned int)strings.size()));
+    strings.insert(make_pair(string(attribute->Value()), (unsigned int)strings.size()));
+  }
+  for (const TiXmlNode *child = node->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->Type() == TiXmlNode::TINYXML_ELEMENT || child->Type() == TiXmlNode::TINYXML_TEXT)
+      CollectStrings(child, strings);
+  }
+}
+
+void CGUICompiledXML::WriteNode(const TiXmlNode *node, const map<string, unsigned int> &strings, string &data)
+{
+  bool element = node->Type() == TiXmlNode::TINYXML_ELEMENT;
+  data.push_back((char)(element ? COMPILED_NODE_ELEMENT : COMPILED_NODE_TEXT));
+  WriteUInt32(data, strings.find(node->Value())->second);
+  if (!element)
+    return;
+
+  uint32_t count = 0;
+  for (const TiXmlAttribute *attribute = node->ToElement()->FirstAttribute(); attribute; attribute = attribute->Next())
+    count++;
+  WriteUInt32(data, count);
+  for (const TiXmlAttribute *attribute = node->ToElement()->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    WriteUInt32(data, strings.find(attribute->Name())->second);
+    WriteUInt32(data, strings.find(attribute->Value())->second);
+  }
+
+  // comments and the like are dropped
+  count = 0;
+  for (const TiXmlNode *child = node->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->Type() == TiXmlNode::TINYXML_ELEMENT || child->Type() == TiXmlNode::TINYXML_TEXT)
+      count++;
+  }
+  WriteUInt32(data, count);
+  for (const TiXmlNode *child = node->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->Type() == TiXmlNode::TINYXML_ELEMENT || child->Type() == TiXmlNode::TINYXML_TEXT)
+      WriteNode(child, strings, data);
+  }
+}
+
+TiXmlNode *CGUICompiledXML::ReadNode(CReader &reader, const vector<string> &strings, unsigned int depth)
+{
+  uint8_t type = reader.ReadByte();
+  uint32_t value = reader.ReadUInt32();
+  if (!reader.Ok() || value >= strings.size() || depth > COMPILED_XML_MAX_DEPTH)
+    return NULL;
+
+  if (type == COMPILED_NODE_TEXT)
+    return new TiXmlText(strings[value].c_str());
+  if (type != COMPILED_NODE_ELEMENT)
+    return NULL;
+
+  TiXmlElement *element = new TiXmlElement(strings[value].c_str());
+  uint32_t count = reader.ReadUInt32();
+  for (uint32_t i = 0; i < count && reader.Ok(); i++)
+  {
+    uint32_t name = reader.ReadUInt32();
+    uint32_t attribute = reader.ReadUInt32();
+    if (name >= strings.size() || attribute >= strings.size())
+    {
+      delete element;
+      return NULL;
+    }
+    element->SetAttribute(strings[name].c_str(), strings[attribute].c_str());
+  }
+
+  count = reader.ReadUInt32();
+  for (uint32_t i = 0; i < count && reader.Ok(); i++)
+  {
+    TiXmlNode *child = ReadNode(reader, strings, depth + 1);
+    if (!child)
+    {
+      delete element;
+      return NULL;
+    }
+    element->LinkEndChild(child);
+  }
+
+  if (!reader.Ok())
+  {
+    delete element;
+    return NULL;
+  }
+  return element;
+}
+
+void CGUICompiledXML::Compile(const TiXmlElement *root, const CStdString &version, const vector<CStdString> &dependencies,
+                              const map<int, bool> &conditions, string &data)
+{
+  data.clear();
+  data.append(COMPILED_XML_MAGIC);
+  WriteUInt32(data, COMPILED_XML_FORMAT);
+  WriteString(data, version);
+
+  WriteUInt32(data, dependencies.size());
+  for (vector<CStdString>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it)
+  {
+    int64_t time = 0, size = -1;
+    StatFile(*it, time, size);
+    WriteString(data, *it);
+    WriteInt64(data, time);
+    WriteInt64(data, size);
+  }
+
+  WriteUInt32(data, conditions.size());
+  for (map<int, bool>::const_iterator it = conditions.begin(); it != conditions.end(); ++it)
+  {
+    WriteString(data, g_infoManager.GetBoolExpression(it->first));
+    data.push_back((char)(it->second ? 1 : 0));
+  }
+
+  map<string, unsigned int> strings;
+  CollectStrings(root, strings);
+  vector<const string *> table(strings.size());
+  for (map<string, unsigned int>::const_iterator it = strings.begin(); it != strings.end(); ++it)
+    table[it->second] = &it->first;
+  WriteUInt32(data, table.size());
+  for (vector<const string *>::const_iterator it = table.begin(); it != table.end(); ++it)
+    WriteString(data, **it);
+
+  WriteNode(root, strings, data);
+}
+
+TiXmlElement *CGUICompiledXML::Decompile(const string &data, const CStdString &version, map<int, bool> &conditions,
+                                         bool *conditionsChanged)
+{
+  conditions.clear();
+  if (conditionsChanged)
+    *conditionsChanged = false;
+  CReader reader(data);
+
+  char magic[4];
+  if (!reader.Read(magic, sizeof(magic)) || memcmp(magic, COMPILED_XML_MAGIC, sizeof(magic)) != 0 ||
+      reader.ReadUInt32() != COMPILED_XML_FORMAT || reader.ReadString() != version || !reader.Ok())
+    return NULL;
+
+  // any of the source files changed?
+  uint32_t count = reader.ReadUInt32();
+  for (uint32_t i = 0; i < count && reader.Ok(); i++)
+  {
+    CStdString file = reader.ReadString();
+    int64_t time = reader.ReadInt64();
+    int64_t size = reader.ReadInt64();
+    int64_t currentTime = 0, currentSize = -1;
+    StatFile(file, currentTime, currentSize);
+    if (time != currentTime || size != currentSize)
+      return NULL;
+  }
+
+  // any of the include conditions evaluating differently?
+  count = reader.ReadUInt32();
+  for (uint32_t i = 0; i < count && reader.Ok(); i++)
+  {
+    CStdString expression = reader.ReadString();
+    bool value = reader.ReadByte() != 0;
+    int condition = g_infoManager.Register(expression);
+    if (!reader.Ok() || g_infoManager.GetBoolValue(condition) != value)
+    {
+      if (conditionsChanged)
+        *conditionsChanged = reader.Ok();
+      conditions.clear();
+      return NULL;
+    }
+    conditions[condition] = value;
+  }
+
+  count = reader.ReadUInt32();
+  if (!reader.Ok() || count > data.size())
+    return NULL;
+  vector<string> strings;
+  strings.reserve(count);
+  for (uint32_t i = 0; i < count && reader.Ok(); i++)
+    strings.push_back(reader.ReadString());
+
+  TiXmlNode *root = ReadNode(reader, strings, 0);
+  if (!root || root->Type() != TiXmlNode::TINYXML_ELEMENT || !reader.AtEnd())
+  {
+    delete root;
+    conditions.clear();
+    return NULL;
+  }
+  return root->ToElement();
+}
+
+bool CGUICompiledXML::Save(const CStdString &file, const TiXmlElement *root, const CStdString &version,
+                           const vector<CStdString> &dependencies, const map<int, bool> &conditions)
+{
+  if (!root)
+    return false;
+
+  string data;
+  Compile(root, version, dependencies, conditions, data);
+
+  XFILE::CFile output;
+  if (!output.OpenForWrite(file, true) || output.Write(data.c_str(), data.size()) != (int)data.size())
+  {
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, file.c_str());
+    output.Close();
+    XFILE::CFile::Delete(file);
+    return false;
+  }
+  output.Close();
+  return true;
+}
+
+TiXmlElement *CGUICompiledXML::Load(const CStdString &file, const CStdString &version, map<int, bool> &conditions,
+                                    bool *conditionsChanged)
+{
+  conditions.clear();
+  if (conditionsChanged)
+    *conditionsChanged = false;
+
+  XFILE::CFile input;
+  if (!input.Open(file))
+    return NULL;
+
+  int64_t length = input.GetLength();
+  if (length <= 0 || length > 64 * 1024 * 1024)
+    return NULL;
+
+  string data((size_t)length, '\0');
+  if (input.Read(&data[0], length) != length)
+    return NULL;
+  input.Close();
+
+  TiXmlElement *root = Decompile(data, version, conditions, conditionsChanged);
+  if (!root)
+    CLog::Log(LOGDEBUG, "%s - %s is out of date", __FUNCTION__, file.c_str());
+  return root;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StdString.h"
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class TiXmlElement;
+class TiXmlNode;
+
+/*!
+ \ingroup windows
+ \brief Stores skin XML with its includes, defaults and constants resolved in a compact binary form.
+
+ A compiled window is rebuilt into an XML tree with a single file read and without parsing any XML
+ or resolving any includes. Alongside the tree it records what it was resolved from:
+  - a version string, eg. the skin's id and version.
+  - the files it was resolved from, with their modification time and size.
+  - the include conditions and the values they had.
+ A compiled window is only used if all of these still match, so that changing a skin setting used
+ by an include condition or editing a skin file falls back to loading the XML.
+ */
+class CGUICompiledXML
+{
+public:
+  /*! \brief Write the compiled form of a resolved XML tree to a file.
+   \param file the file to write to.
+   \param root the XML tree with includes resolved.
+   \param version the version string that Load() must be given to accept the file.
+   \param dependencies the files the tree was resolved from.
+   \param conditions the include conditions and their values, as filled in by CGUIIncludes::ResolveIncludes.
+   \return true if the file was written.
+   \sa Load
+   */
+  static bool Save(const CStdString &file, const TiXmlElement *root, const CStdString &version,
+                   const std::vector<CStdString> &dependencies, const std::map<int, bool> &conditions);
+
+  /*! \brief Read a compiled XML tree from a file.
+   \param file the file to read from.
+   \param version the version string the file must have been saved with.
+   \param conditions [out] the include conditions of the tree and their current values.
+   \param conditionsChanged [out] if non-NULL, set to whether the file was only rejected because an include
+                            condition now has another value. Saving over it would just swap out the tree
+                            for the other value, so callers should keep it.
+   \return the XML tree, to be deleted by the caller, or NULL if the file is missing, invalid or out of date.
+   \sa Save
+   */
+  static TiXmlElement *Load(const CStdString &file, const CStdString &version, std::map<int, bool> &conditions,
+                            bool *conditionsChanged = NULL);
+
+  /*! \brief Compile an XML tree into a buffer.
+   \sa Save
+   */
+  static void Compile(const TiXmlElement *root, const CStdString &version, const std::vector<CStdString> &dependencies,
+                      const std::map<int, bool> &conditions, std::string &data);
+
+  /*! \brief Rebuild an XML tree from a buffer filled by Compile().
+   \sa Load
+   */
+  static TiXmlElement *Decompile(const std::string &data, const CStdString &version, std::map<int, bool> &conditions,
+                                 bool *conditionsChanged = NULL);
+
+private:
+  class CReader;
+
+  static void CollectStrings(const TiXmlNode *node, std::map<std::string, unsigned int> &strings);
+  static void WriteNode(const TiXmlNode *node, const std::map<std::string, unsigned int> &strings, std::string &data);
+  static TiXmlNode *ReadNode(CReader &reader, const std::vector<std::string> &strings, unsigned int depth);
+  static bool StatFile(const CStdString &file, int64_t &time, int64_t &size);
+};
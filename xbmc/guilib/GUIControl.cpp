@@ -685,6 +685,15 @@ void CGUIControl::SetAnimations(const vector<CAnimation> &animations)
   MarkDirtyRegion();
 }
 
+void CGUIControl::SetAnimationProgress(unsigned int animation, const CAnimation::Progress &progress)
+{
+  if (animation < m_animations.size())
+  {
+    m_animations[animation].SetProgress(progress);
+    MarkDirtyRegion();
+  }
+}
+
 void CGUIControl::ResetAnimation(ANIMATION_TYPE type)
 {
   MarkDirtyRegion();
@@ -218,6 +218,7 @@ public:
 
   void SetAnimations(const std::vector<CAnimation> &animations);
   const std::vector<CAnimation> &GetAnimations() const { return m_animations; };
+  void SetAnimationProgress(unsigned int animation, const CAnimation::Progress &progress);
 
   virtual void QueueAnimation(ANIMATION_TYPE anim);
   virtual bool IsAnimating(ANIMATION_TYPE anim);
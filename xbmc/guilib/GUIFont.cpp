@@ -254,6 +254,17 @@ float CGUIFont::GetTextWidth( const vecText &text )
   return m_font->GetTextWidthInternal(text.begin(), text.end()) * g_graphicsContext.GetGUIScaleX();
 }
 
+void CGUIFont::PrefetchText(const CStdStringW &text)
+{
+  if (!m_font) return;
+  vecText characters;
+  characters.reserve(text.size());
+  for (unsigned int i = 0; i < text.size(); i++)
+    characters.push_back(text[i] | ((m_style & 3) << 24));
+  CSingleLock lock(g_graphicsContext);
+  m_font->PrefetchCharacters(characters);
+}
+
 float CGUIFont::GetCharWidth( character_t ch )
 {
   if (!m_font) return 0;
@@ -297,6 +308,64 @@ void CGUIFont::End()
   m_font->End();
 }
 
+void CGUIFont::BeginVertexCache(CGUIFontVertexCache &cache)
+{
+  cache.m_valid = false;
+  cache.m_vertices.clear();
+  if (!m_font) return;
+
+  cache.m_font = m_font;
+  cache.m_generation = m_font->GetGeneration();
+  cache.m_numChars = m_font->m_numChars;
+  cache.m_start.clear();
+  for (unsigned int page = 0; page < m_font->m_pages.size(); page++)
+    cache.m_start.push_back(m_font->m_pages[page].vertices.size());
+  cache.m_transform = g_graphicsContext.GetFinalTransform();
+  cache.m_scaleX = g_graphicsContext.GetGUIScaleX();
+  cache.m_scaleY = g_graphicsContext.GetGUIScaleY();
+  cache.m_clipped = g_graphicsContext.GetClipRegion(cache.m_clip);
+}
+
+void CGUIFont::EndVertexCache(CGUIFontVertexCache &cache)
+{
+  // caching a new character ends and restarts the font's batch, so what we recorded is incomplete
+  if (!m_font || cache.m_font != m_font || cache.m_generation != m_font->GetGeneration() ||
+      cache.m_numChars != m_font->m_numChars || cache.m_start.size() != m_font->m_pages.size())
+    return;
+
+  cache.m_vertices.resize(cache.m_start.size());
+  for (unsigned int page = 0; page < cache.m_start.size(); page++)
+  {
+    const std::vector<SVertex> &vertices = m_font->m_pages[page].vertices;
+    if (cache.m_start[page] > vertices.size())
+      return;
+    cache.m_vertices[page].assign(vertices.begin() + cache.m_start[page], vertices.end());
+  }
+  cache.m_valid = true;
+}
+
+bool CGUIFont::DrawVertexCache(const CGUIFontVertexCache &cache)
+{
+  if (!m_font || !cache.m_valid || cache.m_font != m_font || cache.m_generation != m_font->GetGeneration())
+    return false;
+
+  if (cache.m_scaleX != g_graphicsContext.GetGUIScaleX() || cache.m_scaleY != g_graphicsContext.GetGUIScaleY() ||
+      cache.m_transform != g_graphicsContext.GetFinalTransform())
+    return false;
+
+  CRect clip;
+  bool clipped = g_graphicsContext.GetClipRegion(clip);
+  if (clipped != cache.m_clipped || (clipped && clip != cache.m_clip))
+    return false;
+
+  for (unsigned int page = 0; page < cache.m_vertices.size(); page++)
+  {
+    if (!cache.m_vertices[page].empty())
+      m_font->AddVertices(page, &cache.m_vertices[page][0], cache.m_vertices[page].size());
+  }
+  return true;
+}
+
 void CGUIFont::SetFont(CGUIFontTTFBase *font)
 {
   if (m_font == font)
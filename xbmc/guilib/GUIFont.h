@@ -28,6 +28,8 @@
  */
 
 #include "utils/StdString.h"
+#include "Geometry.h"
+#include "TransformMatrix.h"
 #include <assert.h>
 
 typedef uint32_t character_t;
@@ -37,6 +39,17 @@ typedef std::vector<color_t> vecColors;
 
 class CGUIFontTTFBase;
 
+struct SVertex
+{
+  float x, y, z;
+#ifdef HAS_DX
+  unsigned char b, g, r, a;
+#else
+  unsigned char r, g, b, a;
+#endif
+  float u, v;
+};
+
 // flags for alignment
 #define XBFONT_LEFT       0x00000000
 #define XBFONT_RIGHT      0x00000001
@@ -98,6 +111,38 @@ private:
   uint32_t m_lastFrameTime;
 };
 
+/*!
+ \ingroup textures
+ \brief The vertices of text drawn with a CGUIFont.
+
+ Text that is drawn the same way again can reuse them instead of being laid out again, as long as
+ the font, the transform, the GUI scale and the clip region are unchanged.
+ \sa CGUIFont::BeginVertexCache, CGUIFont::DrawVertexCache
+ */
+class CGUIFontVertexCache
+{
+public:
+  CGUIFontVertexCache() : m_valid(false), m_font(NULL), m_generation(0), m_numChars(0), m_scaleX(0), m_scaleY(0), m_clipped(false) {};
+
+  void Invalidate() { m_valid = false; m_vertices.clear(); };
+  bool IsValid() const { return m_valid; };
+
+private:
+  friend class CGUIFont;
+
+  bool m_valid;
+  CGUIFontTTFBase *m_font;
+  unsigned int m_generation;
+  std::vector<unsigned int> m_start;   ///< vertices already drawn from each page of the font
+  unsigned int m_numChars;
+  TransformMatrix m_transform;
+  float m_scaleX;
+  float m_scaleY;
+  bool m_clipped;
+  CRect m_clip;
+  std::vector< std::vector<SVertex> > m_vertices;   ///< vertices of each page of the font
+};
+
 /*!
  \ingroup textures
  \brief
@@ -137,6 +182,32 @@ public:
   void Begin();
   void End();
 
+  /*! \brief Start recording the vertices of the text drawn from now on into a cache.
+   Must be called between Begin() and End(), and be followed by EndVertexCache().
+   \param cache the cache to record into, its previous contents are discarded.
+   \sa EndVertexCache, DrawVertexCache
+   */
+  void BeginVertexCache(CGUIFontVertexCache &cache);
+
+  /*! \brief Stop recording the vertices of the text drawn into a cache.
+   The cache is left invalid if the glyph texture changed while recording.
+   \param cache the cache passed to BeginVertexCache.
+   */
+  void EndVertexCache(CGUIFontVertexCache &cache);
+
+  /*! \brief Draw the text recorded in a cache again.
+   Must be called between Begin() and End().
+   \param cache the recorded text.
+   \return true if the cache could be drawn, false if it is out of date and the text must be drawn again.
+   */
+  bool DrawVertexCache(const CGUIFontVertexCache &cache);
+
+  /*! \brief Rasterize the characters of some text on a worker thread, ahead of them being drawn in this font.
+   \param text the text whose characters to rasterize.
+   \sa CGUIFontTTFBase::PrefetchCharacters
+   */
+  void PrefetchText(const CStdStringW &text);
+
   uint32_t GetStyle() const { return m_style; };
 
   static wchar_t RemapGlyph(wchar_t letter);
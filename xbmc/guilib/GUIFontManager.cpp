@@ -24,6 +24,7 @@
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
 #include "GUIFont.h"
+#include "GUITextLayout.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
 #include "filesystem/File.h"
@@ -201,6 +202,9 @@ bool GUIFontManager::OnMessage(CGUIMessage &message)
 
 void GUIFontManager::ReloadTTFFonts(void)
 {
+  // layouts were measured with the fonts at their old size
+  CGUITextLayoutCache::Get().Clear();
+
   if (!m_vecFonts.size())
     return;   // we haven't even loaded fonts in yet
 
@@ -239,6 +243,8 @@ void GUIFontManager::ReloadTTFFonts(void)
 
 void GUIFontManager::UnloadTTFFonts()
 {
+  CGUITextLayoutCache::Get().Clear();
+
   for (vector<CGUIFontTTFBase*>::iterator i = m_vecFontFiles.begin(); i != m_vecFontFiles.end(); i++)
     delete (*i);
 
@@ -254,6 +260,7 @@ void GUIFontManager::Unload(const CStdString& strFontName)
   {
     if ((*iFont)->GetFontName().Equals(strFontName))
     {
+      CGUITextLayoutCache::Get().Clear();
       delete (*iFont);
       m_vecFonts.erase(iFont);
       return;
@@ -267,6 +274,7 @@ void GUIFontManager::FreeFontFile(CGUIFontTTFBase *pFont)
   {
     if (pFont == *it)
     {
+      CGUITextLayoutCache::Get().Clear();
       m_vecFontFiles.erase(it);
       delete pFont;
       return;
@@ -335,6 +343,8 @@ CGUIFont* GUIFontManager::GetDefaultFont(bool border)
 
 void GUIFontManager::Clear()
 {
+  CGUITextLayoutCache::Get().Clear();
+
   for (int i = 0; i < (int)m_vecFonts.size(); ++i)
   {
     CGUIFont* pFont = m_vecFonts[i];
@@ -347,6 +357,12 @@ void GUIFontManager::Clear()
   m_fontsetUnicode=false;
 }
 
+void GUIFontManager::PrefetchText(const CStdStringW &text)
+{
+  for (unsigned int i = 0; i < m_vecFonts.size(); i++)
+    m_vecFonts[i]->PrefetchText(text);
+}
+
 void GUIFontManager::LoadFonts(const CStdString& strFontSet)
 {
   CXBMCTinyXML xmlDoc;
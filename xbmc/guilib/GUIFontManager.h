@@ -82,6 +82,12 @@ public:
   void ReloadTTFFonts();
   void UnloadTTFFonts();
 
+  /*! \brief Rasterize the characters of some text in every loaded font, on worker threads.
+   \param text the text whose characters are about to be drawn.
+   \sa CGUIFont::PrefetchText
+   */
+  void PrefetchText(const CStdStringW &text);
+
 protected:
   void RescaleFontSizeAndAspect(float *size, float *aspect, const RESOLUTION_INFO &sourceRes, bool preserveAspect) const;
   void LoadFonts(const TiXmlNode* fontNode);
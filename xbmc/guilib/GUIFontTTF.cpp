@@ -24,11 +24,15 @@
 #include "Texture.h"
 #include "GraphicContext.h"
 #include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/MathUtils.h"
 #include "utils/log.h"
 #include "windowing/WindowingFactory.h"
 
 #include <math.h>
+#include <map>
+#include <set>
 
 // stuff for freetype
 #include <ft2build.h>
@@ -131,16 +135,89 @@ private:
 XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 #define g_freeTypeLibrary XBMC_GLOBAL_USE(CFreeTypeLibrary)
 
+/* the glyphs of a font queued for and rasterized by jobs, kept alive by the jobs should the font go first */
+class CGUIFontTTFBase::CPrefetchState
+{
+public:
+  CPrefetchState(const CStdString &filename, float height, float aspect, FT_Pos border)
+  : m_filename(filename), m_height(height), m_aspect(aspect), m_border(border) {}
+
+  const CStdString m_filename;
+  const float m_height;
+  const float m_aspect;
+  const FT_Pos m_border;                          // strength of the border, 0 for none
+  std::set<character_t> m_pending;                // queued, as style << 16 | letter
+  std::map<character_t, Glyph> m_ready;           // rasterized, waiting to be drawn
+  CCriticalSection m_section;
+};
+
+/* rasterizes glyphs queued by a font. A FreeType library is not to be used by two threads at once,
+   so the job opens the font with a library of its own */
+class CGUIFontPrefetchJob : public CJob
+{
+public:
+  CGUIFontPrefetchJob(const boost::shared_ptr<CGUIFontTTFBase::CPrefetchState> &state, const std::vector<character_t> &characters)
+  : m_state(state), m_characters(characters) {}
+
+  virtual const char *GetType() const { return "fontprefetch"; }
+
+  virtual bool DoWork()
+  {
+    if (!IsPending())
+      return false;
+
+    CFreeTypeLibrary library;
+    FT_Face face = library.GetFont(m_state->m_filename, m_state->m_height, m_state->m_aspect);
+    if (!face)
+      return false;
+    FT_Stroker stroker = NULL;
+    if (m_state->m_border)
+    {
+      stroker = library.GetStroker();
+      if (stroker)
+        FT_Stroker_Set(stroker, m_state->m_border, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+    }
+
+    for (std::vector<character_t>::const_iterator i = m_characters.begin(); i != m_characters.end() && IsPending(); ++i)
+    {
+      {
+        CSingleLock lock(m_state->m_section);
+        if (!m_state->m_pending.count(*i))
+          continue; // drawn, and so rasterized, in the meantime
+      }
+      CGUIFontTTFBase::Glyph glyph;
+      bool rasterized = CGUIFontTTFBase::RasterizeGlyph(face, stroker, (wchar_t)(*i & 0xffff), *i >> 16, glyph);
+
+      CSingleLock lock(m_state->m_section);
+      if (m_state->m_pending.erase(*i) && rasterized)
+        m_state->m_ready[*i] = glyph;
+    }
+
+    if (stroker)
+      library.ReleaseStroker(stroker);
+    library.ReleaseFont(face);
+    return true;
+  }
+
+private:
+  bool IsPending() const
+  {
+    CSingleLock lock(m_state->m_section);
+    return !m_state->m_pending.empty();
+  }
+
+  boost::shared_ptr<CGUIFontTTFBase::CPrefetchState> m_state;
+  std::vector<character_t> m_characters;
+};
+
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
-  m_texture = NULL;
   m_char = NULL;
   m_maxChars = 0;
   m_nestedBeginCount = 0;
 
-  m_bTextureLoaded = false;
-  m_vertex_size   = 4*1024;
-  m_vertex        = (SVertex*)malloc(m_vertex_size * sizeof(SVertex));
+  m_generation = ++m_nextGeneration;
+  m_id = ++m_nextID;
 
   m_face = NULL;
   m_stroker = NULL;
@@ -151,12 +228,10 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_cellBaseLine = m_cellHeight = 0;
   m_numChars = 0;
   m_posX = m_posY = 0;
-  m_textureHeight = m_textureWidth = 0;
-  m_textureScaleX = m_textureScaleY = 0.0;
+  m_textureWidth = m_pageHeight = m_maxPages = 0;
+  m_textureScaleX = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
   m_color = 0;
-  m_vertex_count = 0;
-  m_nTexture = 0;
 }
 
 CGUIFontTTFBase::~CGUIFontTTFBase(void)
@@ -180,11 +255,14 @@ void CGUIFontTTFBase::RemoveReference()
 
 void CGUIFontTTFBase::ClearCharacterCache()
 {
-  delete(m_texture);
-
-  DeleteHardwareTexture();
+  m_generation = ++m_nextGeneration;
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+  {
+    DeleteHardwareTexture(page);
+    delete m_pages[page].texture;
+  }
+  m_pages.clear();
 
-  m_texture = NULL;
   delete[] m_char;
   m_char = new Character[CHAR_CHUNK];
   memset(m_charquick, 0, sizeof(m_charquick));
@@ -193,13 +271,14 @@ void CGUIFontTTFBase::ClearCharacterCache()
   // set the posX and posY so that our texture will be created on first character write.
   m_posX = m_textureWidth;
   m_posY = -(int)GetTextureLineHeight();
-  m_textureHeight = 0;
 }
 
 void CGUIFontTTFBase::Clear()
 {
-  delete(m_texture);
-  m_texture = NULL;
+  m_generation = ++m_nextGeneration;
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+    delete m_pages[page].texture;
+  m_pages.clear();
   delete[] m_char;
   memset(m_charquick, 0, sizeof(m_charquick));
   m_char = NULL;
@@ -209,16 +288,21 @@ void CGUIFontTTFBase::Clear()
   m_posY = 0;
   m_nestedBeginCount = 0;
 
+  // jobs still running drop what they rasterize
+  if (m_prefetch)
+  {
+    CSingleLock lock(m_prefetch->m_section);
+    m_prefetch->m_pending.clear();
+    m_prefetch->m_ready.clear();
+  }
+  m_prefetch.reset();
+
   if (m_face)
     g_freeTypeLibrary.ReleaseFont(m_face);
   m_face = NULL;
   if (m_stroker)
     g_freeTypeLibrary.ReleaseStroker(m_stroker);
   m_stroker = NULL;
-
-  free(m_vertex);
-  m_vertex = NULL;
-  m_vertex_count = 0;
 }
 
 bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float aspect, float lineSpacing, bool border)
@@ -251,13 +335,14 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
   int cellDescender = std::min<int>(m_face->bbox.yMin, m_face->descender);
   int cellAscender  = std::max<int>(m_face->bbox.yMax, m_face->ascender);
 
+  FT_Pos strength = 0;
   if (border)
   {
     /*
      add on the strength of any border - the non-bordered font needs
      aligning with the bordered font by utilising GetTextBaseLine()
      */
-    FT_Pos strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
+    strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
     if (strength < 128)
       strength = 128;
 
@@ -279,8 +364,9 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   m_height = height;
 
-  delete(m_texture);
-  m_texture = NULL;
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+    delete m_pages[page].texture;
+  m_pages.clear();
   delete[] m_char;
   m_char = NULL;
 
@@ -288,14 +374,21 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
   m_numChars = 0;
 
   m_strFilename = strFilename;
+  m_prefetch.reset(new CPrefetchState(strFilename, height, aspect, strength));
 
-  m_textureHeight = 0;
   m_textureWidth = ((m_cellHeight * CHARS_PER_TEXTURE_LINE) & ~63) + 64;
 
   m_textureWidth = CBaseTexture::PadPow2(m_textureWidth);
 
   if (m_textureWidth > g_Windowing.GetMaxTextureSize())
     m_textureWidth = g_Windowing.GetMaxTextureSize();
+  m_textureScaleX = 1.0f / m_textureWidth;
+
+  // square pages, with as many as make up the tallest texture we could have grown to
+  m_pageHeight = std::max(m_textureWidth, CBaseTexture::PadPow2(GetTextureLineHeight() + 1));
+  m_pageHeight = std::min(m_pageHeight, g_Windowing.GetMaxTextureSize());
+  m_maxPages = std::max(g_Windowing.GetMaxTextureSize() / m_pageHeight, 1U);
+  m_pages.reserve(m_maxPages);
 
   // set the posX and posY so that our texture will be created on first character write.
   m_posX = m_textureWidth;
@@ -457,6 +550,10 @@ float CGUIFontTTFBase::GetLineHeight(float lineSpacing) const
 }
 
 unsigned int CGUIFontTTFBase::spacing_between_characters_in_texture = 1;
+unsigned int CGUIFontTTFBase::m_nextGeneration = 0;
+unsigned int CGUIFontTTFBase::m_nextID = 0;
+unsigned int CGUIFontTTFBase::m_glyphsPrefetched = 0;
+unsigned int CGUIFontTTFBase::m_glyphsMissed = 0;
 
 unsigned int CGUIFontTTFBase::GetTextureLineHeight() const
 {
@@ -521,12 +618,14 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   unsigned int nestedBeginCount = m_nestedBeginCount;
   m_nestedBeginCount = 1;
   if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
+  Glyph glyph;
+  bool rasterized = GetGlyph(letter, style, glyph);
+  if (!rasterized || !CacheCharacter(letter, style, glyph, m_char + low))
   { // unable to cache character - try clearing them all out and starting over
     CLog::Log(LOGDEBUG, "GUIFontTTF::GetCharacter: Unable to cache character.  Clearing character cache of %i characters", m_numChars);
     ClearCharacterCache();
     low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+    if (!rasterized || !CacheCharacter(letter, style, glyph, m_char + low))
     {
       CLog::Log(LOGERROR, "GUIFontTTF::GetCharacter: Unable to cache character (out of memory?)");
       if (nestedBeginCount) Begin();
@@ -551,111 +650,212 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   return m_char + low;
 }
 
-bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
+void CGUIFontTTFBase::PrefetchCharacters(const vecText &text)
+{
+  if (!m_prefetch || !m_cellHeight)
+    return;
+
+  // keep to the order given, which may put the characters most likely to be drawn first
+  std::set<character_t> cached, seen;
+  for (int i = 0; i < m_numChars; i++)
+    cached.insert(m_char[i].letterAndStyle);
+  std::vector<character_t> characters;
+  for (vecText::const_iterator i = text.begin(); i != text.end(); ++i)
+  {
+    wchar_t letter = (wchar_t)(*i & 0xffff);
+    character_t character = (((*i & 0x3000000) >> 24) << 16) | letter;
+    if (letter != L'\r' && letter != L'\n' && !cached.count(character) && seen.insert(character).second)
+      characters.push_back(character);
+  }
+
+  // fill no more than half of what the glyph texture holds before it is cleared, leaving the
+  // rest for characters that turn out to be drawn. Glyphs are taken to be about as wide as high
+  unsigned int capacity = (m_textureWidth / m_cellHeight) * (m_pageHeight / GetTextureLineHeight()) * m_maxPages;
+  unsigned int budget = capacity / 2;
+
+  std::vector<character_t> queued;
+  CSingleLock lock(m_prefetch->m_section);
+  unsigned int used = m_numChars + m_prefetch->m_pending.size() + m_prefetch->m_ready.size();
+  for (std::vector<character_t>::const_iterator i = characters.begin(); i != characters.end() && used < budget; ++i)
+  {
+    if (!m_prefetch->m_ready.count(*i) && m_prefetch->m_pending.insert(*i).second)
+    {
+      queued.push_back(*i);
+      used++;
+    }
+  }
+  lock.Leave();
+
+  if (!queued.empty())
+    CJobManager::GetInstance().AddJob(new CGUIFontPrefetchJob(m_prefetch, queued), NULL);
+}
+
+bool CGUIFontTTFBase::IsPrefetching() const
 {
-  int glyph_index = FT_Get_Char_Index( m_face, letter );
+  if (!m_prefetch)
+    return false;
+  CSingleLock lock(m_prefetch->m_section);
+  return !m_prefetch->m_pending.empty();
+}
 
-  FT_Glyph glyph = NULL;
-  if (FT_Load_Glyph( m_face, glyph_index, FT_LOAD_TARGET_LIGHT ))
+void CGUIFontTTFBase::GetGlyphStatistics(unsigned int &prefetched, unsigned int &missed)
+{
+  prefetched = m_glyphsPrefetched;
+  missed = m_glyphsMissed;
+}
+
+bool CGUIFontTTFBase::GetGlyph(wchar_t letter, uint32_t style, Glyph &glyph)
+{
+  character_t ch = (style << 16) | letter;
+  if (m_prefetch)
+  {
+    CSingleLock lock(m_prefetch->m_section);
+    std::map<character_t, Glyph>::iterator i = m_prefetch->m_ready.find(ch);
+    if (i != m_prefetch->m_ready.end())
+    {
+      glyph.pixels.swap(i->second.pixels);
+      glyph.left = i->second.left;
+      glyph.top = i->second.top;
+      glyph.width = i->second.width;
+      glyph.rows = i->second.rows;
+      glyph.advance = i->second.advance;
+      m_prefetch->m_ready.erase(i);
+      m_glyphsPrefetched++;
+      return true;
+    }
+    // a job that has yet to get to it leaves it to us
+    m_prefetch->m_pending.erase(ch);
+  }
+  m_glyphsMissed++;
+  return RasterizeGlyph(m_face, m_stroker, letter, style, glyph);
+}
+
+bool CGUIFontTTFBase::RasterizeGlyph(FT_Face face, FT_Stroker stroker, wchar_t letter, uint32_t style, Glyph &glyph)
+{
+  int glyph_index = FT_Get_Char_Index( face, letter );
+
+  FT_Glyph ftGlyph = NULL;
+  if (FT_Load_Glyph( face, glyph_index, FT_LOAD_TARGET_LIGHT ))
   {
     CLog::Log(LOGDEBUG, "%s Failed to load glyph %x", __FUNCTION__, letter);
     return false;
   }
   // make bold if applicable
   if (style & FONT_STYLE_BOLD)
-    EmboldenGlyph(m_face->glyph);
+    EmboldenGlyph(face->glyph);
   // and italics if applicable
   if (style & FONT_STYLE_ITALICS)
-    ObliqueGlyph(m_face->glyph);
+    ObliqueGlyph(face->glyph);
   // grab the glyph
-  if (FT_Get_Glyph(m_face->glyph, &glyph))
+  if (FT_Get_Glyph(face->glyph, &ftGlyph))
   {
     CLog::Log(LOGDEBUG, "%s Failed to get glyph %x", __FUNCTION__, letter);
     return false;
   }
-  if (m_stroker)
-    FT_Glyph_StrokeBorder(&glyph, m_stroker, 0, 1);
+  if (stroker)
+    FT_Glyph_StrokeBorder(&ftGlyph, stroker, 0, 1);
   // render the glyph
-  if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, NULL, 1))
+  if (FT_Glyph_To_Bitmap(&ftGlyph, FT_RENDER_MODE_NORMAL, NULL, 1))
   {
     CLog::Log(LOGDEBUG, "%s Failed to render glyph %x to a bitmap", __FUNCTION__, letter);
     return false;
   }
-  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)glyph;
+  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)ftGlyph;
   FT_Bitmap bitmap = bitGlyph->bitmap;
-  if (bitGlyph->left < 0)
-    m_posX += -bitGlyph->left;
+
+  glyph.left = bitGlyph->left;
+  glyph.top = bitGlyph->top;
+  glyph.width = bitmap.width;
+  glyph.rows = bitmap.rows;
+  glyph.advance = (float)MathUtils::round_int( (float)face->glyph->advance.x / 64 );
+  glyph.pixels.resize(glyph.width * glyph.rows);
+  for (unsigned int y = 0; y < glyph.rows; y++)
+    memcpy(&glyph.pixels[y * glyph.width], bitmap.buffer + y * bitmap.pitch, glyph.width);
+
+  // free the glyph
+  FT_Done_Glyph(ftGlyph);
+
+  return true;
+}
+
+bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, const Glyph &glyph, Character *ch)
+{
+  if (glyph.left < 0)
+    m_posX += -glyph.left;
 
   // check we have enough room for the character
-  if (m_posX + bitGlyph->left + bitmap.width > (int)m_textureWidth)
-  { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
+  if (m_posX + glyph.left + (int)glyph.width > (int)m_textureWidth)
+  { // no space - gotta drop to the next line
     m_posX = 0;
     m_posY += GetTextureLineHeight();
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
-
-    if(m_posY + GetTextureLineHeight() >= m_textureHeight)
-    {
-      // create the new larger texture
-      unsigned int newHeight = m_posY + GetTextureLineHeight();
-      // check for max height
-      if (newHeight > g_Windowing.GetMaxTextureSize())
-      {
-        CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: New cache texture is too large (%u > %u pixels long)", newHeight, g_Windowing.GetMaxTextureSize());
-        FT_Done_Glyph(glyph);
-        return false;
-      }
+    if (glyph.left < 0)
+      m_posX += -glyph.left;
+  }
 
-      CBaseTexture* newTexture = NULL;
-      newTexture = ReallocTexture(newHeight);
-      if(newTexture == NULL)
+  if (m_pages.empty() || m_posY + GetTextureLineHeight() > m_pages.back().height)
+  {
+    if (m_pages.empty() || m_posY + GetTextureLineHeight() > m_pageHeight)
+    { // the last page is full - start a new one
+      if (m_pages.size() >= m_maxPages)
       {
-        FT_Done_Glyph(glyph);
-        CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: Failed to allocate new texture of height %u", newHeight);
+        CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: All %u pages of the cache texture are full", m_maxPages);
         return false;
       }
-      m_texture = newTexture;
+      m_pages.push_back(Page());
+      m_posY = 0;
     }
-  }
 
-  if(m_texture == NULL)
-  {
-    CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: no texture to cache character to");
-    return false;
+    // grow the last page, which means creating a new texture and copying it across
+    unsigned int page = m_pages.size() - 1;
+    bool grown = m_pages[page].texture != NULL;
+    unsigned int newHeight = m_posY + GetTextureLineHeight();
+    CBaseTexture* newTexture = ReallocTexture(page, newHeight);
+    if(newTexture == NULL)
+    {
+      CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: Failed to allocate new texture of height %u", newHeight);
+      if (!grown)
+        m_pages.pop_back();
+      return false;
+    }
+    m_pages[page].texture = newTexture;
+    // the texture coordinates of the characters on the page change with its height
+    if (grown)
+      m_generation = ++m_nextGeneration;
   }
 
   // set the character in our table
   ch->letterAndStyle = (style << 16) | letter;
-  ch->offsetX = (short)bitGlyph->left;
-  ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
+  ch->page = (unsigned short)(m_pages.size() - 1);
+  ch->offsetX = (short)glyph.left;
+  ch->offsetY = (short)m_cellBaseLine - glyph.top;
   ch->left = (float)m_posX + ch->offsetX;
   ch->top = (float)m_posY + ch->offsetY;
-  ch->right = ch->left + bitmap.width;
-  ch->bottom = ch->top + bitmap.rows;
-  ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->right = ch->left + glyph.width;
+  ch->bottom = ch->top + glyph.rows;
+  ch->advance = glyph.advance;
 
   // we need only render if we actually have some pixels
-  if (bitmap.width * bitmap.rows)
+  if (glyph.width * glyph.rows)
   {
     // ensure our rect will stay inside the texture (it *should* but we need to be certain)
     unsigned int x1 = max(m_posX + ch->offsetX, 0);
     unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
+    unsigned int x2 = min(x1 + glyph.width, m_textureWidth);
+    unsigned int y2 = min(y1 + glyph.rows, m_pages[ch->page].height);
+    CopyCharToTexture(ch->page, glyph, x1, y1, x2, y2);
   }
   m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
   m_numChars++;
 
-  m_textureScaleX = 1.0f / m_textureWidth;
-  m_textureScaleY = 1.0f / m_textureHeight;
-
-  // free the glyph
-  FT_Done_Glyph(glyph);
-
   return true;
 }
 
+void CGUIFontTTFBase::AddVertices(unsigned int page, const SVertex *vertices, unsigned int count)
+{
+  if (page < m_pages.size())
+    m_pages[page].vertices.insert(m_pages[page].vertices.end(), vertices, vertices + count);
+}
+
 void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX)
 {
   // actual image width isn't same as the character width as that is
@@ -713,27 +913,16 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   z[3] = (float)MathUtils::round_int(g_graphicsContext.ScaleFinalZCoord(vertex.x1, vertex.y2));
 
   // tex coords converted to 0..1 range
+  std::vector<SVertex> &vertices = m_pages[ch->page].vertices;
+  float textureScaleY = 1.0f / m_pages[ch->page].height;
   float tl = texture.x1 * m_textureScaleX;
   float tr = texture.x2 * m_textureScaleX;
-  float tt = texture.y1 * m_textureScaleY;
-  float tb = texture.y2 * m_textureScaleY;
-
-  // grow the vertex buffer if required
-  if(m_vertex_count >= m_vertex_size)
-  {
-    m_vertex_size *= 2;
-    void* old      = m_vertex;
-    m_vertex       = (SVertex*)realloc(m_vertex, m_vertex_size * sizeof(SVertex));
-    if (!m_vertex)
-    {
-      free(old);
-      printf("realloc failed in CGUIFontTTF::RenderCharacter. aborting\n");
-      abort();
-    }
-  }
+  float tt = texture.y1 * textureScaleY;
+  float tb = texture.y2 * textureScaleY;
 
   m_color = color;
-  SVertex* v = m_vertex + m_vertex_count;
+  vertices.resize(vertices.size() + 4);
+  SVertex* v = &vertices[vertices.size() - 4];
 
   for(int i = 0; i < 4; i++)
   {
@@ -788,8 +977,6 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   v[3].y = y[2];
   v[3].z = z[2];
 #endif
-
-  m_vertex_count+=4;
 }
 
 // Oblique code - original taken from freetype2 (ftsynth.c)
@@ -822,8 +1009,8 @@ void CGUIFontTTFBase::EmboldenGlyph(FT_GlyphSlot slot)
     return;
 
   /* some reasonable strength */
-  FT_Pos strength = FT_MulFix( m_face->units_per_EM,
-                    m_face->size->metrics.y_scale ) / 24;
+  FT_Pos strength = FT_MulFix( slot->face->units_per_EM,
+                    slot->face->size->metrics.y_scale ) / 24;
 
   FT_BBox bbox_before, bbox_after;
   FT_Outline_Get_CBox( &slot->outline, &bbox_before );
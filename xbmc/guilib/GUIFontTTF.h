@@ -27,8 +27,13 @@
  *
  */
 
+#include "GUIFont.h"
+
+#include <boost/shared_ptr.hpp>
+
 // forward definition
 class CBaseTexture;
+class CGUIFontPrefetchJob;
 
 struct FT_FaceRec_;
 struct FT_LibraryRec_;
@@ -52,21 +57,10 @@ typedef std::vector<color_t> vecColors;
  \brief
  */
 
-struct SVertex
-{
-  float x, y, z;
-#ifdef HAS_DX
-  unsigned char b, g, r, a;
-#else
-  unsigned char r, g, b, a;
-#endif
-  float u, v;
-};
-
-
 class CGUIFontTTFBase
 {
   friend class CGUIFont;
+  friend class CGUIFontPrefetchJob;
 
 public:
 
@@ -82,6 +76,32 @@ public:
 
   const CStdString& GetFileName() const { return m_strFileName; };
 
+  /*! \brief Identifies the layout of the glyph texture, which changes whenever previously
+   generated texture coordinates become invalid.
+   */
+  unsigned int GetGeneration() const { return m_generation; };
+
+  /*! \brief Identifies this font file, unlike its address it is never reused by another one.
+   */
+  unsigned int GetID() const { return m_id; };
+
+  /*! \brief Rasterize the given characters on a worker thread, ahead of them being drawn.
+   The glyphs are copied to the texture once first used, so drawing them doesn't stall the
+   render thread on FreeType.  No more characters are queued once they would take over half of
+   the glyph texture, so the earlier characters in the text are preferred.
+   \param text the characters to rasterize, with their style.
+   */
+  void PrefetchCharacters(const vecText &text);
+
+  /*! \brief Whether characters passed to PrefetchCharacters() are still to be rasterized.
+   */
+  bool IsPrefetching() const;
+
+  /*! \brief Get the number of glyphs that have been rasterized, since startup, ahead of being
+   drawn and on the render thread when first drawn.
+   */
+  static void GetGlyphStatistics(unsigned int &prefetched, unsigned int &missed);
+
 protected:
   struct Character
   {
@@ -89,7 +109,34 @@ protected:
     float left, top, right, bottom;
     float advance;
     character_t letterAndStyle;
+    unsigned short page;
+  };
+
+  /*! \brief A glyph rasterized by FreeType, ready to be copied to the texture.
+   */
+  struct Glyph
+  {
+    int left, top;                      // offset of the bitmap from the pen position and baseline
+    unsigned int width, rows;
+    float advance;
+    std::vector<unsigned char> pixels;  // 8bit alpha, width * rows
   };
+
+  /*! \brief A texture of the glyph atlas and the vertices drawn from it in the current batch.
+   Characters are cached to the last page, which grows until it reaches the page height.
+   A new page is then started rather than every character being copied to a larger texture.
+   */
+  struct Page
+  {
+    Page() : texture(NULL), height(0), hwTexture(0), loaded(false) {};
+    CBaseTexture *texture;
+    unsigned int height;
+    std::vector<SVertex> vertices;
+    unsigned int hwTexture;
+    bool loaded;
+  };
+
+  class CPrefetchState;
   void AddReference();
   void RemoveReference();
 
@@ -108,23 +155,34 @@ protected:
 
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
-  bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  bool GetGlyph(wchar_t letter, uint32_t style, Glyph &glyph);
+  bool CacheCharacter(wchar_t letter, uint32_t style, const Glyph &glyph, Character *ch);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
+  void AddVertices(unsigned int page, const SVertex *vertices, unsigned int count);
   void ClearCharacterCache();
 
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
-  virtual void DeleteHardwareTexture() = 0;
+  /*! \brief Create or grow a page of the glyph texture, keeping its contents.
+   Sets the height of the page and deletes its previous texture.
+   \param page the page to reallocate.
+   \param newHeight the height required, updated to the height allocated.
+   \return the new texture of the page, NULL on failure.
+   */
+  virtual CBaseTexture* ReallocTexture(unsigned int page, unsigned int& newHeight) = 0;
+  virtual bool CopyCharToTexture(unsigned int page, const Glyph &glyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
+  virtual void DeleteHardwareTexture(unsigned int page) = 0;
+
+  static bool RasterizeGlyph(FT_Face face, FT_Stroker stroker, wchar_t letter, uint32_t style, Glyph &glyph);
 
   // modifying glyphs
-  void EmboldenGlyph(FT_GlyphSlot slot);
-  void ObliqueGlyph(FT_GlyphSlot slot);
+  static void EmboldenGlyph(FT_GlyphSlot slot);
+  static void ObliqueGlyph(FT_GlyphSlot slot);
 
-  CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
+  std::vector<Page> m_pages;         // textures that hold our rendered characters (8bit alpha only)
 
-  unsigned int m_textureWidth;       // width of our texture
-  unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
+  unsigned int m_textureWidth;       // width of our texture pages
+  unsigned int m_pageHeight;         // height a page may grow to
+  unsigned int m_maxPages;           // number of pages before the cache is cleared
+  int m_posX;                        // current position in the last page
   int m_posY;
 
   /*! \brief the height of each line in the texture.
@@ -151,18 +209,19 @@ protected:
   FT_Face    m_face;
   FT_Stroker m_stroker;
 
+  boost::shared_ptr<CPrefetchState> m_prefetch;   // glyphs rasterized by jobs, shared with them
+  static unsigned int m_glyphsPrefetched;
+  static unsigned int m_glyphsMissed;
+
   float m_originX;
   float m_originY;
 
-  bool m_bTextureLoaded;
-  unsigned int m_nTexture;
-
-  SVertex* m_vertex;
-  int      m_vertex_count;
-  int      m_vertex_size;
+  unsigned int m_generation;
+  static unsigned int m_nextGeneration;
+  unsigned int m_id;
+  static unsigned int m_nextID;
 
   float    m_textureScaleX;
-  float    m_textureScaleY;
 
   static int justification_word_weight;
 
@@ -40,14 +40,14 @@ using namespace std;
 CGUIFontTTFDX::CGUIFontTTFDX(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
-  m_speedupTexture = NULL;
   m_index      = NULL;
   m_index_size = 0;
 }
 
 CGUIFontTTFDX::~CGUIFontTTFDX(void)
 {
-  SAFE_DELETE(m_speedupTexture);
+  for (unsigned int page = 0; page < m_speedupTextures.size(); page++)
+    SAFE_DELETE(m_speedupTextures[page]);
   free(m_index);
 }
 
@@ -57,8 +57,7 @@ void CGUIFontTTFDX::Begin()
 
   if (m_nestedBeginCount == 0)
   {
-    // just have to blit from our texture.
-    m_texture->BindToUnit(0);
+    // just have to blit from our texture pages, which are bound as they're drawn.
     pD3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_SELECTARG1 ); // only use diffuse
     pD3DDevice->SetTextureStageState( 0, D3DTSS_COLORARG1, D3DTA_DIFFUSE);
     pD3DDevice->SetTextureStageState( 0, D3DTSS_ALPHAOP, D3DTOP_MODULATE );
@@ -79,7 +78,8 @@ void CGUIFontTTFDX::Begin()
     pD3DDevice->SetRenderState( D3DRS_LIGHTING, FALSE);
 
     pD3DDevice->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1);
-    m_vertex_count = 0;
+    for (unsigned int page = 0; page < m_pages.size(); page++)
+      m_pages[page].vertices.clear();
   }
 
   // Keep track of the nested begin/end calls.
@@ -96,17 +96,20 @@ void CGUIFontTTFDX::End()
   if (--m_nestedBeginCount > 0)
     return;
 
-  if (m_vertex_count == 0)
+  unsigned vertex_size = 0;
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+    vertex_size = std::max(vertex_size, (unsigned)m_pages[page].vertices.capacity());
+  if (vertex_size == 0)
     return;
 
-  unsigned index_size = m_vertex_size * 6 / 4;
+  unsigned index_size = vertex_size * 6 / 4;
   if(m_index_size < index_size)
   {
     uint16_t* id  = (uint16_t*)calloc(index_size, sizeof(uint16_t));
     if(id == NULL)
       return;
 
-    for(int i = 0, b = 0; i < m_vertex_size; i += 4, b += 6)
+    for(unsigned i = 0, b = 0; i < vertex_size; i += 4, b += 6)
     {
       id[b+0] = i + 0;
       id[b+1] = i + 1;
@@ -133,22 +136,37 @@ void CGUIFontTTFDX::End()
 
   pD3DDevice->SetTransform(D3DTS_WORLD, &world);
 
-  pD3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST
-                                    , 0
-                                    , m_vertex_count
-                                    , m_vertex_count / 2
-                                    , m_index
-                                    , D3DFMT_INDEX16
-                                    , m_vertex
-                                    , sizeof(SVertex));
+  // one draw for each page of the glyph texture that's in use
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+  {
+    const std::vector<SVertex> &vertices = m_pages[page].vertices;
+    if (vertices.empty())
+      continue;
+
+    m_pages[page].texture->BindToUnit(0);
+    pD3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST
+                                      , 0
+                                      , vertices.size()
+                                      , vertices.size() / 2
+                                      , m_index
+                                      , D3DFMT_INDEX16
+                                      , &vertices[0]
+                                      , sizeof(SVertex));
+  }
   pD3DDevice->SetTransform(D3DTS_WORLD, &orig);
 
   pD3DDevice->SetTexture(0, NULL);
   pD3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_MODULATE );
 }
 
-CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
+CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int page, unsigned int& newHeight)
 {
+  if (m_speedupTextures.size() <= page)
+    m_speedupTextures.resize(page + 1, NULL);
+  CBaseTexture *oldTexture = m_pages[page].texture;
+  CD3DTexture *oldSpeedupTexture = m_speedupTextures[page];
+  unsigned int oldHeight = m_pages[page].height;
+
   CDXTexture* pNewTexture = new CDXTexture(m_textureWidth, newHeight, XB_FMT_A8);
   pNewTexture->CreateTextureObject();
   LPDIRECT3DTEXTURE9 newTexture = pNewTexture->GetTextureObject();
@@ -178,16 +196,16 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
   LPDIRECT3DSURFACE9 pSource, pTarget;
   HRESULT hr;
   // There might be data to copy from the previous texture
-  if ((newSpeedupTexture && m_speedupTexture) || (newTexture && m_texture))
+  if ((newSpeedupTexture && oldSpeedupTexture) || (newTexture && oldTexture))
   {
-    if (m_speedupTexture && newSpeedupTexture)
+    if (oldSpeedupTexture && newSpeedupTexture)
     {
-      m_speedupTexture->GetSurfaceLevel(0, &pSource);
+      oldSpeedupTexture->GetSurfaceLevel(0, &pSource);
       newSpeedupTexture->GetSurfaceLevel(0, &pTarget);
     }
     else
     {
-      ((CDXTexture *)m_texture)->GetTextureObject()->GetSurfaceLevel(0, &pSource);
+      ((CDXTexture *)oldTexture)->GetTextureObject()->GetSurfaceLevel(0, &pSource);
       newTexture->GetSurfaceLevel(0, &pTarget);
     }
 
@@ -211,11 +229,11 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
 
     if (srcPitch == dstPitch)
     {
-      memcpy(dst, src, srcPitch * m_textureHeight);
+      memcpy(dst, src, srcPitch * oldHeight);
     }
     else
     {
-      for (unsigned int y = 0; y < m_textureHeight; y++)
+      for (unsigned int y = 0; y < oldHeight; y++)
       {
         memcpy(dst, src, minPitch);
         src += srcPitch;
@@ -230,12 +248,12 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
   }
 
   // Upload from speedup texture to main texture
-  if (newSpeedupTexture && m_speedupTexture)
+  if (newSpeedupTexture && oldSpeedupTexture)
   {
     LPDIRECT3DSURFACE9 pSource, pTarget;
     newSpeedupTexture->GetSurfaceLevel(0, &pSource);
     newTexture->GetSurfaceLevel(0, &pTarget);
-    const RECT rect = { 0, 0, m_textureWidth, m_textureHeight };
+    const RECT rect = { 0, 0, m_textureWidth, oldHeight };
     const POINT point = { 0, 0 };
 
     hr = g_Windowing.Get3DDevice()->UpdateSurface(pSource, &rect, pTarget, &point);
@@ -251,30 +269,29 @@ CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
     }
   }
 
-  SAFE_DELETE(m_texture);
-  SAFE_DELETE(m_speedupTexture);
-  m_textureHeight = newHeight;
-  m_speedupTexture = newSpeedupTexture;
+  SAFE_DELETE(oldTexture);
+  SAFE_DELETE(oldSpeedupTexture);
+  m_pages[page].height = newHeight;
+  m_speedupTextures[page] = newSpeedupTexture;
 
   return pNewTexture;
 }
 
-bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+bool CGUIFontTTFDX::CopyCharToTexture(unsigned int page, const Glyph &glyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
 {
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-
-  LPDIRECT3DTEXTURE9 texture = ((CDXTexture *)m_texture)->GetTextureObject();
+  LPDIRECT3DTEXTURE9 texture = ((CDXTexture *)m_pages[page].texture)->GetTextureObject();
+  CD3DTexture *speedupTexture = m_speedupTextures[page];
   LPDIRECT3DSURFACE9 target;
-  if (m_speedupTexture)
-    m_speedupTexture->GetSurfaceLevel(0, &target);
+  if (speedupTexture)
+    speedupTexture->GetSurfaceLevel(0, &target);
   else
     texture->GetSurfaceLevel(0, &target);
 
-  RECT sourcerect = { 0, 0, bitmap.width, bitmap.rows };
+  RECT sourcerect = { 0, 0, glyph.width, glyph.rows };
   RECT targetrect = { x1, y1, x2, y2 };
 
   HRESULT hr = D3DXLoadSurfaceFromMemory( target, NULL, &targetrect,
-                                          bitmap.buffer, D3DFMT_LIN_A8, bitmap.pitch, NULL, &sourcerect,
+                                          &glyph.pixels[0], D3DFMT_LIN_A8, glyph.width, NULL, &sourcerect,
                                           D3DX_FILTER_NONE, 0x00000000);
 
   SAFE_RELEASE(target);
@@ -285,10 +302,10 @@ bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1,
     return false;
   }
 
-  if (m_speedupTexture)
+  if (speedupTexture)
   {
     // Upload to GPU - the automatic dirty region tracking takes care of the rect.
-    HRESULT hr = g_Windowing.Get3DDevice()->UpdateTexture(m_speedupTexture->Get(), texture);
+    HRESULT hr = g_Windowing.Get3DDevice()->UpdateTexture(speedupTexture->Get(), texture);
     if (FAILED(hr))
     {
       CLog::Log(LOGERROR, __FUNCTION__": Failed to upload from sysmem to vidmem (0x%08X)", hr);
@@ -299,9 +316,10 @@ bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1,
 }
 
 
-void CGUIFontTTFDX::DeleteHardwareTexture()
+void CGUIFontTTFDX::DeleteHardwareTexture(unsigned int page)
 {
-  
+  if (page < m_speedupTextures.size())
+    SAFE_DELETE(m_speedupTextures[page]);
 }
 
 
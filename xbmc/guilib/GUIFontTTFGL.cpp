@@ -28,6 +28,9 @@
 #include "gui3d.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
+#if defined(HAS_GL)
+#include "GUITextureBatchGL.h"
+#endif
 #if HAS_GLES == 2
 #include "windowing/WindowingFactory.h"
 #endif
@@ -56,27 +59,10 @@ void CGUIFontTTFGL::Begin()
 {
   if (m_nestedBeginCount == 0)
   {
-    if (!m_bTextureLoaded)
-    {
-      // Have OpenGL generate a texture object handle for us
-      glGenTextures(1, (GLuint*) &m_nTexture);
-
-      // Bind the texture object
-      glBindTexture(GL_TEXTURE_2D, m_nTexture);
 #ifdef HAS_GL
-      glEnable(GL_TEXTURE_2D);
+    // text is drawn over the textures queued before it
+    CGUITextureBatchGL::Get().Flush();
 #endif
-      // Set the texture's stretching properties
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-      // Set the texture image -- THIS WORKS, so the pixels must be wrong.
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_texture->GetWidth(), m_texture->GetHeight(), 0,
-                   GL_ALPHA, GL_UNSIGNED_BYTE, m_texture->GetPixels());
-
-      VerifyGLState();
-      m_bTextureLoaded = true;
-    }
 
     // Turn Blending On
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
@@ -84,7 +70,6 @@ void CGUIFontTTFGL::Begin()
 #ifdef HAS_GL
     glEnable(GL_TEXTURE_2D);
 #endif
-    glBindTexture(GL_TEXTURE_2D, m_nTexture);
 
 #ifdef HAS_GL
     glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
@@ -102,7 +87,8 @@ void CGUIFontTTFGL::Begin()
     g_Windowing.EnableGUIShader(SM_FONTS);
 #endif
 
-    m_vertex_count = 0;
+    for (unsigned int page = 0; page < m_pages.size(); page++)
+      m_pages[page].vertices.clear();
   }
   // Keep track of the nested begin/end calls.
   m_nestedBeginCount++;
@@ -116,16 +102,54 @@ void CGUIFontTTFGL::End()
   if (--m_nestedBeginCount > 0)
     return;
 
+  // one draw for each page of the glyph texture that's in use
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+  {
+    if (!m_pages[page].vertices.empty())
+      DrawPage(page);
+  }
+
+#ifndef HAS_GL
+  g_Windowing.DisableGUIShader();
+#endif
+}
+
+void CGUIFontTTFGL::DrawPage(unsigned int page)
+{
+  Page &p = m_pages[page];
+  if (!p.loaded)
+  {
+    // Have OpenGL generate a texture object handle for us
+    glGenTextures(1, (GLuint*) &p.hwTexture);
+
+    // Bind the texture object
+    glBindTexture(GL_TEXTURE_2D, p.hwTexture);
+
+    // Set the texture's stretching properties
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, p.texture->GetWidth(), p.texture->GetHeight(), 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, p.texture->GetPixels());
+
+    VerifyGLState();
+    p.loaded = true;
+  }
+  glBindTexture(GL_TEXTURE_2D, p.hwTexture);
+
+  const SVertex *vertex = &p.vertices[0];
+  int vertex_count = p.vertices.size();
+
 #ifdef HAS_GL
   glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 
-  glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, r));
-  glVertexPointer  (3, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, x));
-  glTexCoordPointer(2, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, u));
+  glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(SVertex), (char*)vertex + offsetof(SVertex, r));
+  glVertexPointer  (3, GL_FLOAT        , sizeof(SVertex), (char*)vertex + offsetof(SVertex, x));
+  glTexCoordPointer(2, GL_FLOAT        , sizeof(SVertex), (char*)vertex + offsetof(SVertex, u));
   glEnableClientState(GL_COLOR_ARRAY);
   glEnableClientState(GL_VERTEX_ARRAY);
   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-  glDrawArrays(GL_QUADS, 0, m_vertex_count);
+  glDrawArrays(GL_QUADS, 0, vertex_count);
   glPopClientAttrib();
 #else
   // GLES 2.0 version. Cannot draw quads. Convert to triangles.
@@ -133,22 +157,24 @@ void CGUIFontTTFGL::End()
   GLint colLoc  = g_Windowing.GUIShaderGetCol();
   GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
 
-  // stack object until VBOs will be used
-  std::vector<SVertex> vecVertices( 6 * (m_vertex_count / 4) );
-  SVertex *vertices = &vecVertices[0];
+  // reuse the buffer of the last frame rather than allocating a new one every time
+  m_triangles.resize(6 * (vertex_count / 4));
+  if (m_triangles.empty())
+    return;
+  SVertex *vertices = &m_triangles[0];
 
-  for (int i=0; i<m_vertex_count; i+=4)
+  for (int i=0; i<vertex_count; i+=4)
   {
-    *vertices++ = m_vertex[i];
-    *vertices++ = m_vertex[i+1];
-    *vertices++ = m_vertex[i+2];
+    *vertices++ = vertex[i];
+    *vertices++ = vertex[i+1];
+    *vertices++ = vertex[i+2];
 
-    *vertices++ = m_vertex[i+1];
-    *vertices++ = m_vertex[i+3];
-    *vertices++ = m_vertex[i+2];
+    *vertices++ = vertex[i+1];
+    *vertices++ = vertex[i+3];
+    *vertices++ = vertex[i+2];
   }
 
-  vertices = &vecVertices[0];
+  vertices = &m_triangles[0];
 
   glVertexAttribPointer(posLoc,  3, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, x));
   // Normalize color values. Does not affect Performance at all.
@@ -159,17 +185,15 @@ void CGUIFontTTFGL::End()
   glEnableVertexAttribArray(colLoc);
   glEnableVertexAttribArray(tex0Loc);
 
-  glDrawArrays(GL_TRIANGLES, 0, vecVertices.size());
+  glDrawArrays(GL_TRIANGLES, 0, m_triangles.size());
 
   glDisableVertexAttribArray(posLoc);
   glDisableVertexAttribArray(colLoc);
   glDisableVertexAttribArray(tex0Loc);
-
-  g_Windowing.DisableGUIShader();
 #endif
 }
 
-CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
+CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int page, unsigned int& newHeight)
 {
   newHeight = CBaseTexture::PadPow2(newHeight);
 
@@ -181,62 +205,60 @@ CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
     delete newTexture;
     return NULL;
   }
-  m_textureHeight = newTexture->GetHeight();
-  m_textureWidth = newTexture->GetWidth();
+  Page &p = m_pages[page];
+  p.height = newTexture->GetHeight();
 
-  memset(newTexture->GetPixels(), 0, m_textureHeight * newTexture->GetPitch());
-  if (m_texture)
+  memset(newTexture->GetPixels(), 0, p.height * newTexture->GetPitch());
+  if (p.texture)
   {
-    unsigned char* src = (unsigned char*) m_texture->GetPixels();
+    unsigned char* src = (unsigned char*) p.texture->GetPixels();
     unsigned char* dst = (unsigned char*) newTexture->GetPixels();
-    for (unsigned int y = 0; y < m_texture->GetHeight(); y++)
+    for (unsigned int y = 0; y < p.texture->GetHeight(); y++)
     {
-      memcpy(dst, src, m_texture->GetPitch());
-      src += m_texture->GetPitch();
+      memcpy(dst, src, p.texture->GetPitch());
+      src += p.texture->GetPitch();
       dst += newTexture->GetPitch();
     }
-    delete m_texture;
+    delete p.texture;
   }
 
   return newTexture;
 }
 
-bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+bool CGUIFontTTFGL::CopyCharToTexture(unsigned int page, const Glyph &glyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
 {
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-
-  unsigned char* source = (unsigned char*) bitmap.buffer;
-  unsigned char* target = (unsigned char*) m_texture->GetPixels() + y1 * m_texture->GetPitch() + x1;
+  CBaseTexture *texture = m_pages[page].texture;
+  const unsigned char* source = &glyph.pixels[0];
+  unsigned char* target = (unsigned char*) texture->GetPixels() + y1 * texture->GetPitch() + x1;
 
   for (unsigned int y = y1; y < y2; y++)
   {
     memcpy(target, source, x2-x1);
-    source += bitmap.width;
-    target += m_texture->GetPitch();
+    source += glyph.width;
+    target += texture->GetPitch();
   }
-  // THE SOURCE VALUES ARE THE SAME IN BOTH SITUATIONS.
 
-  // Since we have a new texture, we need to delete the old one
+  // The texture of the page is uploaded again when next drawn
   // the Begin(); End(); stuff is handled by whoever called us
-  if (m_bTextureLoaded)
+  if (m_pages[page].loaded)
   {
     g_graphicsContext.BeginPaint();  //FIXME
-    DeleteHardwareTexture();
+    DeleteHardwareTexture(page);
     g_graphicsContext.EndPaint();
-    m_bTextureLoaded = false;
   }
 
   return TRUE;
 }
 
 
-void CGUIFontTTFGL::DeleteHardwareTexture()
+void CGUIFontTTFGL::DeleteHardwareTexture(unsigned int page)
 {
-  if (m_bTextureLoaded)
+  Page &p = m_pages[page];
+  if (p.loaded)
   {
-    if (glIsTexture(m_nTexture))
-      g_TextureManager.ReleaseHwTexture(m_nTexture);
-    m_bTextureLoaded = false;
+    if (glIsTexture(p.hwTexture))
+      g_TextureManager.ReleaseHwTexture(p.hwTexture);
+    p.loaded = false;
   }
 }
 
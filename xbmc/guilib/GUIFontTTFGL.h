@@ -45,10 +45,17 @@ public:
   virtual void End();
 
 protected:
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
-  virtual void DeleteHardwareTexture();
+  virtual CBaseTexture* ReallocTexture(unsigned int page, unsigned int& newHeight);
+  virtual bool CopyCharToTexture(unsigned int page, const Glyph &glyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
+  virtual void DeleteHardwareTexture(unsigned int page);
 
+  /*! \brief Draw the vertices of a page of the glyph texture, uploading the page if it changed.
+   */
+  void DrawPage(unsigned int page);
+
+#ifndef HAS_GL
+  std::vector<SVertex> m_triangles;   ///< GLES can't draw quads, so the vertices are converted to triangles in here
+#endif
 };
 
 #endif
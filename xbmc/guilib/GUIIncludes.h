@@ -24,6 +24,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 // forward definitions
 class TiXmlElement;
@@ -50,6 +51,10 @@ public:
   void ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions = NULL);
   const INFO::CSkinVariableString* CreateSkinVariable(const CStdString& name, int context);
 
+  /*! \brief Get the files includes have been loaded from so far
+   */
+  const std::vector<CStdString> &GetFiles() const { return m_files; };
+
 private:
   void ResolveIncludesForNode(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions = NULL);
   CStdString ResolveConstant(const CStdString &constant) const;
@@ -144,6 +144,13 @@ public:
    */
   bool SetScrolling(bool scrolling);
 
+  /*! \brief Get and set how far the text has scrolled
+   Lets the scroll position be carried over to another label showing the same text.
+   \sa CGUIListGroup::SaveState
+   */
+  const CScrollInfo &GetScrollInfo() const { return m_scrollInfo; };
+  void SetScrollInfo(const CScrollInfo &info) { m_scrollInfo = info; };
+
   /*! \brief Set how this label should handle overflowing text.
    \param overflow the overflow type
    \sa OVER_FLOW
@@ -234,6 +234,104 @@ void CGUIListGroup::SetState(bool selected, bool focused)
   }
 }
 
+static void SaveAnimations(const std::vector<CAnimation> &animations, unsigned int control, CGUIListGroupState &state)
+{
+  for (unsigned int i = 0; i < animations.size(); i++)
+  {
+    const CAnimation &anim = animations[i];
+    if (anim.GetState() == ANIM_STATE_NONE && anim.GetQueuedProcess() == ANIM_PROCESS_NONE)
+      continue;
+    CGUIListGroupState::AnimationState animation;
+    animation.control = control;
+    animation.animation = i;
+    animation.progress = anim.GetProgress();
+    state.m_animations.push_back(animation);
+  }
+}
+
+bool CGUIListGroup::SaveState(CGUIListGroupState &state) const
+{
+  state = CGUIListGroupState();
+  SaveChildStates(state);
+  return !state.m_animations.empty() || !state.m_scrolling.empty();
+}
+
+void CGUIListGroup::SaveChildStates(CGUIListGroupState &state) const
+{
+  SaveAnimations(m_animations, state.m_controls++, state);
+  for (ciControls it = m_children.begin(); it != m_children.end(); ++it)
+  {
+    const CGUIControl *child = *it;
+    if (child->GetControlType() == CGUIControl::GUICONTROL_LISTGROUP)
+    {
+      ((const CGUIListGroup *)child)->SaveChildStates(state);
+      continue;
+    }
+    SaveAnimations(child->GetAnimations(), state.m_controls++, state);
+    if (child->GetControlType() == CGUIControl::GUICONTROL_LISTLABEL)
+    {
+      const CScrollInfo &info = ((const CGUIListLabel *)child)->GetScrollInfo();
+      if (info.characterPos || info.pixelPos != -info.initialPos)
+      {
+        CGUIListGroupState::ScrollState scrolling;
+        scrolling.label = state.m_labels;
+        scrolling.characterPos = info.characterPos;
+        scrolling.pixelPos = info.pixelPos;
+        scrolling.waitTime = info.waitTime;
+        state.m_scrolling.push_back(scrolling);
+      }
+      state.m_labels++;
+    }
+  }
+}
+
+void CGUIListGroup::RestoreState(const CGUIListGroupState &state)
+{
+  // only a state kept from a copy of the same layout fits
+  CGUIListGroupState current;
+  SaveChildStates(current);
+  if (current.m_controls != state.m_controls || current.m_labels != state.m_labels)
+    return;
+
+  unsigned int control = 0, label = 0, animation = 0, scrolling = 0;
+  RestoreChildStates(state, control, label, animation, scrolling);
+}
+
+static void RestoreAnimations(CGUIControl *control, unsigned int index, const CGUIListGroupState &state, unsigned int &animation)
+{
+  for (; animation < state.m_animations.size() && state.m_animations[animation].control == index; animation++)
+    control->SetAnimationProgress(state.m_animations[animation].animation, state.m_animations[animation].progress);
+}
+
+void CGUIListGroup::RestoreChildStates(const CGUIListGroupState &state, unsigned int &control, unsigned int &label, unsigned int &animation, unsigned int &scrolling)
+{
+  RestoreAnimations(this, control++, state, animation);
+  for (iControls it = m_children.begin(); it != m_children.end(); ++it)
+  {
+    CGUIControl *child = *it;
+    if (child->GetControlType() == CGUIControl::GUICONTROL_LISTGROUP)
+    {
+      ((CGUIListGroup *)child)->RestoreChildStates(state, control, label, animation, scrolling);
+      continue;
+    }
+    RestoreAnimations(child, control++, state, animation);
+    if (child->GetControlType() == CGUIControl::GUICONTROL_LISTLABEL)
+    {
+      if (scrolling < state.m_scrolling.size() && state.m_scrolling[scrolling].label == label)
+      {
+        CGUIListLabel *listLabel = (CGUIListLabel *)child;
+        CScrollInfo info = listLabel->GetScrollInfo();
+        info.characterPos = state.m_scrolling[scrolling].characterPos;
+        info.pixelPos = state.m_scrolling[scrolling].pixelPos;
+        info.waitTime = state.m_scrolling[scrolling].waitTime;
+        listLabel->SetScrollInfo(info);
+        scrolling++;
+      }
+      label++;
+    }
+  }
+}
+
 void CGUIListGroup::SelectItemFromPoint(const CPoint &point)
 {
   CPoint controlCoords(point);
@@ -26,6 +26,40 @@
  */
 
 #include "GUIControlGroup.h"
+#include "GUIFont.h"
+
+/*!
+ \ingroup controls
+ \brief The state of the controls of a list group that builds up while its item is shown
+ \sa CGUIListGroup::SaveState
+ */
+class CGUIListGroupState
+{
+public:
+  CGUIListGroupState() : m_controls(0), m_labels(0) {};
+
+  /*! \brief how far an animation of one of the controls has got */
+  struct AnimationState
+  {
+    unsigned int control;          ///< the group or control, numbered depth first
+    unsigned int animation;        ///< which of its animations
+    CAnimation::Progress progress;
+  };
+
+  /*! \brief how far the text of one of the list labels has scrolled */
+  struct ScrollState
+  {
+    unsigned int label;            ///< the list label, numbered depth first
+    unsigned int characterPos;
+    float        pixelPos;
+    unsigned int waitTime;
+  };
+
+  unsigned int                m_controls;   ///< number of groups and controls in the layout the state came from
+  unsigned int                m_labels;     ///< number of list labels in that layout
+  std::vector<AnimationState> m_animations; ///< animations that are running or applied
+  std::vector<ScrollState>    m_scrolling;  ///< labels that have scrolled
+};
 
 /*!
  \ingroup controls
@@ -56,7 +90,25 @@ public:
   void SetState(bool selected, bool focused);
   void SelectItemFromPoint(const CPoint &point);
 
+  /*! \brief Keep the animations and label scroll positions of the group and its controls
+   Used to carry them over to another copy of the same layout when the layout of an item is recycled.
+   Only animations that have started and labels that have scrolled are kept.
+   \param state the state to fill in.
+   \return true if an animation is running or a label has scrolled, false if there is nothing worth keeping.
+   \sa RestoreState
+   */
+  bool SaveState(CGUIListGroupState &state) const;
+
+  /*! \brief Apply a state kept by SaveState() from a copy of the same layout
+   \param state the state to apply. Controls it has no state for are left as they are.
+   \sa SaveState
+   */
+  void RestoreState(const CGUIListGroupState &state);
+
 protected:
+  void SaveChildStates(CGUIListGroupState &state) const;
+  void RestoreChildStates(const CGUIListGroupState &state, unsigned int &control, unsigned int &label, unsigned int &animation, unsigned int &scrolling);
+
   const CGUIListItem *m_item;
 };
 
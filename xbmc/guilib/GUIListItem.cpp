@@ -30,6 +30,8 @@ CGUIListItem::CGUIListItem(const CGUIListItem& item)
 {
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_layoutState = NULL;
+  m_focusedLayoutState = NULL;
   *this = item;
   SetInvalid();
 }
@@ -44,6 +46,8 @@ CGUIListItem::CGUIListItem(void)
   m_overlayIcon = ICON_OVERLAY_NONE;
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_layoutState = NULL;
+  m_focusedLayoutState = NULL;
 }
 
 CGUIListItem::CGUIListItem(const CStdString& strLabel)
@@ -57,6 +61,8 @@ CGUIListItem::CGUIListItem(const CStdString& strLabel)
   m_overlayIcon = ICON_OVERLAY_NONE;
   m_layout = NULL;
   m_focusedLayout = NULL;
+  m_layoutState = NULL;
+  m_focusedLayoutState = NULL;
 }
 
 CGUIListItem::~CGUIListItem(void)
@@ -362,6 +368,8 @@ void CGUIListItem::FreeMemory(bool immediately)
     delete m_focusedLayout;
     m_focusedLayout = NULL;
   }
+  SetLayoutState(NULL, false);
+  SetLayoutState(NULL, true);
 }
 
 void CGUIListItem::SetLayout(CGUIListItemLayout *layout)
@@ -386,6 +394,35 @@ CGUIListItemLayout *CGUIListItem::GetFocusedLayout()
   return m_focusedLayout;
 }
 
+CGUIListItemLayout *CGUIListItem::DetachLayout()
+{
+  CGUIListItemLayout *layout = m_layout;
+  m_layout = NULL;
+  return layout;
+}
+
+CGUIListItemLayout *CGUIListItem::DetachFocusedLayout()
+{
+  CGUIListItemLayout *layout = m_focusedLayout;
+  m_focusedLayout = NULL;
+  return layout;
+}
+
+void CGUIListItem::SetLayoutState(CGUIListGroupState *state, bool focused)
+{
+  CGUIListGroupState *&current = focused ? m_focusedLayoutState : m_layoutState;
+  delete current;
+  current = state;
+}
+
+CGUIListGroupState *CGUIListItem::DetachLayoutState(bool focused)
+{
+  CGUIListGroupState *&current = focused ? m_focusedLayoutState : m_layoutState;
+  CGUIListGroupState *state = current;
+  current = NULL;
+  return state;
+}
+
 void CGUIListItem::SetInvalid()
 {
   if (m_layout) m_layout->SetInvalid();
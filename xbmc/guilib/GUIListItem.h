@@ -35,6 +35,7 @@
 
 //  Forward
 class CGUIListItemLayout;
+class CGUIListGroupState;
 class CArchive;
 class CVariant;
 
@@ -145,6 +146,22 @@ public:
   void SetFocusedLayout(CGUIListItemLayout *layout);
   CGUIListItemLayout *GetFocusedLayout();
 
+  /*! \brief Take the layouts away from the item without freeing them
+   The caller becomes responsible for the returned layout, which may be NULL.
+   \sa CGUIListItemLayoutPool
+   */
+  CGUIListItemLayout *DetachLayout();
+  CGUIListItemLayout *DetachFocusedLayout();
+
+  /*! \brief Keep the state of a layout taken away from the item, for the next layout it gets
+   The item owns the state until it is detached again, or the item's memory is freed.
+   \param state the state, which may be NULL.
+   \param focused whether it is the state of the focused layout.
+   \sa CGUIListItemLayout::SaveState
+   */
+  void SetLayoutState(CGUIListGroupState *state, bool focused);
+  CGUIListGroupState *DetachLayoutState(bool focused);
+
   void FreeIcons();
   void FreeMemory(bool immediately = false);
   void SetInvalid();
@@ -181,6 +198,8 @@ protected:
 
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
+  CGUIListGroupState *m_layoutState;
+  CGUIListGroupState *m_focusedLayoutState;
   bool m_bSelected;     // item is selected or not
 
   struct icompare
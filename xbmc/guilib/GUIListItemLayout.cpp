@@ -36,6 +36,7 @@ CGUIListItemLayout::CGUIListItemLayout()
   m_condition = 0;
   m_focused = false;
   m_invalidated = true;
+  m_restoreState = NULL;
   m_group.SetPushUpdates(true);
 }
 
@@ -47,10 +48,12 @@ CGUIListItemLayout::CGUIListItemLayout(const CGUIListItemLayout &from)
   m_focused = from.m_focused;
   m_condition = from.m_condition;
   m_invalidated = true;
+  m_restoreState = NULL;
 }
 
 CGUIListItemLayout::~CGUIListItemLayout()
 {
+  delete m_restoreState;
 }
 
 bool CGUIListItemLayout::IsAnimating(ANIMATION_TYPE animType)
@@ -83,6 +86,12 @@ void CGUIListItemLayout::Process(CGUIListItem *item, int parentID, unsigned int
     if (!item->IsFileItem())
       delete fileItem;
   }
+  if (m_restoreState)
+  {
+    m_group.RestoreState(*m_restoreState);
+    delete m_restoreState;
+    m_restoreState = NULL;
+  }
 
   // update visibility, and render
   m_group.SetState(item->IsSelected() || m_isPlaying, m_focused);
@@ -219,9 +228,95 @@ void CGUIListItemLayout::FreeResources(bool immediately)
   m_group.FreeResources(immediately);
 }
 
+void CGUIListItemLayout::ResetState()
+{
+  // forget anything to do with the item we were showing: animations, focus and scrolling labels
+  m_group.ResetAnimations();
+  m_group.SetFocusedItem(0);
+  RestoreState(NULL);
+  SetInvalid();
+}
+
+CGUIListGroupState *CGUIListItemLayout::SaveState() const
+{
+  CGUIListGroupState *state = new CGUIListGroupState;
+  if (!m_group.SaveState(*state))
+  {
+    delete state;
+    return NULL;
+  }
+  return state;
+}
+
+void CGUIListItemLayout::RestoreState(CGUIListGroupState *state)
+{
+  delete m_restoreState;
+  m_restoreState = state;
+}
+
 #ifdef _DEBUG
 void CGUIListItemLayout::DumpTextureUse()
 {
   m_group.DumpTextureUse();
 }
 #endif
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool()
+{
+  m_from = NULL;
+  m_allocated = 0;
+}
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from)
+{
+  m_from = NULL;
+  m_allocated = 0;
+}
+
+CGUIListItemLayoutPool::~CGUIListItemLayoutPool()
+{
+  Clear();
+}
+
+CGUIListItemLayoutPool &CGUIListItemLayoutPool::operator=(const CGUIListItemLayoutPool &from)
+{
+  Clear();
+  return *this;
+}
+
+CGUIListItemLayout *CGUIListItemLayoutPool::Acquire(const CGUIListItemLayout &from)
+{
+  if (m_from != &from)
+  { // the container has switched layouts
+    Clear();
+    m_from = &from;
+  }
+  if (m_layouts.empty())
+  {
+    m_allocated++;
+    return new CGUIListItemLayout(from);
+  }
+  CGUIListItemLayout *layout = m_layouts.back();
+  m_layouts.pop_back();
+  layout->ResetState();
+  return layout;
+}
+
+void CGUIListItemLayoutPool::Release(CGUIListItemLayout *layout, unsigned int maxSize)
+{
+  if (!layout)
+    return;
+  layout->FreeResources();
+  if (m_from && m_layouts.size() < maxSize)
+    m_layouts.push_back(layout);
+  else
+    delete layout;
+}
+
+void CGUIListItemLayoutPool::Clear()
+{
+  for (unsigned int i = 0; i < m_layouts.size(); i++)
+    delete m_layouts[i];
+  m_layouts.clear();
+  m_from = NULL;
+}
@@ -24,6 +24,8 @@
 #include "GUITexture.h"
 #include "GUIInfoTypes.h"
 
+#include <vector>
+
 class CGUIListItem;
 class CFileItem;
 class CLabelInfo;
@@ -44,6 +46,19 @@ public:
   void ResetAnimation(ANIMATION_TYPE animType);
   void SetInvalid() { m_invalidated = true; };
   void FreeResources(bool immediately = false);
+  void ResetState();
+
+  /*! \brief Keep the state of the layout that builds up while its item is shown
+   \return the state, owned by the caller, or NULL if there is nothing worth keeping.
+   \sa CGUIListGroup::SaveState, RestoreState
+   */
+  CGUIListGroupState *SaveState() const;
+
+  /*! \brief Carry over the state kept from another copy of the same layout for the item
+   The state is applied once the layout shows the item, as showing a different text resets the labels.
+   \param state the state, owned by the layout from now on, which may be NULL.
+   */
+  void RestoreState(CGUIListGroupState *state);
 
 //#ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
   void CreateListControlLayouts(float width, float height, bool focused, const CLabelInfo &labelInfo, const CLabelInfo &labelInfo2, const CTextureInfo &texture, const CTextureInfo &textureFocus, float texHeight, float iconWidth, float iconHeight, const CStdString &nofocusCondition, const CStdString &focusCondition);
@@ -69,8 +84,47 @@ protected:
   float m_height;
   bool m_focused;
   bool m_invalidated;
+  CGUIListGroupState *m_restoreState; ///< state to apply on the next Process()
 
   unsigned int m_condition;
   CGUIInfoBool m_isPlaying;
 };
 
+/*!
+ \brief Keeps the item layouts of a container that are no longer bound to an item.
+
+ Layouts copied from the container's layout are handed back here when their item scrolls out of
+ view and are given to the next item that scrolls into view, so that scrolling doesn't copy the
+ whole control tree for every item. Copying a pool gives an empty pool.
+ */
+class CGUIListItemLayoutPool
+{
+public:
+  CGUIListItemLayoutPool();
+  CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from);
+  ~CGUIListItemLayoutPool();
+  CGUIListItemLayoutPool &operator=(const CGUIListItemLayoutPool &from);
+
+  /*! \brief Get a layout for an item, reusing a pooled one if there is one.
+   \param from the layout to copy if there isn't. Pooled layouts copied from a different layout are freed.
+   \return the layout, owned by the caller.
+   */
+  CGUIListItemLayout *Acquire(const CGUIListItemLayout &from);
+
+  /*! \brief Give a layout back once its item no longer needs it.
+   \param layout the layout, which may be NULL.
+   \param maxSize the most layouts to keep, any further ones are freed.
+   */
+  void Release(CGUIListItemLayout *layout, unsigned int maxSize);
+
+  void Clear();
+  unsigned int Size() const { return m_layouts.size(); };
+
+  /*! \brief Number of layouts copied by Acquire() so far */
+  unsigned int GetAllocated() const { return m_allocated; };
+
+private:
+  const CGUIListItemLayout *m_from;
+  std::vector<CGUIListItemLayout *> m_layouts;
+  unsigned int m_allocated;
+};
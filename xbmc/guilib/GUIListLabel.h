@@ -51,6 +51,8 @@ public:
   void SetLabel(const CStdString &label);
   void SetSelected(bool selected);
   void SetScrolling(bool scrolling);
+  const CScrollInfo &GetScrollInfo() const { return m_label.GetScrollInfo(); };
+  void SetScrollInfo(const CScrollInfo &info) { m_label.SetScrollInfo(info); };
 
   static void CheckAndCorrectOverlap(CGUIListLabel &label1, CGUIListLabel &label2)
   {
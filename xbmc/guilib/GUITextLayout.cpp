@@ -22,6 +22,9 @@
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
+#include "GUIFontTTF.h"
+#include "GraphicContext.h"
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
 
@@ -29,6 +32,9 @@ using namespace std;
 
 #define WORK_AROUND_NEEDED_FOR_LINE_BREAKS
 
+// characters of laid out text kept by the layout cache, around a couple of MB
+#define TEXT_LAYOUT_CACHE_CAPACITY (256 * 1024)
+
 CGUIString::CGUIString(iString start, iString end, bool carriageReturn)
 {
   m_text.assign(start, end);
@@ -43,6 +49,118 @@ CStdString CGUIString::GetAsString() const
   return text;
 }
 
+bool CGUITextLayoutCache::CKey::operator<(const CKey &right) const
+{
+  if (m_font != right.m_font) return m_font < right.m_font;
+  if (m_style != right.m_style) return m_style < right.m_style;
+  if (m_lineHeight != right.m_lineHeight) return m_lineHeight < right.m_lineHeight;
+  if (m_scale != right.m_scale) return m_scale < right.m_scale;
+  if (m_maxWidth != right.m_maxWidth) return m_maxWidth < right.m_maxWidth;
+  if (m_maxHeight != right.m_maxHeight) return m_maxHeight < right.m_maxHeight;
+  if (m_color != right.m_color) return m_color < right.m_color;
+  if (m_wrap != right.m_wrap) return m_wrap < right.m_wrap;
+  if (m_forceLTR != right.m_forceLTR) return m_forceLTR < right.m_forceLTR;
+  if (m_utf8 != right.m_utf8) return m_utf8 < right.m_utf8;
+  return m_text < right.m_text;
+}
+
+size_t CGUITextLayoutCache::CEntry::GetSize() const
+{
+  size_t size = m_text.size();
+  for (vector<CGUIString>::const_iterator i = m_lines.begin(); i != m_lines.end(); ++i)
+    size += i->m_text.size();
+  return size;
+}
+
+CGUITextLayoutCache::CGUITextLayoutCache()
+{
+  m_characters = 0;
+  m_capacity = TEXT_LAYOUT_CACHE_CAPACITY;
+  m_hits = m_misses = 0;
+}
+
+CGUITextLayoutCache &CGUITextLayoutCache::Get()
+{
+  static CGUITextLayoutCache cache;
+  return cache;
+}
+
+bool CGUITextLayoutCache::Find(const CKey &key, CEntry &entry)
+{
+  CSingleLock lock(m_section);
+  if (!m_capacity)
+    return false;
+
+  Items::iterator i = m_items.find(key);
+  if (i == m_items.end())
+  {
+    m_misses++;
+    return false;
+  }
+  m_hits++;
+  m_lru.splice(m_lru.begin(), m_lru, i->second.lru);
+  entry = i->second.entry;
+  return true;
+}
+
+void CGUITextLayoutCache::Add(const CKey &key, const CEntry &entry)
+{
+  CSingleLock lock(m_section);
+  size_t size = key.m_text.size() + entry.GetSize();
+  if (size > m_capacity / 16)
+    return; // the odd huge text isn't worth evicting everything else for
+
+  pair<Items::iterator, bool> added = m_items.insert(make_pair(key, CItem()));
+  if (!added.second)
+    return;
+  added.first->second.entry = entry;
+  added.first->second.size = size;
+  m_lru.push_front(&added.first->first);
+  added.first->second.lru = m_lru.begin();
+  m_characters += size;
+  Trim();
+}
+
+void CGUITextLayoutCache::Trim()
+{
+  while (m_characters > m_capacity && !m_lru.empty())
+  {
+    Items::iterator i = m_items.find(*m_lru.back());
+    m_characters -= i->second.size;
+    m_lru.pop_back();
+    m_items.erase(i);
+  }
+}
+
+void CGUITextLayoutCache::Clear()
+{
+  CSingleLock lock(m_section);
+  m_items.clear();
+  m_lru.clear();
+  m_characters = 0;
+}
+
+void CGUITextLayoutCache::SetCapacity(size_t characters)
+{
+  CSingleLock lock(m_section);
+  m_capacity = characters;
+  Trim();
+}
+
+size_t CGUITextLayoutCache::GetCapacity() const
+{
+  CSingleLock lock(m_section);
+  return m_capacity;
+}
+
+void CGUITextLayoutCache::GetStatistics(unsigned int &hits, unsigned int &misses, size_t &characters) const
+{
+  CSingleLock lock(m_section);
+  hits = m_hits;
+  misses = m_misses;
+  characters = m_characters;
+}
+
 CGUITextLayout::CGUITextLayout(CGUIFont *font, bool wrap, float fHeight, CGUIFont *borderFont)
 {
   m_font = font;
@@ -52,6 +170,11 @@ CGUITextLayout::CGUITextLayout(CGUIFont *font, bool wrap, float fHeight, CGUIFon
   m_maxHeight = fHeight;
   m_textWidth = 0;
   m_textHeight = 0;
+  m_cacheX = m_cacheY = m_cacheMaxWidth = 0;
+  m_cacheColor = m_cacheShadowColor = 0;
+  m_cacheAlignment = 0;
+  m_cacheSolid = false;
+  m_lastWasUTF8 = false;
 }
 
 void CGUITextLayout::SetWrap(bool bWrap)
@@ -81,17 +204,33 @@ void CGUITextLayout::Render(float x, float y, float angle, color_t color, color_
     alignment &= ~XBFONT_CENTER_Y;
   }
   m_font->Begin();
-  for (vector<CGUIString>::iterator i = m_lines.begin(); i != m_lines.end(); i++)
+  // reuse the vertices of the last frame if the text is drawn the same way again
+  bool cached = m_vertexCache.IsValid() && m_cacheX == x && m_cacheY == y && m_cacheColor == color &&
+                m_cacheShadowColor == shadowColor && m_cacheAlignment == alignment && m_cacheMaxWidth == maxWidth &&
+                m_cacheSolid == solid && m_font->DrawVertexCache(m_vertexCache);
+  if (!cached)
   {
-    const CGUIString &string = *i;
-    uint32_t align = alignment;
-    if (align & XBFONT_JUSTIFIED && string.m_carriageReturn)
-      align &= ~XBFONT_JUSTIFIED;
-    if (solid)
-      m_font->DrawText(x, y, m_colors[0], shadowColor, string.m_text, align, maxWidth);
-    else
-      m_font->DrawText(x, y, m_colors, shadowColor, string.m_text, align, maxWidth);
-    y += m_font->GetLineHeight();
+    m_cacheX = x;
+    m_cacheY = y;
+    m_cacheColor = color;
+    m_cacheShadowColor = shadowColor;
+    m_cacheAlignment = alignment;
+    m_cacheMaxWidth = maxWidth;
+    m_cacheSolid = solid;
+    m_font->BeginVertexCache(m_vertexCache);
+    for (vector<CGUIString>::iterator i = m_lines.begin(); i != m_lines.end(); i++)
+    {
+      const CGUIString &string = *i;
+      uint32_t align = alignment;
+      if (align & XBFONT_JUSTIFIED && string.m_carriageReturn)
+        align &= ~XBFONT_JUSTIFIED;
+      if (solid)
+        m_font->DrawText(x, y, m_colors[0], shadowColor, string.m_text, align, maxWidth);
+      else
+        m_font->DrawText(x, y, m_colors, shadowColor, string.m_text, align, maxWidth);
+      y += m_font->GetLineHeight();
+    }
+    m_font->EndVertexCache(m_vertexCache);
   }
   m_font->End();
   if (angle)
@@ -210,12 +349,40 @@ void CGUITextLayout::RenderOutline(float x, float y, color_t color, color_t outl
 
 bool CGUITextLayout::Update(const CStdString &text, float maxWidth, bool forceUpdate /*= false*/, bool forceLTRReadingOrder /*= false*/)
 {
-  // convert to utf16
-  CStdStringW utf16;
-  utf8ToW(text, utf16);
+  if (m_lastWasUTF8 && text == m_lastUTF8 && !forceUpdate)
+    return false;
+
+  // text laid out the same way before skips the charset conversion as well
+  CGUITextLayoutCache::CKey key;
+  CGUITextLayoutCache::CEntry entry;
+  bool cacheable = GetCacheKey(key, maxWidth, forceLTRReadingOrder);
+  key.m_utf8 = true;
+  key.m_text = text;
+  bool changed;
+  if (cacheable && CGUITextLayoutCache::Get().Find(key, entry))
+  {
+    changed = forceUpdate || !entry.m_text.Equals(m_lastText);
+    if (changed)
+      ApplyCacheEntry(entry);
+  }
+  else
+  {
+    // convert to utf16
+    CStdStringW utf16;
+    utf8ToW(text, utf16);
+
+    changed = forceUpdate || !utf16.Equals(m_lastText);
+    if (changed)
+    {
+      Layout(utf16, maxWidth, forceLTRReadingOrder);
+      if (cacheable)
+        AddCacheEntry(key);
+    }
+  }
 
-  // update
-  return UpdateW(utf16, maxWidth, forceUpdate, forceLTRReadingOrder);
+  m_lastUTF8 = text;
+  m_lastWasUTF8 = true;
+  return changed;
 }
 
 bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bool forceUpdate /*= false*/, bool forceLTRReadingOrder /*= false*/)
@@ -223,11 +390,34 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   if (text.Equals(m_lastText) && !forceUpdate)
     return false;
 
+  m_lastWasUTF8 = false;
+
+  CGUITextLayoutCache::CKey key;
+  CGUITextLayoutCache::CEntry entry;
+  if (GetCacheKey(key, maxWidth, forceLTRReadingOrder))
+  {
+    key.m_text.assign((const char *)text.c_str(), text.size() * sizeof(wchar_t));
+    if (CGUITextLayoutCache::Get().Find(key, entry))
+      ApplyCacheEntry(entry);
+    else
+    {
+      Layout(text, maxWidth, forceLTRReadingOrder);
+      AddCacheEntry(key);
+    }
+  }
+  else
+    Layout(text, maxWidth, forceLTRReadingOrder);
+  return true;
+}
+
+void CGUITextLayout::Layout(const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder)
+{
   vecText parsedText;
 
   // empty out our previous string
   m_lines.clear();
   m_colors.clear();
+  m_vertexCache.Invalidate();
   m_colors.push_back(m_textColor);
 
   // parse the text into our string objects
@@ -252,9 +442,46 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   CalcTextExtent();
 
   m_lastText = text;
+}
+
+bool CGUITextLayout::GetCacheKey(CGUITextLayoutCache::CKey &key, float maxWidth, bool forceLTRReadingOrder) const
+{
+  if (!m_font || !m_font->GetFont())
+    return false;
+
+  key.m_font = m_font->GetFont()->GetID();
+  key.m_style = m_font->GetStyle();
+  key.m_lineHeight = m_font->GetLineHeight();
+  key.m_scale = g_graphicsContext.GetGUIScaleX();
+  key.m_wrap = m_wrap && maxWidth > 0;
+  key.m_maxWidth = key.m_wrap ? maxWidth : 0;
+  key.m_maxHeight = m_maxHeight;
+  key.m_color = m_textColor;
+  key.m_forceLTR = forceLTRReadingOrder;
   return true;
 }
 
+void CGUITextLayout::ApplyCacheEntry(const CGUITextLayoutCache::CEntry &entry)
+{
+  m_lines = entry.m_lines;
+  m_colors = entry.m_colors;
+  m_textWidth = entry.m_width;
+  m_textHeight = entry.m_height;
+  m_lastText = entry.m_text;
+  m_vertexCache.Invalidate();
+}
+
+void CGUITextLayout::AddCacheEntry(const CGUITextLayoutCache::CKey &key) const
+{
+  CGUITextLayoutCache::CEntry entry;
+  entry.m_text = m_lastText;
+  entry.m_lines = m_lines;
+  entry.m_colors = m_colors;
+  entry.m_width = m_textWidth;
+  entry.m_height = m_textHeight;
+  CGUITextLayoutCache::Get().Add(key, entry);
+}
+
 // BidiTransform is used to handle RTL text flipping in the string
 void CGUITextLayout::BidiTransform(vector<CGUIString> &lines, bool forceLTRReadingOrder)
 {
@@ -643,7 +870,10 @@ void CGUITextLayout::AppendToUTF32(const CStdString &utf8, character_t colStyle,
 void CGUITextLayout::Reset()
 {
   m_lines.clear();
+  m_vertexCache.Invalidate();
   m_lastText.Empty();
+  m_lastUTF8.Empty();
+  m_lastWasUTF8 = false;
   m_textWidth = m_textHeight = 0;
 }
 
@@ -21,7 +21,12 @@
  */
 
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
+#include "GUIFont.h"
 
+#include <list>
+#include <map>
+#include <string>
 #include <vector>
 
 #ifdef __GNUC__
@@ -61,6 +66,100 @@ public:
   bool m_carriageReturn; // true if we have a carriage return here
 };
 
+/*!
+ \ingroup strings
+ \brief Process wide cache of laid out text, shared by every CGUITextLayout.
+
+ The same titles, genres and years are laid out by every list item and window that shows
+ them.  Layouts are kept by everything that decides how text is broken into lines and how
+ wide they are - the font file, style and scale, the wrapping width and height, the default
+ color and reading order - along with the text itself.  The least recently used layouts are
+ dropped once the text they hold exceeds the cache's capacity.
+ */
+class CGUITextLayoutCache
+{
+public:
+  class CKey
+  {
+  public:
+    CKey() : m_font(0), m_style(0), m_lineHeight(0), m_scale(0), m_maxWidth(0), m_maxHeight(0),
+             m_color(0), m_wrap(false), m_forceLTR(false), m_utf8(false) {};
+    bool operator<(const CKey &right) const;
+
+    unsigned int m_font;   ///< the font file's ID
+    uint32_t m_style;
+    float m_lineHeight;
+    float m_scale;
+    float m_maxWidth;      ///< 0 unless wrapping
+    float m_maxHeight;
+    color_t m_color;
+    bool m_wrap;
+    bool m_forceLTR;
+    bool m_utf8;           ///< whether m_text holds UTF-8 or the bytes of a wide string
+    std::string m_text;
+  };
+
+  class CEntry
+  {
+  public:
+    CEntry() : m_width(0), m_height(0) {};
+    size_t GetSize() const;
+
+    CStdStringW m_text;
+    std::vector<CGUIString> m_lines;
+    vecColors m_colors;
+    float m_width;
+    float m_height;
+  };
+
+  CGUITextLayoutCache();
+  static CGUITextLayoutCache &Get();
+
+  /*! \brief Look up a layout, marking it as the most recently used.
+   \param key what the layout was made from.
+   \param entry [out] the layout, if found.
+   \return true if the layout was found.
+   */
+  bool Find(const CKey &key, CEntry &entry);
+  void Add(const CKey &key, const CEntry &entry);
+
+  /*! \brief Drop all layouts, eg. when the fonts they were laid out with are unloaded or reloaded.
+   \sa GUIFontManager
+   */
+  void Clear();
+
+  /*! \brief Set the number of characters of laid out text to keep, 0 to disable the cache.
+   */
+  void SetCapacity(size_t characters);
+  size_t GetCapacity() const;
+
+  /*! \brief Get the cache's usage.
+   \param hits [out] the number of lookups that found a layout.
+   \param misses [out] the number of lookups that didn't.
+   \param characters [out] the number of characters of text held.
+   */
+  void GetStatistics(unsigned int &hits, unsigned int &misses, size_t &characters) const;
+
+private:
+  struct CItem
+  {
+    CEntry entry;
+    size_t size;   ///< characters held by the key's text and the entry
+    std::list<const CKey*>::iterator lru;
+  };
+  typedef std::map<CKey, CItem> Items;
+
+  void Trim();
+
+  Items m_items;
+  std::list<const CKey*> m_lru;  ///< most recently used first
+  size_t m_characters;
+  size_t m_capacity;
+  unsigned int m_hits;
+  unsigned int m_misses;
+  mutable CCriticalSection m_section;
+};
+
 class CGUITextLayout
 {
 public:
@@ -100,6 +199,10 @@ public:
   static void Filter(CStdString &text);
 
 protected:
+  void Layout(const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder);
+  bool GetCacheKey(CGUITextLayoutCache::CKey &key, float maxWidth, bool forceLTRReadingOrder) const;
+  void ApplyCacheEntry(const CGUITextLayoutCache::CEntry &entry);
+  void AddCacheEntry(const CGUITextLayoutCache::CKey &key) const;
   void ParseText(const CStdStringW &text, vecText &parsedText);
   void LineBreakText(const vecText &text, std::vector<CGUIString> &lines);
   void WrapText(const vecText &text, float maxWidth);
@@ -122,8 +225,20 @@ protected:
   color_t m_textColor;
 
   CStdStringW m_lastText;
+  CStdString m_lastUTF8;   // the text of the last Update(), if it was since the last UpdateW()
+  bool m_lastWasUTF8;
   float m_textWidth;
   float m_textHeight;
+
+  // the vertices of the text from the last Render() call and what it was called with
+  CGUIFontVertexCache m_vertexCache;
+  float m_cacheX;
+  float m_cacheY;
+  float m_cacheMaxWidth;
+  color_t m_cacheColor;
+  color_t m_cacheShadowColor;
+  uint32_t m_cacheAlignment;
+  bool m_cacheSolid;
 private:
   inline bool IsSpace(character_t letter) const XBMC_FORCE_INLINE
   {
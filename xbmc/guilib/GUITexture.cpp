@@ -162,6 +162,14 @@ bool CGUITextureBase::Process(unsigned int currentTime)
 
 void CGUITextureBase::Render()
 {
+  if (m_visible && m_isAllocated == LARGE && !m_texture.size())
+  { // still loading - if we're on screen, have it loaded before images that are just preloaded
+    CRect clip;
+    CRect rect(m_posX, m_posY, m_posX + m_width, m_posY + m_height);
+    if (!g_graphicsContext.GetClipRegion(clip) || !clip.Intersect(rect).IsEmpty())
+      g_largeTextureManager.PrioritizeImage(m_info.filename);
+  }
+
   if (!m_visible || !m_texture.size())
     return;
 
@@ -0,0 +1,263 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_GL)
+#include "GUITextureBatchGL.h"
+#include "Texture.h"
+#include "utils/log.h"
+#include "utils/GLUtils.h"
+
+#include <stddef.h>
+#include <algorithm>
+
+// how many batches back a quad may be moved to join one with the same textures
+#define MAX_BATCH_LOOKBACK 16
+
+CGUITextureBatchGL::CGUITextureBatchGL()
+{
+  m_used = 0;
+  m_vbo = 0;
+  m_vboChecked = false;
+  m_vboSupported = false;
+  m_drawCalls = 0;
+  m_quads = 0;
+  m_lastDrawCalls = 0;
+  m_lastQuads = 0;
+}
+
+CGUITextureBatchGL::~CGUITextureBatchGL()
+{
+}
+
+CGUITextureBatchGL &CGUITextureBatchGL::Get()
+{
+  static CGUITextureBatchGL batch;
+  return batch;
+}
+
+void CGUITextureBatchGL::AddQuad(CBaseTexture *texture, CBaseTexture *diffuse, const float *x, const float *y, const float *z, color_t color,
+                                 const float *u, const float *v, const float *du, const float *dv)
+{
+  CRect bounds(x[0], y[0], x[0], y[0]);
+  for (int i = 1; i < 4; i++)
+  {
+    bounds.x1 = std::min(bounds.x1, x[i]);
+    bounds.y1 = std::min(bounds.y1, y[i]);
+    bounds.x2 = std::max(bounds.x2, x[i]);
+    bounds.y2 = std::max(bounds.y2, y[i]);
+  }
+  // with a perspective camera the final coordinates aren't screen coordinates, so don't reorder anything
+  bool flat = z[0] == 0.0f && z[1] == 0.0f && z[2] == 0.0f && z[3] == 0.0f;
+
+  // find the batch to add the quad to. Going back from the last batch, we may skip a batch only
+  // if the quad doesn't overlap it, otherwise drawing the quad earlier would change the result
+  Batch *batch = NULL;
+  for (unsigned int i = m_used; i > 0 && m_used - i < MAX_BATCH_LOOKBACK; i--)
+  {
+    Batch &candidate = m_batches[i - 1];
+    if (candidate.texture == texture && candidate.diffuse == diffuse)
+    {
+      batch = &candidate;
+      break;
+    }
+    CRect overlap(bounds);
+    if (!flat || !candidate.flat || !overlap.Intersect(candidate.bounds).IsEmpty())
+      break;
+  }
+
+  if (!batch)
+  {
+    if (m_used == m_batches.size())
+      m_batches.resize(m_used + 1);
+    batch = &m_batches[m_used++];
+    batch->texture = texture;
+    batch->diffuse = diffuse;
+    batch->bounds = bounds;
+    batch->flat = flat;
+    batch->vertices.clear();
+  }
+  else
+  {
+    batch->bounds.x1 = std::min(batch->bounds.x1, bounds.x1);
+    batch->bounds.y1 = std::min(batch->bounds.y1, bounds.y1);
+    batch->bounds.x2 = std::max(batch->bounds.x2, bounds.x2);
+    batch->bounds.y2 = std::max(batch->bounds.y2, bounds.y2);
+    batch->flat = batch->flat && flat;
+  }
+
+  PackedVertex vertex;
+  vertex.r = (GLubyte)GET_R(color);
+  vertex.g = (GLubyte)GET_G(color);
+  vertex.b = (GLubyte)GET_B(color);
+  vertex.a = (GLubyte)GET_A(color);
+  for (int i = 0; i < 4; i++)
+  {
+    vertex.x = x[i];
+    vertex.y = y[i];
+    vertex.z = z[i];
+    vertex.u = u[i];
+    vertex.v = v[i];
+    vertex.du = diffuse ? du[i] : 0.0f;
+    vertex.dv = diffuse ? dv[i] : 0.0f;
+    batch->vertices.push_back(vertex);
+  }
+  m_quads++;
+}
+
+void CGUITextureBatchGL::SetupTextureUnit(GLenum source)
+{
+  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, source);
+  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, source == GL_TEXTURE0 ? GL_PRIMARY_COLOR : GL_PREVIOUS);
+  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+}
+
+void CGUITextureBatchGL::Flush()
+{
+  if (!m_used)
+    return;
+
+  if (!m_vboChecked)
+  {
+    m_vboSupported = glewIsSupported("GL_ARB_vertex_buffer_object") == GL_TRUE;
+    if (m_vboSupported)
+      glGenBuffersARB(1, &m_vbo);
+    m_vboChecked = true;
+  }
+
+  // gather all batches into a single buffer
+  m_vertices.clear();
+  for (unsigned int i = 0; i < m_used; i++)
+    m_vertices.insert(m_vertices.end(), m_batches[i].vertices.begin(), m_batches[i].vertices.end());
+
+  const GLubyte *base = (const GLubyte *)&m_vertices[0];
+  if (m_vboSupported)
+  {
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, m_vbo);
+    glBufferDataARB(GL_ARRAY_BUFFER_ARB, m_vertices.size() * sizeof(PackedVertex), &m_vertices[0], GL_STREAM_DRAW_ARB);
+    base = NULL;
+  }
+
+  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_BLEND);          // Turn Blending On
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(PackedVertex), base + offsetof(PackedVertex, x));
+  glEnableClientState(GL_COLOR_ARRAY);
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PackedVertex), base + offsetof(PackedVertex, r));
+  glClientActiveTextureARB(GL_TEXTURE1_ARB);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(PackedVertex), base + offsetof(PackedVertex, du));
+  glClientActiveTextureARB(GL_TEXTURE0_ARB);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(PackedVertex), base + offsetof(PackedVertex, u));
+
+  CBaseTexture *boundTexture = NULL;
+  CBaseTexture *boundDiffuse = NULL;
+  bool unitsSetup = false;
+  GLint first = 0;
+  for (unsigned int i = 0; i < m_used; i++)
+  {
+    const Batch &batch = m_batches[i];
+    if (batch.texture != boundTexture || !unitsSetup)
+    {
+      batch.texture->BindToUnit(0);
+      if (!unitsSetup)
+        SetupTextureUnit(GL_TEXTURE0);
+      boundTexture = batch.texture;
+    }
+
+    if (batch.diffuse != boundDiffuse || !unitsSetup)
+    {
+      if (batch.diffuse)
+      {
+        batch.diffuse->BindToUnit(1);
+        if (!boundDiffuse)
+        {
+          // diffuse coloring
+          SetupTextureUnit(GL_TEXTURE1);
+          glClientActiveTextureARB(GL_TEXTURE1_ARB);
+          glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+          glClientActiveTextureARB(GL_TEXTURE0_ARB);
+        }
+      }
+      else
+      {
+        glActiveTextureARB(GL_TEXTURE1_ARB);
+        glDisable(GL_TEXTURE_2D);
+        glClientActiveTextureARB(GL_TEXTURE1_ARB);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glClientActiveTextureARB(GL_TEXTURE0_ARB);
+      }
+      glActiveTextureARB(GL_TEXTURE0_ARB);
+      boundDiffuse = batch.diffuse;
+    }
+    unitsSetup = true;
+    VerifyGLState();
+
+    GLsizei count = batch.vertices.size();
+    glDrawArrays(GL_QUADS, first, count);
+    first += count;
+    m_drawCalls++;
+  }
+
+  if (boundDiffuse)
+  {
+    glActiveTextureARB(GL_TEXTURE1_ARB);
+    glDisable(GL_TEXTURE_2D);
+    glClientActiveTextureARB(GL_TEXTURE1_ARB);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glClientActiveTextureARB(GL_TEXTURE0_ARB);
+    glActiveTextureARB(GL_TEXTURE0_ARB);
+  }
+  glDisable(GL_TEXTURE_2D);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  if (m_vboSupported)
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+  VerifyGLState();
+
+  m_used = 0;
+}
+
+void CGUITextureBatchGL::BeginFrame()
+{
+  m_lastDrawCalls = m_drawCalls;
+  m_lastQuads = m_quads;
+  m_drawCalls = 0;
+  m_quads = 0;
+}
+
+void CGUITextureBatchGL::Release()
+{
+  // the textures may be gone along with the context, so drop anything still queued
+  m_used = 0;
+  if (m_vbo)
+    glDeleteBuffersARB(1, &m_vbo);
+  m_vbo = 0;
+  m_vboChecked = false;
+  m_vboSupported = false;
+}
+
+#endif
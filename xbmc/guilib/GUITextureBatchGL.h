@@ -0,0 +1,127 @@
+/*!
+\file GUITextureBatchGL.h
+\brief
+*/
+
+#ifndef GUILIB_GUITEXTUREBATCHGL_H
+#define GUILIB_GUITEXTUREBATCHGL_H
+
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "Geometry.h"
+#include "system_gl.h"
+
+class CBaseTexture;
+
+typedef uint32_t color_t;
+
+/*!
+ \ingroup textures
+ \brief Collects the quads of all GUI textures in a frame and draws them with as few draw calls as possible.
+
+ Quads are grouped into batches that share a texture and diffuse texture. A quad is only moved into an
+ earlier batch when nothing queued after that batch overlaps it, so the result is identical to drawing
+ every quad in the order it was added.
+
+ Anything else that draws with GL must call Flush() first. CRenderSystemGL does so whenever the
+ viewport, scissor, transform or state block changes and at the end of each frame.
+ Must only be used from the rendering thread.
+ */
+class CGUITextureBatchGL
+{
+public:
+  static CGUITextureBatchGL &Get();
+
+  /*!
+   \brief Queue a textured quad.
+   \param texture the texture, which must already be loaded to the GPU.
+   \param diffuse the diffuse texture, or NULL.
+   \param x,y,z the final coordinates of the four corners, clockwise from the top left.
+   \param color the color of the quad.
+   \param u,v the texture coordinates of the four corners.
+   \param du,dv the diffuse texture coordinates of the four corners, ignored without a diffuse texture.
+   */
+  void AddQuad(CBaseTexture *texture, CBaseTexture *diffuse, const float *x, const float *y, const float *z, color_t color,
+               const float *u, const float *v, const float *du, const float *dv);
+
+  /*!
+   \brief Draw all queued quads.
+   */
+  void Flush();
+
+  /*!
+   \brief Start a new frame, keeping the counters of the previous one.
+   */
+  void BeginFrame();
+
+  /*!
+   \brief Release the GL resources, eg. before the GL context is destroyed.
+   */
+  void Release();
+
+  unsigned int GetDrawCalls() const { return m_lastDrawCalls; }
+  unsigned int GetQuads() const { return m_lastQuads; }
+
+private:
+  CGUITextureBatchGL();
+  ~CGUITextureBatchGL();
+  CGUITextureBatchGL(const CGUITextureBatchGL&);
+  CGUITextureBatchGL const& operator=(CGUITextureBatchGL const&);
+
+  typedef struct PackedVertex
+  {
+    GLfloat x, y, z;
+    GLubyte r, g, b, a;
+    GLfloat u, v;
+    GLfloat du, dv;
+  } PackedVertex;
+
+  typedef struct Batch
+  {
+    CBaseTexture *texture;
+    CBaseTexture *diffuse;
+    CRect bounds;
+    bool flat;
+    std::vector<PackedVertex> vertices;
+  } Batch;
+
+  void SetupTextureUnit(GLenum source);
+
+  std::vector<Batch> m_batches;    ///< batches of the current flush, only the first m_used are valid
+  unsigned int m_used;
+  std::vector<PackedVertex> m_vertices;
+
+  GLuint m_vbo;
+  bool m_vboChecked;
+  bool m_vboSupported;
+
+  unsigned int m_drawCalls;
+  unsigned int m_quads;
+  unsigned int m_lastDrawCalls;
+  unsigned int m_lastQuads;
+};
+
+#endif
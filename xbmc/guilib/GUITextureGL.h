@@ -42,7 +42,7 @@ protected:
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
 private:
-  GLubyte m_col[4];
+  color_t m_color;
 };
 
 #endif
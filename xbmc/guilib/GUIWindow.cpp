@@ -42,6 +42,11 @@
 #include "Application.h"
 #include "ApplicationMessenger.h"
 #include "utils/Variant.h"
+#include "utils/Crc32.h"
+#include "utils/URIUtils.h"
+#include "filesystem/Directory.h"
+#include "GUICompiledXML.h"
+#include "TextureManager.h"
 
 #ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceSample.h"
@@ -128,47 +133,133 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
   return ret;
 }
 
+#define COMPILED_SKIN_PATH "special://temp/skincache/"
+
+/*! \brief Get the file the compiled form of a skin file is kept in
+ Skin files with the same name for different resolutions each get their own.
+ */
+static CStdString GetCompiledFile(const CStdString &strPath)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(strPath);
+  CStdString file;
+  file.Format(COMPILED_SKIN_PATH "%s/%08x.bin", g_SkinInfo->ID().c_str(), (unsigned int)crc);
+  return file;
+}
+
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
+  CStdString compiledVersion;
+  compiledVersion.Format("%s %s", g_SkinInfo->ID().c_str(), g_SkinInfo->Version().c_str());
+  CStdString compiledFile = GetCompiledFile(strPath);
+
+  // if nothing it depends on has changed, the compiled window is ready to go without any XML parsing
+  bool conditionsChanged = false;
+  TiXmlElement *compiled = CGUICompiledXML::Load(compiledFile, compiledVersion, m_xmlIncludeConditions, &conditionsChanged);
+  if (compiled)
+  {
+    CLog::Log(LOGDEBUG, "Using compiled skin file for %s", strPath.c_str());
+    bool ret = LoadResolved(compiled);
+    delete compiled;
+    return ret;
+  }
+
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
     CXBMCTinyXML xmlDoc;
-    if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
+    CStdString loadedPath = strPath;
+    if (!xmlDoc.LoadFile(loadedPath) && !xmlDoc.LoadFile(loadedPath = CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(loadedPath = strLowerPath))
     {
       CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
       SetID(WINDOW_INVALID);
       return false;
     }
     m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
+    m_windowXMLPath = loadedPath;
   }
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(m_windowXMLRootElement);
+  TiXmlElement *resolved = ResolveXML(m_windowXMLRootElement);
+  if (!resolved)
+    return false;
+
+  // save the resolved window for next time, unless it is just the include conditions that
+  // differ from the stored one: skin settings flip back and forth, and the files haven't changed
+  if (!conditionsChanged)
+  {
+    vector<CStdString> dependencies = g_SkinInfo->GetIncludeFiles();
+    dependencies.push_back(m_windowXMLPath);
+    if (XFILE::CDirectory::Create(COMPILED_SKIN_PATH) && XFILE::CDirectory::Create(URIUtils::GetDirectory(compiledFile)))
+      CGUICompiledXML::Save(compiledFile, resolved, compiledVersion, dependencies, m_xmlIncludeConditions);
+  }
+
+  bool ret = LoadResolved(resolved);
+  delete resolved;
+  return ret;
 }
 
 bool CGUIWindow::Load(TiXmlElement* pRootElement)
 {
-  if (!pRootElement)
+  TiXmlElement *resolved = ResolveXML(pRootElement);
+  if (!resolved)
     return false;
+
+  bool ret = LoadResolved(resolved);
+  delete resolved;
+  return ret;
+}
+
+TiXmlElement *CGUIWindow::ResolveXML(const TiXmlElement *pRootElement)
+{
+  if (!pRootElement)
+    return NULL;
   
   if (strcmpi(pRootElement->Value(), "window"))
   {
     CLog::Log(LOGERROR, "file : XML file doesnt contain <window>");
-    return false;
+    return NULL;
   }
 
   // we must create copy of root element as we will manipulate it when resolving includes
   // and we don't want original root element to change
-  pRootElement = (TiXmlElement*)pRootElement->Clone();
+  TiXmlElement *resolved = (TiXmlElement*)pRootElement->Clone();
+
+  // Resolve any includes that may be present and save conditions used to do it
+  g_SkinInfo->ResolveIncludes(resolved, &m_xmlIncludeConditions);
+  return resolved;
+}
+
+/* gather the fixed textures a window's controls use, so they can be decompressed together */
+static void GetTextureNames(const TiXmlElement *element, vector<CStdString> &textures)
+{
+  for (const TiXmlElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+  {
+    CStdString tag(child->Value());
+    const TiXmlNode *text = child->FirstChild();
+    if (text && text->Type() == TiXmlNode::TINYXML_TEXT)
+    {
+      if (tag.ToLower().Find("texture") >= 0 && !strchr(text->Value(), '$'))
+        textures.push_back(text->Value());
+    }
+    else
+      GetTextureNames(child, textures);
+  }
+}
+
+bool CGUIWindow::LoadResolved(TiXmlElement* pRootElement)
+{
+  if (strcmpi(pRootElement->Value(), "window"))
+  {
+    CLog::Log(LOGERROR, "file : XML file doesnt contain <window>");
+    return false;
+  }
 
   // set the scaling resolution so that any control creation or initialisation can
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
-  // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
   // now load in the skin file
   SetDefaults();
 
@@ -177,6 +268,9 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
   CGUIControlFactory::GetActions(pRootElement, "onunload", m_unloadActions);
   CGUIControlFactory::GetHitRect(pRootElement, m_hitRect);
 
+  m_textureNames.clear();
+  GetTextureNames(pRootElement, m_textureNames);
+
   TiXmlElement *pChild = pRootElement->FirstChildElement();
   while (pChild)
   {
@@ -264,7 +358,6 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
 
   m_windowLoaded = true;
   OnWindowLoaded();
-  delete pRootElement;
   return true;
 }
 
@@ -386,10 +479,13 @@ void CGUIWindow::Close_Internal(bool forceClose /*= false*/, int nextWindowID /*
       // Perform the window out effect
       QueueAnimation(ANIM_TYPE_WINDOW_CLOSE);
       m_closing = true;
+      g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
     }
     return;
   }
 
+  if (m_closing)
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
   m_closing = false;
   CGUIMessage msg(GUI_MSG_WINDOW_DEINIT, 0, 0);
   OnMessage(msg);
@@ -713,33 +809,40 @@ bool CGUIWindow::NeedXMLReload()
 
 void CGUIWindow::AllocResources(bool forceLoad /*= FALSE */)
 {
-  CSingleLock lock(g_graphicsContext);
-
 #ifdef _DEBUG
   int64_t start;
   start = CurrentHostCounter();
 #endif
-  // use forceLoad to determine if xml file needs loading
-  forceLoad |= NeedXMLReload() || (m_loadType == LOAD_EVERY_TIME);
+  {
+    CSingleLock lock(g_graphicsContext);
 
-  // if window is loaded and load is forced we have to free window resources first
-  if (m_windowLoaded && forceLoad)
-    FreeResources(true);
+    // use forceLoad to determine if xml file needs loading
+    forceLoad |= NeedXMLReload() || (m_loadType == LOAD_EVERY_TIME);
 
-  if (forceLoad)
-  {
-    CStdString xmlFile = GetProperty("xmlfile").asString();
-    if (xmlFile.size())
+    // if window is loaded and load is forced we have to free window resources first
+    if (m_windowLoaded && forceLoad)
+      FreeResources(true);
+
+    if (forceLoad)
     {
-      bool bHasPath = xmlFile.Find("\\") > -1 || xmlFile.Find("/") > -1;
-      Load(xmlFile,bHasPath);
+      CStdString xmlFile = GetProperty("xmlfile").asString();
+      if (xmlFile.size())
+      {
+        bool bHasPath = xmlFile.Find("\\") > -1 || xmlFile.Find("/") > -1;
+        Load(xmlFile,bHasPath);
+      }
     }
   }
 
   int64_t slend;
   slend = CurrentHostCounter();
 
+  // decompress the window's textures in parallel, rather than one at a time as each control allocates.
+  // This needs nothing the graphics context guards, so it's done before taking it for the allocation
+  g_TextureManager.PrefetchTextures(m_textureNames);
+
   // and now allocate resources
+  CSingleLock lock(g_graphicsContext);
   CGUIControlGroup::AllocResources();
 
 #ifdef _DEBUG
@@ -852,6 +955,7 @@ bool CGUIWindow::Animate(unsigned int currentTime)
 void CGUIWindow::DisableAnimations()
 {
   m_animationsEnabled = false;
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
 }
 
 // returns true if the control group with id groupID has controlID as
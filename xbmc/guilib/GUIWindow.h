@@ -198,6 +198,8 @@ protected:
   virtual EVENT_RESULT OnMouseEvent(const CPoint &point, const CMouseEvent &event);
   virtual bool LoadXML(const CStdString& strPath, const CStdString &strLowerPath);  ///< Loads from the given file
   bool Load(TiXmlElement *pRootElement);                 ///< Loads from the given XML root element
+  TiXmlElement *ResolveXML(const TiXmlElement *pRootElement); ///< Copies the given XML root element with all includes resolved
+  bool LoadResolved(TiXmlElement *pRootElement);         ///< Loads from the given XML root element with includes resolved
   /*! \brief Check if XML file needs (re)loading
    XML file has to be (re)loaded when window is not loaded or include conditions values were changed
    */
@@ -277,6 +279,7 @@ protected:
   CGUIAction m_unloadActions;
 
   TiXmlElement* m_windowXMLRootElement;
+  CStdString m_windowXMLPath;  ///< the file m_windowXMLRootElement was loaded from
 
   bool m_manualRunActions;
 
@@ -285,6 +288,7 @@ protected:
 private:
   std::map<CStdString, CVariant, icompare> m_mapProperties;
   std::map<int, bool> m_xmlIncludeConditions; ///< \brief used to store conditions used to resolve includes for this window
+  std::vector<CStdString> m_textureNames;     ///< \brief textures named by the window's controls, prefetched on AllocResources
 };
 
 #endif
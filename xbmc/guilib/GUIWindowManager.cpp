@@ -207,6 +207,8 @@ void CGUIWindowManager::AddCustomWindow(CGUIWindow* pWindow)
 void CGUIWindowManager::AddModeless(CGUIWindow* dialog)
 {
   CSingleLock lock(g_graphicsContext);
+  // the dialog may be reopened while it was closing
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
   // only add the window if it's not already added
   for (iDialog it = m_activeDialogs.begin(); it != m_activeDialogs.end(); ++it)
     if (*it == dialog) return;
@@ -222,7 +224,10 @@ void CGUIWindowManager::Remove(int id)
     for(vector<CGUIWindow*>::iterator it2 = m_activeDialogs.begin(); it2 != m_activeDialogs.end();)
     {
       if(*it2 == it->second)
+      {
         it2 = m_activeDialogs.erase(it2);
+        g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
+      }
       else
         it2++;
     }
@@ -310,6 +315,7 @@ void CGUIWindowManager::PreviousWindow()
 
   // remove the current window off our window stack
   m_windowHistory.pop();
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
 
   // ok, initialize the new window
   CLog::Log(LOGDEBUG,"CGUIWindowManager::PreviousWindow: Activate new");
@@ -702,6 +708,7 @@ void CGUIWindowManager::DeInitialize()
   // clear our vectors of windows
   m_vecCustomWindows.clear();
   m_activeDialogs.clear();
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
 
   m_initialized = false;
 }
@@ -716,6 +723,7 @@ void CGUIWindowManager::RouteToWindow(CGUIWindow* dialog)
   RemoveDialog(dialog->GetID());
 
   m_activeDialogs.push_back(dialog);
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
 }
 
 /// \brief Unroute window
@@ -728,6 +736,7 @@ void CGUIWindowManager::RemoveDialog(int id)
     if ((*it)->GetID() == id)
     {
       m_activeDialogs.erase(it);
+      g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
       return;
     }
   }
@@ -940,6 +949,7 @@ void CGUIWindowManager::AddToWindowHistory(int newWindowID)
   { // didn't find window in history - add it to the stack
     m_windowHistory.push(newWindowID);
   }
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
 }
 
 void CGUIWindowManager::GetActiveModelessWindows(vector<int> &ids)
@@ -988,6 +998,7 @@ void CGUIWindowManager::ClearWindowHistory()
 {
   while (m_windowHistory.size())
     m_windowHistory.pop();
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_WINDOW);
 }
 
 void CGUIWindowManager::CloseWindowSync(CGUIWindow *window, int nextWindowID /*= 0*/)
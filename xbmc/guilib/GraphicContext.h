@@ -121,6 +121,7 @@ public:
   inline void ScaleFinalCoords(float &x, float &y, float &z) const XBMC_FORCE_INLINE { m_finalTransform.TransformPosition(x, y, z); }
   bool RectIsAngled(float x1, float y1, float x2, float y2) const;
 
+  inline const TransformMatrix &GetFinalTransform() const XBMC_FORCE_INLINE { return m_finalTransform; }
   inline float GetGUIScaleX() const XBMC_FORCE_INLINE { return m_guiScaleX; }
   inline float GetGUIScaleY() const XBMC_FORCE_INLINE { return m_guiScaleY; }
   inline color_t MergeAlpha(color_t color) const XBMC_FORCE_INLINE
@@ -169,6 +170,12 @@ public:
   void ApplyHardwareTransform();
   void RestoreHardwareTransform();
   void ClipRect(CRect &vertex, CRect &texture, CRect *diffuse = NULL);
+  /*! \brief Get the clip region that ClipRect applies, in the current coordinates
+   \param region [out] the clip region
+   \return false if there is no clip region
+   \sa ClipRect
+   */
+  bool GetClipRegion(CRect &region) const;
   inline unsigned int AddGUITransform()
   {
     unsigned int size = m_groupTransform.size();
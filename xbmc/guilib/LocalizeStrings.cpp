@@ -28,6 +28,10 @@
 #include "utils/POUtils.h"
 #include "filesystem/Directory.h"
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 CLocalizeStrings::CLocalizeStrings(void)
 {
 
@@ -241,6 +245,28 @@ const CStdString& CLocalizeStrings::Get(uint32_t dwCode) const
   return i->second.strTranslated;
 }
 
+CStdStringW CLocalizeStrings::GetCommonCharacters() const
+{
+  std::map<wchar_t, unsigned int> frequency;
+  for (ciStrings i = m_strings.begin(); i != m_strings.end(); ++i)
+  {
+    CStdStringW text;
+    g_charsetConverter.utf8ToW(i->second.strTranslated, text, false);
+    for (size_t j = 0; j < text.size(); j++)
+      frequency[text[j]]++;
+  }
+
+  std::vector< std::pair<unsigned int, wchar_t> > sorted;
+  for (std::map<wchar_t, unsigned int>::const_iterator i = frequency.begin(); i != frequency.end(); ++i)
+    sorted.push_back(std::make_pair(i->second, i->first));
+  std::sort(sorted.begin(), sorted.end(), std::greater< std::pair<unsigned int, wchar_t> >());
+
+  CStdStringW characters;
+  for (size_t i = 0; i < sorted.size(); i++)
+    characters += sorted[i].second;
+  return characters;
+}
+
 void CLocalizeStrings::Clear()
 {
   m_strings.clear();
@@ -55,6 +55,11 @@ public:
   bool LoadSkinStrings(const CStdString& path, const CStdString& language);
   void ClearSkinStrings();
   const CStdString& Get(uint32_t code) const;
+
+  /*! \brief Get the characters used by the loaded strings.
+   \return the characters, the most frequent first.
+   */
+  CStdStringW GetCommonCharacters() const;
   void Clear();
   uint32_t LoadBlock(const CStdString &id, const CStdString &path, const CStdString &language);
   void ClearBlock(const CStdString &id);
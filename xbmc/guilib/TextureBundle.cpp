@@ -103,6 +103,14 @@ int CTextureBundle::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextu
   }
 }
 
+unsigned int CTextureBundle::PrefetchTextures(const std::vector<CStdString> &names)
+{
+  // only XBT bundles are compressed
+  if (m_useXBT)
+    return m_tbXBT.PrefetchTextures(names);
+  return 0;
+}
+
 void CTextureBundle::Cleanup()
 {
   m_tbXBT.Cleanup();
@@ -29,8 +29,15 @@
 #include "filesystem/SpecialProtocol.h"
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
+#include "utils/CPUInfo.h"
+#include "utils/Job.h"
+#include "utils/JobGroup.h"
+#include "threads/SingleLock.h"
 #include "XBTF.h"
 #include <lzo/lzo1x.h>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <set>
 
 #ifdef _WIN32
 #pragma comment(lib,"liblzo2.lib")
@@ -77,13 +84,20 @@ bool CTextureBundleXBT::OpenBundle()
 
   strPath = CSpecialProtocol::TranslatePathConvertCase(strPath);
 
+  return OpenBundle(strPath);
+}
+
+bool CTextureBundleXBT::OpenBundle(const CStdString &strPath)
+{
+  Cleanup();
+
   // Load the texture file
   if (!m_XBTFReader.Open(strPath))
   {
     return false;
   }
 
-  CLog::Log(LOGDEBUG, "%s - Opened bundle %s", __FUNCTION__, strPath.c_str());
+  CLog::Log(LOGDEBUG, "%s - Opened %sbundle %s", __FUNCTION__, m_XBTFReader.IsMapped() ? "mapped " : "", strPath.c_str());
 
   m_TimeStamp = m_XBTFReader.GetLastModificationTimestamp();
 
@@ -145,7 +159,19 @@ bool CTextureBundleXBT::LoadTexture(const CStdString& Filename, CBaseTexture** p
     return false;
 
   CXBTFFrame& frame = file->GetFrames().at(0);
-  if (!ConvertFrameToTexture(Filename, frame, ppTexture))
+  CBaseTexture *texture = NULL;
+  {
+    CSingleLock lock(m_prefetchSection);
+    std::map<CStdString, CBaseTexture*>::iterator prefetched = m_prefetched.find(name);
+    if (prefetched != m_prefetched.end())
+    {
+      texture = prefetched->second;
+      m_prefetched.erase(prefetched);
+    }
+  }
+  if (texture)
+    *ppTexture = texture;
+  else if (!ConvertFrameToTexture(Filename, frame, ppTexture))
   {
     return false;
   }
@@ -191,22 +217,160 @@ int CTextureBundleXBT::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTe
   return nTextures;
 }
 
-bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+/* decompresses every step'th texture of a prefetch, starting from the first'th */
+class CTexturePrefetchJob : public CJob
 {
-  // found texture - allocate the necessary buffers
-  squish::u8 *buffer = new squish::u8[(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
+public:
+  class CState
   {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %"PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
-    return false;
+  public:
+    CState(CTextureBundleXBT *bundle) : m_bundle(bundle), m_running(0), m_abandoned(false), m_idle(true) {}
+    ~CState()
+    {
+      for (size_t i = 0; i < m_textures.size(); i++)
+        delete m_textures[i];
+    }
+
+    /* stop any jobs still to run, wait for those running, and hand back what's done */
+    void Abandon(std::vector<CBaseTexture*> &textures)
+    {
+      CSingleLock lock(m_section);
+      m_abandoned = true;
+      while (m_running)
+      {
+        lock.Leave();
+        m_idle.Wait();
+        lock.Enter();
+      }
+      textures.swap(m_textures);
+    }
+
+    CTextureBundleXBT *m_bundle;
+    std::vector<CStdString> m_names;
+    std::vector<CXBTFFrame> m_frames;
+    std::vector<CBaseTexture*> m_textures;
+    unsigned int m_running;
+    bool m_abandoned;
+    CEvent m_idle;
+    CCriticalSection m_section;
+  };
+
+  CTexturePrefetchJob(const boost::shared_ptr<CState> &state, unsigned int first, unsigned int step)
+  : m_state(state), m_first(first), m_step(step) {}
+
+  virtual const char *GetType() const { return "textureprefetch"; }
+
+  virtual bool DoWork()
+  {
+    CSingleLock lock(m_state->m_section);
+    if (m_state->m_abandoned)
+      return false;
+    m_state->m_running++;
+    m_state->m_idle.Reset();
+
+    for (size_t i = m_first; i < m_state->m_frames.size() && !m_state->m_abandoned; i += m_step)
+    {
+      lock.Leave();
+      CBaseTexture *texture = NULL;
+      m_state->m_bundle->ConvertFrameToTexture(m_state->m_names[i], m_state->m_frames[i], &texture);
+      lock.Enter();
+      m_state->m_textures[i] = texture;
+    }
+
+    if (--m_state->m_running == 0)
+      m_state->m_idle.Set();
+    return true;
   }
 
-  // load the compressed texture
-  if (!m_XBTFReader.Load(frame, buffer))
+private:
+  boost::shared_ptr<CState> m_state;
+  unsigned int m_first;
+  unsigned int m_step;
+};
+
+unsigned int CTextureBundleXBT::PrefetchTextures(const std::vector<CStdString> &names)
+{
+  // whatever the last window didn't use is dropped
+  FreePrefetched();
+
+  boost::shared_ptr<CTexturePrefetchJob::CState> state(new CTexturePrefetchJob::CState(this));
+  std::set<CStdString> seen;
+  for (std::vector<CStdString>::const_iterator i = names.begin(); i != names.end(); ++i)
   {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
-    return false;
+    CStdString name = Normalize(*i);
+    CXBTFFile* file = m_XBTFReader.Find(name);
+    if (!file || file->GetFrames().size() != 1 || !seen.insert(name).second)
+      continue;
+    state->m_names.push_back(name);
+    state->m_frames.push_back(file->GetFrames()[0]);
+  }
+  state->m_textures.resize(state->m_frames.size(), NULL);
+  if (state->m_frames.empty())
+    return 0;
+
+  // this thread takes the first share, the job manager the rest.  The group may live on the stack:
+  // once Cancel() or the destructor returns, no job of the group is running its callback any more
+  unsigned int shares = std::min((unsigned int)std::max(g_cpuInfo.getCPUCount(), 1), (unsigned int)state->m_frames.size());
+  CJobGroup group(NULL, 0, CJob::PRIORITY_HIGH);
+  for (unsigned int i = 1; i < shares; i++)
+    group.AddJob(new CTexturePrefetchJob(state, i, shares));
+  group.Close();
+
+  CTexturePrefetchJob(state, 0, shares).DoWork();
+
+  // jobs stuck behind other work shouldn't hold up the window, its textures then load as usual
+  if (!group.Wait(2000))
+  {
+    CLog::Log(LOGWARNING, "%s - timed out decompressing %"PRIdS" textures", __FUNCTION__, state->m_frames.size());
+    group.Cancel();
+  }
+  std::vector<CBaseTexture*> textures;
+  state->Abandon(textures);
+
+  CSingleLock lock(m_prefetchSection);
+  unsigned int count = 0;
+  for (size_t i = 0; i < textures.size(); i++)
+  {
+    if (textures[i])
+    {
+      m_prefetched[state->m_names[i]] = textures[i];
+      count++;
+    }
+  }
+  return count;
+}
+
+void CTextureBundleXBT::FreePrefetched()
+{
+  CSingleLock lock(m_prefetchSection);
+  for (std::map<CStdString, CBaseTexture*>::iterator i = m_prefetched.begin(); i != m_prefetched.end(); ++i)
+    delete i->second;
+  m_prefetched.clear();
+}
+
+bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, const CXBTFFrame& frame, CBaseTexture** ppTexture)
+{
+  // packed frames are decompressed straight from the mapped bundle where possible
+  const squish::u8 *packed = frame.IsPacked() ? m_XBTFReader.GetData(frame) : NULL;
+  squish::u8 *buffer = NULL;
+  if (!packed)
+  {
+    // found texture - allocate the necessary buffers
+    buffer = new squish::u8[(size_t)frame.GetPackedSize()];
+    if (buffer == NULL)
+    {
+      CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %"PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
+      return false;
+    }
+
+    // load the compressed texture
+    if (!m_XBTFReader.Load(frame, buffer))
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
+      delete[] buffer;
+      return false;
+    }
+    packed = buffer;
   }
 
   // check if it's packed with lzo
@@ -220,7 +384,7 @@ bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame
       return false;
     }
     lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
+    if (lzo1x_decompress_safe(packed, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
         s != frame.GetUnpackedSize())
     {
       CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
@@ -243,6 +407,7 @@ bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame
 
 void CTextureBundleXBT::Cleanup()
 {
+  FreePrefetched();
   if (m_XBTFReader.IsOpen())
   {
     m_XBTFReader.Close();
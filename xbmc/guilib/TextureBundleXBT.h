@@ -22,7 +22,9 @@
 
 #include "utils/StdString.h"
 #include <map>
+#include <vector>
 #include "XBTFReader.h"
+#include "threads/CriticalSection.h"
 
 class CBaseTexture;
 
@@ -44,14 +46,37 @@ public:
   int LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /*!
+   \brief Decompress a set of textures on several threads ahead of them being loaded.
+   The textures are kept until LoadTexture() is called for them, or until the next call
+   to PrefetchTextures(), which drops any that weren't used.  Animated textures and
+   those not in the bundle are skipped.  No lock is taken on the graphics context, so call
+   this without holding it to let other threads carry on while the textures decompress.
+   \param names the names of the textures to decompress.
+   \return the number of textures decompressed.
+   */
+  unsigned int PrefetchTextures(const std::vector<CStdString> &names);
+
+  /*!
+   \brief Open a bundle at the given path rather than the current skin's.
+   \param path the path of the .xbt file.
+   \return true if the bundle was opened.
+   */
+  bool OpenBundle(const CStdString &path);
+
 private:
+  friend class CTexturePrefetchJob;
+
   bool OpenBundle();
-  bool ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
+  bool ConvertFrameToTexture(const CStdString& name, const CXBTFFrame& frame, CBaseTexture** ppTexture);
+  void FreePrefetched();
 
   time_t m_TimeStamp;
 
   bool m_themeBundle;
   CXBTFReader m_XBTFReader;
+  std::map<CStdString, CBaseTexture*> m_prefetched; ///< decompressed textures waiting for LoadTexture(), by normalized name
+  CCriticalSection m_prefetchSection;               ///< guards m_prefetched, which is filled outside the graphics context
 };
 
 
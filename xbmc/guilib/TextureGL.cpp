@@ -20,6 +20,9 @@
 
 #include "system.h"
 #include "TextureGL.h"
+#if defined(HAS_GL)
+#include "GUITextureBatchGL.h"
+#endif
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
@@ -50,7 +53,13 @@ void CGLTexture::CreateTextureObject()
 void CGLTexture::DestroyTextureObject()
 {
   if (m_texture)
+  {
+#ifdef HAS_GL
+    // the GUI may still have quads queued with this texture
+    CGUITextureBatchGL::Get().Flush();
+#endif
     glDeleteTextures(1, (GLuint*) &m_texture);
+  }
 }
 
 void CGLTexture::LoadToGPU()
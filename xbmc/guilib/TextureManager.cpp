@@ -34,6 +34,7 @@
 #include "filesystem/Directory.h"
 #include "URL.h"
 #include <assert.h>
+#include <set>
 
 using namespace std;
 
@@ -597,3 +598,38 @@ void CGUITextureManager::GetBundledTexturesFromPath(const CStdString& texturePat
   if (items.empty())
     m_TexBundle[1].GetTexturesFromPath(texturePath, items);
 }
+
+void CGUITextureManager::PrefetchTextures(const std::vector<CStdString> &textureNames)
+{
+  // only the bundles are checked, looking for loose files is left to Load()
+  std::vector<CStdString> bundled[2];
+  {
+    CSingleLock lock(g_graphicsContext);
+    std::set<CStdString> loaded;
+    for (ivecTextures i = m_vecTextures.begin(); i != m_vecTextures.end(); ++i)
+      loaded.insert((*i)->GetName());
+
+    for (std::vector<CStdString>::const_iterator i = textureNames.begin(); i != textureNames.end(); ++i)
+    {
+      if (i->Right(4).ToLower() == ".gif" || !CanLoad(*i) || loaded.find(*i) != loaded.end())
+        continue;
+      CStdString bundledName = CTextureBundle::Normalize(*i);
+      for (int bundle = 0; bundle < 2; bundle++)
+      {
+        if (m_TexBundle[bundle].HasFile(bundledName))
+        {
+          bundled[bundle].push_back(*i);
+          break;
+        }
+      }
+    }
+  }
+
+  // decompressing needs nothing the graphics context guards
+  for (int i = 0; i < 2; i++)
+  {
+    unsigned int count = m_TexBundle[i].PrefetchTextures(bundled[i]);
+    if (count)
+      CLog::Log(LOGDEBUG, "%s - decompressed %u of %"PRIdS" textures from bundle %i", __FUNCTION__, count, bundled[i].size(), i);
+  }
+}
@@ -118,6 +118,13 @@ public:
   CStdString GetTexturePath(const CStdString& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const CStdString& texturePath, std::vector<CStdString> &items);
 
+  /*! \brief Decompress the bundled textures of a set ahead of them being loaded
+   Textures that are already loaded, animated or not bundled are skipped.
+   \param textureNames the textures that are about to be loaded.
+   \sa CTextureBundleXBT::PrefetchTextures
+   */
+  void PrefetchTextures(const std::vector<CStdString> &textureNames);
+
   void AddTexturePath(const CStdString &texturePath);    ///< Add a new path to the paths to check when loading media
   void SetTexturePath(const CStdString &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
   void RemoveTexturePath(const CStdString &texturePath); ///< Remove a path from the paths to check when loading media
@@ -241,6 +241,16 @@ public:
     return (color_t)(colour * alpha);
   }
 
+  bool operator==(const TransformMatrix &right) const
+  {
+    return memcmp(m, right.m, sizeof(m)) == 0 && alpha == right.alpha;
+  }
+
+  bool operator!=(const TransformMatrix &right) const
+  {
+    return !(*this == right);
+  }
+
   float m[3][4];
   float alpha;
   bool identity;
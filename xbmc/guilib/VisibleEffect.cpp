@@ -567,6 +567,31 @@ void CAnimation::RenderAnimation(TransformMatrix &matrix, const CPoint &center)
   }
 }
 
+CAnimation::Progress CAnimation::GetProgress() const
+{
+  Progress progress;
+  progress.queuedProcess = m_queuedProcess;
+  progress.currentProcess = m_currentProcess;
+  progress.currentState = m_currentState;
+  progress.start = m_start;
+  progress.amount = m_amount;
+  progress.lastCondition = m_lastCondition;
+  return progress;
+}
+
+void CAnimation::SetProgress(const Progress &progress)
+{
+  m_queuedProcess = progress.queuedProcess;
+  m_currentProcess = progress.currentProcess;
+  m_currentState = progress.currentState;
+  m_start = progress.start;
+  m_amount = progress.amount;
+  m_lastCondition = progress.lastCondition;
+  // have the effects of an applied animation worked out again on the next render
+  if (m_currentState == ANIM_STATE_APPLIED)
+    m_currentProcess = ANIM_PROCESS_NORMAL;
+}
+
 void CAnimation::QueueAnimation(ANIMATION_PROCESS process)
 {
   m_queuedProcess = process;
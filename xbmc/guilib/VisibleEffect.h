@@ -174,6 +174,25 @@ public:
   void UpdateCondition(const CGUIListItem *item = NULL);
   void SetInitialCondition();
 
+  /*! \brief How far an animation has got, without the animation itself
+   \sa GetProgress, SetProgress
+   */
+  struct Progress
+  {
+    ANIMATION_PROCESS queuedProcess;
+    ANIMATION_PROCESS currentProcess;
+    ANIMATION_STATE currentState;
+    unsigned int start;
+    unsigned int amount;
+    bool lastCondition;
+  };
+
+  /*! \brief Get and set how far the animation has got
+   Lets another copy of the same animation carry on from where this one is.
+   */
+  Progress GetProgress() const;
+  void SetProgress(const Progress &progress);
+
 private:
   void Calculate(const CPoint &point);
   void AddEffect(const CStdString &type, const TiXmlElement *node, const CRect &rect);
@@ -22,8 +22,12 @@
 #include "XBTFReader.h"
 #include "utils/EndianSwap.h"
 #include "utils/CharsetConverter.h"
+#include "threads/SingleLock.h"
 #ifdef _WIN32
 #include "FileSystem/SpecialProtocol.h"
+#include <io.h>
+#else
+#include <sys/mman.h>
 #endif
 
 #include <string.h>
@@ -46,6 +50,9 @@
 CXBTFReader::CXBTFReader()
 {
   m_file = NULL;
+  m_mapped = NULL;
+  m_mappedSize = 0;
+  m_mapping = NULL;
 }
 
 bool CXBTFReader::IsOpen() const
@@ -135,11 +142,61 @@ bool CXBTFReader::Open(const CStdString& fileName)
     return false;
   }
 
+  // failing to map isn't fatal, frames are then read from the file instead
+  Map();
+
+  return true;
+}
+
+bool CXBTFReader::Map()
+{
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == -1 || fileStat.st_size <= 0 ||
+      (uint64_t)fileStat.st_size != (size_t)fileStat.st_size)
+    return false;
+
+  size_t size = (size_t)fileStat.st_size;
+#ifdef _WIN32
+  HANDLE file = (HANDLE)_get_osfhandle(_fileno(m_file));
+  HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL)
+    return false;
+  void *mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+  if (mapped == NULL)
+  {
+    CloseHandle(mapping);
+    return false;
+  }
+  m_mapping = mapping;
+#else
+  void *mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(m_file), 0);
+  if (mapped == MAP_FAILED)
+    return false;
+#endif
+  m_mapped = (unsigned char *)mapped;
+  m_mappedSize = size;
   return true;
 }
 
+void CXBTFReader::Unmap()
+{
+  if (!m_mapped)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_mapped);
+  CloseHandle((HANDLE)m_mapping);
+  m_mapping = NULL;
+#else
+  munmap(m_mapped, (size_t)m_mappedSize);
+#endif
+  m_mapped = NULL;
+  m_mappedSize = 0;
+}
+
 void CXBTFReader::Close()
 {
+  Unmap();
   if (m_file)
   {
     fclose(m_file);
@@ -173,7 +230,7 @@ bool CXBTFReader::Exists(const CStdString& name)
 
 CXBTFFile* CXBTFReader::Find(const CStdString& name)
 {
-  std::map<CStdString, CXBTFFile>::iterator iter = m_filesMap.find(name);
+  boost::unordered_map<std::string, CXBTFFile>::iterator iter = m_filesMap.find(name);
   if (iter == m_filesMap.end())
   {
     return NULL;
@@ -188,6 +245,15 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
   {
     return false;
   }
+
+  const unsigned char *data = GetData(frame);
+  if (data)
+  {
+    memcpy(buffer, data, (size_t)frame.GetPackedSize());
+    return true;
+  }
+
+  CSingleLock lock(m_section);
 #if defined(TARGET_DARWIN) || defined(__FreeBSD__) || defined(__ANDROID__)
     if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
 #else
@@ -205,6 +271,19 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
   return true;
 }
 
+const unsigned char* CXBTFReader::GetData(const CXBTFFrame& frame) const
+{
+  if (!m_mapped || frame.GetOffset() > m_mappedSize || frame.GetPackedSize() > m_mappedSize - frame.GetOffset())
+    return NULL;
+
+  return m_mapped + frame.GetOffset();
+}
+
+bool CXBTFReader::IsMapped() const
+{
+  return m_mapped != NULL;
+}
+
 std::vector<CXBTFFile>& CXBTFReader::GetFiles()
 {
   return m_xbtf.GetFiles();
@@ -22,10 +22,21 @@
 #define XBTFREADER_H_
 
 #include <vector>
-#include <map>
+#include <string>
+#include <boost/unordered_map.hpp>
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
 #include "XBTF.h"
 
+/*!
+ \ingroup textures
+ \brief Reads the header and frames of an XBT texture bundle.
+
+ The bundle is memory mapped where the platform allows, in which case frames may be
+ loaded from any number of threads at once.  Otherwise frames are read from the file,
+ one thread at a time.
+ */
+
 class CXBTFReader
 {
 public:
@@ -37,13 +48,28 @@ public:
   bool Exists(const CStdString& name);
   CXBTFFile* Find(const CStdString& name);
   bool Load(const CXBTFFrame& frame, unsigned char* buffer);
+
+  /*!
+   \brief Get the packed data of a frame straight from the mapped bundle, without copying it.
+   \param frame the frame to get the data of.
+   \return a pointer to GetPackedSize() bytes, valid until Close(), or NULL if the bundle isn't mapped.
+   */
+  const unsigned char* GetData(const CXBTFFrame& frame) const;
+  bool IsMapped() const;
   std::vector<CXBTFFile>&  GetFiles();
 
 private:
+  bool Map();
+  void Unmap();
+
   CXBTF      m_xbtf;
   CStdString m_fileName;
   FILE*      m_file;
-  std::map<CStdString, CXBTFFile> m_filesMap;
+  unsigned char* m_mapped;  ///< the whole bundle, or NULL if it couldn't be mapped
+  uint64_t   m_mappedSize;
+  void*      m_mapping;     ///< the file mapping handle on windows
+  CCriticalSection m_section; ///< serialises seeking and reading when the bundle isn't mapped
+  boost::unordered_map<std::string, CXBTFFile> m_filesMap;
 };
 
 #endif
@@ -0,0 +1,216 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DirtyRegionSolvers.h"
+#include "guilib/DirtyRegionTracker.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const float TestDirtyRegionWidth = 1920.0f;
+static const float TestDirtyRegionHeight = 1080.0f;
+static const unsigned int TestDirtyRegionFrames = 600;
+
+typedef std::vector<CDirtyRegionList> TestDirtyRegionSequence;
+
+/* what the window manager marks each frame on a home screen left alone: a clock ticking over
+   every second, a busy spinner and a scrolling label in different corners */
+static TestDirtyRegionSequence TestDirtyRegionIdle()
+{
+  TestDirtyRegionSequence frames(TestDirtyRegionFrames);
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    if (i % 60 == 0)
+      frames[i].push_back(CDirtyRegion(1700, 20, 1890, 60));
+    frames[i].push_back(CDirtyRegion(40, 1000, 88, 1048));
+    frames[i].push_back(CDirtyRegion(600, 900, 1300, 940));
+  }
+  return frames;
+}
+
+/* a list moving its focus down a row every few frames, with the spinner still going */
+static TestDirtyRegionSequence TestDirtyRegionList()
+{
+  TestDirtyRegionSequence frames(TestDirtyRegionFrames);
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    if (i % 8 == 0)
+    {
+      float row = (float)(i / 8 % 12);
+      frames[i].push_back(CDirtyRegion(100, 200 + row * 60, 900, 260 + row * 60));
+      frames[i].push_back(CDirtyRegion(100, 260 + row * 60, 900, 320 + row * 60));
+    }
+    frames[i].push_back(CDirtyRegion(40, 1000, 88, 1048));
+  }
+  return frames;
+}
+
+/* a dialog fading in over the whole screen, then only the clock */
+static TestDirtyRegionSequence TestDirtyRegionDialog()
+{
+  TestDirtyRegionSequence frames(TestDirtyRegionFrames);
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    if (i < 20)
+      frames[i].push_back(CDirtyRegion(0, 0, TestDirtyRegionWidth, TestDirtyRegionHeight));
+    else if (i % 60 == 0)
+      frames[i].push_back(CDirtyRegion(1700, 20, 1890, 60));
+  }
+  return frames;
+}
+
+static bool TestDirtyRegionCovered(const CDirtyRegionList &regions, float x, float y)
+{
+  for (unsigned int i = 0; i < regions.size(); i++)
+  {
+    if (regions[i].PtInRect(CPoint(x, y)))
+      return true;
+  }
+  return false;
+}
+
+struct TestDirtyRegionResult
+{
+  TestDirtyRegionResult() : pixels(0), passes(0), uncovered(0) {}
+  double pixels;          ///< pixels redrawn, counting those redrawn by more than one pass each time
+  unsigned int passes;    ///< render passes
+  unsigned int uncovered; ///< marked regions not redrawn in full
+};
+
+/* replays marked regions through a tracker as the window manager does */
+static TestDirtyRegionResult TestDirtyRegionReplay(int algorithm, const TestDirtyRegionSequence &frames)
+{
+  TestDirtyRegionResult result;
+  CDirtyRegionTracker tracker(3);
+  tracker.SelectAlgorithm(algorithm);
+  CRect screen(0, 0, TestDirtyRegionWidth, TestDirtyRegionHeight);
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    for (unsigned int j = 0; j < frames[i].size(); j++)
+      tracker.MarkDirtyRegion(frames[i][j]);
+
+    CDirtyRegionList regions = tracker.GetDirtyRegions();
+    for (unsigned int j = 0; j < regions.size(); j++)
+    {
+      CRect region(regions[j]);
+      region.Intersect(screen);
+      result.pixels += region.Area();
+    }
+    result.passes += regions.size();
+
+    // every marked region must be redrawn, checked at a few points across each
+    const CDirtyRegionList &marked = tracker.GetMarkedRegions();
+    for (unsigned int j = 0; j < marked.size(); j++)
+    {
+      bool covered = true;
+      for (unsigned int k = 0; k <= 4; k++)
+      {
+        float x = marked[j].x1 + (marked[j].Width() - 1) * k / 4;
+        float y = marked[j].y1 + (marked[j].Height() - 1) * k / 4;
+        covered &= TestDirtyRegionCovered(regions, x, y);
+        covered &= TestDirtyRegionCovered(regions, x, marked[j].y2 - 1 - (y - marked[j].y1));
+      }
+      if (!covered)
+        result.uncovered++;
+    }
+
+    tracker.CleanMarkedRegions();
+  }
+  return result;
+}
+
+TEST(TestDirtyRegionSolvers, TilesSeparateDistantRegions)
+{
+  CDirtyRegionList input, output;
+  input.push_back(CDirtyRegion(10, 10, 30, 30));
+  input.push_back(CDirtyRegion(1800, 1000, 1850, 1040));
+
+  CTileDirtyRegionSolver solver;
+  solver.Solve(input, output);
+  ASSERT_EQ(2U, output.size());
+  EXPECT_FALSE(input[0] != output[0]);
+  EXPECT_FALSE(input[1] != output[1]);
+}
+
+TEST(TestDirtyRegionSolvers, TilesMergeNeighbours)
+{
+  CDirtyRegionList input, output;
+  input.push_back(CDirtyRegion(10, 10, 100, 30));
+  input.push_back(CDirtyRegion(10, 30, 100, 60));
+  input.push_back(CDirtyRegion(12, 60, 90, 70));
+
+  CTileDirtyRegionSolver solver;
+  solver.Solve(input, output);
+  ASSERT_EQ(1U, output.size());
+  EXPECT_FALSE(CRect(10, 10, 100, 70) != output[0]);
+}
+
+TEST(TestDirtyRegionSolvers, TilesLimitPasses)
+{
+  CDirtyRegionList input, output;
+  for (unsigned int i = 0; i < 20; i++)
+    input.push_back(CDirtyRegion(i * 90.0f, i * 50.0f, i * 90.0f + 10, i * 50.0f + 10));
+
+  CTileDirtyRegionSolver solver(32.0f, 4);
+  solver.Solve(input, output);
+  EXPECT_EQ(4U, output.size());
+}
+
+TEST(TestDirtyRegionSolvers, TilesIgnoreEmpty)
+{
+  CDirtyRegionList input, output;
+  input.push_back(CDirtyRegion(100, 100, 100, 200));
+  input.push_back(CDirtyRegion(300, 300, 200, 200));
+
+  CTileDirtyRegionSolver solver;
+  solver.Solve(input, output);
+  EXPECT_TRUE(output.empty());
+}
+
+/* replays each sequence through each solver, reporting the pixels redrawn */
+TEST(TestDirtyRegionSolvers, ReplayBenchmark)
+{
+  const char *names[] = { "idle home", "list focus", "dialog fade" };
+  TestDirtyRegionSequence sequences[] = { TestDirtyRegionIdle(), TestDirtyRegionList(), TestDirtyRegionDialog() };
+  const char *solverNames[] = { "union", "cost reduction", "tiles" };
+  int solvers[] = { DIRTYREGION_SOLVER_UNION, DIRTYREGION_SOLVER_COST_REDUCTION, DIRTYREGION_SOLVER_TILES };
+
+  for (unsigned int i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++)
+  {
+    TestDirtyRegionResult results[3];
+    for (unsigned int j = 0; j < 3; j++)
+    {
+      results[j] = TestDirtyRegionReplay(solvers[j], sequences[i]);
+      EXPECT_EQ(0U, results[j].uncovered) << solverNames[j] << " on " << names[i];
+
+      // replays are deterministic
+      TestDirtyRegionResult again = TestDirtyRegionReplay(solvers[j], sequences[i]);
+      EXPECT_EQ(results[j].pixels, again.pixels);
+
+      std::cout << std::setw(12) << names[i] << ", " << std::setw(14) << solverNames[j] << ": " <<
+        std::fixed << std::setprecision(1) << results[j].pixels / sequences[i].size() / 1000 <<
+        " kpixels and " << (double)results[j].passes / sequences[i].size() << " passes per frame" << std::endl;
+    }
+    EXPECT_LE(results[2].pixels, results[0].pixels) << names[i];
+  }
+}
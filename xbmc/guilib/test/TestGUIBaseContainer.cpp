@@ -0,0 +1,172 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIListContainer.h"
+#include "guilib/GUIListGroup.h"
+#include "FileItem.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <set>
+
+#include "gtest/gtest.h"
+
+static const int TestGUIBaseContainerItems = 100000;
+static const int TestGUIBaseContainerPreload = 4;
+
+/* a 400 pixel high list of 40 pixel high items, with access to its layouts */
+class TestGUIBaseContainerList : public CGUIListContainer
+{
+public:
+  TestGUIBaseContainerList()
+  : CGUIListContainer(0, 1, 0, 0, 400, 400, VERTICAL, CScroller(0), TestGUIBaseContainerPreload)
+  {
+    m_time = 0;
+    CXBMCTinyXML xml;
+    xml.Parse("<control>"
+                "<itemlayout width=\"400\" height=\"40\"/>"
+                "<focusedlayout width=\"400\" height=\"40\"/>"
+              "</control>");
+    LoadLayout(xml.RootElement());
+
+    for (int i = 0; i < TestGUIBaseContainerItems; ++i)
+      m_items.push_back(CGUIListItemPtr(new CFileItem(StringUtils::Format("Item %i", i))));
+    UpdateLayout(true);
+  }
+
+  void Frame()
+  {
+    m_time += 20;
+    CDirtyRegionList dirtyregions;
+    Process(m_time, dirtyregions);
+  }
+
+  void Select(int item)
+  {
+    SelectItem(item);
+    Frame();
+  }
+
+  /* collects the layouts of all items, returning false if two items share a layout */
+  bool BoundLayouts(std::set<CGUIListItemLayout*> &layouts) const
+  {
+    unsigned int bound = 0;
+    for (unsigned int i = 0; i < m_items.size(); ++i)
+    {
+      if (m_items[i]->GetLayout())
+      {
+        layouts.insert(m_items[i]->GetLayout());
+        bound++;
+      }
+      if (m_items[i]->GetFocusedLayout())
+      {
+        layouts.insert(m_items[i]->GetFocusedLayout());
+        bound++;
+      }
+    }
+    return layouts.size() == bound;
+  }
+
+  unsigned int GetLayoutsAllocated() const
+  {
+    return m_layoutPool.GetAllocated() + m_focusedLayoutPool.GetAllocated();
+  }
+
+  unsigned int GetLayoutsPooled() const
+  {
+    return m_layoutPool.Size() + m_focusedLayoutPool.Size();
+  }
+
+  int GetItemsPerPage() const { return m_itemsPerPage; }
+
+private:
+  unsigned int m_time;
+};
+
+TEST(TestGUIBaseContainer, ScrollRecyclesLayouts)
+{
+  TestGUIBaseContainerList list;
+  list.Frame();
+  ASSERT_EQ(10, list.GetItemsPerPage());
+
+  // at most a page plus the preloaded items are bound at any time, and as many again may be pooled
+  unsigned int window = list.GetItemsPerPage() + TestGUIBaseContainerPreload + 2;
+  unsigned int maxLayouts = 2 * (window + window);
+
+  for (int i = 0; i < TestGUIBaseContainerItems; ++i)
+    list.Select(i);
+  for (int i = TestGUIBaseContainerItems - 1; i >= 0; i -= list.GetItemsPerPage())
+    list.Select(i);
+  for (int i = 0; i < 1000; ++i)
+    list.Select((i * 7919) % TestGUIBaseContainerItems);
+
+  std::set<CGUIListItemLayout*> layouts;
+  EXPECT_TRUE(list.BoundLayouts(layouts));
+  EXPECT_GE(window * 2, layouts.size());
+  EXPECT_GE(maxLayouts, layouts.size() + list.GetLayoutsPooled());
+  EXPECT_GE(maxLayouts, list.GetLayoutsAllocated());
+}
+
+TEST(TestGUIBaseContainer, JumpReusesLayouts)
+{
+  TestGUIBaseContainerList list;
+  list.Frame();
+
+  // jump well away so that the first page's layouts are handed to other items and back again
+  list.Select(0);
+  list.Select(5000);
+  unsigned int allocated = list.GetLayoutsAllocated();
+  list.Select(0);
+  EXPECT_EQ(allocated, list.GetLayoutsAllocated());
+
+  std::set<CGUIListItemLayout*> layouts;
+  EXPECT_TRUE(list.BoundLayouts(layouts));
+}
+
+TEST(TestGUIBaseContainer, RecycledLayoutKeepsState)
+{
+  // a layout with a control that fades in as the window opens, copied for two items
+  CGUIListGroup layout(0, 0, 0, 0, 400, 40);
+  CGUIListGroup *control = new CGUIListGroup(0, 5, 0, 0, 400, 40);
+  control->SetAnimations(std::vector<CAnimation>(1, CAnimation::CreateFader(0, 100, 0, 1000, ANIM_TYPE_WINDOW_OPEN)));
+  layout.AddControl(control);
+  CGUIListGroup shown(layout), recycled(layout);
+
+  // halfway through the fade when the item scrolls away
+  CDirtyRegionList dirtyregions;
+  shown.QueueAnimation(ANIM_TYPE_WINDOW_OPEN);
+  shown.DoProcess(1000, dirtyregions);
+  shown.DoProcess(1500, dirtyregions);
+  ASSERT_EQ(ANIM_PROCESS_NORMAL, shown.GetControl(5)->GetAnimations()[0].GetProcess());
+  ASSERT_EQ(ANIM_PROCESS_NONE, recycled.GetControl(5)->GetAnimations()[0].GetProcess());
+
+  CGUIListGroupState state;
+  EXPECT_FALSE(recycled.SaveState(state));
+  EXPECT_TRUE(shown.SaveState(state));
+  // only the running fade is kept, not the animations of every control
+  EXPECT_EQ(2U, state.m_controls);
+  ASSERT_EQ(1U, state.m_animations.size());
+  EXPECT_EQ(1U, state.m_animations[0].control);
+
+  // and carries on from there in the layout it gets when it comes back
+  recycled.RestoreState(state);
+  EXPECT_EQ(ANIM_PROCESS_NORMAL, recycled.GetControl(5)->GetAnimations()[0].GetProcess());
+  EXPECT_TRUE(recycled.IsAnimating(ANIM_TYPE_WINDOW_OPEN));
+}
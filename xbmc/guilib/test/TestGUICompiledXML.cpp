@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "addons/Skin.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "guilib/GUICompiledXML.h"
+#include "guilib/GUIWindow.h"
+#include "guilib/Key.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <iostream>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestGUICompiledXMLControls = 3000;
+static const unsigned int TestGUICompiledXMLRuns = 10;
+static const char *TestGUICompiledXMLSkinPath = "special://temp/skin.test.compiledxml/";
+
+/* a window about the size of a busy skin's home screen, with most of each control coming from an include */
+static std::string TestGUICompiledXMLWindow()
+{
+  std::string xml = "<window><defaultcontrol always=\"true\">50</defaultcontrol><controls>";
+  for (unsigned int i = 0; i < TestGUICompiledXMLControls; ++i)
+    xml += StringUtils::Format("<control type=\"image\" id=\"%u\">"
+                                 "<posx>%u</posx>"
+                                 "<include>TestImage</include>"
+                                 "<visible>Control.HasFocus(%u) + !Skin.HasSetting(foo)</visible>"
+                               "</control>", i, i * 2, i);
+  xml += "</controls></window>";
+  return xml;
+}
+
+static const char *TestGUICompiledXMLIncludes =
+  "<includes>"
+    "<include name=\"TestImage\">"
+      "<posy>10</posy><width>100</width><height>40</height>"
+      "<texture border=\"5\">list-focus.png</texture>"
+      "<animation effect=\"fade\" time=\"200\">WindowOpen</animation>"
+    "</include>"
+  "</includes>";
+
+static bool TestGUICompiledXMLWriteFile(const CStdString &path, const std::string &data)
+{
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+  bool written = file.Write(data.c_str(), data.size()) == (int)data.size();
+  file.Close();
+  return written;
+}
+
+/* a skin with just the includes the test windows use */
+class TestGUICompiledXMLSkin : public ADDON::CSkinInfo
+{
+public:
+  TestGUICompiledXMLSkin()
+  : CSkinInfo(ADDON::AddonProps("skin.test.compiledxml", ADDON::ADDON_SKIN, "1.0", "1.0"))
+  {
+  }
+
+  bool LoadIncludesFrom(const CStdString &file) { return m_includes.LoadIncludes(file); }
+};
+
+/* gives access to loading a window from a skin file */
+class TestGUICompiledXMLWindowLoader : public CGUIWindow
+{
+public:
+  TestGUICompiledXMLWindowLoader() : CGUIWindow(WINDOW_INVALID, "") {}
+
+  bool Load(const CStdString &path) { return LoadXML(path, path); }
+  unsigned int GetControlCount() const { return m_children.size(); }
+};
+
+/* installs a skin whose windows live in TestGUICompiledXMLRuns copies of the same file */
+class TestGUICompiledXMLWindowLoad : public testing::Test
+{
+protected:
+  TestGUICompiledXMLWindowLoad()
+  {
+    m_skin = g_SkinInfo;
+    TestGUICompiledXMLSkin *skin = new TestGUICompiledXMLSkin;
+    g_SkinInfo.reset(skin);
+
+    XFILE::CDirectory::Create(TestGUICompiledXMLSkinPath);
+    TestGUICompiledXMLWriteFile(TestGUICompiledXMLSkinPath + CStdString("includes.xml"), TestGUICompiledXMLIncludes);
+    skin->LoadIncludesFrom(TestGUICompiledXMLSkinPath + CStdString("includes.xml"));
+    std::string window = TestGUICompiledXMLWindow();
+    for (unsigned int i = 0; i < TestGUICompiledXMLRuns; ++i)
+      TestGUICompiledXMLWriteFile(GetWindowPath(i), window);
+  }
+
+  ~TestGUICompiledXMLWindowLoad()
+  {
+    XFILE::CFile::Delete(TestGUICompiledXMLSkinPath + CStdString("includes.xml"));
+    for (unsigned int i = 0; i < TestGUICompiledXMLRuns; ++i)
+      XFILE::CFile::Delete(GetWindowPath(i));
+    XFILE::CDirectory::Remove(TestGUICompiledXMLSkinPath);
+
+    // along with the windows compiled from them
+    CStdString compiledPath = "special://temp/skincache/" + g_SkinInfo->ID() + "/";
+    CFileItemList compiled;
+    XFILE::CDirectory::GetDirectory(compiledPath, compiled);
+    for (int i = 0; i < compiled.Size(); ++i)
+      XFILE::CFile::Delete(compiled[i]->GetPath());
+    XFILE::CDirectory::Remove(compiledPath);
+    g_SkinInfo = m_skin;
+  }
+
+  CStdString GetWindowPath(unsigned int i) const
+  {
+    return StringUtils::Format("%sWindow%u.xml", TestGUICompiledXMLSkinPath, i);
+  }
+
+  boost::shared_ptr<ADDON::CSkinInfo> m_skin;
+};
+
+static std::string TestGUICompiledXMLPrint(const TiXmlNode *node)
+{
+  TiXmlPrinter printer;
+  node->Accept(&printer);
+  return printer.Str();
+}
+
+TEST(TestGUICompiledXML, RoundTrip)
+{
+  CXBMCTinyXML xml;
+  ASSERT_TRUE(xml.Parse("<window id=\"1\"><!-- dropped --><controls>"
+                          "<control type=\"label\"><label>$INFO[ListItem.Label]</label></control>"
+                          "<control type=\"group\"><control type=\"image\" id=\"2\"/></control>"
+                        "</controls></window>") != NULL);
+
+  std::string data;
+  std::map<int, bool> conditions;
+  CGUICompiledXML::Compile(xml.RootElement(), "skin.test 1.0", std::vector<CStdString>(), conditions, data);
+
+  TiXmlElement *root = CGUICompiledXML::Decompile(data, "skin.test 1.0", conditions);
+  ASSERT_TRUE(root != NULL);
+  xml.RootElement()->RemoveChild(xml.RootElement()->FirstChild());
+  EXPECT_EQ(TestGUICompiledXMLPrint(xml.RootElement()), TestGUICompiledXMLPrint(root));
+  delete root;
+}
+
+TEST(TestGUICompiledXML, RejectsStale)
+{
+  CXBMCTinyXML xml;
+  ASSERT_TRUE(xml.Parse("<window><controls><control type=\"image\"/></controls></window>") != NULL);
+
+  std::string data;
+  std::map<int, bool> conditions;
+  CGUICompiledXML::Compile(xml.RootElement(), "skin.test 1.0", std::vector<CStdString>(), conditions, data);
+
+  // another skin version, or a truncated file, must fall back to the XML
+  EXPECT_TRUE(CGUICompiledXML::Decompile(data, "skin.test 1.1", conditions) == NULL);
+  for (size_t i = 0; i < data.size(); ++i)
+    EXPECT_TRUE(CGUICompiledXML::Decompile(data.substr(0, i), "skin.test 1.0", conditions) == NULL);
+}
+
+/* compares loading a window from its XML, resolving its includes, with loading it from the compiled form */
+TEST_F(TestGUICompiledXMLWindowLoad, LoadBenchmark)
+{
+  // each window file is new to the compiled cache the first time round
+  int64_t start = CurrentHostCounter();
+  for (unsigned int i = 0; i < TestGUICompiledXMLRuns; ++i)
+  {
+    TestGUICompiledXMLWindowLoader window;
+    ASSERT_TRUE(window.Load(GetWindowPath(i)));
+    ASSERT_EQ(TestGUICompiledXMLControls, window.GetControlCount());
+  }
+  int64_t parsed = CurrentHostCounter() - start;
+
+  // and comes from the cache after that
+  start = CurrentHostCounter();
+  for (unsigned int i = 0; i < TestGUICompiledXMLRuns; ++i)
+  {
+    TestGUICompiledXMLWindowLoader window;
+    ASSERT_TRUE(window.Load(GetWindowPath(i)));
+    ASSERT_EQ(TestGUICompiledXMLControls, window.GetControlCount());
+  }
+  int64_t compiled = CurrentHostCounter() - start;
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << TestGUICompiledXMLControls << " controls: " << parsed / frequency / TestGUICompiledXMLRuns <<
+    " ms from XML, " << compiled / frequency / TestGUICompiledXMLRuns << " ms compiled" << std::endl;
+}
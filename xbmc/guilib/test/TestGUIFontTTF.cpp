@@ -0,0 +1,219 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_GL) || defined(HAS_GLES)
+#include "guilib/GUIFont.h"
+#include "guilib/GUIFontTTF.h"
+#include "guilib/Texture.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+#include "test/TestUtils.h"
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestGUIFontTTFCharacters = 400;
+
+/* a font that keeps what it would have drawn instead of drawing it */
+class TestGUIFontTTFFont : public CGUIFontTTF
+{
+public:
+  TestGUIFontTTFFont() : CGUIFontTTF("TestGUIFontTTFFont") {}
+
+  virtual void Begin()
+  {
+    if (m_nestedBeginCount++ == 0)
+    {
+      for (unsigned int page = 0; page < m_pages.size(); page++)
+        m_pages[page].vertices.clear();
+    }
+  }
+
+  virtual void End()
+  {
+    if (m_nestedBeginCount == 0 || --m_nestedBeginCount > 0)
+      return;
+    m_drawn.clear();
+    for (unsigned int page = 0; page < m_pages.size(); page++)
+      m_drawn.insert(m_drawn.end(), m_pages[page].vertices.begin(), m_pages[page].vertices.end());
+  }
+
+  bool Load(float height = 20.0f)
+  {
+    return CGUIFontTTF::Load(XBMC_REF_FILE_PATH("addons/skin.confluence/fonts/Roboto-Regular.ttf"), height);
+  }
+
+  bool WaitForPrefetch()
+  {
+    XbmcThreads::EndTime timeout(10000);
+    while (IsPrefetching() && !timeout.IsTimePast())
+      XbmcThreads::ThreadSleep(1);
+    return !IsPrefetching();
+  }
+
+  void Draw(const vecText &text)
+  {
+    vecColors colors(1, 0xffffffff);
+    DrawTextInternal(0, 0, colors, text, XBFONT_LEFT, 0, false);
+  }
+
+  unsigned int GetPages() const { return m_pages.size(); }
+  const CBaseTexture *GetPage(unsigned int page) const { return m_pages[page].texture; }
+  unsigned int GetPageHeight(unsigned int page) const { return m_pages[page].height; }
+  unsigned int GetMaxPageHeight() const { return m_pageHeight; }
+  unsigned int GetGlyphCapacity() const { return (m_textureWidth / m_cellHeight) * (m_pageHeight / GetTextureLineHeight()) * m_maxPages; }
+
+  std::vector<SVertex> m_drawn;
+};
+
+/* greek, cyrillic and accented latin letters, as a translated list might show */
+static vecText TestGUIFontTTFText(unsigned int count, character_t first = 0x100)
+{
+  vecText text;
+  for (character_t ch = first; text.size() < count; ch++)
+  {
+    if (ch == 0x180)
+      ch = 0x391;
+    else if (ch == 0x3d0)
+      ch = 0x410;
+    text.push_back(ch);
+  }
+  return text;
+}
+
+TEST(TestGUIFontTTF, PrefetchedGlyphs)
+{
+  TestGUIFontTTFFont prefetched, drawn;
+  ASSERT_TRUE(prefetched.Load());
+  ASSERT_TRUE(drawn.Load());
+  vecText text = TestGUIFontTTFText(100);
+
+  prefetched.PrefetchCharacters(text);
+  ASSERT_TRUE(prefetched.WaitForPrefetch());
+
+  unsigned int before, missedBefore, after, missedAfter;
+  CGUIFontTTFBase::GetGlyphStatistics(before, missedBefore);
+  prefetched.Draw(text);
+  CGUIFontTTFBase::GetGlyphStatistics(after, missedAfter);
+  EXPECT_EQ(text.size(), after - before);
+  EXPECT_EQ(missedBefore, missedAfter);
+
+  // rasterized on the render thread, the same glyphs end up in the same place
+  drawn.Draw(text);
+  CGUIFontTTFBase::GetGlyphStatistics(before, missedBefore);
+  EXPECT_EQ(text.size(), missedBefore - missedAfter);
+
+  ASSERT_EQ(drawn.m_drawn.size(), prefetched.m_drawn.size());
+  EXPECT_EQ(0, memcmp(&drawn.m_drawn[0], &prefetched.m_drawn[0], drawn.m_drawn.size() * sizeof(SVertex)));
+  ASSERT_EQ(drawn.GetPages(), prefetched.GetPages());
+  const CBaseTexture *a = drawn.GetPage(0), *b = prefetched.GetPage(0);
+  ASSERT_EQ(a->GetPitch() * a->GetRows(), b->GetPitch() * b->GetRows());
+  EXPECT_EQ(0, memcmp(a->GetPixels(), b->GetPixels(), a->GetPitch() * a->GetRows()));
+
+  // characters already in the texture aren't queued again
+  prefetched.PrefetchCharacters(text);
+  EXPECT_FALSE(prefetched.IsPrefetching());
+}
+
+TEST(TestGUIFontTTF, PrefetchKeepsToTextureBudget)
+{
+  TestGUIFontTTFFont font;
+  ASSERT_TRUE(font.Load(100.0f));
+  unsigned int budget = font.GetGlyphCapacity() / 2;
+  vecText text = TestGUIFontTTFText(budget * 2);
+
+  unsigned int before, missedBefore, after, missedAfter;
+  CGUIFontTTFBase::GetGlyphStatistics(before, missedBefore);
+  font.PrefetchCharacters(text);
+  ASSERT_TRUE(font.WaitForPrefetch());
+
+  // only the first half of the text is rasterized ahead
+  font.Draw(vecText(text.begin(), text.begin() + budget));
+  CGUIFontTTFBase::GetGlyphStatistics(after, missedAfter);
+  EXPECT_EQ(budget, after - before);
+  EXPECT_EQ(missedBefore, missedAfter);
+
+  font.Draw(vecText(text.begin() + budget, text.begin() + budget + 1));
+  CGUIFontTTFBase::GetGlyphStatistics(before, missedBefore);
+  EXPECT_EQ(after, before);
+  EXPECT_EQ(missedAfter + 1, missedBefore);
+}
+
+TEST(TestGUIFontTTF, Pages)
+{
+  TestGUIFontTTFFont font;
+  ASSERT_TRUE(font.Load(40.0f));
+  ASSERT_EQ(1U, font.GetPages());
+
+  // draw characters until the first page is full
+  character_t next = 0x4e00;
+  while (font.GetPages() == 1 && next < 0x9fff)
+  {
+    font.Draw(vecText(1, next++));
+    ASSERT_GE(font.GetMaxPageHeight(), font.GetPageHeight(0));
+  }
+  ASSERT_EQ(2U, font.GetPages());
+  EXPECT_EQ(font.GetMaxPageHeight(), font.GetPageHeight(0));
+
+  // more characters go to the second page, without the first being reallocated or the
+  // vertices of text drawn so far being invalidated
+  const CBaseTexture *first = font.GetPage(0);
+  unsigned int generation = font.GetGeneration();
+  font.Draw(vecText(1, next++));
+  EXPECT_EQ(first, font.GetPage(0));
+  EXPECT_EQ(generation, font.GetGeneration());
+
+  // and text drawn from both pages has every character
+  vecText text;
+  text.push_back(0x4e00);
+  text.push_back(next - 1);
+  font.Draw(text);
+  EXPECT_EQ(8U, font.m_drawn.size());
+}
+
+/* time spent drawing text in new characters for the first time, rasterizing them as they are
+   drawn and with them prefetched by a job while the previous window was shown */
+TEST(TestGUIFontTTF, PrefetchBenchmark)
+{
+  TestGUIFontTTFFont prefetched, drawn;
+  ASSERT_TRUE(prefetched.Load());
+  ASSERT_TRUE(drawn.Load());
+  vecText text = TestGUIFontTTFText(TestGUIFontTTFCharacters);
+
+  int64_t start = CurrentHostCounter();
+  drawn.Draw(text);
+  int64_t rasterized = CurrentHostCounter() - start;
+
+  prefetched.PrefetchCharacters(text);
+  ASSERT_TRUE(prefetched.WaitForPrefetch());
+  start = CurrentHostCounter();
+  prefetched.Draw(text);
+  int64_t copied = CurrentHostCounter() - start;
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << TestGUIFontTTFCharacters << " new characters: " << rasterized / frequency << " ms rasterized while drawing, " <<
+    copied / frequency << " ms prefetched" << std::endl;
+}
+#endif
@@ -0,0 +1,297 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_GL) || defined(HAS_GLES)
+#include "guilib/GUIFont.h"
+#include "guilib/GUIFontTTF.h"
+#include "guilib/GUIFontManager.h"
+#include "guilib/GUITextLayout.h"
+#include "guilib/GraphicContext.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "test/TestUtils.h"
+
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestGUITextLayoutLabels = 200;
+static const unsigned int TestGUITextLayoutFrames = 100;
+static const unsigned int TestGUITextLayoutItems = 5000;
+static const unsigned int TestGUITextLayoutPage = 20;
+
+/* a font that keeps what it would have drawn instead of drawing it */
+class TestGUITextLayoutFont : public CGUIFontTTF
+{
+public:
+  TestGUITextLayoutFont() : CGUIFontTTF("TestGUITextLayoutFont") {}
+
+  virtual void Begin()
+  {
+    if (m_nestedBeginCount++ == 0)
+    {
+      for (unsigned int page = 0; page < m_pages.size(); page++)
+        m_pages[page].vertices.clear();
+    }
+  }
+
+  virtual void End()
+  {
+    if (m_nestedBeginCount == 0 || --m_nestedBeginCount > 0)
+      return;
+    m_drawn.clear();
+    for (unsigned int page = 0; page < m_pages.size(); page++)
+      m_drawn.insert(m_drawn.end(), m_pages[page].vertices.begin(), m_pages[page].vertices.end());
+  }
+
+  std::vector<SVertex> m_drawn;
+};
+
+static bool TestGUITextLayoutEqual(const std::vector<SVertex> &a, const std::vector<SVertex> &b)
+{
+  return a.size() == b.size() && (a.empty() || memcmp(&a[0], &b[0], a.size() * sizeof(SVertex)) == 0);
+}
+
+class TestGUITextLayout : public testing::Test
+{
+protected:
+  TestGUITextLayout()
+  {
+    m_ttf = new TestGUITextLayoutFont();
+    m_loaded = m_ttf->Load(XBMC_REF_FILE_PATH("addons/skin.confluence/fonts/Roboto-Regular.ttf"), 20.0f);
+    m_font = new CGUIFont("font13", FONT_STYLE_NORMAL, 0xffffffff, 0, 1.0f, 20.0f, m_ttf);
+
+    for (unsigned int i = 0; i < TestGUITextLayoutLabels; ++i)
+    {
+      // a mix of single line labels and wrapped plots, as on a busy home screen
+      CGUITextLayout *layout = new CGUITextLayout(m_font, i % 10 == 0);
+      layout->Update(StringUtils::Format("Label %u: The quick brown fox jumps over the lazy dog [B]%u[/B]", i, i * 7), 300.0f);
+      m_layouts.push_back(layout);
+    }
+  }
+
+  ~TestGUITextLayout()
+  {
+    for (unsigned int i = 0; i < m_layouts.size(); ++i)
+      delete m_layouts[i];
+    delete m_font;
+    delete m_ttf;
+  }
+
+  void RenderFrame(color_t color)
+  {
+    for (unsigned int i = 0; i < m_layouts.size(); ++i)
+      m_layouts[i]->Render(20.0f, 30.0f * (i % 24), 0, color, 0, XBFONT_TRUNCATED, 300.0f);
+  }
+
+  TestGUITextLayoutFont *m_ttf;
+  CGUIFont *m_font;
+  bool m_loaded;
+  std::vector<CGUITextLayout*> m_layouts;
+};
+
+TEST_F(TestGUITextLayout, CachedVertices)
+{
+  ASSERT_TRUE(m_loaded);
+
+  CGUITextLayout &layout = *m_layouts[1];
+  layout.Render(20.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  std::vector<SVertex> first = m_ttf->m_drawn;
+  ASSERT_FALSE(first.empty());
+
+  // unchanged, the text comes from the cache and must be identical
+  layout.Render(20.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  EXPECT_TRUE(TestGUITextLayoutEqual(first, m_ttf->m_drawn));
+
+  // a different color, position or text must not
+  layout.Render(20.0f, 30.0f, 0, 0xff00ff00, 0, XBFONT_LEFT, 300.0f);
+  EXPECT_FALSE(TestGUITextLayoutEqual(first, m_ttf->m_drawn));
+  EXPECT_EQ(0xff, m_ttf->m_drawn[0].g);
+  EXPECT_EQ(0x00, m_ttf->m_drawn[0].r);
+
+  layout.Render(25.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  EXPECT_FALSE(TestGUITextLayoutEqual(first, m_ttf->m_drawn));
+
+  layout.Update("Something else entirely", 300.0f);
+  layout.Render(20.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  EXPECT_FALSE(TestGUITextLayoutEqual(first, m_ttf->m_drawn));
+}
+
+TEST_F(TestGUITextLayout, CachedVerticesTransform)
+{
+  ASSERT_TRUE(m_loaded);
+
+  CGUITextLayout &layout = *m_layouts[2];
+  layout.Render(20.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  std::vector<SVertex> first = m_ttf->m_drawn;
+
+  // the same text in a group that has moved must move with it
+  g_graphicsContext.SetOrigin(50.0f, 0.0f);
+  layout.Render(20.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  std::vector<SVertex> moved = m_ttf->m_drawn;
+  g_graphicsContext.RestoreOrigin();
+
+  ASSERT_EQ(first.size(), moved.size());
+  EXPECT_FLOAT_EQ(first[0].x + 50.0f, moved[0].x);
+
+  // and be back where it was once the group is
+  layout.Render(20.0f, 30.0f, 0, 0xffffffff, 0, XBFONT_LEFT, 300.0f);
+  EXPECT_TRUE(TestGUITextLayoutEqual(first, m_ttf->m_drawn));
+}
+
+/* measures the font CPU time of a text heavy window, with every label drawn the same way each
+   frame and with every label changing color each frame so that none of them can be cached */
+TEST_F(TestGUITextLayout, RenderBenchmark)
+{
+  ASSERT_TRUE(m_loaded);
+
+  // lay everything out once, so that both runs start with all characters in the glyph texture
+  RenderFrame(0xffffffff);
+
+  int64_t start = CurrentHostCounter();
+  for (unsigned int i = 0; i < TestGUITextLayoutFrames; ++i)
+    RenderFrame(0xffffffff);
+  int64_t cached = CurrentHostCounter() - start;
+
+  start = CurrentHostCounter();
+  for (unsigned int i = 0; i < TestGUITextLayoutFrames; ++i)
+    RenderFrame(i & 1 ? 0xffffffff : 0xfffffffe);
+  int64_t uncached = CurrentHostCounter() - start;
+
+  double frequency = CurrentHostFrequency() / 1000000.0;
+  std::cout << TestGUITextLayoutLabels << " labels: " << cached / frequency / TestGUITextLayoutFrames <<
+    " us per frame cached, " << uncached / frequency / TestGUITextLayoutFrames << " us per frame laid out" << std::endl;
+}
+
+TEST_F(TestGUITextLayout, SharedLayouts)
+{
+  ASSERT_TRUE(m_loaded);
+
+  const CStdString plot = "A plot that is long enough to be wrapped over a few lines";
+  unsigned int hits, misses, before;
+  size_t characters, charactersBefore;
+  CGUITextLayoutCache::Get().GetStatistics(before, misses, charactersBefore);
+
+  // a second layout of the same text comes from the cache, and matches the first
+  CGUITextLayout first(m_font, true), second(m_font, true);
+  EXPECT_TRUE(first.Update(plot, 150.0f));
+  EXPECT_TRUE(second.Update(plot, 150.0f));
+  CGUITextLayoutCache::Get().GetStatistics(hits, misses, characters);
+  EXPECT_EQ(before + 1, hits);
+  // the text is held by the key, the entry and its lines
+  EXPECT_GT(characters, charactersBefore + 2 * plot.size());
+
+  float width, height, cachedWidth, cachedHeight;
+  first.GetTextExtent(width, height);
+  second.GetTextExtent(cachedWidth, cachedHeight);
+  EXPECT_EQ(width, cachedWidth);
+  EXPECT_EQ(height, cachedHeight);
+  vecText text, cachedText;
+  first.GetFirstText(text);
+  second.GetFirstText(cachedText);
+  EXPECT_TRUE(text == cachedText);
+
+  // unchanged text isn't looked up again
+  EXPECT_FALSE(second.Update(plot, 150.0f));
+  CGUITextLayoutCache::Get().GetStatistics(hits, misses, characters);
+  EXPECT_EQ(before + 1, hits);
+
+  // but wrapped to another width it is laid out afresh
+  CGUITextLayout narrow(m_font, true);
+  EXPECT_TRUE(narrow.Update(plot, 80.0f));
+  narrow.GetTextExtent(cachedWidth, cachedHeight);
+  EXPECT_GT(cachedHeight, height);
+  CGUITextLayoutCache::Get().GetStatistics(hits, misses, characters);
+  EXPECT_EQ(before + 1, hits);
+}
+
+TEST_F(TestGUITextLayout, FontReloadClearsCache)
+{
+  ASSERT_TRUE(m_loaded);
+
+  CGUITextLayout layout(m_font, true);
+  EXPECT_TRUE(layout.Update("Laid out with the fonts at their old size", 150.0f));
+  unsigned int hits, misses;
+  size_t characters;
+  CGUITextLayoutCache::Get().GetStatistics(hits, misses, characters);
+  EXPECT_LT(0U, characters);
+
+  g_fontManager.ReloadTTFFonts();
+  CGUITextLayoutCache::Get().GetStatistics(hits, misses, characters);
+  EXPECT_EQ(0U, characters);
+}
+
+/* scrolls a page of list items, each with a title, genre and year, through a large library as
+   a list view does, with the shared layout cache and without */
+TEST_F(TestGUITextLayout, LibraryListBenchmark)
+{
+  ASSERT_TRUE(m_loaded);
+
+  static const char *genres[] = { "Action", "Adventure", "Animation", "Comedy", "Documentary", "Drama", "Horror", "Science Fiction" };
+  std::vector<CStdString> labels;
+  for (unsigned int i = 0; i < TestGUITextLayoutItems; ++i)
+  {
+    labels.push_back(StringUtils::Format("Movie number %u: The Sequel", i));
+    labels.push_back(genres[i % (sizeof(genres) / sizeof(genres[0]))]);
+    labels.push_back(StringUtils::Format("%u", 1950 + i % 60));
+  }
+
+  std::vector<CGUITextLayout*> page;
+  for (unsigned int i = 0; i < TestGUITextLayoutPage * 3; ++i)
+    page.push_back(new CGUITextLayout(m_font, false));
+
+  size_t capacity = CGUITextLayoutCache::Get().GetCapacity();
+  int64_t times[2];
+  unsigned int hits[2], misses[2];
+  for (unsigned int run = 0; run < 2; ++run)
+  {
+    CGUITextLayoutCache::Get().SetCapacity(run ? capacity : 0);
+    size_t characters;
+    CGUITextLayoutCache::Get().GetStatistics(hits[run], misses[run], characters);
+
+    int64_t start = CurrentHostCounter();
+    for (unsigned int offset = 0; offset + TestGUITextLayoutPage <= TestGUITextLayoutItems; ++offset)
+    {
+      for (unsigned int i = 0; i < page.size(); ++i)
+        page[i]->Update(labels[offset * 3 + i], 300.0f);
+    }
+    times[run] = CurrentHostCounter() - start;
+
+    unsigned int h, m;
+    CGUITextLayoutCache::Get().GetStatistics(h, m, characters);
+    hits[run] = h - hits[run];
+    misses[run] = m - misses[run];
+  }
+  CGUITextLayoutCache::Get().SetCapacity(capacity);
+
+  for (unsigned int i = 0; i < page.size(); ++i)
+    delete page[i];
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << TestGUITextLayoutItems << " items: " << times[0] / frequency << " ms laid out, " << times[1] / frequency <<
+    " ms with the cache (" << hits[1] * 100 / std::max(hits[1] + misses[1], 1U) << "% hits)" << std::endl;
+  EXPECT_EQ(0U, hits[0] + misses[0]);
+  EXPECT_GT(hits[1], misses[1]);
+}
+#endif
@@ -0,0 +1,198 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/Texture.h"
+#include "guilib/TextureBundleXBT.h"
+#include "guilib/XBTFReader.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+#include <lzo/lzo1x.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestTextureBundleXBTTextures = 300;
+static const unsigned int TestTextureBundleXBTSize = 128;
+
+static void TestTextureBundleXBTWrite(std::string &data, uint64_t value, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    data.push_back((char)(value >> (8 * i)));
+}
+
+/* writes a bundle of lzo packed textures the size of typical skin media, with one animation */
+class TestTextureBundleXBT : public testing::Test
+{
+protected:
+  TestTextureBundleXBT()
+  {
+    std::vector<std::string> frames;
+    std::vector<CStdString> paths;
+    std::vector<unsigned int> counts;
+    srand(1);
+    for (unsigned int i = 0; i < TestTextureBundleXBTTextures; i++)
+    {
+      // smooth gradients with a little noise, so they pack about as well as real textures
+      std::string pixels(TestTextureBundleXBTSize * TestTextureBundleXBTSize * 4, '\0');
+      for (size_t j = 0; j < pixels.size(); j++)
+        pixels[j] = (char)((j / 4 % TestTextureBundleXBTSize) * (j % 4 + i) + (rand() % 8 == 0 ? rand() & 0xFF : 0));
+      frames.push_back(pixels);
+      paths.push_back(StringUtils::Format("textures/texture%u.png", i));
+      counts.push_back(1);
+    }
+    frames.push_back(frames[0]);
+    frames.push_back(frames[1]);
+    paths.push_back("textures/animated.gif");
+    counts.push_back(2);
+
+    std::string header, packed;
+    header.append(XBTF_MAGIC);
+    header.append(XBTF_VERSION);
+    TestTextureBundleXBTWrite(header, paths.size(), 4);
+    uint64_t offset = 4 + 1 + 4 + paths.size() * (256 + 4 + 4) + frames.size() * (4 + 4 + 4 + 8 + 8 + 4 + 8);
+    std::vector<unsigned char> memory(LZO1X_1_MEM_COMPRESS);
+    size_t frame = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+      std::string path(paths[i]);
+      path.resize(256, '\0');
+      header.append(path);
+      TestTextureBundleXBTWrite(header, 0, 4);
+      TestTextureBundleXBTWrite(header, counts[i], 4);
+      for (unsigned int j = 0; j < counts[i]; j++, frame++)
+      {
+        std::string out(frames[frame].size() + frames[frame].size() / 16 + 64 + 3, '\0');
+        lzo_uint size = out.size();
+        lzo1x_1_compress((const unsigned char *)frames[frame].c_str(), frames[frame].size(), (unsigned char *)&out[0], &size, &memory[0]);
+        out.resize(size);
+
+        TestTextureBundleXBTWrite(header, TestTextureBundleXBTSize, 4);
+        TestTextureBundleXBTWrite(header, TestTextureBundleXBTSize, 4);
+        TestTextureBundleXBTWrite(header, XB_FMT_A8R8G8B8, 4);
+        TestTextureBundleXBTWrite(header, out.size(), 8);
+        TestTextureBundleXBTWrite(header, frames[frame].size(), 8);
+        TestTextureBundleXBTWrite(header, 100, 4);
+        TestTextureBundleXBTWrite(header, offset + packed.size(), 8);
+        packed.append(out);
+      }
+    }
+
+    m_file = XBMC_CREATETEMPFILE(".xbt");
+    if (m_file)
+    {
+      m_file->Close();
+      m_path = XBMC_TEMPFILEPATH(m_file);
+      if (m_file->OpenForWrite(m_path, true))
+      {
+        m_file->Write(header.c_str(), header.size());
+        m_file->Write(packed.c_str(), packed.size());
+        m_file->Close();
+      }
+    }
+  }
+
+  ~TestTextureBundleXBT()
+  {
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  XFILE::CFile *m_file;
+  CStdString m_path;
+};
+
+TEST_F(TestTextureBundleXBT, Prefetch)
+{
+  CTextureBundleXBT prefetched, loaded;
+  ASSERT_TRUE(prefetched.OpenBundle(m_path));
+  ASSERT_TRUE(loaded.OpenBundle(m_path));
+
+  std::vector<CStdString> names;
+  names.push_back("textures/texture1.png");
+  names.push_back("Textures\\Texture2.png");
+  names.push_back("textures/texture2.png");
+  names.push_back("textures/animated.gif");
+  names.push_back("textures/missing.png");
+  EXPECT_EQ(2U, prefetched.PrefetchTextures(names));
+
+  for (unsigned int i = 1; i <= 2; i++)
+  {
+    CStdString name = StringUtils::Format("textures/texture%u.png", i);
+    CBaseTexture *texture = NULL, *expected = NULL;
+    int width = 0, height = 0;
+    ASSERT_TRUE(prefetched.LoadTexture(name, &texture, width, height));
+    EXPECT_EQ((int)TestTextureBundleXBTSize, width);
+    ASSERT_TRUE(loaded.LoadTexture(name, &expected, width, height));
+    ASSERT_EQ(expected->GetPitch() * expected->GetRows(), texture->GetPitch() * texture->GetRows());
+    EXPECT_EQ(0, memcmp(expected->GetPixels(), texture->GetPixels(), expected->GetPitch() * expected->GetRows()));
+    delete texture;
+    delete expected;
+  }
+}
+
+/* time until every texture of a bundle is ready to upload, decompressing them one by one and with a prefetch.
+   A skin's own bundle is used if it has been built, our generated one otherwise. */
+TEST_F(TestTextureBundleXBT, LoadBenchmark)
+{
+  CStdString path = XBMC_REF_FILE_PATH("addons/skin.confluence/media/Textures.xbt");
+  if (!XFILE::CFile::Exists(path))
+    path = m_path;
+
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  std::vector<CStdString> names;
+  for (std::vector<CXBTFFile>::iterator i = reader.GetFiles().begin(); i != reader.GetFiles().end(); ++i)
+  {
+    if (i->GetFrames().size() == 1)
+      names.push_back(i->GetPath());
+  }
+  reader.Close();
+
+  CTextureBundleXBT bundle;
+  ASSERT_TRUE(bundle.OpenBundle(path));
+  int64_t start = CurrentHostCounter();
+  for (std::vector<CStdString>::const_iterator i = names.begin(); i != names.end(); ++i)
+  {
+    CBaseTexture *texture = NULL;
+    int width, height;
+    EXPECT_TRUE(bundle.LoadTexture(*i, &texture, width, height));
+    delete texture;
+  }
+  int64_t serial = CurrentHostCounter() - start;
+
+  start = CurrentHostCounter();
+  EXPECT_EQ(names.size(), bundle.PrefetchTextures(names));
+  for (std::vector<CStdString>::const_iterator i = names.begin(); i != names.end(); ++i)
+  {
+    CBaseTexture *texture = NULL;
+    int width, height;
+    EXPECT_TRUE(bundle.LoadTexture(*i, &texture, width, height));
+    delete texture;
+  }
+  int64_t prefetched = CurrentHostCounter() - start;
+
+  double frequency = CurrentHostFrequency() / 1000.0;
+  std::cout << names.size() << " textures from " << path << ": " << serial / frequency << " ms one by one, " <<
+    prefetched / frequency << " ms prefetched" << std::endl;
+}
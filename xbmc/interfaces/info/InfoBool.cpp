@@ -26,10 +26,36 @@
 using namespace std;
 using namespace INFO;
 
+bool InfoBool::Get(unsigned int time, const CGUIListItem *item)
+{
+  if (item && (m_sources & INFO_SOURCE_LISTITEM))
+  {
+    Update(item);
+    g_infoManager.m_boolEvaluations++;
+  }
+  else if (time != m_lastUpdate)
+  {
+    // fetch the version before updating, so that a change during the update is caught next time
+    unsigned int version = g_infoManager.GetSourcesVersion(m_sources);
+    if (!m_valid || version != m_version || (m_sources & INFO_SOURCE_VOLATILE))
+    {
+      Update(NULL);
+      m_version = version;
+      m_valid = true;
+      g_infoManager.m_boolEvaluations++;
+    }
+    else
+      g_infoManager.m_boolsCached++;
+    m_lastUpdate = time;
+  }
+  return m_value;
+}
+
 InfoSingle::InfoSingle(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression);
+  m_sources = g_infoManager.GetConditionSources(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -40,6 +66,8 @@ void InfoSingle::Update(const CGUIListItem *item)
 InfoExpression::InfoExpression(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
+  // an expression depends on whatever its operands depend on, see Parse()
+  m_sources = 0;
   Parse(expression);
 }
 
@@ -86,6 +114,7 @@ void InfoExpression::Parse(const CStdString &expression)
         {
           m_postfix.push_back(m_operands.size());
           m_operands.push_back(info);
+          m_sources |= g_infoManager.GetBoolSources(info);
         }
         operand.clear();
       }
@@ -132,6 +161,7 @@ void InfoExpression::Parse(const CStdString &expression)
     {
       m_postfix.push_back(m_operands.size());
       m_operands.push_back(info);
+      m_sources |= g_infoManager.GetBoolSources(info);
     }
   }
 
@@ -28,6 +28,23 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief Sources of information boolean conditions depend on
+ Sources other than INFO_SOURCE_VOLATILE publish their changes via CGUIInfoManager::SourceChanged,
+ so conditions that depend only on them need not be evaluated again until one of them changes.
+ */
+enum InfoSource
+{
+  INFO_SOURCE_LISTITEM       = 0x01, ///< the list item a condition is evaluated for
+  INFO_SOURCE_LIBRARY        = 0x02, ///< the content of the libraries, eg. Library.HasContent(movies)
+  INFO_SOURCE_SKIN_SETTINGS  = 0x04, ///< the skin's settings, eg. Skin.HasSetting(foo)
+  INFO_SOURCE_PLAYER         = 0x08, ///< the state of the player, eg. Player.Paused
+  INFO_SOURCE_WINDOW         = 0x10, ///< the active window and dialogs, eg. Window.IsActive(foo)
+  INFO_SOURCE_SYSTEM         = 0x20, ///< settings and system state, eg. System.ScreenSaverActive
+  INFO_SOURCE_VOLATILE       = 0x80  ///< anything that doesn't publish changes, evaluated every frame
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -38,29 +55,25 @@ public:
   InfoBool(const CStdString &expression, int context)
     : m_value(false),
       m_context(context),
+      m_sources(INFO_SOURCE_VOLATILE),
       m_expression(expression),
-      m_lastUpdate(0)
+      m_lastUpdate(0),
+      m_version(0),
+      m_valid(false)
   {
   };
 
   virtual ~InfoBool() {};
 
   /*! \brief Get the value of this info bool
-   This is called to update (if necessary) and fetch the value of the info bool
+   This is called to update (if necessary) and fetch the value of the info bool.
+   The info bool is only updated if it depends on a volatile source, if one of the sources
+   it depends on has changed since it was last updated, or if it depends on the item.
    \param time current time (used to test if we need to update yet)
    \param item the item used to evaluate the bool
+   \sa GetSources, CGUIInfoManager::SourceChanged
    */
-  inline bool Get(unsigned int time, const CGUIListItem *item = NULL)
-  {
-    if (item)
-      Update(item);
-    else if (time - m_lastUpdate > 0)
-    {
-      Update(NULL);
-      m_lastUpdate = time;
-    }
-    return m_value;
-  }
+  bool Get(unsigned int time, const CGUIListItem *item = NULL);
 
   bool operator==(const InfoBool &right) const
   {
@@ -73,14 +86,24 @@ public:
    */
   virtual void Update(const CGUIListItem *item) {};
 
+  const CStdString &GetExpression() const { return m_expression; };
+
+  /*! \brief Get the sources of information this info bool depends on
+   \return a combination of InfoSource flags
+   */
+  unsigned int GetSources() const { return m_sources; };
+
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
+  unsigned int m_sources;      ///< sources of information the value depends on (InfoSource flags)
 
 private:
   CStdString m_expression;     ///< original expression
   unsigned int m_lastUpdate;   ///< last update time (to determine dirty status)
+  unsigned int m_version;      ///< version of the sources at the last update
+  bool m_valid;                ///< true once m_value has been updated without an item
 };
 
 /*! \brief Class to wrap active boolean conditions
@@ -854,10 +854,13 @@ int CMusicDatabase::AddPath(const CStdString& strPath1)
     if (it != m_pathCache.end())
       return it->second;
 
-    strSQL=PrepareSQL( "select * from path where strPath='%s'", strPath.c_str());
-    m_pDS->query(strSQL.c_str());
-    if (m_pDS->num_rows() == 0)
+    strSQL = "select idPath from path where strPath=?";
+    dbiplus::BindList params;
+    params.push_back(strPath.c_str());
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDS->open_cursor(strSQL, params));
+    if (!cursor.get() || !cursor->next())
     {
+      cursor.reset();
       m_pDS->close();
       // doesnt exists, add it
       strSQL=PrepareSQL("insert into path (idPath, strPath) values( NULL, '%s' )", strPath.c_str());
@@ -869,9 +872,8 @@ int CMusicDatabase::AddPath(const CStdString& strPath1)
     }
     else
     {
-      int idPath = m_pDS->fv("idPath").get_asInt();
+      int idPath = cursor->get_int(0);
       m_pathCache.insert(pair<CStdString, int>(strPath, idPath));
-      m_pDS->close();
       return idPath;
     }
   }
@@ -934,39 +936,47 @@ void CMusicDatabase::GetFileItemFromDataset(CFileItem* item, const CStdString& s
 }
 
 void CMusicDatabase::GetFileItemFromDataset(const dbiplus::sql_record* const record, CFileItem* item, const CStdString& strMusicDBbasePath)
+{
+  dbiplus::RecordCursor row(record);
+  GetFileItemFromCursor(row, item, strMusicDBbasePath);
+}
+
+void CMusicDatabase::GetFileItemFromCursor(dbiplus::Cursor &row, CFileItem* item, const CStdString& strMusicDBbasePath)
 {
   // get the full artist string
-  item->GetMusicInfoTag()->SetArtist(StringUtils::Split(record->at(song_strArtists).get_asString(), g_advancedSettings.m_musicItemSeparator));
+  item->GetMusicInfoTag()->SetArtist(StringUtils::Split(row.get_text(song_strArtists), g_advancedSettings.m_musicItemSeparator));
   // and the full genre string
-  item->GetMusicInfoTag()->SetGenre(record->at(song_strGenres).get_asString());
+  item->GetMusicInfoTag()->SetGenre(row.get_text(song_strGenres));
   // and the rest...
-  item->GetMusicInfoTag()->SetAlbum(record->at(song_strAlbum).get_asString());
-  item->GetMusicInfoTag()->SetAlbumId(record->at(song_idAlbum).get_asInt());
-  item->GetMusicInfoTag()->SetTrackAndDiskNumber(record->at(song_iTrack).get_asInt());
-  item->GetMusicInfoTag()->SetDuration(record->at(song_iDuration).get_asInt());
-  item->GetMusicInfoTag()->SetDatabaseId(record->at(song_idSong).get_asInt(), "song");
+  item->GetMusicInfoTag()->SetAlbum(row.get_text(song_strAlbum));
+  item->GetMusicInfoTag()->SetAlbumId(row.get_int(song_idAlbum));
+  item->GetMusicInfoTag()->SetTrackAndDiskNumber(row.get_int(song_iTrack));
+  item->GetMusicInfoTag()->SetDuration(row.get_int(song_iDuration));
+  item->GetMusicInfoTag()->SetDatabaseId(row.get_int(song_idSong), "song");
   SYSTEMTIME stTime;
-  stTime.wYear = (WORD)record->at(song_iYear).get_asInt();
+  stTime.wYear = (WORD)row.get_int(song_iYear);
   item->GetMusicInfoTag()->SetReleaseDate(stTime);
-  item->GetMusicInfoTag()->SetTitle(record->at(song_strTitle).get_asString());
-  item->SetLabel(record->at(song_strTitle).get_asString());
-  item->m_lStartOffset = record->at(song_iStartOffset).get_asInt();
+  CStdString strTitle = row.get_text(song_strTitle);
+  item->GetMusicInfoTag()->SetTitle(strTitle);
+  item->SetLabel(strTitle);
+  item->m_lStartOffset = row.get_int(song_iStartOffset);
   item->SetProperty("item_start", item->m_lStartOffset);
-  item->m_lEndOffset = record->at(song_iEndOffset).get_asInt();
-  item->GetMusicInfoTag()->SetMusicBrainzTrackID(record->at(song_strMusicBrainzTrackID).get_asString());
-  item->GetMusicInfoTag()->SetMusicBrainzArtistID(record->at(song_strMusicBrainzArtistID).get_asString());
-  item->GetMusicInfoTag()->SetMusicBrainzAlbumID(record->at(song_strMusicBrainzAlbumID).get_asString());
-  item->GetMusicInfoTag()->SetMusicBrainzAlbumArtistID(record->at(song_strMusicBrainzAlbumArtistID).get_asString());
-  item->GetMusicInfoTag()->SetMusicBrainzTRMID(record->at(song_strMusicBrainzTRMID).get_asString());
-  item->GetMusicInfoTag()->SetRating(record->at(song_rating).get_asChar());
-  item->GetMusicInfoTag()->SetComment(record->at(song_comment).get_asString());
-  item->GetMusicInfoTag()->SetPlayCount(record->at(song_iTimesPlayed).get_asInt());
-  item->GetMusicInfoTag()->SetLastPlayed(record->at(song_lastplayed).get_asString());
+  item->m_lEndOffset = row.get_int(song_iEndOffset);
+  item->GetMusicInfoTag()->SetMusicBrainzTrackID(row.get_text(song_strMusicBrainzTrackID));
+  item->GetMusicInfoTag()->SetMusicBrainzArtistID(row.get_text(song_strMusicBrainzArtistID));
+  item->GetMusicInfoTag()->SetMusicBrainzAlbumID(row.get_text(song_strMusicBrainzAlbumID));
+  item->GetMusicInfoTag()->SetMusicBrainzAlbumArtistID(row.get_text(song_strMusicBrainzAlbumArtistID));
+  item->GetMusicInfoTag()->SetMusicBrainzTRMID(row.get_text(song_strMusicBrainzTRMID));
+  item->GetMusicInfoTag()->SetRating(row.get_text(song_rating)[0]);
+  item->GetMusicInfoTag()->SetComment(row.get_text(song_comment));
+  item->GetMusicInfoTag()->SetPlayCount(row.get_int(song_iTimesPlayed));
+  item->GetMusicInfoTag()->SetLastPlayed(row.get_text(song_lastplayed));
+  CStdString strFileName = row.get_text(song_strFileName);
   CStdString strRealPath;
-  URIUtils::AddFileToFolder(record->at(song_strPath).get_asString(), record->at(song_strFileName).get_asString(), strRealPath);
+  URIUtils::AddFileToFolder(row.get_text(song_strPath), strFileName, strRealPath);
   item->GetMusicInfoTag()->SetURL(strRealPath);
-  item->GetMusicInfoTag()->SetCompilation(record->at(song_bCompilation).get_asInt() == 1);
-  item->GetMusicInfoTag()->SetAlbumArtist(record->at(song_strAlbumArtists).get_asString());
+  item->GetMusicInfoTag()->SetCompilation(row.get_int(song_bCompilation) == 1);
+  item->GetMusicInfoTag()->SetAlbumArtist(row.get_text(song_strAlbumArtists));
   item->GetMusicInfoTag()->SetLoaded(true);
   // Get filename with full path
   if (strMusicDBbasePath.IsEmpty())
@@ -977,9 +987,8 @@ void CMusicDatabase::GetFileItemFromDataset(const dbiplus::sql_record* const rec
     if (!itemUrl.FromString(strMusicDBbasePath))
       return;
     
-    CStdString strFileName = record->at(song_strFileName).get_asString();
     CStdString strExt = URIUtils::GetExtension(strFileName);
-    CStdString path; path.Format("%ld%s", record->at(song_idSong).get_asInt(), strExt.c_str());
+    CStdString path; path.Format("%ld%s", row.get_int(song_idSong), strExt.c_str());
     itemUrl.AppendPath(path);
     item->SetPath(itemUrl.ToString());
   }
@@ -3255,54 +3264,54 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
+    FieldList fields;
+    if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), MediaTypeSong, fields))
+      fields.clear();
+
+    // run query, stepping through the rows instead of loading them all into the dataset first
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDS->open_cursor(strSQL));
+    if (!cursor.get())
       return false;
 
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
+    std::vector<CFileItemPtr> rows;
+    DatabaseResults results;
+    CStdString strBaseDir = musicUrl.ToString();
+    while (cursor->next())
     {
-      m_pDS->close();
-      return true;
+      DatabaseResult result;
+      if (!DatabaseUtils::GetDatabaseResult(MediaTypeSong, fields, *cursor, result))
+        return false;
+      result[FieldRow] = (unsigned int)rows.size();
+      results.push_back(result);
+
+      CFileItemPtr item(new CFileItem);
+      GetFileItemFromCursor(*cursor, item.get(), strBaseDir);
+      rows.push_back(item);
     }
+    cursor.reset();
+
+    int iRowsFound = (int)rows.size();
+    if (iRowsFound == 0)
+      return true;
 
     // store the total value of items as a property
     if (total < iRowsFound)
       total = iRowsFound;
     items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
-      return false;
 
-    // get data from returned rows
+    SortUtils::SortDatabaseResults(sortDescription, results);
+
+    // add the items in sorted order
     items.Reserve(results.size());
-    const dbiplus::query_data &data = m_pDS->get_result_set().records;
     int count = 0;
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-      
-      try
-      {
-        CFileItemPtr item(new CFileItem);
-        GetFileItemFromDataset(record, item.get(), musicUrl.ToString());
-        // HACK for sorting by database returned order
-        item->m_iprogramCount = ++count;
-        items.Add(item);
-      }
-      catch (...)
-      {
-        m_pDS->close();
-        CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
-        return (items.Size() > 0);
-      }
+      const CFileItemPtr &item = rows[(unsigned int)it->at(FieldRow).asInteger()];
+      // HACK for sorting by database returned order
+      item->m_iprogramCount = ++count;
+      items.Add(item);
     }
 
-    // cleanup
-    m_pDS->close();
     CLog::Log(LOGDEBUG, "%s(%s) - took %d ms", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time);
     return true;
   }
@@ -33,6 +33,7 @@ class CFileItem;
 
 namespace dbiplus
 {
+  class Cursor;
   class field_value;
   typedef std::vector<field_value> sql_record;
 }
@@ -311,6 +312,7 @@ private:
   CAlbum GetAlbumFromDataset(const dbiplus::sql_record* const record, bool imageURL=false);
   void GetFileItemFromDataset(CFileItem* item, const CStdString& strMusicDBbasePath);
   void GetFileItemFromDataset(const dbiplus::sql_record* const record, CFileItem* item, const CStdString& strMusicDBbasePath);
+  void GetFileItemFromCursor(dbiplus::Cursor &row, CFileItem* item, const CStdString& strMusicDBbasePath);
   bool CleanupSongs();
   bool CleanupSongsByIds(const CStdString &strSongIds);
   bool CleanupPaths();
@@ -43,6 +43,8 @@
 #include "settings/Settings.h"
 #include "FileItem.h"
 #include "guilib/LocalizeStrings.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobGroup.h"
 #include "utils/StringUtils.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
@@ -59,6 +61,21 @@ using namespace MUSIC_INFO;
 using namespace XFILE;
 using namespace MUSIC_GRABBER;
 
+/* reads the tag of a file into its item */
+class CMusicTagLoadJob : public CJob
+{
+public:
+  CMusicTagLoadJob(const CFileItemPtr &item) : m_item(item) {}
+  virtual const char *GetType() const { return "musictagload"; }
+  virtual bool DoWork()
+  {
+    auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(m_item->GetPath()));
+    return NULL != pLoader.get() && pLoader->Load(m_item->GetPath(), *m_item->GetMusicInfoTag());
+  }
+private:
+  CFileItemPtr m_item;
+};
+
 CMusicInfoScanner::CMusicInfoScanner() : CThread("CMusicInfoScanner")
 {
   m_bRunning = false;
@@ -471,80 +488,89 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
 
   CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
-  // for every file found, but skip folder
+  // dont try reading id3tags for folders, playlists or shoutcast streams, nor for
+  // excluded files defined by m_musicExcludeRegExps
+  vector<CFileItemPtr> songItems;
   for (int i = 0; i < items.Size(); ++i)
   {
     CFileItemPtr pItem = items[i];
-    CStdString strExtension;
-    URIUtils::GetExtension(pItem->GetPath(), strExtension);
+    if (!pItem->m_bIsFolder && !pItem->IsPlayList() && !pItem->IsPicture() && !pItem->IsLyrics() &&
+        !CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
+      songItems.push_back(pItem);
+  }
+
+  // read the tags from the files in parallel, as most of the time goes to waiting for them
+  {
+    CJobGroup group(NULL, std::max(1, g_cpuInfo.getCPUCount()), CJob::PRIORITY_NORMAL);
+    for (vector<CFileItemPtr>::iterator i = songItems.begin(); i != songItems.end(); ++i)
+    {
+      if (!(*i)->GetMusicInfoTag()->Loaded())
+        group.AddJob(new CMusicTagLoadJob(*i));
+    }
+    group.Close();
+    while (!group.Wait(100))
+    {
+      if (m_bStop)
+        return 0;
+    }
+  }
+
+  for (vector<CFileItemPtr>::iterator i = songItems.begin(); i != songItems.end(); ++i)
+  {
+    CFileItemPtr pItem = *i;
 
     if (m_bStop)
       return 0;
 
-    // Discard all excluded files defined by m_musicExcludeRegExps
-    if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
-      continue;
+    m_currentItem++;
 
-    // dont try reading id3tags for folders, playlists or shoutcast streams
-    if (!pItem->m_bIsFolder && !pItem->IsPlayList() && !pItem->IsPicture() && !pItem->IsLyrics() )
-    {
-      m_currentItem++;
-//      CLog::Log(LOGDEBUG, "%s - Reading tag for: %s", __FUNCTION__, pItem->GetPath().c_str());
-
-      // grab info from the song
-      CSong *dbSong = songsMap.Find(pItem->GetPath());
-
-      CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
-      if (!tag.Loaded() )
-      { // read the tag from a file
-        auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->GetPath()));
-        if (NULL != pLoader.get())
-          pLoader->Load(pItem->GetPath(), tag);
-      }
+    // grab info from the song
+    CSong *dbSong = songsMap.Find(pItem->GetPath());
 
-      // if we have the itemcount, update our
-      // dialog with the progress we made
-      if (m_handle && m_itemCount>0)
-        m_handle->SetPercentage(m_currentItem/(float)m_itemCount*100);
+    CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
+
+    // if we have the itemcount, update our
+    // dialog with the progress we made
+    if (m_handle && m_itemCount>0)
+      m_handle->SetPercentage(m_currentItem/(float)m_itemCount*100);
+
+    if (tag.Loaded())
+    {
+      CSong song(tag);
 
-      if (tag.Loaded())
+      // ensure our song has a valid filename or else it will assert in AddSong()
+      if (song.strFileName.IsEmpty())
       {
-        CSong song(tag);
+        // copy filename from path in case UPnP or other tag loaders didn't specify one (FIXME?)
+        song.strFileName = pItem->GetPath();
 
-        // ensure our song has a valid filename or else it will assert in AddSong()
+        // if we still don't have a valid filename, skip the song
         if (song.strFileName.IsEmpty())
         {
-          // copy filename from path in case UPnP or other tag loaders didn't specify one (FIXME?)
-          song.strFileName = pItem->GetPath();
-
-          // if we still don't have a valid filename, skip the song
-          if (song.strFileName.IsEmpty())
-          {
-            // this shouldn't ideally happen!
-            CLog::Log(LOGERROR, "Skipping song since it doesn't seem to have a filename");
-            continue;
-          }
+          // this shouldn't ideally happen!
+          CLog::Log(LOGERROR, "Skipping song since it doesn't seem to have a filename");
+          continue;
         }
+      }
 
-        song.iStartOffset = pItem->m_lStartOffset;
-        song.iEndOffset = pItem->m_lEndOffset;
-        song.strThumb = pItem->GetUserMusicThumb(true);
-        if (dbSong)
-        { // keep the db-only fields intact on rescan...
-          song.iTimesPlayed = dbSong->iTimesPlayed;
-          song.lastPlayed = dbSong->lastPlayed;
-          song.iKaraokeNumber = dbSong->iKaraokeNumber;
-
-          if (song.rating == '0') song.rating = dbSong->rating;
-          if (song.strThumb.empty())
-            song.strThumb = dbSong->strThumb;
-        }
-        songsToAdd.push_back(song);
-//        CLog::Log(LOGDEBUG, "%s - Tag loaded for: %s", __FUNCTION__, pItem->GetPath().c_str());
+      song.iStartOffset = pItem->m_lStartOffset;
+      song.iEndOffset = pItem->m_lEndOffset;
+      song.strThumb = pItem->GetUserMusicThumb(true);
+      if (dbSong)
+      { // keep the db-only fields intact on rescan...
+        song.iTimesPlayed = dbSong->iTimesPlayed;
+        song.lastPlayed = dbSong->lastPlayed;
+        song.iKaraokeNumber = dbSong->iKaraokeNumber;
+
+        if (song.rating == '0') song.rating = dbSong->rating;
+        if (song.strThumb.empty())
+          song.strThumb = dbSong->strThumb;
       }
-      else
-        CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, pItem->GetPath().c_str());
+      songsToAdd.push_back(song);
+//      CLog::Log(LOGDEBUG, "%s - Tag loaded for: %s", __FUNCTION__, pItem->GetPath().c_str());
     }
+    else
+      CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, pItem->GetPath().c_str());
   }
 
   VECALBUMS albums;
@@ -24,6 +24,15 @@
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <algorithm>
+#include <assert.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef TARGET_LINUX
+#include <sys/epoll.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -55,6 +64,34 @@ using namespace ANNOUNCEMENT;
 //using namespace std; On VS2010, bind conflicts with std::bind
 
 #define RECEIVEBUFFER 1024
+#define MAXEVENTS     64
+#define MAXSENDBUFFER (1024 * 1024)
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+static bool SetNonBlocking(SOCKET fd)
+{
+#ifdef _WIN32
+  u_long nonblocking = 1;
+  return ioctlsocket(fd, FIONBIO, &nonblocking) == 0;
+#else
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static bool WouldBlock()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -90,6 +127,7 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("CTCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_epoll = -1;
 }
 
 void CTCPServer::Process()
@@ -98,110 +136,229 @@ void CTCPServer::Process()
 
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    std::vector<SOCKET> readable, writable;
+    if (!WaitForEvents(readable, writable))
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for socket events failed");
+      Sleep(1000);
+      Initialize();
+      continue;
+    }
 
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+    for (std::vector<SOCKET>::iterator it = writable.begin(); it != writable.end(); it++)
     {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
+      ConnectionMap::iterator connection = m_connections.find(*it);
+      if (connection != m_connections.end() && !connection->second->Flush())
+        CloseConnection(connection);
     }
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    for (std::vector<SOCKET>::iterator it = readable.begin(); it != readable.end(); it++)
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      if (std::find(m_servers.begin(), m_servers.end(), *it) != m_servers.end())
+      {
+        if (!AcceptConnection(*it))
+          break;
+        continue;
+      }
+
+      ConnectionMap::iterator connection = m_connections.find(*it);
+      if (connection != m_connections.end())
+        ReadConnection(connection);
     }
+  }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+  Deinitialize();
+}
+
+bool CTCPServer::WaitForEvents(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable)
+{
+#ifdef TARGET_LINUX
+  if (m_epoll != -1)
+  {
+    struct epoll_event events[MAXEVENTS];
+    int res = epoll_wait(m_epoll, events, MAXEVENTS, 1000);
     if (res < 0)
+      return errno == EINTR;
+
+    for (int i = 0; i < res; i++)
+    {
+      // errors and hangups are picked up by the next recv()
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        readable.push_back(events[i].data.fd);
+      if (events[i].events & EPOLLOUT)
+        writable.push_back(events[i].data.fd);
+    }
+    return true;
+  }
+#endif
+
+  // only the server thread changes m_connections, so it can walk it unlocked
+  assert(IsCurrentThread());
+
+  SOCKET          max_fd = 0;
+  fd_set          rfds, wfds;
+  struct timeval  to     = {1, 0};
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  {
+    FD_SET(*it, &rfds);
+    if ((intptr_t)*it > (intptr_t)max_fd)
+      max_fd = *it;
+  }
+
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); it++)
+  {
+    FD_SET(it->first, &rfds);
+    if (it->second->HasPendingData())
+      FD_SET(it->first, &wfds);
+    if ((intptr_t)it->first > (intptr_t)max_fd)
+      max_fd = it->first;
+  }
+
+  int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
+  if (res < 0)
+    return false;
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end() && res > 0; it++)
+  {
+    if (FD_ISSET(*it, &rfds))
+      readable.push_back(*it);
+  }
+
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end() && res > 0; it++)
+  {
+    if (FD_ISSET(it->first, &rfds))
+      readable.push_back(it->first);
+    if (FD_ISSET(it->first, &wfds))
+      writable.push_back(it->first);
+  }
+  return true;
+}
+
+void CTCPServer::WatchWritable(CTCPClient *client, bool writable)
+{
+#ifdef TARGET_LINUX
+  if (m_epoll != -1)
+  {
+    struct epoll_event event = {};
+    event.events = EPOLLIN | (writable ? EPOLLOUT : 0);
+    event.data.fd = client->m_socket;
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, client->m_socket, &event);
+  }
+#endif
+  // the select() loop checks for queued output every time round
+}
+
+bool CTCPServer::AcceptConnection(SOCKET server)
+{
+  assert(IsCurrentThread());
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  CTCPClient *newconnection = new CTCPClient();
+  newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    int error = errno;
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", error);
+    delete newconnection;
+    if (EBADF == error)
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
+      return false;
     }
-    else if (res > 0)
+    return true;
+  }
+
+  if (!SetNonBlocking(newconnection->m_socket))
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to make connection non-blocking");
+
+#ifdef TARGET_LINUX
+  if (m_epoll != -1)
+  {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = newconnection->m_socket;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, newconnection->m_socket, &event) < 0)
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
-
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection: %d", errno);
+      newconnection->Disconnect();
+      delete newconnection;
+      return true;
+    }
+  }
+#endif
+
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+  newconnection->m_server = this;
+  CSingleLock lock(m_critSection);
+  m_connections[newconnection->m_socket] = newconnection;
+  return true;
+}
+
+void CTCPServer::ReadConnection(ConnectionMap::iterator connection)
+{
+  assert(IsCurrentThread());
+  CTCPClient *client = connection->second;
+  char buffer[RECEIVEBUFFER] = {};
+  int  nread = 0;
+  nread = recv(client->m_socket, (char*)&buffer, RECEIVEBUFFER, 0);
+  if (nread < 0 && WouldBlock())
+    return;
+
+  bool close = false;
+  if (nread > 0)
+  {
+    std::string response;
+    if (client->IsNew())
+    {
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+      if (response.size() > 0)
+        client->Send(response.c_str(), response.size());
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+      if (websocket != NULL)
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+        // Replace the CTCPClient with a CWebSocketClient
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *client);
+        CSingleLock lock(m_critSection);
+        connection->second = websocketClient;
+        delete client;
+        client = websocketClient;
       }
     }
+
+    if (response.size() <= 0)
+      client->PushBuffer(this, buffer, nread);
+
+    close = client->Closing();
   }
+  else
+    close = true;
 
-  Deinitialize();
+  if (close)
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+    CloseConnection(connection);
+  }
+}
+
+void CTCPServer::CloseConnection(ConnectionMap::iterator connection)
+{
+  assert(IsCurrentThread());
+  CSingleLock lock(m_critSection);
+#ifdef TARGET_LINUX
+  if (m_epoll != -1)
+  {
+    struct epoll_event event = {};
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, connection->first, &event);
+  }
+#endif
+  connection->second->Disconnect();
+  delete connection->second;
+  m_connections.erase(connection);
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -223,15 +380,17 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  // sends never block, so a slow client can't hold up the announcement to the others
+  CSingleLock lock (m_critSection);
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); it++)
   {
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
+      CSingleLock lock (it->second->m_critSection);
+      if ((it->second->GetAnnouncementFlags() & flag) == 0)
         continue;
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    it->second->Send(str.c_str(), str.size());
   }
 }
 
@@ -246,6 +405,9 @@ bool CTCPServer::Initialize()
 
   if(started)
   {
+    if (!InitializeEvents())
+      CLog::Log(LOGWARNING, "JSONRPC Server: Falling back to select()");
+
     CAnnouncementManager::AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
@@ -463,7 +625,7 @@ bool CTCPServer::InitializeTCP()
     return false;
   }
 
-  if (listen(fd, 10) < 0)
+  if (listen(fd, SOMAXCONN) < 0)
   {
     CLog::Log(LOGERROR, "JSONRPC Server: Failed to set listen");
     closesocket(fd);
@@ -473,21 +635,58 @@ bool CTCPServer::InitializeTCP()
   return true;
 }
 
-void CTCPServer::Deinitialize()
+bool CTCPServer::InitializeEvents()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+#ifdef TARGET_LINUX
+  m_epoll = epoll_create(MAXEVENTS);
+  if (m_epoll < 0)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
+    m_epoll = -1;
+    return false;
   }
 
-  m_connections.clear();
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = *it;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, *it, &event) < 0)
+    {
+      close(m_epoll);
+      m_epoll = -1;
+      return false;
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CTCPServer::Deinitialize()
+{
+  {
+    CSingleLock lock (m_critSection);
+    for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); it++)
+    {
+      it->second->Disconnect();
+      delete it->second;
+    }
+
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
 
   m_servers.clear();
 
+#ifdef TARGET_LINUX
+  if (m_epoll != -1)
+    close(m_epoll);
+  m_epoll = -1;
+#endif
+
 #ifdef HAVE_LIBBLUETOOTH
   if(m_sdpd)
     sdp_close( (sdp_session_t*)m_sdpd );
@@ -502,6 +701,7 @@ CTCPServer::CTCPClient::CTCPClient()
   m_new = true;
   m_announcementflags = ANNOUNCE_ALL;
   m_socket = INVALID_SOCKET;
+  m_server = NULL;
   m_beginBrackets = 0;
   m_endBrackets = 0;
   m_beginChar = 0;
@@ -539,12 +739,62 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  // only write straight away if nothing is queued, so the output stays in order
+  if (m_sendBuffer.empty())
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
-  } while (sent < size);
+    int sent = send(m_socket, data, size, SEND_FLAGS);
+    if (sent < 0)
+    {
+      if (!WouldBlock())
+        return;
+      sent = 0;
+    }
+    data += sent;
+    size -= sent;
+  }
+
+  if (size == 0)
+    return;
+
+  // a client that doesn't read its output must not hold up everyone else
+  if (m_sendBuffer.size() + size > MAXSENDBUFFER)
+  {
+    CLog::Log(LOGWARNING, "JSONRPC Server: Dropping connection that stopped reading");
+    m_sendBuffer.clear();
+    shutdown(m_socket, SHUT_RDWR);
+    return;
+  }
+
+  bool watch = m_sendBuffer.empty();
+  m_sendBuffer.append(data, size);
+  if (watch && m_server)
+    m_server->WatchWritable(this, true);
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  if (m_sendBuffer.empty())
+    return true;
+
+  int sent = send(m_socket, m_sendBuffer.c_str(), m_sendBuffer.size(), SEND_FLAGS);
+  if (sent < 0)
+    return WouldBlock();
+
+  m_sendBuffer.erase(0, sent);
+  if (m_sendBuffer.empty() && m_server)
+    m_server->WatchWritable(this, false);
+  return true;
+}
+
+bool CTCPServer::CTCPClient::HasPendingData()
+{
+  CSingleLock lock (m_critSection);
+  return !m_sendBuffer.empty();
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -589,6 +839,7 @@ void CTCPServer::CTCPClient::Disconnect()
   if (m_socket > 0)
   {
     CSingleLock lock (m_critSection);
+    Flush();
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -599,6 +850,7 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
 {
   m_new               = client.m_new;
   m_socket            = client.m_socket;
+  m_server            = client.m_server;
   m_cliaddr           = client.m_cliaddr;
   m_addrlen           = client.m_addrlen;
   m_announcementflags = client.m_announcementflags;
@@ -607,6 +859,7 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_sendBuffer        = client.m_sendBuffer;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
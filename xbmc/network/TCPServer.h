@@ -19,6 +19,7 @@
  *
  */
 
+#include <map>
 #include <vector>
 #include <sys/socket.h>
 
@@ -49,8 +50,23 @@ namespace JSONRPC
     bool Initialize();
     bool InitializeBlue();
     bool InitializeTCP();
+    bool InitializeEvents();
     void Deinitialize();
 
+    class CTCPClient;
+    typedef std::map<SOCKET, CTCPClient*> ConnectionMap;
+
+    /*!
+     \brief Wait for any of the sockets to become readable or, for clients
+     with queued output, writable.
+     \return false if waiting failed and the sockets need to be reinitialized.
+     */
+    bool WaitForEvents(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable);
+    void WatchWritable(CTCPClient *client, bool writable);
+    bool AcceptConnection(SOCKET server);
+    void ReadConnection(ConnectionMap::iterator connection);
+    void CloseConnection(ConnectionMap::iterator connection);
+
     class CTCPClient : public IClient
     {
     public:
@@ -72,10 +88,18 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Send as much of the queued output as the socket takes without blocking.
+       \return false if the connection failed.
+       */
+      bool Flush();
+      bool HasPendingData();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
       CCriticalSection m_critSection;
+      CTCPServer      *m_server;
 
     protected:
       void Copy(const CTCPClient& client);
@@ -85,6 +109,7 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendBuffer;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -107,8 +132,15 @@ namespace JSONRPC
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    /*!
+     Connections are only added and removed by the server thread, which
+     holds m_critSection while doing so and reads the map without it; any
+     other thread (e.g. announcements) must hold m_critSection to read it.
+     */
+    ConnectionMap m_connections;
+    CCriticalSection m_critSection;
     std::vector<SOCKET> m_servers;
+    int m_epoll;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
@@ -21,6 +21,8 @@
 #include "WebServer.h"
 #ifdef HAS_WEB_SERVER
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/HttpRangeUtils.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
@@ -29,11 +31,19 @@
 #include "XBDateTime.h"
 #include "URL.h"
 
+#include <algorithm>
+
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef _WIN32
 #pragma comment(lib, "libmicrohttpd.dll.lib")
 #endif
 
 #define MAX_POST_BUFFER_SIZE 2048
+#define FILE_DOWNLOAD_BLOCK_SIZE (32 * 1024)
 
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
@@ -358,109 +368,203 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
 {
   CFile *file = new CFile();
 
-  if (file->Open(strURL, READ_NO_CACHE))
+  if (!file->Open(strURL, READ_NO_CACHE))
   {
-    bool getData = true;
-    if (methodType != HEAD)
-    {
-      if (methodType == GET)
-      {
-        string ifModifiedSince = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Modified-Since");
-        if (!ifModifiedSince.empty())
-        {
-          CDateTime ifModifiedSinceDate;
-          ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince);
+    delete file;
+    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
+    return SendErrorResponse(connection, MHD_HTTP_NOT_FOUND, GET); /* GET Assumed Temporarily */
+  }
 
-          struct __stat64 statBuffer;
-          if (file->Stat(&statBuffer) == 0)
-          {
-            struct tm *time = localtime((time_t *)&statBuffer.st_mtime);
-            if (time != NULL)
-            {
-              CDateTime lastModified = *time;
-              if (lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
-              {
-                getData = false;
-                response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
-                responseCode = MHD_HTTP_NOT_MODIFIED;
-              }
-            }
-          }
-        }
-      }
+  int64_t fileLength = file->GetLength();
+  uint64_t totalLength = (uint64_t)fileLength;
 
-      if (getData)
-        response = MHD_create_response_from_callback(file->GetLength(),
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, file,
-                                                     &CWebServer::ContentReaderFreeCallback);
-      if (response == NULL)
+  CStdString ext = URIUtils::GetExtension(strURL);
+  ext = ext.ToLower();
+  const char *mime = CreateMimeTypeFromExtension(ext.c_str());
+
+  // the Last-Modified date and the entity tag are both derived from the modification time
+  CDateTime lastModified;
+  string etag;
+  struct __stat64 statBuffer;
+  if (file->Stat(&statBuffer) == 0)
+  {
+    struct tm *time = localtime((time_t *)&statBuffer.st_mtime);
+    if (time != NULL)
+      lastModified = *time;
+    if (fileLength >= 0)
+      etag = CHttpRangeUtils::GenerateETag(totalLength, (int64_t)statBuffer.st_mtime);
+  }
+
+  // If-None-Match takes precedence over If-Modified-Since
+  bool notModified = false;
+  if (methodType == GET || methodType == HEAD)
+  {
+    string ifNoneMatch = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-None-Match");
+    if (!ifNoneMatch.empty())
+      notModified = CHttpRangeUtils::MatchesETag(ifNoneMatch, etag);
+    else
+    {
+      string ifModifiedSince = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Modified-Since");
+      if (!ifModifiedSince.empty() && lastModified.IsValid())
       {
-        file->Close();
-        delete file;
-        return MHD_NO;
+        CDateTime ifModifiedSinceDate;
+        ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince);
+        notModified = lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate;
       }
     }
-    else
-    {
-      getData = false;
+  }
 
-      CStdString contentLength;
-      contentLength.Format("%I64d", file->GetLength());
+  // an invalid Range header is ignored, as is one whose If-Range doesn't match the current file
+  HttpRanges ranges;
+  bool ranged = false;
+  if (!notModified && methodType == GET && fileLength >= 0)
+  {
+    string range = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "Range");
+    string ifRange = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Range");
+    if (!range.empty() &&
+        (ifRange.empty() || ifRange == etag || (lastModified.IsValid() && ifRange == lastModified.GetAsRFC1123DateTime())))
+      ranged = CHttpRangeUtils::ParseRangeHeader(range, totalLength, ranges);
+  }
 
-      response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
-      if (response == NULL)
-      {
-        file->Close();
-        delete file;
-        return MHD_NO;
-      }
+  HttpFileDownloadContext *context = NULL;
+  string boundary;
+  if (notModified)
+  {
+    response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+    responseCode = MHD_HTTP_NOT_MODIFIED;
+  }
+  else if (ranged && ranges.empty())
+  {
+    response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+    responseCode = MHD_HTTP_REQUESTED_RANGE_NOT_SATISFIABLE;
+    if (response)
+      MHD_add_response_header(response, "Content-Range", CHttpRangeUtils::GetUnsatisfiableContentRange(totalLength).c_str());
+  }
+  else if (methodType == HEAD)
+  {
+    CStdString contentLength;
+    contentLength.Format("%"PRId64, fileLength);
+
+    response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+    if (response)
       MHD_add_response_header(response, "Content-Length", contentLength);
+  }
+  else
+  {
+    if (!ranged && totalLength > 0)
+    {
+      HttpRange whole = { 0, totalLength - 1 };
+      ranges.push_back(whole);
     }
+    else if (ranged)
+      responseCode = MHD_HTTP_PARTIAL_CONTENT;
 
-    // set the Content-Type header
-    CStdString ext = URIUtils::GetExtension(strURL);
-    ext = ext.ToLower();
-    const char *mime = CreateMimeTypeFromExtension(ext.c_str());
-    if (mime)
-      MHD_add_response_header(response, "Content-Type", mime);
+    if (ranges.size() == 1)
+      response = CreateLocalFileResponse(strURL, ranges[0].first, ranges[0].GetLength());
 
-    // set the Last-Modified header
-    struct __stat64 statBuffer;
-    if (file->Stat(&statBuffer) == 0)
+    if (response == NULL)
     {
-      struct tm *time = localtime((time_t *)&statBuffer.st_mtime);
-      if (time != NULL)
+      if (ranges.size() > 1)
+        boundary = CHttpRangeUtils::GenerateMultipartBoundary();
+
+      // lay the parts out one after the other, libmicrohttpd reads them back through ContentReaderCallback
+      context = new HttpFileDownloadContext;
+      context->file = file;
+      context->length = 0;
+      context->part = 0;
+      for (HttpRanges::const_iterator range = ranges.begin(); range != ranges.end(); ++range)
       {
-        CDateTime lastModified = *time;
-        MHD_add_response_header(response, "Last-Modified", lastModified.GetAsRFC1123DateTime());
+        HttpFileDownloadPart part;
+        if (!boundary.empty())
+          part.header = CHttpRangeUtils::GetMultipartHeader(boundary, mime ? mime : "", *range, totalLength);
+        part.offset = context->length;
+        part.position = range->first;
+        part.length = range->GetLength();
+        context->length += part.header.size() + part.length;
+        context->parts.push_back(part);
+      }
+      if (!boundary.empty())
+      {
+        context->footer = CHttpRangeUtils::GetMultipartEnd(boundary);
+        context->length += context->footer.size();
       }
-    }
-
-    // set the Expires header
-    CDateTime expiryTime = CDateTime::GetCurrentDateTime();
-    if (mime && strncmp(mime, "text/html", 9) == 0)
-      expiryTime += CDateTimeSpan(1, 0, 0, 0);
-    else
-      expiryTime += CDateTimeSpan(365, 0, 0, 0);
-    MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
 
-    // only close the CFile instance if libmicrohttpd doesn't have to grab the data of the file
-    if (!getData)
-    {
-      file->Close();
-      delete file;
+      response = MHD_create_response_from_callback(context->length,
+                                                   FILE_DOWNLOAD_BLOCK_SIZE,
+                                                   &CWebServer::ContentReaderCallback, context,
+                                                   &CWebServer::ContentReaderFreeCallback);
+      if (response == NULL)
+      {
+        delete context;
+        context = NULL;
+      }
     }
+
+    if (response && ranged && ranges.size() == 1)
+      MHD_add_response_header(response, "Content-Range", CHttpRangeUtils::GetContentRange(ranges[0], totalLength).c_str());
   }
-  else
+
+  // the context owns the CFile instance once libmicrohttpd has to grab the data of the file
+  if (context == NULL)
   {
+    file->Close();
     delete file;
-    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
-    return SendErrorResponse(connection, MHD_HTTP_NOT_FOUND, GET); /* GET Assumed Temporarily */
   }
+
+  if (response == NULL)
+    return MHD_NO;
+
+  // set the Content-Type header
+  if (!boundary.empty())
+    MHD_add_response_header(response, "Content-Type", ("multipart/byteranges; boundary=" + boundary).c_str());
+  else if (mime)
+    MHD_add_response_header(response, "Content-Type", mime);
+
+  // set the Last-Modified and ETag headers
+  if (lastModified.IsValid())
+    MHD_add_response_header(response, "Last-Modified", lastModified.GetAsRFC1123DateTime());
+  if (!etag.empty())
+  {
+    MHD_add_response_header(response, "ETag", etag.c_str());
+    MHD_add_response_header(response, "Accept-Ranges", "bytes");
+  }
+
+  // set the Expires header
+  CDateTime expiryTime = CDateTime::GetCurrentDateTime();
+  if (mime && strncmp(mime, "text/html", 9) == 0)
+    expiryTime += CDateTimeSpan(1, 0, 0, 0);
+  else
+    expiryTime += CDateTimeSpan(365, 0, 0, 0);
+  MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+
   return MHD_YES;
 }
 
+struct MHD_Response* CWebServer::CreateLocalFileResponse(const string &strURL, uint64_t position, uint64_t length)
+{
+#if (MHD_VERSION >= 0x00091600) && defined(TARGET_POSIX)
+  // hand plain local files to libmicrohttpd as a file descriptor, so it can
+  // send them with sendfile() instead of copying them through a CFile
+  CStdString path = CSpecialProtocol::TranslatePath(strURL);
+  if (!CURL(path).GetProtocol().IsEmpty())
+    return NULL;
+  if ((uint64_t)(size_t)length != length || (uint64_t)(off_t)position != position)
+    return NULL;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  // libmicrohttpd closes the descriptor when the response is destroyed
+  struct MHD_Response *response = MHD_create_response_from_fd_at_offset((size_t)length, fd, (off_t)position);
+  if (response == NULL)
+    close(fd);
+  return response;
+#else
+  return NULL;
+#endif
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response)
 {
   size_t payloadSize = 0;
@@ -522,21 +626,68 @@ int CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, int ma
 int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 #endif
 {
-  CFile *file = (CFile *)cls;
-  if((unsigned int)pos != file->GetPosition())
-    file->Seek(pos);
-  unsigned res = file->Read(buf, max);
-  if(res == 0)
+  HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  if (context == NULL || context->file == NULL)
     return -1;
-  return res;
+
+  size_t written = 0;
+  while (written < (size_t)max)
+  {
+    uint64_t position = pos + written;
+    if (position >= context->length)
+      break;
+
+    // responses are read front to back, so this is almost always the part the last read ended in
+    if (context->part >= context->parts.size() || position < context->parts[context->part].offset)
+      context->part = 0;
+    while (context->part < context->parts.size() &&
+           position >= context->parts[context->part].offset + context->parts[context->part].header.size() + context->parts[context->part].length)
+      context->part++;
+
+    size_t size = (size_t)max - written;
+    if (context->part < context->parts.size())
+    {
+      const HttpFileDownloadPart &part = context->parts[context->part];
+      uint64_t offset = position - part.offset;
+      if (offset < part.header.size())
+      {
+        size = std::min(size, part.header.size() - (size_t)offset);
+        memcpy(buf + written, part.header.c_str() + offset, size);
+      }
+      else
+      {
+        offset -= part.header.size();
+        if (part.position + offset != (uint64_t)context->file->GetPosition() &&
+            context->file->Seek(part.position + offset) < 0)
+          break;
+
+        size = (size_t)std::min((uint64_t)size, part.length - offset);
+        size = context->file->Read(buf + written, size);
+        if (size == 0)
+          break;
+      }
+    }
+    else
+    {
+      uint64_t offset = position - (context->length - context->footer.size());
+      size = std::min(size, context->footer.size() - (size_t)offset);
+      memcpy(buf + written, context->footer.c_str() + offset, size);
+    }
+    written += size;
+  }
+
+  if (written == 0)
+    return -1;
+  return written;
 }
 
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
-  CFile *file = (CFile *)cls;
-  file->Close();
+  HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  context->file->Close();
 
-  delete file;
+  delete context->file;
+  delete context;
 }
 
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
@@ -33,6 +33,11 @@
 #include "threads/CriticalSection.h"
 #include "httprequesthandler/IHTTPRequestHandler.h"
 
+namespace XFILE
+{
+  class CFile;
+}
+
 class CWebServer : public JSONRPC::ITransportLayer
 {
 public:
@@ -92,6 +97,7 @@ private:
   static void ContentReaderFreeCallback (void *cls);
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
   static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode);
+  static struct MHD_Response* CreateLocalFileResponse(const std::string &strURL, uint64_t position, uint64_t length);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -114,5 +120,22 @@ private:
     IHTTPRequestHandler *requestHandler;
     struct MHD_PostProcessor *postprocessor;
   } ConnectionHandler;
+
+  typedef struct HttpFileDownloadPart
+  {
+    std::string header;   ///< multipart delimiter and headers sent ahead of the data
+    uint64_t offset;      ///< position of the part in the response
+    uint64_t position;    ///< position of the data in the file
+    uint64_t length;      ///< length of the data
+  } HttpFileDownloadPart;
+
+  typedef struct HttpFileDownloadContext
+  {
+    XFILE::CFile *file;
+    std::vector<HttpFileDownloadPart> parts;
+    std::string footer;   ///< closing delimiter of a multipart response
+    uint64_t length;      ///< length of the whole response
+    size_t part;          ///< the part the last read ended in
+  } HttpFileDownloadContext;
 };
 #endif
@@ -22,6 +22,7 @@
 #include "network/WebServer.h"
 #include "URL.h"
 #include "filesystem/ImageFile.h"
+#include "TextureCache.h"
 
 using namespace std;
 
@@ -39,6 +40,12 @@ int CHTTPImageHandler::HandleHTTPRequest(const HTTPRequest &request)
     XFILE::CImageFile imageFile;
     if (imageFile.Exists(m_path))
     {
+      // serve the cached thumbnail directly, so the webserver can send it straight from disk
+      bool needsRecaching = false;
+      CStdString cachedPath = CTextureCache::Get().CheckCachedImage(m_path, false, needsRecaching);
+      if (!cachedPath.empty())
+        m_path = cachedPath;
+
       m_responseCode = MHD_HTTP_OK;
       m_responseType = HTTPFileDownload;
     }
@@ -0,0 +1,229 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#ifdef TARGET_POSIX
+#include "network/TCPServer.h"
+#include "interfaces/AnnouncementManager.h"
+#include "threads/SystemClock.h"
+#include "utils/Variant.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define TEST_TCPSERVER_PORT 34568
+
+static const unsigned int TestTCPServerClients = 250;
+
+static int TestTCPServerConnect(int receiveBuffer = 0)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0)
+    return -1;
+
+  if (receiveBuffer > 0)
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(TEST_TCPSERVER_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+  {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+/* reads from all clients until each of them has received the marker,
+   and returns how long after start each one got it or -1 if it timed out */
+static std::vector<int> TestTCPServerWaitFor(const std::vector<int> &clients, const std::string &marker, unsigned int start, unsigned int timeout)
+{
+  std::vector<int> latency(clients.size(), -1);
+  std::vector<std::string> received(clients.size());
+  unsigned int pending = clients.size();
+
+  while (pending > 0 && XbmcThreads::SystemClockMillis() - start < timeout)
+  {
+    std::vector<struct pollfd> fds;
+    std::vector<unsigned int> index;
+    for (unsigned int i = 0; i < clients.size(); ++i)
+    {
+      if (latency[i] >= 0)
+        continue;
+      struct pollfd fd = { clients[i], POLLIN, 0 };
+      fds.push_back(fd);
+      index.push_back(i);
+    }
+
+    if (poll(&fds[0], fds.size(), 100) <= 0)
+      continue;
+
+    for (unsigned int i = 0; i < fds.size(); ++i)
+    {
+      if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+        continue;
+
+      char buf[16 * 1024];
+      ssize_t read = recv(fds[i].fd, buf, sizeof(buf), 0);
+      if (read <= 0)
+        continue;
+
+      // only keep enough of the output to find a marker split across reads
+      std::string &data = received[index[i]];
+      data.append(buf, read);
+      if (data.find(marker) != std::string::npos)
+      {
+        latency[index[i]] = XbmcThreads::SystemClockMillis() - start;
+        pending--;
+      }
+      else if (data.size() > marker.size())
+        data.erase(0, data.size() - marker.size());
+    }
+  }
+  return latency;
+}
+
+/* makes sure the server has accepted every client by having each one send an invalid request */
+static bool TestTCPServerHandshake(const std::vector<int> &clients)
+{
+  for (unsigned int i = 0; i < clients.size(); ++i)
+  {
+    if (send(clients[i], "{x}", 3, 0) != 3)
+      return false;
+  }
+
+  std::vector<int> latency = TestTCPServerWaitFor(clients, "-32700", XbmcThreads::SystemClockMillis(), 10000);
+  return std::find(latency.begin(), latency.end(), -1) == latency.end();
+}
+
+/* reads and throws away everything until the server closes the connection */
+static bool TestTCPServerWaitForClose(int client, unsigned int timeout)
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  while (XbmcThreads::SystemClockMillis() - start < timeout)
+  {
+    struct pollfd fd = { client, POLLIN, 0 };
+    if (poll(&fd, 1, 100) <= 0)
+      continue;
+
+    char buf[16 * 1024];
+    if (recv(client, buf, sizeof(buf), 0) <= 0)
+      return true;
+  }
+  return false;
+}
+
+static void TestTCPServerDisconnect(std::vector<int> &clients)
+{
+  for (unsigned int i = 0; i < clients.size(); ++i)
+    close(clients[i]);
+  clients.clear();
+}
+
+class TestTCPServer : public testing::Test
+{
+protected:
+  TestTCPServer()
+  {
+    m_started = JSONRPC::CTCPServer::StartServer(TEST_TCPSERVER_PORT, false);
+  }
+
+  ~TestTCPServer()
+  {
+    JSONRPC::CTCPServer::StopServer(true);
+  }
+
+  bool m_started;
+};
+
+TEST_F(TestTCPServer, FanOut)
+{
+  ASSERT_TRUE(m_started);
+
+  std::vector<int> clients;
+  for (unsigned int i = 0; i < TestTCPServerClients; ++i)
+  {
+    int client = TestTCPServerConnect();
+    ASSERT_NE(-1, client);
+    clients.push_back(client);
+  }
+  ASSERT_TRUE(TestTCPServerHandshake(clients));
+
+  CVariant data;
+  data["test"] = "fanout";
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::System, "xbmc", "OnTestFanOut", data);
+  std::vector<int> latency = TestTCPServerWaitFor(clients, "OnTestFanOut", start, 10000);
+
+  EXPECT_TRUE(std::find(latency.begin(), latency.end(), -1) == latency.end());
+  std::sort(latency.begin(), latency.end());
+  std::cout << TestTCPServerClients << " clients: notification latency " <<
+    latency[latency.size() / 2] << " ms median, " << latency.back() << " ms max" << std::endl;
+
+  TestTCPServerDisconnect(clients);
+}
+
+TEST_F(TestTCPServer, SlowClient)
+{
+  ASSERT_TRUE(m_started);
+
+  // a client with a tiny receive buffer that stops reading after the handshake
+  std::vector<int> slow(1, TestTCPServerConnect(4096));
+  ASSERT_NE(-1, slow[0]);
+  ASSERT_TRUE(TestTCPServerHandshake(slow));
+
+  std::vector<int> clients;
+  for (unsigned int i = 0; i < 20; ++i)
+  {
+    int client = TestTCPServerConnect();
+    ASSERT_NE(-1, client);
+    clients.push_back(client);
+  }
+  ASSERT_TRUE(TestTCPServerHandshake(clients));
+
+  // far more than the slow client's socket and send buffer take, announcing must not block on it
+  CVariant data;
+  data["payload"] = std::string(64 * 1024, 'x');
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < 64; ++i)
+    ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::System, "xbmc", "OnTestPayload", data);
+  ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::System, "xbmc", "OnTestFanOut");
+
+  // everyone else got everything, and the slow client has been dropped
+  std::vector<int> latency = TestTCPServerWaitFor(clients, "OnTestFanOut", start, 10000);
+  EXPECT_TRUE(std::find(latency.begin(), latency.end(), -1) == latency.end());
+  EXPECT_TRUE(TestTCPServerWaitForClose(slow[0], 10000));
+
+  TestTCPServerDisconnect(clients);
+  TestTCPServerDisconnect(slow);
+}
+#endif
@@ -0,0 +1,290 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_WEB_SERVER) && defined(TARGET_POSIX)
+#include "network/WebServer.h"
+#include "network/httprequesthandler/IHTTPRequestHandler.h"
+#include "filesystem/File.h"
+#include "threads/Thread.h"
+#include "utils/HttpHeader.h"
+#include "utils/HttpRangeUtils.h"
+#include "utils/StringUtils.h"
+#include "test/TestUtils.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#define TEST_WEBSERVER_PORT 34567
+#define TEST_WEBSERVER_URL  "/testwebserver"
+
+static const unsigned int TestWebServerFileSize = 256 * 1024 + 17;
+static std::string TestWebServerFile;
+
+/* serves the test file the same way CHTTPVfsHandler serves a source */
+class TestWebServerHandler : public IHTTPRequestHandler
+{
+public:
+  virtual IHTTPRequestHandler* GetInstance() { return new TestWebServerHandler(); }
+  virtual bool CheckHTTPRequest(const HTTPRequest &request) { return request.url == TEST_WEBSERVER_URL; }
+  virtual int HandleHTTPRequest(const HTTPRequest &request)
+  {
+    m_responseCode = MHD_HTTP_OK;
+    m_responseType = HTTPFileDownload;
+    return MHD_YES;
+  }
+  virtual std::string GetHTTPResponseFile() const { return TestWebServerFile; }
+  virtual int GetPriority() const { return 100; }
+};
+
+typedef struct TestWebServerResponse
+{
+  int status;
+  CHttpHeader header;
+  std::string body;
+} TestWebServerResponse;
+
+/* a minimal HTTP/1.1 client, so the test sees exactly what the server sends */
+static bool TestWebServerRequest(const std::string &method, const std::string &headers, TestWebServerResponse &response)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0)
+    return false;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(TEST_WEBSERVER_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+  {
+    close(sock);
+    return false;
+  }
+
+  std::string request = method + " " TEST_WEBSERVER_URL " HTTP/1.1\r\n"
+                        "Host: localhost\r\n"
+                        "Connection: close\r\n" + headers + "\r\n";
+  if (send(sock, request.c_str(), request.size(), 0) != (ssize_t)request.size())
+  {
+    close(sock);
+    return false;
+  }
+
+  std::string data;
+  char buf[16 * 1024];
+  ssize_t read;
+  while ((read = recv(sock, buf, sizeof(buf), 0)) > 0)
+    data.append(buf, read);
+  close(sock);
+
+  size_t end = data.find("\r\n\r\n");
+  size_t line = data.find("\r\n");
+  if (end == std::string::npos || data.compare(0, 9, "HTTP/1.1 ") != 0)
+    return false;
+
+  response.status = atoi(data.c_str() + 9);
+  response.header.Clear();
+  response.header.Parse(data.substr(line + 2, end + 2 - line - 2));
+  response.body = data.substr(end + 4);
+  return true;
+}
+
+class TestWebServer : public testing::Test
+{
+protected:
+  TestWebServer()
+  {
+    srand(1);
+    m_data.resize(TestWebServerFileSize);
+    for (unsigned int i = 0; i < m_data.size(); ++i)
+      m_data[i] = rand() & 0xFF;
+
+    m_file = XBMC_CREATETEMPFILE("");
+    if (m_file)
+    {
+      m_file->Close();
+      TestWebServerFile = XBMC_TEMPFILEPATH(m_file);
+      if (m_file->OpenForWrite(TestWebServerFile, true))
+      {
+        m_file->Write(m_data.c_str(), m_data.size());
+        m_file->Close();
+      }
+    }
+
+    CWebServer::RegisterRequestHandler(&m_handler);
+    m_webserver.Start(TEST_WEBSERVER_PORT, "", "");
+  }
+
+  ~TestWebServer()
+  {
+    m_webserver.Stop();
+    CWebServer::UnregisterRequestHandler(&m_handler);
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  CWebServer m_webserver;
+  TestWebServerHandler m_handler;
+  XFILE::CFile *m_file;
+  std::string m_data;
+};
+
+/* issues random range requests and checks every byte it gets back */
+class TestWebServerClient : public CThread
+{
+public:
+  TestWebServerClient(const std::string &data, unsigned int seed)
+    : CThread("TestWebServerClient"), m_data(data), m_seed(seed), m_failures(0) {}
+
+  unsigned int GetFailures() const { return m_failures; }
+
+protected:
+  virtual void Process()
+  {
+    for (unsigned int i = 0; i < 50 && !m_bStop; ++i)
+    {
+      HttpRange range;
+      range.first = rand_r(&m_seed) % m_data.size();
+      range.last = std::min((uint64_t)m_data.size() - 1, range.first + rand_r(&m_seed) % (64 * 1024));
+
+      TestWebServerResponse response;
+      std::string header = StringUtils::Format("Range: bytes=%"PRIu64"-%"PRIu64"\r\n", range.first, range.last);
+      if (!TestWebServerRequest("GET", header, response) ||
+          response.status != MHD_HTTP_PARTIAL_CONTENT ||
+          response.header.GetValue("Content-Range") != CHttpRangeUtils::GetContentRange(range, m_data.size()) ||
+          response.body != m_data.substr(range.first, range.GetLength()))
+        m_failures++;
+    }
+  }
+
+  const std::string &m_data;
+  unsigned int m_seed;
+  unsigned int m_failures;
+};
+
+TEST_F(TestWebServer, Download)
+{
+  TestWebServerResponse response;
+  ASSERT_TRUE(TestWebServerRequest("GET", "", response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+  EXPECT_STREQ("bytes", response.header.GetValue("Accept-Ranges").c_str());
+  EXPECT_FALSE(response.header.GetValue("ETag").empty());
+  EXPECT_TRUE(response.body == m_data);
+
+  ASSERT_TRUE(TestWebServerRequest("HEAD", "", response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+  EXPECT_EQ(TestWebServerFileSize, (unsigned int)atoi(response.header.GetValue("Content-Length").c_str()));
+  EXPECT_TRUE(response.body.empty());
+}
+
+TEST_F(TestWebServer, Range)
+{
+  TestWebServerResponse response;
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: bytes=100-1099\r\n", response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+  EXPECT_STREQ(StringUtils::Format("bytes 100-1099/%u", TestWebServerFileSize).c_str(), response.header.GetValue("Content-Range").c_str());
+  EXPECT_TRUE(response.body == m_data.substr(100, 1000));
+
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: bytes=-500\r\n", response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+  EXPECT_TRUE(response.body == m_data.substr(TestWebServerFileSize - 500));
+
+  // an unsatisfiable range only reports the length of the file
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: bytes=999999999-\r\n", response));
+  EXPECT_EQ(MHD_HTTP_REQUESTED_RANGE_NOT_SATISFIABLE, response.status);
+  EXPECT_STREQ(StringUtils::Format("bytes */%u", TestWebServerFileSize).c_str(), response.header.GetValue("Content-Range").c_str());
+
+  // and an invalid one is ignored
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: lines=1-2\r\n", response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+  EXPECT_TRUE(response.body == m_data);
+}
+
+TEST_F(TestWebServer, MultipleRanges)
+{
+  TestWebServerResponse response;
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: bytes=0-9,5000-5999,-100\r\n", response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+
+  std::string contentType = response.header.GetValue("Content-Type");
+  ASSERT_EQ(0U, contentType.find("multipart/byteranges; boundary="));
+  std::string boundary = contentType.substr(31);
+
+  HttpRange ranges[] = { { 0, 9 }, { 5000, 5999 }, { TestWebServerFileSize - 100, TestWebServerFileSize - 1 } };
+  std::string expected;
+  for (unsigned int i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i)
+    expected += CHttpRangeUtils::GetMultipartHeader(boundary, "", ranges[i], TestWebServerFileSize) +
+                m_data.substr(ranges[i].first, ranges[i].GetLength());
+  expected += CHttpRangeUtils::GetMultipartEnd(boundary);
+  EXPECT_TRUE(response.body == expected);
+}
+
+TEST_F(TestWebServer, ETag)
+{
+  TestWebServerResponse response;
+  ASSERT_TRUE(TestWebServerRequest("HEAD", "", response));
+  std::string etag = response.header.GetValue("ETag");
+  ASSERT_FALSE(etag.empty());
+
+  ASSERT_TRUE(TestWebServerRequest("GET", "If-None-Match: " + etag + "\r\n", response));
+  EXPECT_EQ(MHD_HTTP_NOT_MODIFIED, response.status);
+  EXPECT_TRUE(response.body.empty());
+
+  ASSERT_TRUE(TestWebServerRequest("GET", "If-None-Match: \"other\"\r\n", response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+
+  // a stale If-Range turns the range request into a full download
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: bytes=0-99\r\nIf-Range: \"other\"\r\n", response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+  EXPECT_TRUE(response.body == m_data);
+
+  ASSERT_TRUE(TestWebServerRequest("GET", "Range: bytes=0-99\r\nIf-Range: " + etag + "\r\n", response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+  EXPECT_TRUE(response.body == m_data.substr(0, 100));
+}
+
+TEST_F(TestWebServer, ConcurrentRanges)
+{
+  static const unsigned int clients = 8;
+  TestWebServerClient *client[clients];
+  for (unsigned int i = 0; i < clients; ++i)
+  {
+    client[i] = new TestWebServerClient(m_data, i + 1);
+    client[i]->Create();
+  }
+
+  for (unsigned int i = 0; i < clients; ++i)
+    EXPECT_TRUE(client[i]->WaitForThreadExit(60000)) << "client " << i;
+
+  for (unsigned int i = 0; i < clients; ++i)
+  {
+    EXPECT_EQ(0U, client[i]->GetFailures()) << "client " << i;
+    delete client[i];
+  }
+}
+#endif
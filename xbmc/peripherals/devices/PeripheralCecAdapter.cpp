@@ -24,6 +24,7 @@
 #include "input/XBIRRemote.h"
 #include "Application.h"
 #include "ApplicationMessenger.h"
+#include "GUIInfoManager.h"
 #include "DynamicDll.h"
 #include "threads/SingleLock.h"
 #include "dialogs/GUIDialogKaiToast.h"
@@ -1542,6 +1543,7 @@ CStdString CPeripheralCecAdapterUpdateThread::UpdateAudioSystemStatus(void)
     m_adapter->SetAudioSystemConnected(true);
     g_settings.m_bMute = false;
     g_settings.m_fVolumeLevel = VOLUME_MAXIMUM;
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_PLAYER);
   }
   else
   {
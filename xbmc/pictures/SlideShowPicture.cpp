@@ -27,6 +27,9 @@
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
 #include "threads/SingleLock.h"
+#if defined(HAS_GL)
+#include "guilib/GUITextureBatchGL.h"
+#endif
 #ifndef _USE_MATH_DEFINES
 #define _USE_MATH_DEFINES
 #endif
@@ -775,6 +778,7 @@ void CSlideShowPic::Render(float *x, float *y, CBaseTexture* pTexture, color_t c
     g_Windowing.Get3DDevice()->DrawPrimitiveUP( D3DPT_LINESTRIP, 4, vertex, sizeof(VERTEX) );
 
 #elif defined(HAS_GL)
+  CGUITextureBatchGL::Get().Flush();
   g_graphicsContext.BeginPaint();
   if (pTexture)
   {
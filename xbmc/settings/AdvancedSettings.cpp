@@ -106,6 +106,10 @@ void CAdvancedSettings::Initialize()
   m_videoAllowMpeg4VAAPI = false;  
   m_videoDisableBackgroundDeinterlace = false;
   m_videoCaptureUseOcclusionQuery = -1; //-1 is auto detect
+  m_videoExtractThumbJobs = 0; //0 is one per spare core, up to 4
+  m_videoProbeCache = true;
+  m_videoDecodeThreads = 0; //0 is one per core, up to 8
+  m_videoFrameThreading = false;
   m_DXVACheckCompatibility = false;
   m_DXVACheckCompatibilityPresent = false;
   m_DXVAForceProcessorRenderer = true;
@@ -185,6 +189,7 @@ void CAdvancedSettings::Initialize()
 
   m_fanartRes = 1080;
   m_imageRes = 720;
+  m_largeTextureMemory = 64;
   m_useDDSFanart = false;
 
   m_sambaclienttimeout = 10;
@@ -289,6 +294,8 @@ void CAdvancedSettings::Initialize()
 #endif
 
   m_bgInfoLoaderMaxThreads = 5;
+  m_jobWorkStealing = false;
+  m_jobMaxWorkers = 5;
 
   m_iPVRTimeCorrection             = 0;
   m_iPVRInfoToggleInterval         = 3000;
@@ -303,6 +310,8 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_cacheSegmented = false;
+  m_cacheReadAheadTime = 30;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
@@ -324,6 +333,8 @@ void CAdvancedSettings::Initialize()
 
   m_databaseMusic.Reset();
   m_databaseVideo.Reset();
+  m_databaseWAL = false;
+  m_databasePoolSize = 4;
 
   m_logLevelHint = m_logLevel = LOG_LEVEL_NORMAL;
 }
@@ -505,6 +516,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement,"allowmpeg4vaapi",m_videoAllowMpeg4VAAPI);    
     XMLUtils::GetBoolean(pElement, "disablebackgrounddeinterlace", m_videoDisableBackgroundDeinterlace);
     XMLUtils::GetInt(pElement, "useocclusionquery", m_videoCaptureUseOcclusionQuery, -1, 1);
+    XMLUtils::GetInt(pElement, "extractthumbjobs", m_videoExtractThumbJobs, 0, 16);
+    XMLUtils::GetBoolean(pElement, "probecache", m_videoProbeCache);
+    XMLUtils::GetInt(pElement, "decodethreads", m_videoDecodeThreads, 0, 16);
+    XMLUtils::GetBoolean(pElement, "framethreading", m_videoFrameThreading);
 
     TiXmlElement* pAdjustRefreshrate = pElement->FirstChildElement("adjustrefreshrate");
     if (pAdjustRefreshrate)
@@ -700,6 +715,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetBoolean(pElement, "segmentedcache", m_cacheSegmented);
+    XMLUtils::GetUInt(pElement, "readaheadtime", m_cacheReadAheadTime, 0, 3600);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -956,6 +973,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetUInt(pRootElement, "fanartres", m_fanartRes, 0, 1080);
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 1080);
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
+  XMLUtils::GetUInt(pRootElement, "largetexturememory", m_largeTextureMemory, 0, 4096);
 
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
@@ -1008,6 +1026,13 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetInt(pRootElement, "bginfoloadermaxthreads", m_bgInfoLoaderMaxThreads);
   m_bgInfoLoaderMaxThreads = std::max(1, m_bgInfoLoaderMaxThreads);
 
+  pElement = pRootElement->FirstChildElement("jobmanager");
+  if (pElement)
+  {
+    XMLUtils::GetBoolean(pElement, "workstealing", m_jobWorkStealing);
+    XMLUtils::GetUInt(pElement, "maxworkers", m_jobMaxWorkers, 1, 64);
+  }
+
   TiXmlElement *pPVR = pRootElement->FirstChildElement("pvr");
   if (pPVR)
   {
@@ -1036,6 +1061,13 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetString(pDatabase, "name", m_databaseVideo.name);
   }
 
+  pDatabase = pRootElement->FirstChildElement("sqlite");
+  if (pDatabase)
+  {
+    XMLUtils::GetBoolean(pDatabase, "wal", m_databaseWAL);
+    XMLUtils::GetUInt(pDatabase, "poolsize", m_databasePoolSize, 0, 16);
+  }
+
   pDatabase = pRootElement->FirstChildElement("musicdatabase");
   if (pDatabase)
   {
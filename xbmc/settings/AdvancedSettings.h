@@ -159,6 +159,10 @@ class CAdvancedSettings
     float m_videoDefaultLatency;
     bool m_videoDisableBackgroundDeinterlace;
     int  m_videoCaptureUseOcclusionQuery;
+    int  m_videoExtractThumbJobs;
+    bool m_videoProbeCache;
+    int  m_videoDecodeThreads;
+    bool m_videoFrameThreading;
     bool m_DXVACheckCompatibility;
     bool m_DXVACheckCompatibilityPresent;
     bool m_DXVAForceProcessorRenderer;
@@ -226,6 +230,7 @@ class CAdvancedSettings
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    unsigned int m_largeTextureMemory; ///< \brief memory in MB that large textures no longer displayed may be kept loaded in
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -333,6 +338,8 @@ class CAdvancedSettings
     CStdString m_cpuTempCmd;
     CStdString m_gpuTempCmd;
     int m_bgInfoLoaderMaxThreads;
+    bool m_jobWorkStealing;       ///< use the work stealing job scheduler
+    unsigned int m_jobMaxWorkers; ///< maximum number of job worker threads
 
     /* PVR/TV related advanced settings */
     int m_iPVRTimeCorrection;     /*!< @brief correct all times (epg tags, timer tags, recording tags) by this amount of minutes. defaults to 0. */
@@ -352,6 +359,8 @@ class CAdvancedSettings
     DatabaseSettings m_databaseVideo; // advanced video database setup
     DatabaseSettings m_databaseTV;    // advanced tv database setup
     DatabaseSettings m_databaseEpg;   /*!< advanced EPG database setup */
+    bool m_databaseWAL;               ///< use write-ahead logging for sqlite databases in local folders (opt-in)
+    unsigned int m_databasePoolSize;  ///< idle sqlite connections kept open per database
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
@@ -359,6 +368,8 @@ class CAdvancedSettings
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    bool m_cacheSegmented; ///< keep seeked to ranges cached (CSegmentedCache) rather than a single window
+    unsigned int m_cacheReadAheadTime; ///< seconds of media to keep cached ahead of the player, 0 fills the whole cache
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
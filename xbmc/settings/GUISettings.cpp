@@ -28,6 +28,7 @@
 #include "LinuxTimezone.h"
 #endif
 #include "Application.h"
+#include "GUIInfoManager.h"
 #include "AdvancedSettings.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/StringUtils.h"
@@ -1076,9 +1077,12 @@ void CGUISettings::SetBool(const char *strSetting, bool bSetting)
   mapIter it = settingsMap.find(strSetting);
   if (it != settingsMap.end())
   { // old category
+    bool changed = ((CSettingBool*)(*it).second)->GetData() != bSetting;
     ((CSettingBool*)(*it).second)->SetData(bSetting);
 
     SetChanged();
+    if (changed)
+      g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
 
     return ;
   }
@@ -1095,6 +1099,7 @@ void CGUISettings::ToggleBool(const char *strSetting)
     ((CSettingBool*)(*it).second)->SetData(!((CSettingBool *)(*it).second)->GetData());
 
     SetChanged();
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
 
     return ;
   }
@@ -1204,9 +1209,12 @@ void CGUISettings::SetInt(const char *strSetting, int iSetting)
   mapIter it = settingsMap.find(strSetting);
   if (it != settingsMap.end())
   {
+    bool changed = ((CSettingInt *)(*it).second)->GetData() != iSetting;
     ((CSettingInt *)(*it).second)->SetData(iSetting);
 
     SetChanged();
+    if (changed)
+      g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
 
     return ;
   }
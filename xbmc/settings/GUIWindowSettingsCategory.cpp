@@ -1024,6 +1024,7 @@ void CGUIWindowSettingsCategory::UpdateSettings()
 void CGUIWindowSettingsCategory::OnClick(BaseSettingControlPtr pSettingControl)
 {
   CStdString strSetting = pSettingControl->GetSetting()->GetSetting();
+  CStdString oldValue = pSettingControl->GetSetting()->ToString();
   if (strSetting.Equals("weather.addonsettings"))
   {
     CStdString name = g_guiSettings.GetString("weather.addon");
@@ -1067,7 +1068,11 @@ void CGUIWindowSettingsCategory::OnClick(BaseSettingControlPtr pSettingControl)
 
   // if OnClick() returns false, the setting hasn't changed or doesn't
   // require immediate update
-  if (!pSettingControl->OnClick())
+  bool changed = pSettingControl->OnClick();
+  // skin conditions on settings only need another look if the value did change
+  if (pSettingControl->GetSetting()->ToString() != oldValue)
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
+  if (!changed)
   {
     UpdateSettings();
     if (!pSettingControl->IsDelayed())
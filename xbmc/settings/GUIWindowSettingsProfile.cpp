@@ -22,6 +22,7 @@
 #include "windows/GUIWindowFileManager.h"
 #include "Profile.h"
 #include "Application.h"
+#include "GUIInfoManager.h"
 #include "dialogs/GUIDialogContextMenu.h"
 #include "GUIDialogProfileSettings.h"
 #include "utils/URIUtils.h"
@@ -163,6 +164,7 @@ bool CGUIWindowSettingsProfile::OnMessage(CGUIMessage& message)
       else if (iControl == CONTROL_LOGINSCREEN)
       {
         g_settings.ToggleLoginScreen();
+        g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
         g_settings.SaveProfiles(PROFILES_FILE);
         return true;
       }
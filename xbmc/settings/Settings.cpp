@@ -50,6 +50,7 @@
 #endif
 #include "cores/playercorefactory/PlayerCoreFactory.h"
 #include "utils/FileUtils.h"
+#include "utils/JobManager.h"
 #include "utils/URIUtils.h"
 #include "input/MouseStat.h"
 #include "filesystem/File.h"
@@ -1001,6 +1002,7 @@ bool CSettings::LoadProfile(unsigned int index)
 
     g_Mouse.SetEnabled(g_guiSettings.GetBool("input.enablemouse"));
 
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_PLAYER | INFO::INFO_SOURCE_SYSTEM);
     g_infoManager.ResetCache();
     g_infoManager.ResetLibraryBools();
 
@@ -1442,6 +1444,7 @@ void CSettings::LoadSkinSettings(const TiXmlElement* pRootElement)
       pChild = pChild->NextSiblingElement("setting");
     }
   }
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_SKIN_SETTINGS);
 }
 
 void CSettings::SaveSkinSettings(TiXmlNode *pRootElement) const
@@ -1540,6 +1543,7 @@ void CSettings::SetSkinString(int setting, const CStdString &label)
   if (it != m_skinStrings.end())
   {
     (*it).second.value = label;
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_SKIN_SETTINGS);
     return;
   }
   assert(false);
@@ -1556,6 +1560,7 @@ void CSettings::ResetSkinSetting(const CStdString &setting)
     if (settingName.Equals((*it).second.name))
     {
       (*it).second.value = "";
+      g_infoManager.SourceChanged(INFO::INFO_SOURCE_SKIN_SETTINGS);
       return;
     }
   }
@@ -1565,6 +1570,7 @@ void CSettings::ResetSkinSetting(const CStdString &setting)
     if (settingName.Equals((*it).second.name))
     {
       (*it).second.value = false;
+      g_infoManager.SourceChanged(INFO::INFO_SOURCE_SKIN_SETTINGS);
       return;
     }
   }
@@ -1605,6 +1611,7 @@ void CSettings::SetSkinBool(int setting, bool set)
   if (it != m_skinBools.end())
   {
     (*it).second.value = set;
+    g_infoManager.SourceChanged(INFO::INFO_SOURCE_SKIN_SETTINGS);
     return;
   }
   assert(false);
@@ -1633,6 +1640,7 @@ void CSettings::ResetSkinSettings()
 
     it2++;
   }
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_SKIN_SETTINGS);
   g_infoManager.ResetCache();
 }
 
@@ -1944,6 +1952,12 @@ void CSettings::AddProfile(const CProfile &profile)
   m_vecProfiles.push_back(profile);
 }
 
+void CSettings::RemoveProfile(unsigned int index)
+{
+  if (index < m_vecProfiles.size() && (index != m_currentProfile || m_vecProfiles.size() == 1))
+    m_vecProfiles.erase(m_vecProfiles.begin() + index);
+}
+
 void CSettings::LoadMasterForLogin()
 {
   // save the previous user
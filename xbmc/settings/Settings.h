@@ -287,6 +287,12 @@ public:
    */
   void AddProfile(const CProfile &profile);
 
+  /*! \brief Remove a profile added with AddProfile
+   Unlike DeleteProfile, neither asks for confirmation nor deletes the profile's folder.
+   \param index index of the profile to remove. The current profile is only removed when it is the only one.
+   */
+  void RemoveProfile(unsigned int index);
+
   /*! \brief Are we using the login screen?
    \return true if we're using the login screen, false otherwise
    */
@@ -0,0 +1,146 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "FileItem.h"
+#include "guilib/Key.h"
+#include "settings/Settings.h"
+
+#include "gtest/gtest.h"
+
+/* ends the frame, returning the number of conditions evaluated during it */
+static unsigned int TestGUIInfoManagerFrame(unsigned int *cached = NULL)
+{
+  g_infoManager.ResetCache();
+  unsigned int evaluated, reused;
+  g_infoManager.GetBoolStatistics(evaluated, reused);
+  if (cached)
+    *cached = reused;
+  return evaluated;
+}
+
+TEST(TestGUIInfoManager, ConstantConditions)
+{
+  unsigned int condition = g_infoManager.Register("true + !false");
+  EXPECT_EQ(0U, g_infoManager.GetBoolSources(condition));
+
+  TestGUIInfoManagerFrame();
+  EXPECT_TRUE(g_infoManager.GetBoolValue(condition));
+  TestGUIInfoManagerFrame();
+
+  unsigned int cached;
+  EXPECT_TRUE(g_infoManager.GetBoolValue(condition));
+  EXPECT_EQ(0U, TestGUIInfoManagerFrame(&cached));
+  EXPECT_EQ(1U, cached);
+}
+
+TEST(TestGUIInfoManager, SkinSettingChanges)
+{
+  int setting = g_settings.TranslateSkinBool("testguiinfomanager");
+  g_settings.SetSkinBool(setting, false);
+  unsigned int condition = g_infoManager.Register("Skin.HasSetting(testguiinfomanager)");
+  unsigned int expression = g_infoManager.Register("Skin.HasSetting(testguiinfomanager) | false");
+  EXPECT_EQ((unsigned int)INFO::INFO_SOURCE_SKIN_SETTINGS, g_infoManager.GetBoolSources(condition));
+  EXPECT_EQ((unsigned int)INFO::INFO_SOURCE_SKIN_SETTINGS, g_infoManager.GetBoolSources(expression));
+
+  TestGUIInfoManagerFrame();
+  EXPECT_FALSE(g_infoManager.GetBoolValue(expression));
+  TestGUIInfoManagerFrame();
+
+  // nothing changed, so nothing is evaluated
+  EXPECT_FALSE(g_infoManager.GetBoolValue(expression));
+  EXPECT_EQ(0U, TestGUIInfoManagerFrame());
+
+  // the setting and the expression using it are
+  g_settings.SetSkinBool(setting, true);
+  EXPECT_TRUE(g_infoManager.GetBoolValue(expression));
+  EXPECT_EQ(2U, TestGUIInfoManagerFrame());
+  g_settings.SetSkinBool(setting, false);
+}
+
+TEST(TestGUIInfoManager, VolatileConditions)
+{
+  unsigned int condition = g_infoManager.Register("Skin.HasTheme(testguiinfomanager)");
+  EXPECT_EQ((unsigned int)INFO::INFO_SOURCE_VOLATILE, g_infoManager.GetBoolSources(condition));
+
+  TestGUIInfoManagerFrame();
+  g_infoManager.GetBoolValue(condition);
+  TestGUIInfoManagerFrame();
+  g_infoManager.GetBoolValue(condition);
+  EXPECT_EQ(1U, TestGUIInfoManagerFrame());
+}
+
+TEST(TestGUIInfoManager, ListItemConditions)
+{
+  CFileItem folder("folder", true);
+  CFileItem file("file", false);
+  unsigned int isFolder = g_infoManager.Register("ListItem.IsFolder");
+  unsigned int constant = g_infoManager.Register("true");
+  EXPECT_TRUE((g_infoManager.GetBoolSources(isFolder) & INFO::INFO_SOURCE_LISTITEM) != 0);
+  EXPECT_EQ(0U, g_infoManager.GetBoolSources(constant));
+
+  TestGUIInfoManagerFrame();
+  g_infoManager.GetBoolValue(constant);
+  TestGUIInfoManagerFrame();
+
+  EXPECT_TRUE(g_infoManager.GetBoolValue(isFolder, &folder));
+  EXPECT_FALSE(g_infoManager.GetBoolValue(isFolder, &file));
+  EXPECT_TRUE(g_infoManager.GetBoolValue(isFolder, &folder));
+
+  // conditions that don't depend on the item are evaluated once for all items
+  for (unsigned int i = 0; i < 10; i++)
+    EXPECT_TRUE(g_infoManager.GetBoolValue(constant, i & 1 ? &folder : &file));
+  EXPECT_EQ(3U, TestGUIInfoManagerFrame());
+}
+
+TEST(TestGUIInfoManager, PlayerAndWindowChanges)
+{
+  unsigned int paused = g_infoManager.Register("Player.Paused");
+  unsigned int active = g_infoManager.Register("Window.IsActive(testguiinfomanager.xml)");
+  unsigned int alarm = g_infoManager.Register("System.HasAlarm(testguiinfomanager)");
+  EXPECT_EQ((unsigned int)INFO::INFO_SOURCE_PLAYER, g_infoManager.GetBoolSources(paused));
+  EXPECT_EQ((unsigned int)INFO::INFO_SOURCE_WINDOW, g_infoManager.GetBoolSources(active));
+  EXPECT_EQ((unsigned int)INFO::INFO_SOURCE_SYSTEM, g_infoManager.GetBoolSources(alarm));
+
+  TestGUIInfoManagerFrame();
+  g_infoManager.GetBoolValue(paused);
+  g_infoManager.GetBoolValue(active);
+  g_infoManager.GetBoolValue(alarm);
+  TestGUIInfoManagerFrame();
+
+  // nothing is playing and no window changed, so nothing is evaluated
+  EXPECT_FALSE(g_infoManager.GetBoolValue(paused));
+  EXPECT_FALSE(g_infoManager.GetBoolValue(active));
+  EXPECT_FALSE(g_infoManager.GetBoolValue(alarm));
+  EXPECT_EQ(0U, TestGUIInfoManagerFrame());
+
+  // only the conditions on the source that changed are
+  g_infoManager.SetNextWindow(WINDOW_INVALID);
+  EXPECT_FALSE(g_infoManager.GetBoolValue(paused));
+  EXPECT_FALSE(g_infoManager.GetBoolValue(active));
+  EXPECT_FALSE(g_infoManager.GetBoolValue(alarm));
+  EXPECT_EQ(1U, TestGUIInfoManagerFrame());
+
+  g_infoManager.ToggleShowInfo();
+  g_infoManager.ToggleShowInfo();
+  EXPECT_FALSE(g_infoManager.GetBoolValue(paused));
+  EXPECT_FALSE(g_infoManager.GetBoolValue(active));
+  EXPECT_EQ(1U, TestGUIInfoManagerFrame());
+}
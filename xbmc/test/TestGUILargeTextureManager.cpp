@@ -0,0 +1,148 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUILargeTextureManager.h"
+#include "guilib/Texture.h"
+#include "guilib/XBTF.h"
+#include "settings/AdvancedSettings.h"
+
+#include <map>
+
+#include "gtest/gtest.h"
+
+static const unsigned int TestGUILargeTextureManagerSize = 256;
+static const uint64_t TestGUILargeTextureManagerBytes = TestGUILargeTextureManagerSize * TestGUILargeTextureManagerSize * 4;
+
+/* a manager whose images are loaded by the test rather than by jobs */
+class TestGUILargeTextureManagerLoader : public CGUILargeTextureManager
+{
+public:
+  TestGUILargeTextureManagerLoader() : m_lastJob(0) {}
+
+  /* requests an image and completes its load with a TestGUILargeTextureManagerSize square texture */
+  bool Load(const CStdString &path)
+  {
+    CTextureArray texture;
+    GetImage(path, texture, true);
+    std::map<CStdString, unsigned int>::iterator it = m_jobs.find(path);
+    if (it == m_jobs.end())
+      return false;
+
+    CImageLoader loader(path);
+    loader.m_texture = new CTexture(TestGUILargeTextureManagerSize, TestGUILargeTextureManagerSize, XB_FMT_A8R8G8B8);
+    OnJobComplete(it->second, true, &loader);
+    m_jobs.erase(it);
+    return true;
+  }
+
+  bool IsLoaded(const CStdString &path)
+  {
+    CTextureArray texture;
+    GetImage(path, texture, false);
+    return texture.size() > 0;
+  }
+
+  uint64_t GetResident()
+  {
+    uint64_t resident;
+    unsigned int hits, misses;
+    GetStatistics(resident, hits, misses);
+    return resident;
+  }
+
+protected:
+  virtual unsigned int StartLoading(const CStdString &path)
+  {
+    m_jobs[path] = ++m_lastJob;
+    return m_lastJob;
+  }
+
+private:
+  std::map<CStdString, unsigned int> m_jobs;
+  unsigned int m_lastJob;
+};
+
+/* room for four of the test images */
+class TestGUILargeTextureManager : public testing::Test
+{
+protected:
+  TestGUILargeTextureManager()
+  {
+    m_largeTextureMemory = g_advancedSettings.m_largeTextureMemory;
+    g_advancedSettings.m_largeTextureMemory = 1;
+  }
+
+  ~TestGUILargeTextureManager()
+  {
+    m_manager.CleanupUnusedImages(true);
+    g_advancedSettings.m_largeTextureMemory = m_largeTextureMemory;
+  }
+
+  TestGUILargeTextureManagerLoader m_manager;
+  unsigned int m_largeTextureMemory;
+};
+
+TEST_F(TestGUILargeTextureManager, KeepsImagesInUseOverBudget)
+{
+  for (char image = 'a'; image <= 'f'; image++)
+    ASSERT_TRUE(m_manager.Load(CStdString(1, image)));
+  EXPECT_EQ(6 * TestGUILargeTextureManagerBytes, m_manager.GetResident());
+
+  m_manager.CleanupUnusedImages();
+  EXPECT_EQ(6 * TestGUILargeTextureManagerBytes, m_manager.GetResident());
+  for (char image = 'a'; image <= 'f'; image++)
+  {
+    EXPECT_TRUE(m_manager.IsLoaded(CStdString(1, image)));
+    m_manager.ReleaseImage(CStdString(1, image));
+  }
+}
+
+TEST_F(TestGUILargeTextureManager, UnloadsLeastRecentlyUsedToBudget)
+{
+  for (char image = 'a'; image <= 'f'; image++)
+    ASSERT_TRUE(m_manager.Load(CStdString(1, image)));
+  for (char image = 'a'; image <= 'f'; image++)
+    m_manager.ReleaseImage(CStdString(1, image));
+
+  // unused images stay loaded until cleaned up, and using one again makes it the most recently used
+  CTextureArray texture;
+  EXPECT_TRUE(m_manager.GetImage("b", texture, true));
+  EXPECT_EQ(1U, texture.size());
+  m_manager.ReleaseImage("b");
+
+  uint64_t resident;
+  unsigned int hits, misses;
+  m_manager.GetStatistics(resident, hits, misses);
+  EXPECT_EQ(6 * TestGUILargeTextureManagerBytes, resident);
+  EXPECT_EQ(1U, hits);
+  EXPECT_EQ(6U, misses);
+
+  m_manager.CleanupUnusedImages();
+  EXPECT_EQ(4 * TestGUILargeTextureManagerBytes, m_manager.GetResident());
+  EXPECT_FALSE(m_manager.IsLoaded("a"));
+  EXPECT_TRUE(m_manager.IsLoaded("b"));
+  EXPECT_FALSE(m_manager.IsLoaded("c"));
+  for (char image = 'd'; image <= 'f'; image++)
+    EXPECT_TRUE(m_manager.IsLoaded(CStdString(1, image)));
+
+  m_manager.CleanupUnusedImages(true);
+  EXPECT_EQ(0U, m_manager.GetResident());
+  EXPECT_FALSE(m_manager.IsLoaded("b"));
+}
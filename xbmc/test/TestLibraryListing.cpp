@@ -0,0 +1,169 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DatabaseManager.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "music/MusicDatabase.h"
+#include "music/tags/MusicInfoTag.h"
+#include "settings/Settings.h"
+#include "utils/StringUtils.h"
+#include "utils/Stopwatch.h"
+#include "video/VideoDatabase.h"
+#include "video/VideoInfoTag.h"
+
+#include "gtest/gtest.h"
+
+static const int TestLibraryListingRows = 100000;
+
+/* music and video databases below the temp folder, filled with a library of
+   TestLibraryListingRows songs and movies, titled in the reverse of their ids */
+class TestLibraryListing : public testing::Test
+{
+protected:
+  TestLibraryListing()
+  {
+    // the databases live in the profile's folder
+    m_addedProfile = !g_settings.GetNumProfiles();
+    if (m_addedProfile)
+      g_settings.AddProfile(CProfile("special://temp/"));
+    XFILE::CDirectory::Create(g_settings.GetDatabaseFolder());
+    CDatabaseManager::Get().Initialize();
+  }
+
+  ~TestLibraryListing()
+  {
+    CDatabaseManager::Get().Deinitialize();
+    if (m_addedProfile)
+      g_settings.RemoveProfile(0);
+  }
+
+  void CreateSongs(CMusicDatabase &db)
+  {
+    db.BeginTransaction();
+    db.ExecuteQuery("INSERT INTO path (idPath, strPath) VALUES (1, '/music/')");
+    db.ExecuteQuery("INSERT INTO album (idAlbum, strAlbum, strArtists, strGenres, iYear) VALUES (1, 'Album', 'Artist', 'Genre', 2000)");
+    for (int i = 1; i <= TestLibraryListingRows; i++)
+      db.ExecuteQuery(db.PrepareSQL("INSERT INTO song (idSong, idAlbum, idPath, strArtists, strGenres, strTitle, iTrack, iDuration, iYear, strFileName, iTimesPlayed, iStartOffset, iEndOffset, rating) "
+                                    "VALUES (%i, 1, 1, 'Artist', 'Genre', 'Song %06i', %i, 180, 2000, 'song%i.mp3', %i, 0, 0, '0')",
+                                    i, TestLibraryListingRows - i, i % 100, i, i % 3));
+    db.CommitTransaction();
+  }
+
+  void CreateMovies(CVideoDatabase &db)
+  {
+    db.BeginTransaction();
+    db.ExecuteQuery("INSERT INTO path (idPath, strPath) VALUES (1, '/movies/')");
+    for (int i = 1; i <= TestLibraryListingRows; i++)
+    {
+      db.ExecuteQuery(db.PrepareSQL("INSERT INTO files (idFile, idPath, strFilename, playCount) VALUES (%i, 1, 'movie%i.mkv', %i)",
+                                    i, i, i % 3));
+      db.ExecuteQuery(db.PrepareSQL("INSERT INTO movie (idMovie, idFile, c%02d, c%02d, c%02d) VALUES (%i, %i, 'Movie %06i', '%i', '%.1f')",
+                                    VIDEODB_ID_TITLE, VIDEODB_ID_YEAR, VIDEODB_ID_RATING,
+                                    i, i, TestLibraryListingRows - i, 1950 + i % 60, (i % 100) / 10.0));
+    }
+    db.CommitTransaction();
+  }
+
+  bool m_addedProfile;
+};
+
+TEST_F(TestLibraryListing, GetSongsByWhere)
+{
+  CMusicDatabase db;
+  ASSERT_TRUE(db.Open());
+  CreateSongs(db);
+
+  CStopWatch watch;
+  CFileItemList items;
+  watch.StartZero();
+  ASSERT_TRUE(db.GetSongsByWhere("musicdb://4/", CDatabase::Filter(), items));
+  float unsortedTime = watch.GetElapsedMilliseconds();
+  ASSERT_EQ(TestLibraryListingRows, items.Size());
+
+  // typed values of a row come through the cursor unchanged
+  const MUSIC_INFO::CMusicInfoTag *tag = items[0]->GetMusicInfoTag();
+  EXPECT_EQ(1, tag->GetDatabaseId());
+  EXPECT_STREQ(StringUtils::Format("Song %06i", TestLibraryListingRows - 1).c_str(), tag->GetTitle().c_str());
+  EXPECT_EQ(1, tag->GetTrackNumber());
+  EXPECT_EQ(180, tag->GetDuration());
+  EXPECT_EQ(1, tag->GetPlayCount());
+  EXPECT_STREQ("/music/song1.mp3", tag->GetURL().c_str());
+  EXPECT_STREQ("musicdb://4/1.mp3", items[0]->GetPath().c_str());
+
+  // sorting with limits picks the rows after the whole listing has been read
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.limitEnd = 100;
+  items.Clear();
+  watch.StartZero();
+  ASSERT_TRUE(db.GetSongsByWhere("musicdb://4/", CDatabase::Filter(), items, sorting));
+  float sortedTime = watch.GetElapsedMilliseconds();
+  ASSERT_EQ(100, items.Size());
+  EXPECT_EQ(TestLibraryListingRows, items.GetProperty("total").asInteger());
+  for (int i = 0; i < items.Size(); i++)
+    EXPECT_EQ(TestLibraryListingRows - i, items[i]->GetMusicInfoTag()->GetDatabaseId());
+
+  db.Close();
+
+  std::cout << "Songs: " << testing::PrintToString(unsortedTime) << " ms" << std::endl;
+  std::cout << "Songs sorted by title: " << testing::PrintToString(sortedTime) << " ms" << std::endl;
+}
+
+TEST_F(TestLibraryListing, GetMoviesByWhere)
+{
+  CVideoDatabase db;
+  ASSERT_TRUE(db.Open());
+  CreateMovies(db);
+
+  CStopWatch watch;
+  CFileItemList items;
+  watch.StartZero();
+  ASSERT_TRUE(db.GetMoviesByWhere("videodb://1/2/", CDatabase::Filter(), items));
+  float unsortedTime = watch.GetElapsedMilliseconds();
+  ASSERT_EQ(TestLibraryListingRows, items.Size());
+
+  // typed values of a row come through the cursor unchanged
+  const CVideoInfoTag *tag = items[0]->GetVideoInfoTag();
+  EXPECT_EQ(1, tag->m_iDbId);
+  EXPECT_STREQ(StringUtils::Format("Movie %06i", TestLibraryListingRows - 1).c_str(), tag->m_strTitle.c_str());
+  EXPECT_EQ(1951, tag->m_iYear);
+  EXPECT_FLOAT_EQ(0.1f, tag->m_fRating);
+  EXPECT_EQ(1, tag->m_playCount);
+  EXPECT_STREQ("/movies/movie1.mkv", tag->m_strFileNameAndPath.c_str());
+  EXPECT_STREQ("videodb://1/2/1", items[0]->GetPath().c_str());
+
+  SortDescription sorting;
+  sorting.sortBy = SortByTitle;
+  sorting.limitEnd = 100;
+  items.Clear();
+  watch.StartZero();
+  ASSERT_TRUE(db.GetMoviesByWhere("videodb://1/2/", CDatabase::Filter(), items, sorting));
+  float sortedTime = watch.GetElapsedMilliseconds();
+  ASSERT_EQ(100, items.Size());
+  EXPECT_EQ(TestLibraryListingRows, items.GetProperty("total").asInteger());
+  for (int i = 0; i < items.Size(); i++)
+    EXPECT_EQ(TestLibraryListingRows - i, items[i]->GetVideoInfoTag()->m_iDbId);
+
+  db.Close();
+
+  std::cout << "Movies: " << testing::PrintToString(unsortedTime) << " ms" << std::endl;
+  std::cout << "Movies sorted by title: " << testing::PrintToString(sortedTime) << " ms" << std::endl;
+}
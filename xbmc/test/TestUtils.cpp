@@ -185,6 +185,48 @@ XFILE::CFile *CXBMCTestUtils::CreateCorruptedFile(CStdString const& strFileName,
   return NULL;
 }
 
+XFILE::CFile *CXBMCTestUtils::CreateYUV4MPEGFile(int width, int height,
+  unsigned int frames, unsigned int seed)
+{
+  XFILE::CFile *tmpfile = CreateTempFile(".y4m");
+  if (!tmpfile)
+    return NULL;
+  tmpfile->Close();
+
+  CStdString path = TempFilePath(tmpfile);
+  if (!tmpfile->OpenForWrite(path, true))
+  {
+    DeleteTempFile(tmpfile);
+    return NULL;
+  }
+
+  std::string header = StringUtils::Format(
+    "YUV4MPEG2 W%d H%d F25:1 Ip A1:1 C420jpeg\n", width, height);
+  bool written = tmpfile->Write(header.c_str(), header.size()) == (int)header.size();
+
+  std::string frame(width * height * 3 / 2, '\0');
+  for (unsigned int i = 0; i < frames && written; i++)
+  {
+    for (int y = 0; y < height; y++)
+    {
+      for (int x = 0; x < width; x++)
+        frame[y * width + x] = (char)(x + y + i * 4 + seed * 16);
+    }
+    for (int k = width * height; k < (int)frame.size(); k++)
+      frame[k] = (char)(96 + (k + i) % 64);
+    written = tmpfile->Write("FRAME\n", 6) == 6 &&
+              tmpfile->Write(frame.c_str(), frame.size()) == (int)frame.size();
+  }
+  tmpfile->Close();
+
+  if (!written)
+  {
+    DeleteTempFile(tmpfile);
+    return NULL;
+  }
+  return tmpfile;
+}
+
 
 std::vector<CStdString> &CXBMCTestUtils::getTestDownloadQueueUrls()
 {
@@ -221,6 +263,11 @@ std::vector<CStdString> &CXBMCTestUtils::getGUISettingsFiles()
   return GUISettingsFiles;
 }
 
+std::vector<CStdString> &CXBMCTestUtils::getTestVideoCodecFiles()
+{
+  return TestVideoCodecFiles;
+}
+
 static const char usage[] =
 "XBMC Test Suite\n"
 "Usage: xbmc-test [options]\n"
@@ -265,6 +312,13 @@ static const char usage[] =
 "    Add multiple GUI settings files from a ',' delimited string of\n"
 "    files to be loaded in test cases that use them.\n"
 "\n"
+"  --add-testvideocodec-file [FILE]\n"
+"    Add a video file to be decoded in the TestDVDVideoCodecFFmpeg tests.\n"
+"\n"
+"  --add-testvideocodec-files [FILES]\n"
+"    Add multiple video files from a ',' delimited string of files to be\n"
+"    decoded in the TestDVDVideoCodecFFmpeg tests.\n"
+"\n"
 "  --set-probability [PROBABILITY]\n"
 "    Set the probability variable used by the file corrupting functions.\n"
 "    The variable should be a double type from 0.0 to 1.0. Values given\n"
@@ -343,6 +397,18 @@ void CXBMCTestUtils::ParseArgs(int argc, char **argv)
       for (it = urls.begin(); it < urls.end(); it++)
         GUISettingsFiles.push_back(*it);
     }
+    else if (arg == "--add-testvideocodec-file")
+    {
+      TestVideoCodecFiles.push_back(argv[++i]);
+    }
+    else if (arg == "--add-testvideocodec-files")
+    {
+      arg = argv[++i];
+      std::vector<std::string> urls = StringUtils::Split(arg, ",");
+      std::vector<std::string>::iterator it;
+      for (it = urls.begin(); it < urls.end(); it++)
+        TestVideoCodecFiles.push_back(*it);
+    }
     else if (arg == "--set-probability")
     {
       probability = atof(argv[++i]);
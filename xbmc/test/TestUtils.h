@@ -75,6 +75,9 @@ public:
   /* Function to get GUI settings files. */
   std::vector<CStdString> &getGUISettingsFiles();
 
+  /* Function to get the sample files used in the TestDVDVideoCodecFFmpeg tests. */
+  std::vector<CStdString> &getTestVideoCodecFiles();
+
   /* Function used in creating a corrupted file. The parameters are a URL
    * to the original file to be corrupted and a suffix to append to the
    * path of the newly created file. This will return a XFILE::CFile
@@ -84,6 +87,16 @@ public:
   XFILE::CFile *CreateCorruptedFile(CStdString const& strFileName,
                                     CStdString const& suffix);
 
+  /* Function used in creating a clip of moving gradients, written as
+   * uncompressed yuv4mpeg since no video encoders are built with our
+   * ffmpeg. The parameters are the picture size, the number of frames
+   * and a seed which varies the pictures between clips. This will return
+   * a XFILE::CFile object which is itself a tempfile object which can be
+   * used with the tempfile functions of this utility class.
+   */
+  XFILE::CFile *CreateYUV4MPEGFile(int width, int height,
+                                   unsigned int frames, unsigned int seed = 0);
+
   /* Function to parse command line options */
   void ParseArgs(int argc, char **argv);
 
@@ -101,6 +114,7 @@ private:
 
   std::vector<CStdString> AdvancedSettingsFiles;
   std::vector<CStdString> GUISettingsFiles;
+  std::vector<CStdString> TestVideoCodecFiles;
 
   double probability;
 };
@@ -111,3 +125,5 @@ private:
 #define XBMC_TEMPFILEPATH(a) CXBMCTestUtils::Instance().TempFilePath(a)
 #define XBMC_CREATECORRUPTEDFILE(a, b) \
   CXBMCTestUtils::Instance().CreateCorruptedFile(a, b)
+#define XBMC_CREATEYUV4MPEGFILE(w, h, f, s) \
+  CXBMCTestUtils::Instance().CreateYUV4MPEGFile(w, h, f, s)
@@ -20,6 +20,7 @@
 
 #include "AlarmClock.h"
 #include "ApplicationMessenger.h"
+#include "GUIInfoManager.h"
 #include "guilib/LocalizeStrings.h"
 #include "threads/SingleLock.h"
 #include "log.h"
@@ -75,6 +76,7 @@ void CAlarmClock::Start(const CStdString& strName, float n_secs, const CStdStrin
   event.watch.StartZero();
   CSingleLock lock(m_events);
   m_event.insert(make_pair(lowerName,event));
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
   CLog::Log(LOGDEBUG,"started alarm with name: %s",lowerName.c_str());
 }
 
@@ -123,6 +125,7 @@ void CAlarmClock::Stop(const CStdString& strName, bool bSilent /* false */)
 
   iter->second.watch.Stop();
   m_event.erase(iter);
+  g_infoManager.SourceChanged(INFO::INFO_SOURCE_SYSTEM);
 }
 
 void CAlarmClock::Process()
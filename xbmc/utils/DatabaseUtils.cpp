@@ -545,6 +545,67 @@ bool DatabaseUtils::GetFieldValue(const dbiplus::field_value &fieldValue, CVaria
   return false;
 }
 
+/* fills in the fields derived from the values read for a result */
+static void FinishDatabaseResult(MediaType mediaType, DatabaseResult &result)
+{
+  if (mediaType == MediaTypeTvShow || mediaType == MediaTypeEpisode)
+  {
+    DatabaseResult::iterator year = result.find(FieldYear);
+    if (year != result.end())
+    {
+      CDateTime dateTime;
+      dateTime.SetFromDBDate(year->second.asString());
+      if (dateTime.IsValid())
+      {
+        year->second.clear();
+        year->second = dateTime.GetYear();
+      }
+    }
+  }
+
+  result[FieldMediaType] = mediaType;
+  switch (mediaType)
+  {
+  case MediaTypeMovie:
+  case MediaTypeVideoCollection:
+  case MediaTypeTvShow:
+  case MediaTypeMusicVideo:
+    result[FieldLabel] = result.at(FieldTitle).asString();
+    break;
+    
+  case MediaTypeEpisode:
+  {
+    std::ostringstream label;
+    label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
+    label << ". ";
+    label << result.at(FieldTitle).asString();
+    result[FieldLabel] = label.str();
+    break;
+  }
+
+  case MediaTypeAlbum:
+    result[FieldLabel] = result.at(FieldAlbum).asString();
+    break;
+
+  case MediaTypeSong:
+  {
+    std::ostringstream label;
+    label << (int)result.at(FieldTrackNumber).asInteger();
+    label << ". ";
+    label << result.at(FieldTitle).asString();
+    result[FieldLabel] = label.str();
+    break;
+  }
+
+  case MediaTypeArtist:
+    result[FieldLabel] = result.at(FieldArtist).asString();
+    break;
+
+  default:
+    break;
+  }
+}
+
 bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
 {
   if (dataset->num_rows() == 0)
@@ -591,66 +652,39 @@ bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fie
       if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value.second))
         CLog::Log(LOGWARNING, "GetDatabaseResults: unable to retrieve value of field %s", resultSet.record_header[fieldIndex].name.c_str());
 
-      if (value.first == FieldYear &&
-         (mediaType == MediaTypeTvShow || mediaType == MediaTypeEpisode))
-      {
-        CDateTime dateTime;
-        dateTime.SetFromDBDate(value.second.asString());
-        if (dateTime.IsValid())
-        {
-          value.second.clear();
-          value.second = dateTime.GetYear();
-        }
-      }
-
       result.insert(value);
     }
 
-    result[FieldMediaType] = mediaType;
-    switch (mediaType)
-    {
-    case MediaTypeMovie:
-    case MediaTypeVideoCollection:
-    case MediaTypeTvShow:
-    case MediaTypeMusicVideo:
-      result[FieldLabel] = result.at(FieldTitle).asString();
-      break;
-      
-    case MediaTypeEpisode:
-    {
-      std::ostringstream label;
-      label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-      break;
-    }
+    FinishDatabaseResult(mediaType, result);
+    results.push_back(result);
+  }
 
-    case MediaTypeAlbum:
-      result[FieldLabel] = result.at(FieldAlbum).asString();
-      break;
+  return true;
+}
 
-    case MediaTypeSong:
-    {
-      std::ostringstream label;
-      label << (int)result.at(FieldTrackNumber).asInteger();
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-      break;
-    }
+bool DatabaseUtils::GetDatabaseResult(MediaType mediaType, const FieldList &fields, dbiplus::Cursor &cursor, DatabaseResult &result)
+{
+  if (fields.empty())
+    return true;
 
-    case MediaTypeArtist:
-      result[FieldLabel] = result.at(FieldArtist).asString();
-      break;
+  if (cursor.field_count() < (int)fields.size())
+    return false;
 
-    default:
-      break;
-    }
+  for (FieldList::const_iterator it = fields.begin(); it != fields.end(); it++)
+  {
+    int fieldIndex = GetFieldIndex(*it, mediaType);
+    if (fieldIndex < 0)
+      return false;
 
-    results.push_back(result);
+    std::pair<Field, CVariant> value;
+    value.first = *it;
+    if (!GetFieldValue(cursor.get_value(fieldIndex), value.second))
+      CLog::Log(LOGWARNING, "GetDatabaseResult: unable to retrieve value of field %s", cursor.field_name(fieldIndex));
+
+    result.insert(value);
   }
 
+  FinishDatabaseResult(mediaType, result);
   return true;
 }
 
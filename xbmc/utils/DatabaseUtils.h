@@ -29,6 +29,7 @@ class CVariant;
 
 namespace dbiplus
 {
+  class Cursor;
   class Dataset;
   class field_value;
 }
@@ -159,6 +160,8 @@ public:
   
   static bool GetFieldValue(const dbiplus::field_value &fieldValue, CVariant &variantValue);
   static bool GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  // reads the given fields of the current row of cursor, the caller sets FieldRow
+  static bool GetDatabaseResult(MediaType mediaType, const FieldList &fields, dbiplus::Cursor &cursor, DatabaseResult &result);
 
   static std::string BuildLimitClause(int end, int start = 0);
 };
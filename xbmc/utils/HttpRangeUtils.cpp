@@ -0,0 +1,185 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "system.h"
+#include "HttpRangeUtils.h"
+#include "StringUtils.h"
+
+using namespace std;
+
+static const uint64_t HttpRangeMax = ~(uint64_t)0;
+
+static bool RangeSort(const HttpRange &a, const HttpRange &b)
+{
+  return a.first < b.first;
+}
+
+/* parses a run of digits, saturating rather than wrapping on overflow */
+static bool ParseNumber(const string &str, uint64_t &value)
+{
+  if (str.empty())
+    return false;
+
+  value = 0;
+  for (string::const_iterator it = str.begin(); it != str.end(); ++it)
+  {
+    if (*it < '0' || *it > '9')
+      return false;
+    unsigned int digit = *it - '0';
+    if (value > (HttpRangeMax - digit) / 10)
+      value = HttpRangeMax;
+    else
+      value = value * 10 + digit;
+  }
+  return true;
+}
+
+bool CHttpRangeUtils::ParseRangeHeader(const string &header, uint64_t totalLength, HttpRanges &ranges)
+{
+  ranges.clear();
+
+  string value = header;
+  StringUtils::Trim(value);
+  if (value.size() < 6 || strnicmp(value.c_str(), "bytes=", 6) != 0)
+    return false;
+
+  vector<string> specs = StringUtils::Split(value.substr(6), ",");
+  bool hasSpec = false;
+  for (vector<string>::iterator spec = specs.begin(); spec != specs.end(); ++spec)
+  {
+    StringUtils::Trim(*spec);
+    if (spec->empty())
+      continue;
+
+    size_t dash = spec->find('-');
+    if (dash == string::npos)
+      return false;
+
+    string first = spec->substr(0, dash);
+    string last  = spec->substr(dash + 1);
+    StringUtils::Trim(first);
+    StringUtils::Trim(last);
+
+    HttpRange range;
+    if (first.empty())
+    {
+      // suffix range, the last n bytes
+      uint64_t suffix;
+      if (!ParseNumber(last, suffix))
+        return false;
+      hasSpec = true;
+      if (suffix == 0 || totalLength == 0)
+        continue;
+
+      range.first = totalLength - std::min(suffix, totalLength);
+      range.last  = totalLength - 1;
+    }
+    else
+    {
+      if (!ParseNumber(first, range.first))
+        return false;
+      if (last.empty())
+        range.last = HttpRangeMax;
+      else if (!ParseNumber(last, range.last) || range.last < range.first)
+        return false;
+      hasSpec = true;
+
+      if (range.first >= totalLength)
+        continue;
+      range.last = std::min(range.last, totalLength - 1);
+    }
+
+    ranges.push_back(range);
+  }
+
+  if (!hasSpec)
+    return false;
+
+  // merge overlapping and adjacent ranges so a client can't have us send the same data over and over
+  std::sort(ranges.begin(), ranges.end(), RangeSort);
+  HttpRanges merged;
+  for (HttpRanges::const_iterator range = ranges.begin(); range != ranges.end(); ++range)
+  {
+    if (!merged.empty() && range->first <= merged.back().last + 1)
+      merged.back().last = std::max(merged.back().last, range->last);
+    else
+      merged.push_back(*range);
+  }
+  ranges.swap(merged);
+
+  return true;
+}
+
+string CHttpRangeUtils::GetContentRange(const HttpRange &range, uint64_t totalLength)
+{
+  return StringUtils::Format("bytes %"PRIu64"-%"PRIu64"/%"PRIu64, range.first, range.last, totalLength);
+}
+
+string CHttpRangeUtils::GetUnsatisfiableContentRange(uint64_t totalLength)
+{
+  return StringUtils::Format("bytes */%"PRIu64, totalLength);
+}
+
+string CHttpRangeUtils::GenerateMultipartBoundary()
+{
+  CStdString uuid = StringUtils::CreateUUID();
+  uuid.Remove('-');
+  return "xbmc-" + uuid;
+}
+
+string CHttpRangeUtils::GetMultipartHeader(const string &boundary, const string &contentType, const HttpRange &range, uint64_t totalLength)
+{
+  string header = "\r\n--" + boundary + "\r\n";
+  if (!contentType.empty())
+    header += "Content-Type: " + contentType + "\r\n";
+  header += "Content-Range: " + GetContentRange(range, totalLength) + "\r\n\r\n";
+  return header;
+}
+
+string CHttpRangeUtils::GetMultipartEnd(const string &boundary)
+{
+  return "\r\n--" + boundary + "--\r\n";
+}
+
+string CHttpRangeUtils::GenerateETag(uint64_t size, int64_t modified)
+{
+  return StringUtils::Format("\"%"PRIx64"-%"PRIx64"\"", (uint64_t)modified, size);
+}
+
+bool CHttpRangeUtils::MatchesETag(const string &header, const string &etag)
+{
+  if (etag.empty())
+    return false;
+
+  vector<string> tags = StringUtils::Split(header, ",");
+  for (vector<string>::iterator tag = tags.begin(); tag != tags.end(); ++tag)
+  {
+    StringUtils::Trim(*tag);
+    if (*tag == "*")
+      return true;
+    if (tag->compare(0, 2, "W/") == 0)
+      tag->erase(0, 2);
+    if (*tag == etag)
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,98 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief An inclusive range of bytes, as in a "Range: bytes=first-last" header.
+ */
+typedef struct HttpRange
+{
+  uint64_t first;
+  uint64_t last;
+
+  uint64_t GetLength() const { return last - first + 1; }
+} HttpRange;
+
+typedef std::vector<HttpRange> HttpRanges;
+
+class CHttpRangeUtils
+{
+public:
+  /*!
+   \brief Parse the value of a Range header for a resource of the given length.
+   Ranges are clamped to the resource, sorted, and overlapping or adjacent ones
+   are merged.
+   \param header the value of the Range header, eg. "bytes=0-499,-500".
+   \param totalLength the length of the resource.
+   \param ranges the satisfiable ranges, empty if there are none.
+   \return false if the header is not a valid byte range set and must be ignored.
+   */
+  static bool ParseRangeHeader(const std::string &header, uint64_t totalLength, HttpRanges &ranges);
+
+  /*!
+   \brief Generate the value of the Content-Range header for a range.
+   \return eg. "bytes 0-499/1234".
+   */
+  static std::string GetContentRange(const HttpRange &range, uint64_t totalLength);
+
+  /*!
+   \brief Generate the value of the Content-Range header of a 416 response,
+   which only carries the length of the resource.
+   */
+  static std::string GetUnsatisfiableContentRange(uint64_t totalLength);
+
+  /*!
+   \brief Generate a boundary for a multipart/byteranges response.
+   */
+  static std::string GenerateMultipartBoundary();
+
+  /*!
+   \brief Generate the delimiter and headers that precede a part of a multipart/byteranges response.
+   \param boundary the boundary of the response.
+   \param contentType the Content-Type of the resource, may be empty.
+   \param range the range of the resource in this part.
+   \param totalLength the length of the resource.
+   */
+  static std::string GetMultipartHeader(const std::string &boundary, const std::string &contentType, const HttpRange &range, uint64_t totalLength);
+
+  /*!
+   \brief Generate the closing delimiter of a multipart/byteranges response.
+   */
+  static std::string GetMultipartEnd(const std::string &boundary);
+
+  /*!
+   \brief Generate a strong entity tag from the size and modification time of a file.
+   \return the quoted entity tag.
+   */
+  static std::string GenerateETag(uint64_t size, int64_t modified);
+
+  /*!
+   \brief Check an If-None-Match or If-Match header against an entity tag.
+   Weak tags in the header match their strong counterpart.
+   \param header the list of entity tags, or "*".
+   \param etag the quoted entity tag of the resource.
+   \return true if one of the tags in the header matches.
+   */
+  static bool MatchesETag(const std::string &header, const std::string &etag);
+};
@@ -0,0 +1,186 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JobGroup.h"
+#include <algorithm>
+#include "JobManager.h"
+#include "threads/SingleLock.h"
+
+using namespace std;
+
+CJobGroup::CJobGroup(IJobGroupCallback *callback, unsigned int maxConcurrent, CJob::PRIORITY priority)
+: m_callback(callback), m_maxConcurrent(maxConcurrent), m_priority(priority),
+  m_total(0), m_completed(0), m_succeeded(0), m_closed(false), m_cancelled(false),
+  m_done(true)
+{
+}
+
+CJobGroup::~CJobGroup()
+{
+  Cancel();
+}
+
+void CJobGroup::AddJob(CJob *job)
+{
+  CSingleLock lock(m_section);
+  if (m_cancelled || m_closed)
+  {
+    delete job;
+    return;
+  }
+  m_total++;
+  m_pending.push_back(job);
+  QueueJobs();
+}
+
+void CJobGroup::QueueJobs()
+{
+  CSingleLock lock(m_section);
+  while (m_pending.size() && (m_maxConcurrent == 0 || m_processing.size() < m_maxConcurrent))
+  {
+    CJob *job = m_pending.front();
+    m_pending.pop_front();
+    unsigned int id = CJobManager::GetInstance().AddJob(job, this, m_priority);
+    if (id)
+      m_processing.push_back(id);
+    else
+    { // job manager is shutting down - count the job as failed
+      delete job;
+      m_completed++;
+    }
+  }
+}
+
+void CJobGroup::Close()
+{
+  CSingleLock lock(m_section);
+  if (m_closed || m_cancelled)
+    return;
+  m_closed = true;
+  if (m_completed < m_total)
+    return;
+
+  unsigned int succeeded = m_succeeded;
+  unsigned int total = m_total;
+  lock.Leave();
+  if (m_callback)
+    m_callback->OnJobGroupComplete(this, succeeded, total);
+  m_done.Set();
+}
+
+void CJobGroup::Cancel()
+{
+  CSingleLock lock(m_section);
+  if (!m_cancelled)
+  {
+    m_cancelled = true;
+    for (Processing::iterator i = m_processing.begin(); i != m_processing.end(); ++i)
+    {
+      if (CJobManager::GetInstance().CancelJob(*i))
+        m_cancelling.push_back(*i);
+    }
+    m_processing.clear();
+    for (Pending::iterator i = m_pending.begin(); i != m_pending.end(); ++i)
+      delete *i;
+    m_pending.clear();
+    m_done.Set();
+  }
+  WaitForCallbacks(lock);
+}
+
+void CJobGroup::WaitForCallbacks(CSingleLock &lock)
+{
+  // a callback running on this thread may cancel the group, so don't wait for ourselves
+  ThreadIdentifier self = CThread::GetCurrentThreadId();
+  while (m_cancelling.size() || (size_t)count(m_calling.begin(), m_calling.end(), self) != m_calling.size())
+    m_callbackDone.wait(lock);
+}
+
+bool CJobGroup::Wait(unsigned int timeoutMs)
+{
+  return m_done.WaitMSec(timeoutMs);
+}
+
+bool CJobGroup::IsCancelled() const
+{
+  CSingleLock lock(m_section);
+  return m_cancelled;
+}
+
+unsigned int CJobGroup::GetTotal() const
+{
+  CSingleLock lock(m_section);
+  return m_total;
+}
+
+unsigned int CJobGroup::GetCompleted() const
+{
+  CSingleLock lock(m_section);
+  return m_completed;
+}
+
+unsigned int CJobGroup::GetSucceeded() const
+{
+  CSingleLock lock(m_section);
+  return m_succeeded;
+}
+
+void CJobGroup::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_section);
+  Processing::iterator i = find(m_processing.begin(), m_processing.end(), jobID);
+  if (i == m_processing.end())
+  { // cancelled, but Cancel() may be waiting on us
+    Processing::iterator j = find(m_cancelling.begin(), m_cancelling.end(), jobID);
+    if (j != m_cancelling.end())
+    {
+      m_cancelling.erase(j);
+      m_callbackDone.notifyAll();
+    }
+    return;
+  }
+  m_processing.erase(i);
+  m_completed++;
+  if (success)
+    m_succeeded++;
+  QueueJobs();
+
+  unsigned int completed = m_completed;
+  unsigned int succeeded = m_succeeded;
+  unsigned int total = m_total;
+  bool done = m_closed && completed == total;
+  ThreadIdentifier self = CThread::GetCurrentThreadId();
+  m_calling.push_back(self);
+  lock.Leave();
+
+  if (m_callback)
+  {
+    m_callback->OnJobGroupProgress(this, completed, total);
+    if (done)
+      m_callback->OnJobGroupComplete(this, succeeded, total);
+  }
+  if (done)
+    m_done.Set();
+
+  // Cancel() and the destructor wait until we're out
+  lock.Enter();
+  m_calling.erase(find(m_calling.begin(), m_calling.end(), self));
+  m_callbackDone.notifyAll();
+}
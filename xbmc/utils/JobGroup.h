@@ -0,0 +1,152 @@
+#pragma once
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "threads/Condition.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "Job.h"
+
+class CJobGroup;
+
+/*!
+ \ingroup jobs
+ \brief Callback interface for groups of jobs.
+
+ Used by clients of CJobGroup to receive aggregated progress and completion
+ notification for all the jobs in the group.
+
+ \sa CJobGroup
+ */
+class IJobGroupCallback
+{
+public:
+  virtual ~IJobGroupCallback() {};
+
+  /*!
+   \brief The callback used when every job in a closed group has completed.
+   Not called if the group is cancelled.
+   \param group the group that has completed.
+   \param succeeded the number of jobs whose DoWork() returned true.
+   \param total the total number of jobs in the group.
+   \sa CJobGroup::Close()
+   */
+  virtual void OnJobGroupComplete(CJobGroup *group, unsigned int succeeded, unsigned int total)=0;
+
+  /*!
+   \brief An optional callback made each time a job in the group completes.
+   \param group the group the job belongs to.
+   \param completed the number of jobs completed so far.
+   \param total the number of jobs added to the group so far.
+   */
+  virtual void OnJobGroupProgress(CJobGroup *group, unsigned int completed, unsigned int total) {};
+};
+
+/*!
+ \ingroup jobs
+ \brief Runs a set of jobs in parallel with a single completion notification.
+
+ Jobs added to the group are passed to the CJobManager, with at most maxConcurrent
+ of them queued or processing at once.  Once Close() has been called and all jobs
+ have completed, IJobGroupCallback::OnJobGroupComplete() is called and Wait() returns.
+ Unlike CJobQueue, jobs are not checked for uniqueness.
+
+ \sa CJob, CJobManager and IJobGroupCallback
+ */
+class CJobGroup : public IJobCallback
+{
+public:
+  /*!
+   \brief CJobGroup constructor
+   \param callback optional callback to receive progress and completion of the group.
+   \param maxConcurrent maximum number of jobs to hand to the job manager at once, 0 for no limit.
+   \param priority priority of the jobs in this group.
+   */
+  CJobGroup(IJobGroupCallback *callback = NULL, unsigned int maxConcurrent = 0, CJob::PRIORITY priority = CJob::PRIORITY_LOW);
+
+  /*!
+   \brief CJobGroup destructor
+   Cancels any jobs still queued or processing, and waits for completion callbacks
+   that are already running.  Must not be called from within the group's own callbacks.
+   */
+  virtual ~CJobGroup();
+
+  /*!
+   \brief Add a job to the group
+   The job is destroyed by the job manager once complete, or by the group if cancelled
+   before it started.
+   \param job a pointer to the job to add. The job should be subclassed from CJob.
+   */
+  void AddJob(CJob *job);
+
+  /*!
+   \brief Mark that no more jobs will be added to the group.
+   The group completes once all the jobs added so far have completed.
+   */
+  void Close();
+
+  /*!
+   \brief Cancel all jobs in the group.
+   Jobs currently processing may complete after this call, but no further callbacks are made.
+   Completion callbacks already running on other threads are waited for before returning.
+   */
+  void Cancel();
+
+  /*!
+   \brief Wait for the group to complete or be cancelled.
+   \param timeoutMs the time to wait in milliseconds.
+   \return true if the group has completed or been cancelled, false on timeout.
+   */
+  bool Wait(unsigned int timeoutMs);
+
+  bool IsCancelled() const;
+  unsigned int GetTotal() const;
+  unsigned int GetCompleted() const;
+  unsigned int GetSucceeded() const;
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  void QueueJobs();
+  void WaitForCallbacks(CSingleLock &lock);
+
+  typedef std::deque<CJob*> Pending;
+  typedef std::vector<unsigned int> Processing;
+  typedef std::vector<ThreadIdentifier> Calling;
+  Pending    m_pending;
+  Processing m_processing;
+  Processing m_cancelling; ///< cancelled jobs whose OnJobComplete is still to be called
+  Calling    m_calling;    ///< threads currently within OnJobComplete
+
+  IJobGroupCallback *m_callback;
+  unsigned int       m_maxConcurrent;
+  CJob::PRIORITY     m_priority;
+  unsigned int       m_total;
+  unsigned int       m_completed;
+  unsigned int       m_succeeded;
+  bool               m_closed;
+  bool               m_cancelled;
+  CEvent             m_done;
+  XbmcThreads::ConditionVariable m_callbackDone; ///< Signalled whenever a callback finishes.
+  CCriticalSection   m_section;
+};
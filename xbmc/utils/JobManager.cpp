@@ -21,6 +21,7 @@
 #include "JobManager.h"
 #include <algorithm>
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "utils/log.h"
 
 #include "system.h"
@@ -35,9 +36,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("Jobworker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int queueIndex) : CThread("Jobworker")
 {
   m_jobManager = manager;
+  m_queueIndex = queueIndex;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -167,9 +169,50 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    m_stealQueued[priority] = 0;
+  m_processingCount = 0;
+  m_workerCount = 0;
+  m_pausedCount = 0;
+  m_maxWorkers = 5;
+  m_queueCount = m_maxWorkers;
+  m_workStealing = false;
   m_running = true;
 }
 
+void CJobManager::Restart()
+{
+  CSingleLock lock(m_section);
+  m_running = true;
+}
+
+bool CJobManager::SetScheduler(bool workStealing, unsigned int maxWorkers)
+{
+  CSingleLock lock(m_section);
+  maxWorkers = std::max(1U, std::min(maxWorkers, (unsigned int)MAX_WORKER_QUEUES));
+  if (workStealing == m_workStealing && maxWorkers == m_maxWorkers)
+    return true;
+  if (m_running && m_jobCounter != 0)
+  {
+    CLog::Log(LOGWARNING, "%s - jobs have already been queued, scheduler unchanged", __FUNCTION__);
+    return false;
+  }
+  m_workStealing = workStealing;
+  m_maxWorkers = maxWorkers;
+  m_queueCount = m_maxWorkers;
+  CLog::Log(LOGDEBUG, "%s - using %s scheduler with %u workers", __FUNCTION__, m_workStealing ? "work stealing" : "queued", m_maxWorkers);
+  return true;
+}
+
+unsigned int CJobManager::NextJobID()
+{
+  // increment the job counter, ensuring 0 (invalid job) is never hit
+  unsigned int id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  if (id == 0)
+    id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  return id;
+}
+
 void CJobManager::CancelJobs()
 {
   CSingleLock lock(m_section);
@@ -181,6 +224,7 @@ void CJobManager::CancelJobs()
     for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
     m_jobQueue[priority].clear();
   }
+  CancelStealJobs();
 
   // cancel any callbacks on jobs still processing
   for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
@@ -201,26 +245,51 @@ CJobManager::~CJobManager()
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
+  if (m_workStealing)
+  {
+    if (!m_running)
+      return 0;
+
+    // the job id selects the worker queue, which spreads the jobs over the
+    // queues and lets CancelJob() find the job again without any searching
+    unsigned int id = NextJobID();
+    CWorkerQueue &queue = m_workerQueues[id % m_queueCount];
+    {
+      CSingleLock lock(queue.m_section);
+      CStealItem *item = new CStealItem(CWorkItem(job, id, callback), priority);
+      queue.m_jobs[priority].push_back(item);
+      queue.m_items.insert(make_pair(id, item));
+      AtomicIncrement(&m_stealQueued[priority]);
+    }
+
+    // wake a sleeping worker if we have one. When all the workers this priority
+    // may use are running the job waits for the first of them to finish, so only
+    // growing the pool takes the manager lock
+    if (m_processingCount < m_workerCount || (unsigned int)m_workerCount >= GetMaxWorkers(priority))
+      m_jobEvent.Set();
+    else
+      StartWorkers(priority);
+    return id;
+  }
+
   CSingleLock lock(m_section);
 
   if (!m_running)
     return 0;
 
-  // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
-
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, callback);
+  CWorkItem work(job, NextJobID(), callback);
   m_jobQueue[priority].push_back(work);
 
   StartWorkers(priority);
   return work.m_id;
 }
 
-void CJobManager::CancelJob(unsigned int jobID)
+bool CJobManager::CancelJob(unsigned int jobID)
 {
+  if (CancelStealJob(jobID))
+    return false;
+
   CSingleLock lock(m_section);
 
   // check whether we have this job in the queue
@@ -231,13 +300,18 @@ void CJobManager::CancelJob(unsigned int jobID)
     {
       delete i->m_job;
       m_jobQueue[priority].erase(i);
-      return;
+      return false;
     }
   }
   // or if we're processing it
   Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
   if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+  { // job is in progress, so only thing to do is to remove callback, unless it's already been taken
+    bool completing = it->m_completing && it->m_callback;
+    it->m_callback = NULL;
+    return completing;
+  }
+  return false;
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
@@ -245,18 +319,38 @@ void CJobManager::StartWorkers(CJob::PRIORITY priority)
   CSingleLock lock(m_section);
 
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if ((unsigned int)m_processingCount >= GetMaxWorkers(priority))
     return;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  if ((unsigned int)m_processingCount < m_workers.size())
   {
     m_jobEvent.Set();
     return;
   }
 
   // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  AddWorker(new CJobWorker(this, GetIdleQueue()));
+}
+
+void CJobManager::AddWorker(CJobWorker *worker)
+{
+  CSingleLock lock(m_section);
+  m_workers.push_back(worker);
+  m_workerCount = m_workers.size();
+  AtomicIncrement(&m_workerQueues[worker->GetQueueIndex() % MAX_WORKER_QUEUES].m_owners);
+}
+
+unsigned int CJobManager::GetIdleQueue() const
+{
+  // the queue with the fewest workers, so every queue gets an owner before any gets two
+  unsigned int index = 0;
+  for (unsigned int i = 1; i < m_queueCount; i++)
+  {
+    if (m_workerQueues[i].m_owners < m_workerQueues[index].m_owners)
+      index = i;
+  }
+  return index;
 }
 
 CJob *CJobManager::PopJob()
@@ -264,7 +358,7 @@ CJob *CJobManager::PopJob()
   CSingleLock lock(m_section);
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
   {
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (m_jobQueue[priority].size() && (unsigned int)m_processingCount < GetMaxWorkers(CJob::PRIORITY(priority)))
     {
       // skip adding any paused types
       if (!SkipPausedJobs((CJob::PRIORITY)priority))
@@ -276,6 +370,7 @@ CJob *CJobManager::PopJob()
 
       // add to the processing vector
       m_processing.push_back(job);
+      AtomicIncrement(&m_processingCount);
       job.m_job->m_callback = this;
       return job.m_job;
     }
@@ -283,6 +378,159 @@ CJob *CJobManager::PopJob()
   return NULL;
 }
 
+CJobManager::CStealItem *CJobManager::CWorkerQueue::Pop(CJob::PRIORITY priority, const std::vector<std::string> &pausedTypes, bool owner)
+{
+  CSingleLock lock(m_section);
+  Deque &jobs = m_jobs[priority];
+  size_t n = 0;
+  while (n < jobs.size())
+  {
+    // the owner takes the oldest job, thieves take the newest unless nobody
+    // owns the queue, so that jobs there don't wait behind newer ones
+    size_t i = (owner || m_owners <= 0) ? n : jobs.size() - 1 - n;
+    CStealItem *item = jobs[i];
+    if (item->m_state == CStealItem::CANCELLED)
+    { // lazily remove cancelled jobs, CancelJob() has already freed the job
+      jobs.erase(jobs.begin() + i);
+      delete item;
+      continue;
+    }
+    if (!pausedTypes.empty() && find(pausedTypes.begin(), pausedTypes.end(), item->m_work.m_job->GetType()) != pausedTypes.end())
+    {
+      n++;
+      continue;
+    }
+    // leave the item in m_items until it is in the processing vector, so
+    // that CancelJob() can flag it in the meantime
+    item->m_state = CStealItem::CLAIMED;
+    jobs.erase(jobs.begin() + i);
+    return item;
+  }
+  return NULL;
+}
+
+CJob *CJobManager::PopStealJob(const CJobWorker *worker)
+{
+  for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
+  {
+    if (m_stealQueued[priority] <= 0)
+      continue;
+
+    // reserve our processing slot up front, so the worker limits hold without the manager lock
+    if ((unsigned int)AtomicIncrement(&m_processingCount) > GetMaxWorkers(CJob::PRIORITY(priority)))
+    {
+      AtomicDecrement(&m_processingCount);
+      continue;
+    }
+
+    // skip any paused types
+    std::vector<std::string> pausedTypes;
+    if (priority == CJob::PRIORITY_LOW && m_pausedCount > 0)
+    {
+      CSingleLock lock(m_section);
+      pausedTypes = m_pausedTypes;
+    }
+
+    // try our own queue first, then steal from the others
+    unsigned int first = worker->GetQueueIndex() % m_queueCount;
+    for (unsigned int i = 0; i < m_queueCount; i++)
+    {
+      CStealItem *item = m_workerQueues[(first + i) % m_queueCount].Pop(CJob::PRIORITY(priority), pausedTypes, i == 0);
+      if (item)
+      {
+        AtomicDecrement(&m_stealQueued[priority]);
+        return ClaimStealItem(item);
+      }
+    }
+    AtomicDecrement(&m_processingCount);
+  }
+  return NULL;
+}
+
+CJob *CJobManager::ClaimStealItem(CStealItem *item)
+{
+  CWorkItem work(item->m_work);
+  {
+    CSingleLock lock(m_section);
+    if (!m_running)
+      work.Cancel();
+    m_processing.push_back(work);
+    work.m_job->m_callback = this;
+  }
+
+  bool cancelled;
+  {
+    CWorkerQueue &queue = m_workerQueues[work.m_id % m_queueCount];
+    CSingleLock lock(queue.m_section);
+    queue.m_items.erase(work.m_id);
+    cancelled = item->m_state == CStealItem::CANCEL_PENDING;
+    delete item;
+  }
+
+  if (cancelled)
+  {
+    CSingleLock lock(m_section);
+    Processing::iterator it = find(m_processing.begin(), m_processing.end(), work.m_id);
+    if (it != m_processing.end())
+      it->Cancel();
+  }
+  return work.m_job;
+}
+
+bool CJobManager::CancelStealJob(unsigned int jobID)
+{
+  CWorkerQueue &queue = m_workerQueues[jobID % m_queueCount];
+  CSingleLock lock(queue.m_section);
+  CWorkerQueue::Items::iterator i = queue.m_items.find(jobID);
+  if (i == queue.m_items.end())
+    return false;
+
+  CStealItem *item = i->second;
+  if (item->m_state == CStealItem::QUEUED)
+  { // the item is left in its deque and discarded when a worker reaches it
+    item->m_work.FreeJob();
+    item->m_state = CStealItem::CANCELLED;
+    queue.m_items.erase(i);
+    AtomicDecrement(&m_stealQueued[item->m_priority]);
+  }
+  else // a worker is moving the job to processing, and cancels it once there
+    item->m_state = CStealItem::CANCEL_PENDING;
+  return true;
+}
+
+void CJobManager::CancelStealJobs()
+{
+  for (unsigned int i = 0; i < MAX_WORKER_QUEUES; i++)
+  {
+    CWorkerQueue &queue = m_workerQueues[i];
+    CSingleLock lock(queue.m_section);
+
+    // claimed items are no longer queued, and are released by their worker
+    CWorkerQueue::Items claimed;
+    for (CWorkerQueue::Items::iterator it = queue.m_items.begin(); it != queue.m_items.end(); ++it)
+    {
+      if (it->second->m_state != CStealItem::QUEUED)
+        claimed.insert(*it);
+    }
+    queue.m_items.swap(claimed);
+
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      CWorkerQueue::Deque &jobs = queue.m_jobs[priority];
+      for (CWorkerQueue::Deque::iterator it = jobs.begin(); it != jobs.end(); ++it)
+      {
+        if ((*it)->m_state == CStealItem::QUEUED)
+        {
+          (*it)->m_work.FreeJob();
+          AtomicDecrement(&m_stealQueued[priority]);
+        }
+        delete *it;
+      }
+      jobs.clear();
+    }
+  }
+}
+
 void CJobManager::Pause(const std::string &pausedType)
 {
   CSingleLock lock(m_section);
@@ -290,6 +538,7 @@ void CJobManager::Pause(const std::string &pausedType)
   // the queue will resume when all Pause requests
   // for a given type have been UnPaused.
   m_pausedTypes.push_back(pausedType);
+  m_pausedCount = m_pausedTypes.size();
 }
 
 void CJobManager::UnPause(const std::string &pausedType)
@@ -298,6 +547,7 @@ void CJobManager::UnPause(const std::string &pausedType)
   std::vector<std::string>::iterator i = find(m_pausedTypes.begin(), m_pausedTypes.end(), pausedType);
   if (i != m_pausedTypes.end())
     m_pausedTypes.erase(i);
+  m_pausedCount = m_pausedTypes.size();
 }
 
 bool CJobManager::IsPaused(const std::string &pausedType)
@@ -346,6 +596,9 @@ int CJobManager::IsProcessing(const std::string &pausedType)
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
+  if (m_workStealing)
+    return GetNextStealJob(worker);
+
   CSingleLock lock(m_section);
   while (m_running)
   {
@@ -370,6 +623,29 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
   return NULL;
 }
 
+CJob *CJobManager::GetNextStealJob(const CJobWorker *worker)
+{
+  while (m_running)
+  {
+    // grab a job off the queues if we have one
+    CJob *job = PopStealJob(worker);
+    if (job)
+      return job;
+    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+    if (!m_jobEvent.WaitMSec(30000))
+      break;
+  }
+  // remove ourselves before the final check, so that any job added after it
+  // sees there are no sleeping workers and starts a new one
+  CSingleLock lock(m_section);
+  RemoveWorker(worker);
+  lock.Leave();
+  CJob *job = PopStealJob(worker);
+  if (job)
+    AddWorker(const_cast<CJobWorker*>(worker));
+  return job;
+}
+
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
   CSingleLock lock(m_section);
@@ -396,6 +672,7 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
   if (i != m_processing.end())
   {
     // tell any listeners we're done with the job, then delete it
+    i->m_completing = true;
     CWorkItem item(*i);
     lock.Leave();
     try
@@ -410,7 +687,10 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
     lock.Enter();
     Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
     if (j != m_processing.end())
+    {
       m_processing.erase(j);
+      AtomicDecrement(&m_processingCount);
+    }
     lock.Leave();
     item.FreeJob();
   }
@@ -422,11 +702,15 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
   // remove our worker
   Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
   if (i != m_workers.end())
+  {
     m_workers.erase(i); // workers auto-delete
+    AtomicDecrement(&m_workerQueues[worker->GetQueueIndex() % MAX_WORKER_QUEUES].m_owners);
+  }
+  m_workerCount = m_workers.size();
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  int max_workers = (int)m_maxWorkers - (CJob::PRIORITY_HIGH - priority);
+  return (unsigned int)std::max(1, max_workers);
 }
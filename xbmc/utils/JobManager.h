@@ -22,6 +22,7 @@
 #include <queue>
 #include <vector>
 #include <string>
+#include <map>
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -31,12 +32,18 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int queueIndex = 0);
   virtual ~CJobWorker();
 
   void Process();
+
+  /*!
+   \brief Index of the worker queue this worker services first when work stealing.
+   */
+  unsigned int GetQueueIndex() const { return m_queueIndex; };
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_queueIndex;
 };
 
 /*!
@@ -170,6 +177,7 @@ class CJobManager
       m_job = job;
       m_id = id;
       m_callback = callback;
+      m_completing = false;
     }
     bool operator==(unsigned int jobID) const
     {
@@ -191,6 +199,41 @@ class CJobManager
     CJob         *m_job;
     unsigned int  m_id;
     IJobCallback *m_callback;
+    bool          m_completing;
+  };
+
+  /*!
+   \brief Queued job used by the work stealing scheduler.
+   The state is only changed while holding the owning CWorkerQueue's lock.
+   */
+  class CStealItem
+  {
+  public:
+    enum STATE { QUEUED = 0, CLAIMED, CANCELLED, CANCEL_PENDING };
+    CStealItem(const CWorkItem &work, CJob::PRIORITY priority) : m_work(work), m_priority(priority), m_state(QUEUED) {};
+    CWorkItem      m_work;
+    CJob::PRIORITY m_priority;
+    STATE          m_state;
+  };
+
+  /*!
+   \brief Per-worker deques used by the work stealing scheduler.
+   A job lives in the queue selected by its id, so cancelling by id only needs
+   this queue's lock. The owning worker takes the oldest job, other workers
+   steal the newest one, or the oldest one when no worker owns the queue.
+   */
+  class CWorkerQueue
+  {
+  public:
+    CWorkerQueue() : m_owners(0) {};
+    CStealItem *Pop(CJob::PRIORITY priority, const std::vector<std::string> &pausedTypes, bool owner);
+
+    typedef std::deque<CStealItem*> Deque;
+    typedef std::map<unsigned int, CStealItem*> Items;
+    Deque            m_jobs[CJob::PRIORITY_HIGH+1];
+    Items            m_items;
+    CCriticalSection m_section;
+    volatile long    m_owners; ///< workers servicing this queue first, changed under the manager lock
   };
 
 public:
@@ -212,10 +255,13 @@ public:
 
   /*!
    \brief Cancel a job with the given id.
+   If the job has already finished and its IJobCallback::OnJobComplete() is being called
+   this call does not wait for it, so callers that are about to be destroyed must wait for it themselves.
    \param jobID the id of the job to cancel, retrieved previously from AddJob()
+   \return true if IJobCallback::OnJobComplete() is still to be called for the job, false otherwise.
    \sa AddJob()
    */
-  void CancelJob(unsigned int jobID);
+  bool CancelJob(unsigned int jobID);
 
   /*!
    \brief Cancel all remaining jobs, preparing for shutdown
@@ -257,6 +303,27 @@ public:
    */
   int IsProcessing(const std::string &pausedType);
 
+  /*!
+   \brief Selects the scheduler used for queueing jobs.
+   The default scheduler keeps a single queue per priority.  The work stealing scheduler
+   spreads jobs over one queue per worker, so adding jobs only takes the manager lock while
+   the pool of workers grows, and workers only take it briefly to move a job to processing
+   and on completion.
+   Jobs are cancelled lazily.
+   The scheduler may only be changed before any job has been added, or after CancelJobs().
+   \param workStealing true to use the work stealing scheduler.
+   \param maxWorkers maximum number of worker threads for high priority jobs.
+   \return true if the scheduler is the one asked for, false if jobs have already been queued.
+   \sa Restart()
+   */
+  bool SetScheduler(bool workStealing, unsigned int maxWorkers);
+
+  /*!
+   \brief Start accepting jobs again after CancelJobs()
+   \sa CancelJobs()
+   */
+  void Restart();
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -300,8 +367,21 @@ private:
    */
   CJob *PopJob();
 
+  /*! \brief Pop a job off the worker queues, preferring the worker's own queue
+   \param worker the worker requesting a job.
+   \return the job to process, NULL if no jobs are available
+   */
+  CJob *PopStealJob(const CJobWorker *worker);
+  CJob *ClaimStealItem(CStealItem *item);
+  CJob *GetNextStealJob(const CJobWorker *worker);
+  bool  CancelStealJob(unsigned int jobID);
+  void  CancelStealJobs();
+  unsigned int NextJobID();
+
   void StartWorkers(CJob::PRIORITY priority);
+  void AddWorker(CJobWorker *worker);
   void RemoveWorker(const CJobWorker *worker);
+  unsigned int GetIdleQueue() const;
   unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
 
   /*! \brief skips over any paused jobs of given priority.
@@ -312,7 +392,7 @@ private:
    */
   bool SkipPausedJobs(CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  volatile long m_jobCounter;
 
   typedef std::deque<CWorkItem>    JobQueue;
   typedef std::vector<CWorkItem>   Processing;
@@ -322,8 +402,18 @@ private:
   Processing m_processing;
   Workers    m_workers;
 
+  static const unsigned int MAX_WORKER_QUEUES = 64; ///< upper bound of <maxworkers>
+  CWorkerQueue  m_workerQueues[MAX_WORKER_QUEUES];
+  unsigned int  m_queueCount;                         ///< queues in use, one per worker
+  volatile long m_stealQueued[CJob::PRIORITY_HIGH+1]; ///< jobs waiting in the worker queues, per priority
+  volatile long m_processingCount;                    ///< jobs processing, or claimed by a worker
+  volatile long m_workerCount;
+  volatile long m_pausedCount;
+  unsigned int  m_maxWorkers;
+  volatile bool m_workStealing;
+
   CCriticalSection m_section;
   CEvent           m_jobEvent;
-  bool             m_running;
+  volatile bool    m_running;
   std::vector<std::string>  m_pausedTypes;
 };
@@ -695,6 +695,14 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, MediaTyp
   if (!DatabaseUtils::GetDatabaseResults(mediaType, fields, dataset, results))
     return false;
 
+  SortDatabaseResults(sortDescription, results);
+
+  return true;
+}
+
+void SortUtils::SortDatabaseResults(const SortDescription &sortDescription, DatabaseResults &results)
+{
+  // without sorting the limits have already been applied by the query
   SortDescription sorting = sortDescription;
   if (sortDescription.sortBy == SortByNone)
   {
@@ -703,8 +711,6 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, MediaTyp
   }
 
   Sort(sorting, results);
-
-  return true;
 }
 
 const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
@@ -0,0 +1,121 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/HttpRangeUtils.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestHttpRangeUtils, ParseRangeHeader)
+{
+  HttpRanges ranges;
+
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=0-499", 10000, ranges));
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(0U, ranges[0].first);
+  EXPECT_EQ(499U, ranges[0].last);
+  EXPECT_EQ(500U, ranges[0].GetLength());
+
+  // open ended and suffix ranges are clamped to the resource
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=9500-", 10000, ranges));
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(9500U, ranges[0].first);
+  EXPECT_EQ(9999U, ranges[0].last);
+
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=-500", 10000, ranges));
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(9500U, ranges[0].first);
+  EXPECT_EQ(9999U, ranges[0].last);
+
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=-20000", 10000, ranges));
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(0U, ranges[0].first);
+
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=9000-99999999999999999999999", 10000, ranges));
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(9999U, ranges[0].last);
+}
+
+TEST(TestHttpRangeUtils, MultipleRanges)
+{
+  HttpRanges ranges;
+
+  // sorted, with overlapping and adjacent ranges merged
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=500-599, 0-99,50-149, -100 ,150-199", 10000, ranges));
+  ASSERT_EQ(3U, ranges.size());
+  EXPECT_EQ(0U, ranges[0].first);
+  EXPECT_EQ(199U, ranges[0].last);
+  EXPECT_EQ(500U, ranges[1].first);
+  EXPECT_EQ(599U, ranges[1].last);
+  EXPECT_EQ(9900U, ranges[2].first);
+  EXPECT_EQ(9999U, ranges[2].last);
+}
+
+TEST(TestHttpRangeUtils, InvalidRanges)
+{
+  HttpRanges ranges;
+
+  // not a valid byte range set, the header is ignored
+  EXPECT_FALSE(CHttpRangeUtils::ParseRangeHeader("", 10000, ranges));
+  EXPECT_FALSE(CHttpRangeUtils::ParseRangeHeader("items=0-5", 10000, ranges));
+  EXPECT_FALSE(CHttpRangeUtils::ParseRangeHeader("bytes=", 10000, ranges));
+  EXPECT_FALSE(CHttpRangeUtils::ParseRangeHeader("bytes=5-2", 10000, ranges));
+  EXPECT_FALSE(CHttpRangeUtils::ParseRangeHeader("bytes=a-2", 10000, ranges));
+  EXPECT_FALSE(CHttpRangeUtils::ParseRangeHeader("bytes=0-1,x", 10000, ranges));
+
+  // valid but unsatisfiable
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=10000-", 10000, ranges));
+  EXPECT_TRUE(ranges.empty());
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=-0", 10000, ranges));
+  EXPECT_TRUE(ranges.empty());
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=0-", 0, ranges));
+  EXPECT_TRUE(ranges.empty());
+
+  // but one satisfiable range is enough
+  EXPECT_TRUE(CHttpRangeUtils::ParseRangeHeader("bytes=20000-30000,0-0", 10000, ranges));
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(1U, ranges[0].GetLength());
+}
+
+TEST(TestHttpRangeUtils, Headers)
+{
+  HttpRange range = { 0, 499 };
+  EXPECT_STREQ("bytes 0-499/1234", CHttpRangeUtils::GetContentRange(range, 1234).c_str());
+  EXPECT_STREQ("bytes */1234", CHttpRangeUtils::GetUnsatisfiableContentRange(1234).c_str());
+
+  std::string boundary = CHttpRangeUtils::GenerateMultipartBoundary();
+  EXPECT_FALSE(boundary.empty());
+  EXPECT_NE(boundary, CHttpRangeUtils::GenerateMultipartBoundary());
+  EXPECT_STREQ(("\r\n--" + boundary + "\r\nContent-Type: video/avi\r\nContent-Range: bytes 0-499/1234\r\n\r\n").c_str(),
+               CHttpRangeUtils::GetMultipartHeader(boundary, "video/avi", range, 1234).c_str());
+  EXPECT_STREQ(("\r\n--" + boundary + "--\r\n").c_str(), CHttpRangeUtils::GetMultipartEnd(boundary).c_str());
+}
+
+TEST(TestHttpRangeUtils, ETag)
+{
+  std::string etag = CHttpRangeUtils::GenerateETag(1234, 1350000000);
+  EXPECT_STREQ("\"50775d80-4d2\"", etag.c_str());
+  EXPECT_NE(etag, CHttpRangeUtils::GenerateETag(1235, 1350000000));
+
+  EXPECT_TRUE(CHttpRangeUtils::MatchesETag(etag, etag));
+  EXPECT_TRUE(CHttpRangeUtils::MatchesETag("\"abc\", W/" + etag, etag));
+  EXPECT_TRUE(CHttpRangeUtils::MatchesETag("*", etag));
+  EXPECT_FALSE(CHttpRangeUtils::MatchesETag("\"abc\"", etag));
+  EXPECT_FALSE(CHttpRangeUtils::MatchesETag("*", ""));
+}
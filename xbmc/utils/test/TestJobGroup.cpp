@@ -0,0 +1,216 @@
+/*
+ *      Copyright (C) 2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/JobGroup.h"
+#include "utils/JobManager.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+static volatile long g_running = 0;
+static volatile long g_maxRunning = 0;
+
+class TestJobGroupJob : public CJob
+{
+public:
+  TestJobGroupJob(bool result, unsigned int sleepMs = 0) : m_result(result), m_sleepMs(sleepMs) {}
+  virtual bool DoWork()
+  {
+    long running = AtomicIncrement(&g_running);
+    long max = g_maxRunning;
+    while (running > max && cas(&g_maxRunning, max, running) != max)
+      max = g_maxRunning;
+    if (m_sleepMs)
+      CThread::GetCurrentThread()->Sleep(m_sleepMs);
+    AtomicDecrement(&g_running);
+    return m_result;
+  }
+private:
+  bool m_result;
+  unsigned int m_sleepMs;
+};
+
+class TestJobGroupCallback : public IJobGroupCallback
+{
+public:
+  TestJobGroupCallback() : m_completeCalls(0), m_progressCalls(0), m_succeeded(0), m_total(0) {}
+  virtual void OnJobGroupComplete(CJobGroup *group, unsigned int succeeded, unsigned int total)
+  {
+    AtomicIncrement(&m_completeCalls);
+    m_succeeded = succeeded;
+    m_total = total;
+  }
+  virtual void OnJobGroupProgress(CJobGroup *group, unsigned int completed, unsigned int total)
+  {
+    AtomicIncrement(&m_progressCalls);
+  }
+  volatile long m_completeCalls;
+  volatile long m_progressCalls;
+  unsigned int m_succeeded;
+  unsigned int m_total;
+};
+
+class TestJobGroup : public testing::Test
+{
+protected:
+  TestJobGroup()
+  {
+    CJobManager::GetInstance().Restart();
+    g_running = 0;
+    g_maxRunning = 0;
+  }
+
+  ~TestJobGroup()
+  {
+    CJobManager::GetInstance().CancelJobs();
+  }
+};
+
+TEST_F(TestJobGroup, Complete)
+{
+  TestJobGroupCallback callback;
+  CJobGroup group(&callback);
+  for (unsigned int i = 0; i < 20; i++)
+    group.AddJob(new TestJobGroupJob(i % 2 == 0));
+  group.Close();
+
+  EXPECT_TRUE(group.Wait(10000));
+  EXPECT_EQ(1, callback.m_completeCalls);
+  EXPECT_EQ(20, callback.m_progressCalls);
+  EXPECT_EQ(10U, callback.m_succeeded);
+  EXPECT_EQ(20U, callback.m_total);
+  EXPECT_EQ(20U, group.GetCompleted());
+}
+
+TEST_F(TestJobGroup, Empty)
+{
+  TestJobGroupCallback callback;
+  CJobGroup group(&callback);
+  group.Close();
+
+  EXPECT_TRUE(group.Wait(0));
+  EXPECT_EQ(1, callback.m_completeCalls);
+  EXPECT_EQ(0U, callback.m_total);
+}
+
+TEST_F(TestJobGroup, MaxConcurrent)
+{
+  CJobGroup group(NULL, 2);
+  for (unsigned int i = 0; i < 8; i++)
+    group.AddJob(new TestJobGroupJob(true, 20));
+  group.Close();
+
+  EXPECT_TRUE(group.Wait(10000));
+  EXPECT_EQ(8U, group.GetSucceeded());
+  EXPECT_LE(g_maxRunning, 2);
+}
+
+TEST_F(TestJobGroup, Cancel)
+{
+  TestJobGroupCallback callback;
+  CJobGroup group(&callback, 1);
+  for (unsigned int i = 0; i < 8; i++)
+    group.AddJob(new TestJobGroupJob(true, 50));
+  group.Cancel();
+  group.Close();
+
+  EXPECT_TRUE(group.Wait(0));
+  EXPECT_TRUE(group.IsCancelled());
+  EXPECT_EQ(0, callback.m_completeCalls);
+  EXPECT_GT(8U, group.GetCompleted());
+}
+
+/* blocks in DoWork until the gate is opened */
+class TestJobGroupGatedJob : public CJob
+{
+public:
+  TestJobGroupGatedJob(CEvent &gate) : m_gate(gate) {}
+  virtual bool DoWork()
+  {
+    m_gate.Wait();
+    return true;
+  }
+  virtual const char *GetType() const { return "testjobgroupgated"; }
+private:
+  CEvent &m_gate;
+};
+
+/* blocks in the progress callback until released, and notes when it has returned */
+class TestJobGroupBlockingCallback : public TestJobGroupCallback
+{
+public:
+  TestJobGroupBlockingCallback() : m_returned(false) {}
+  virtual void OnJobGroupProgress(CJobGroup *group, unsigned int completed, unsigned int total)
+  {
+    m_entered.Set();
+    m_release.Wait();
+    TestJobGroupCallback::OnJobGroupProgress(group, completed, total);
+    m_returned = true;
+  }
+  CEvent m_entered;
+  CEvent m_release;
+  volatile bool m_returned;
+};
+
+/* destroys a group, and notes whether its callback had returned by then */
+class TestJobGroupDestroyer : public CThread
+{
+public:
+  TestJobGroupDestroyer(CJobGroup *group, TestJobGroupBlockingCallback &callback)
+    : CThread("TestJobGroupDestroyer"), m_group(group), m_callback(callback), m_returnedFirst(false) {}
+  virtual void Process()
+  {
+    delete m_group;
+    m_returnedFirst = m_callback.m_returned;
+  }
+  CJobGroup *m_group;
+  TestJobGroupBlockingCallback &m_callback;
+  volatile bool m_returnedFirst;
+};
+
+TEST_F(TestJobGroup, DestroyDuringCallback)
+{
+  TestJobGroupBlockingCallback callback;
+  CEvent gate(true);
+  CJobGroup *group = new CJobGroup(&callback);
+  group->AddJob(new TestJobGroupJob(true));
+  group->AddJob(new TestJobGroupGatedJob(gate));
+  group->Close();
+
+  // destroy the group while the callback of the first job is running
+  ASSERT_TRUE(callback.m_entered.WaitMSec(10000));
+  TestJobGroupDestroyer destroyer(group, callback);
+  destroyer.Create();
+  for (unsigned int i = 0; i < 10000 && !group->IsCancelled(); i++)
+    XbmcThreads::ThreadSleep(1);
+  callback.m_release.Set();
+  ASSERT_TRUE(destroyer.WaitForThreadExit(10000));
+  EXPECT_TRUE(destroyer.m_returnedFirst);
+
+  // the gated job completes after the group is gone, without calling back
+  gate.Set();
+  for (unsigned int i = 0; i < 10000 && CJobManager::GetInstance().IsProcessing("testjobgroupgated"); i++)
+    XbmcThreads::ThreadSleep(1);
+  EXPECT_EQ(0, CJobManager::GetInstance().IsProcessing("testjobgroupgated"));
+  EXPECT_EQ(1, callback.m_progressCalls);
+  EXPECT_EQ(0, callback.m_completeCalls);
+}
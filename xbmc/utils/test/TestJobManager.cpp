@@ -21,6 +21,9 @@
 #include "utils/JobManager.h"
 #include "settings/GUISettings.h"
 #include "utils/SystemInfo.h"
+#include "utils/Stopwatch.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
 
 #include "gtest/gtest.h"
 
@@ -88,3 +91,69 @@ TEST_F(TestJobManager, IsProcessing)
 
   CJobManager::GetInstance().CancelJobs();
 }
+
+class TestJobManagerNullJob : public CJob
+{
+public:
+  virtual bool DoWork() { return true; }
+};
+
+class TestJobManagerCounter : public IJobCallback
+{
+public:
+  TestJobManagerCounter(long total) : m_total(total), m_completed(0) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    if (AtomicIncrement(&m_completed) == m_total)
+      m_done.Set();
+  }
+  long m_total;
+  volatile long m_completed;
+  CEvent m_done;
+};
+
+TEST_F(TestJobManager, SchedulerThroughput)
+{
+  static const long jobs = 20000;
+  static const unsigned int workers[] = { 1, 4, 16 };
+
+  for (int workStealing = 0; workStealing <= 1; workStealing++)
+  {
+    for (unsigned int i = 0; i < sizeof(workers) / sizeof(workers[0]); i++)
+    {
+      CJobManager::GetInstance().CancelJobs();
+      EXPECT_TRUE(CJobManager::GetInstance().SetScheduler(workStealing != 0, workers[i]));
+      CJobManager::GetInstance().Restart();
+
+      TestJobManagerCounter counter(jobs);
+      CStopWatch watch;
+      watch.StartZero();
+      for (long j = 0; j < jobs; j++)
+        CJobManager::GetInstance().AddJob(new TestJobManagerNullJob(), &counter);
+      EXPECT_TRUE(counter.m_done.WaitMSec(60000));
+      float elapsed = watch.GetElapsedMilliseconds();
+      EXPECT_EQ(jobs, counter.m_completed);
+
+      std::cout << (workStealing ? "Work stealing" : "Queued") << " scheduler, " <<
+        testing::PrintToString(workers[i]) << " workers: " <<
+        testing::PrintToString(elapsed) << " ms" << std::endl;
+    }
+  }
+
+  CJobManager::GetInstance().CancelJobs();
+  CJobManager::GetInstance().SetScheduler(false, 5);
+}
+
+TEST_F(TestJobManager, SetSchedulerUnchanged)
+{
+  CJobManager::GetInstance().Restart();
+  TestJobManagerCounter counter(1);
+  CJobManager::GetInstance().AddJob(new TestJobManagerNullJob(), &counter);
+  EXPECT_TRUE(counter.m_done.WaitMSec(10000));
+
+  // once jobs have been queued, only the scheduler in use can be asked for
+  EXPECT_TRUE(CJobManager::GetInstance().SetScheduler(false, 5));
+  EXPECT_FALSE(CJobManager::GetInstance().SetScheduler(true, 5));
+
+  CJobManager::GetInstance().CancelJobs();
+}
@@ -477,12 +477,14 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
-    if (!m_pDS->eof())
-      idPath = m_pDS->fv("path.idPath").get_asInt();
+    // looked up for every file during scans, so use a cached statement
+    strSQL = "select idPath from path where strPath=?";
+    dbiplus::BindList params;
+    params.push_back(strPath1.c_str());
+    auto_ptr<dbiplus::Cursor> cursor(m_pDS->open_cursor(strSQL, params));
+    if (cursor.get() && cursor->next())
+      idPath = cursor->get_int(0);
 
-    m_pDS->close();
     return idPath;
   }
   catch (...)
@@ -919,15 +921,12 @@ int CVideoDatabase::GetFileId(const CStdString& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      CStdString strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL.c_str());
-      if (m_pDS->num_rows() > 0)
-      {
-        int idFile = m_pDS->fv("files.idFile").get_asInt();
-        m_pDS->close();
-        return idFile;
-      }
+      dbiplus::BindList params;
+      params.push_back(strFileName.c_str());
+      params.push_back(idPath);
+      auto_ptr<dbiplus::Cursor> cursor(m_pDS->open_cursor("select idFile from files where strFileName=? and idPath=?", params));
+      if (cursor.get() && cursor->next())
+        return cursor->get_int(0);
     }
   }
   catch (...)
@@ -3038,32 +3037,38 @@ void CVideoDatabase::GetDetailsFromDB(auto_ptr<Dataset> &pDS, int min, int max,
 }
 
 void CVideoDatabase::GetDetailsFromDB(const dbiplus::sql_record* const record, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset)
+{
+  dbiplus::RecordCursor row(record);
+  GetDetailsFromDB(row, min, max, offsets, details, idxOffset);
+}
+
+void CVideoDatabase::GetDetailsFromDB(dbiplus::Cursor &row, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset)
 {
   for (int i = min + 1; i < max; i++)
   {
     switch (offsets[i].type)
     {
     case VIDEODB_TYPE_STRING:
-      *(CStdString*)(((char*)&details)+offsets[i].offset) = record->at(i+idxOffset).get_asString();
+      *(CStdString*)(((char*)&details)+offsets[i].offset) = row.get_text(i+idxOffset);
       break;
     case VIDEODB_TYPE_INT:
     case VIDEODB_TYPE_COUNT:
-      *(int*)(((char*)&details)+offsets[i].offset) = record->at(i+idxOffset).get_asInt();
+      *(int*)(((char*)&details)+offsets[i].offset) = row.get_int(i+idxOffset);
       break;
     case VIDEODB_TYPE_BOOL:
-      *(bool*)(((char*)&details)+offsets[i].offset) = record->at(i+idxOffset).get_asBool();
+      *(bool*)(((char*)&details)+offsets[i].offset) = row.get_value(i+idxOffset).get_asBool();
       break;
     case VIDEODB_TYPE_FLOAT:
-      *(float*)(((char*)&details)+offsets[i].offset) = record->at(i+idxOffset).get_asFloat();
+      *(float*)(((char*)&details)+offsets[i].offset) = (float)row.get_double(i+idxOffset);
       break;
     case VIDEODB_TYPE_STRINGARRAY:
-      *(std::vector<std::string>*)(((char*)&details)+offsets[i].offset) = StringUtils::Split(record->at(i+idxOffset).get_asString(), g_advancedSettings.m_videoItemSeparator);
+      *(std::vector<std::string>*)(((char*)&details)+offsets[i].offset) = StringUtils::Split(row.get_text(i+idxOffset), g_advancedSettings.m_videoItemSeparator);
       break;
     case VIDEODB_TYPE_DATE:
-      ((CDateTime*)(((char*)&details)+offsets[i].offset))->SetFromDBDate(record->at(i+idxOffset).get_asString());
+      ((CDateTime*)(((char*)&details)+offsets[i].offset))->SetFromDBDate(row.get_text(i+idxOffset));
       break;
     case VIDEODB_TYPE_DATETIME:
-      ((CDateTime*)(((char*)&details)+offsets[i].offset))->SetFromDBDateTime(record->at(i+idxOffset).get_asString());
+      ((CDateTime*)(((char*)&details)+offsets[i].offset))->SetFromDBDateTime(row.get_text(i+idxOffset));
       break;
     }
   }
@@ -3247,30 +3252,36 @@ CVideoInfoTag CVideoDatabase::GetDetailsForMovie(auto_ptr<Dataset> &pDS, bool ge
 
 CVideoInfoTag CVideoDatabase::GetDetailsForMovie(const dbiplus::sql_record* const record, bool getDetails /* = false */)
 {
-  CVideoInfoTag details;
-
   if (record == NULL)
-    return details;
+    return CVideoInfoTag();
+
+  dbiplus::RecordCursor row(record);
+  return GetDetailsForMovie(row, getDetails);
+}
+
+CVideoInfoTag CVideoDatabase::GetDetailsForMovie(dbiplus::Cursor &row, bool getDetails /* = false */)
+{
+  CVideoInfoTag details;
 
   DWORD time = XbmcThreads::SystemClockMillis();
-  int idMovie = record->at(0).get_asInt();
+  int idMovie = row.get_int(0);
 
-  GetDetailsFromDB(record, VIDEODB_ID_MIN, VIDEODB_ID_MAX, DbMovieOffsets, details);
+  GetDetailsFromDB(row, VIDEODB_ID_MIN, VIDEODB_ID_MAX, DbMovieOffsets, details);
 
   details.m_iDbId = idMovie;
   details.m_type = "movie";
   
-  details.m_iSetId = record->at(VIDEODB_DETAILS_MOVIE_SET_ID).get_asInt();
-  details.m_strSet = record->at(VIDEODB_DETAILS_MOVIE_SET_NAME).get_asString();
-  details.m_iFileId = record->at(VIDEODB_DETAILS_FILEID).get_asInt();
-  details.m_strPath = record->at(VIDEODB_DETAILS_MOVIE_PATH).get_asString();
-  CStdString strFileName = record->at(VIDEODB_DETAILS_MOVIE_FILE).get_asString();
+  details.m_iSetId = row.get_int(VIDEODB_DETAILS_MOVIE_SET_ID);
+  details.m_strSet = row.get_text(VIDEODB_DETAILS_MOVIE_SET_NAME);
+  details.m_iFileId = row.get_int(VIDEODB_DETAILS_FILEID);
+  details.m_strPath = row.get_text(VIDEODB_DETAILS_MOVIE_PATH);
+  CStdString strFileName = row.get_text(VIDEODB_DETAILS_MOVIE_FILE);
   ConstructPath(details.m_strFileNameAndPath,details.m_strPath,strFileName);
-  details.m_playCount = record->at(VIDEODB_DETAILS_MOVIE_PLAYCOUNT).get_asInt();
-  details.m_lastPlayed.SetFromDBDateTime(record->at(VIDEODB_DETAILS_MOVIE_LASTPLAYED).get_asString());
-  details.m_dateAdded.SetFromDBDateTime(record->at(VIDEODB_DETAILS_MOVIE_DATEADDED).get_asString());
-  details.m_resumePoint.timeInSeconds = record->at(VIDEODB_DETAILS_MOVIE_RESUME_TIME).get_asInt();
-  details.m_resumePoint.totalTimeInSeconds = record->at(VIDEODB_DETAILS_MOVIE_TOTAL_TIME).get_asInt();
+  details.m_playCount = row.get_int(VIDEODB_DETAILS_MOVIE_PLAYCOUNT);
+  details.m_lastPlayed.SetFromDBDateTime(row.get_text(VIDEODB_DETAILS_MOVIE_LASTPLAYED));
+  details.m_dateAdded.SetFromDBDateTime(row.get_text(VIDEODB_DETAILS_MOVIE_DATEADDED));
+  details.m_resumePoint.timeInSeconds = row.get_int(VIDEODB_DETAILS_MOVIE_RESUME_TIME);
+  details.m_resumePoint.totalTimeInSeconds = row.get_int(VIDEODB_DETAILS_MOVIE_TOTAL_TIME);
   details.m_resumePoint.type = CBookmark::RESUME;
 
   movieTime += XbmcThreads::SystemClockMillis() - time; time = XbmcThreads::SystemClockMillis();
@@ -5859,35 +5870,34 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
+    FieldList fields;
+    if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), MediaTypeMovie, fields))
+      fields.clear();
 
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+    // step through the rows instead of loading them all into the dataset first
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    std::auto_ptr<Cursor> cursor(m_pDS->open_cursor(strSQL));
+    if (!cursor.get())
       return false;
 
-    // get data from returned rows
-    items.Reserve(results.size());
-    const query_data &data = m_pDS->get_result_set().records;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    // locked movies keep their row so the sort results stay aligned, but get no item
+    std::vector<CFileItemPtr> rows;
+    DatabaseResults results;
+    while (cursor->next())
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      DatabaseResult result;
+      if (!DatabaseUtils::GetDatabaseResult(MediaTypeMovie, fields, *cursor, result))
+        return false;
+      result[FieldRow] = (unsigned int)rows.size();
+      results.push_back(result);
 
-      CVideoInfoTag movie = GetDetailsForMovie(record);
+      CFileItemPtr pItem;
+      CVideoInfoTag movie = GetDetailsForMovie(*cursor);
       if (g_settings.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
           g_passwordManager.bMasterUser                                   ||
           g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, g_settings.m_videoSources))
       {
-        CFileItemPtr pItem(new CFileItem(movie));
+        pItem.reset(new CFileItem(movie));
 
         CVideoDbUrl itemUrl = videoUrl;
         CStdString path; path.Format("%ld", movie.m_iDbId);
@@ -5895,12 +5905,32 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
         pItem->SetPath(itemUrl.ToString());
 
         pItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED,movie.m_playCount > 0);
-        items.Add(pItem);
       }
+      rows.push_back(pItem);
+    }
+    cursor.reset();
+
+    int iRowsFound = (int)rows.size();
+    CLog::Log(LOGDEBUG, "%s took %d ms for %d items query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, iRowsFound, strSQL.c_str());
+    if (iRowsFound == 0)
+      return true;
+
+    // store the total value of items as a property
+    if (total < iRowsFound)
+      total = iRowsFound;
+    items.SetProperty("total", total);
+
+    SortUtils::SortDatabaseResults(sortDescription, results);
+
+    // add the items in sorted order
+    items.Reserve(results.size());
+    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    {
+      const CFileItemPtr &pItem = rows[(unsigned int)it->at(FieldRow).asInteger()];
+      if (pItem)
+        items.Add(pItem);
     }
 
-    // cleanup
-    m_pDS->close();
     return true;
   }
   catch (...)
@@ -25,10 +25,12 @@
 #include "filesystem/File.h"
 #include "filesystem/DirectoryCache.h"
 #include "FileItem.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
 #include "GUIUserMessages.h"
 #include "guilib/GUIWindowManager.h"
 #include "TextureCache.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
 #include "video/VideoInfoTag.h"
 #include "video/VideoDatabase.h"
@@ -111,8 +113,17 @@ bool CThumbExtractor::DoWork()
   return result;
 }
 
+/* extraction is mostly spent decoding, so run as many files at once as there are cores to
+   decode them, leaving a few for the GUI and playback unless asked for more */
+static unsigned int GetExtractThumbJobs()
+{
+  if (g_advancedSettings.m_videoExtractThumbJobs > 0)
+    return g_advancedSettings.m_videoExtractThumbJobs;
+  return std::max(1, std::min(4, g_cpuInfo.getCPUCount() - 1));
+}
+
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(1), CJobQueue(true), m_pStreamDetailsObs(NULL)
+  CThumbLoader(1), CJobQueue(true, GetExtractThumbJobs()), m_pStreamDetailsObs(NULL)
 {
   m_database = new CVideoDatabase();
 }
@@ -28,11 +28,16 @@
 #include "input/ButtonTranslator.h"
 #include "guilib/GUIControlFactory.h"
 #include "guilib/GUIFontManager.h"
+#include "guilib/GUIFontTTF.h"
 #include "guilib/GUITextLayout.h"
 #include "guilib/GUIWindowManager.h"
 #include "guilib/GUIControlProfiler.h"
 #include "GUIInfoManager.h"
+#include "GUILargeTextureManager.h"
 #include "utils/Variant.h"
+#if defined(HAS_GL)
+#include "guilib/GUITextureBatchGL.h"
+#endif
 
 #include <climits>
 
@@ -41,6 +46,7 @@ CGUIWindowDebugInfo::CGUIWindowDebugInfo(void)
 {
   m_needsScaling = false;
   m_layout = NULL;
+  m_glyphsMissed = 0;
   m_renderOrder = INT_MAX - 2;
 }
 
@@ -111,6 +117,26 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
     info.Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps\nCPU: %s (CPU-XBMC %4.2f%%%s)", g_settings.m_logFolder.c_str(),
                 stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), dCPU, profiling.c_str());
 #endif
+#if defined(HAS_GL)
+    info.AppendFormat("\nGUI: %u quads in %u draw calls", CGUITextureBatchGL::Get().GetQuads(), CGUITextureBatchGL::Get().GetDrawCalls());
+#endif
+    unsigned int evaluated, cached;
+    g_infoManager.GetBoolStatistics(evaluated, cached);
+    info.AppendFormat("\nCONDITIONS: %u evaluated, %u cached", evaluated, cached);
+    uint64_t resident;
+    unsigned int hits, misses;
+    g_largeTextureManager.GetStatistics(resident, hits, misses);
+    info.AppendFormat("\nLARGE TEXTURES: %"PRIu64" KB, %u%% of %u requests loaded", resident / 1024,
+                      hits + misses ? hits * 100 / (hits + misses) : 0, hits + misses);
+    size_t characters;
+    CGUITextLayoutCache::Get().GetStatistics(hits, misses, characters);
+    info.AppendFormat("\nTEXT LAYOUTS: %"PRIdS" KB, %u%% of %u reused", characters * sizeof(character_t) / 1024,
+                      hits + misses ? hits * 100 / (hits + misses) : 0, hits + misses);
+    unsigned int prefetched;
+    CGUIFontTTFBase::GetGlyphStatistics(prefetched, misses);
+    info.AppendFormat("\nGLYPHS: %u rasterized while drawing this frame, %u of %u prefetched", misses - m_glyphsMissed,
+                      prefetched, prefetched + misses);
+    m_glyphsMissed = misses;
   }
 
   // render the skin debug info
@@ -40,6 +40,7 @@ protected:
   virtual void UpdateVisibility();
 private:
   CGUITextLayout *m_layout;
+  unsigned int m_glyphsMissed;  ///< glyphs rasterized while drawing, as of the last frame
 #ifdef _LINUX
   CLinuxResourceCounter m_resourceCounter;
 #endif